@@ -0,0 +1,116 @@
+/**
+ * @file main.c
+ * @brief Main example file
+ * @author Baudouin FEILDEL
+ */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "../../src/art.h"
+#include "../../src/map.h"
+#include "../../src/helpers.h"
+
+NEW_ART_DEFINITION(Routes, char *);
+NEW_ART_DEFINITION(Paths, int);
+NEW_MAP_DEFINITION(PathMap, int, char *);
+
+IMPLEMENT_ART(Routes, char *, Str_copy, Str_cmp, Str_free);
+IMPLEMENT_ART(Paths, int, Int_copy, Int_cmp, Int_free);
+IMPLEMENT_MAP(PathMap, int, char *, Int_copy, Str_copy, Int_cmp, Str_cmp, Int_free, Str_free);
+
+#define PATHS   10000
+#define LOOKUPS 100000
+
+double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int print_route(char * key, char ** value, void * data)
+{
+    (void)(data);
+    printf("  %s -> %s\n", key, *value);
+    return 0;
+}
+
+int count_path(char * key, int * value, void * data)
+{
+    (void)(key);
+    (void)(value);
+    (*(int *)data)++;
+    return 0;
+}
+
+int main(int argc, char ** argv)
+{
+    Routes  * routes = NULL;
+    Paths   * paths = NULL;
+    PathMap * map = NULL;
+    char   ** keys = malloc(sizeof(char *) * PATHS);
+    char    * match = NULL;
+    char   ** handler = NULL;
+    char      buffer[128];
+    double    start = 0, artTime = 0, mapTime = 0;
+    size_t    mapMemory = 0;
+    long      found = 0;
+    int       i = 0, count = 0;
+
+    printf("--- Adaptive radix tree ---\n");
+    routes = Routes_new();
+    Routes_add(routes, "/", "index");
+    Routes_add(routes, "/api/", "api");
+    Routes_add(routes, "/api/users/", "users");
+    Routes_add(routes, "/api/users/admin", "admin");
+    Routes_add(routes, "/static/", "files");
+    printf("Routes under /api/:\n");
+    Routes_prefix_iterate(routes, "/api/", print_route, NULL);
+    handler = Routes_longest_prefix(routes, "/api/users/42/profile", &match);
+    printf("Longest prefix of /api/users/42/profile: %s -> %s\n", match, *handler);
+    handler = Routes_longest_prefix(routes, "/about", &match);
+    printf("Longest prefix of /about: %s -> %s\n", match, *handler);
+    Routes_remove(routes, "/api/users/");
+    handler = Routes_longest_prefix(routes, "/api/users/42/profile", &match);
+    printf("After removing /api/users/: %s -> %s\n", match, *handler);
+    Routes_free(routes);
+
+    printf("\n--- %d paths: tree against MAP ---\n", PATHS);
+    paths = Paths_new();
+    map   = PathMap_new();
+    for(i = 0 ; i < PATHS ; i++)
+    {
+        snprintf(buffer, sizeof(buffer), "/home/user%d/projects/p%d/src/file%d.c", i % 50, i % 7, i);
+        keys[i] = strdup(buffer);
+        Paths_add(paths, keys[i], i);
+        PathMap_add(map, keys[i], i);
+    }
+    mapMemory = sizeof(PathMap) + (size_t)PATHS * map->elemSize;
+    for(i = 0 ; i < PATHS ; i++)
+        mapMemory += strlen(keys[i]) + 1;
+
+    start = now();
+    for(i = 0 ; i < LOOKUPS ; i++)
+        found += *Paths_get(paths, keys[(i * 7919) % PATHS]);
+    artTime = now() - start;
+    start = now();
+    for(i = 0 ; i < LOOKUPS / 100 ; i++)
+        found += PathMap_get(map, keys[(i * 7919) % PATHS])->value;
+    mapTime = (now() - start) * 100;
+
+    Paths_prefix_iterate(paths, "/home/user7/", count_path, &count);
+    printf("Paths under /home/user7/: %d\n", count);
+    printf("Memory: tree %zu bytes, MAP %zu bytes (%.2fx)\n", Paths_memory(paths), mapMemory,
+           (double)Paths_memory(paths) / mapMemory);
+    printf("%d lookups: tree %.4f s, MAP %.4f s (estimated from %d)\n", LOOKUPS, artTime, mapTime, LOOKUPS / 100);
+    printf("Checksum: %ld\n", found);
+
+    for(i = 0 ; i < PATHS ; i++)
+        free(keys[i]);
+    free(keys);
+    Paths_free(paths);
+    PathMap_free(map);
+
+    return 0;
+}
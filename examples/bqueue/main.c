@@ -0,0 +1,113 @@
+/**
+ * @file main.c
+ * @brief Main example file
+ * @author Baudouin FEILDEL
+ */
+#include <stdio.h>
+
+#include "../../src/bqueue.h"
+#include "../../src/helpers.h"
+
+NEW_BQUEUE_DEFINITION(Jobs, int);
+
+#define PRODUCERS 4
+#define CONSUMERS 2
+#define JOBS      10000
+
+IMPLEMENT_BQUEUE(Jobs, int, Int_copy, Int_cmp, Int_free, Int_print, 0);
+
+typedef struct Worker
+{
+    Jobs * jobs;
+    int    id;
+    long   sum;
+    int    count;
+    int    wakeups;
+} Worker;
+
+void * produce(void * data)
+{
+    Worker * worker = data;
+    int i = 0;
+
+    // Waits while the queue is full
+    for(i = 0 ; i < JOBS ; i++)
+        Jobs_enqueue(worker->jobs, worker->id * JOBS + i);
+    return NULL;
+}
+
+void * consume(void * data)
+{
+    Worker * worker = data;
+    int batch[64];
+    int i = 0, count = 0;
+
+    // Takes up to 64 jobs per wakeup, until the queue is closed and empty
+    while((count = Jobs_dequeue_batch(worker->jobs, batch, 64, 100)) != BQUEUE_CLOSED)
+    {
+        if(count > 0)
+            worker->wakeups++;
+        for(i = 0 ; i < count ; i++)
+            worker->sum += batch[i];
+        worker->count += count;
+    }
+    return NULL;
+}
+
+int main(int argc, char ** argv)
+{
+    Jobs      * jobs = NULL;
+    pthread_t   threads[PRODUCERS + CONSUMERS];
+    Worker      workers[PRODUCERS + CONSUMERS];
+    long        sum = 0;
+    int         i = 0, value = 0, total = 0;
+
+    printf("--- Blocking queue ---\n");
+    jobs = Jobs_new(256);
+
+    printf("Enqueue: ");
+    for(i = 0 ; i < 5 ; i++)
+    {
+        printf("%d, ", i);
+        Jobs_enqueue(jobs, i);
+    }
+    printf("\n");
+    Jobs_print(jobs);
+
+    printf("\nDequeue: ");
+    while(Jobs_dequeue_wait(jobs, &value, 0) == BQUEUE_OK)
+        printf("%d, ", value);
+    printf("\n");
+    printf("Dequeue on an empty queue with a 10ms timeout: %s\n",
+           Jobs_dequeue_wait(jobs, &value, 10) == BQUEUE_TIMEOUT ? "timeout" : "value");
+
+    printf("\n%d producers, %d consumers, capacity 256\n", PRODUCERS, CONSUMERS);
+    for(i = 0 ; i < PRODUCERS + CONSUMERS ; i++)
+    {
+        workers[i].jobs    = jobs;
+        workers[i].id      = i;
+        workers[i].sum     = 0;
+        workers[i].count   = 0;
+        workers[i].wakeups = 0;
+        pthread_create(&threads[i], NULL, i < PRODUCERS ? produce : consume, &workers[i]);
+    }
+
+    // Shutdown: wait for the producers, close, then let the consumers drain
+    for(i = 0 ; i < PRODUCERS ; i++)
+        pthread_join(threads[i], NULL);
+    Jobs_close(jobs);
+    printf("Enqueue after close: %s\n", Jobs_enqueue(jobs, 0) == BQUEUE_CLOSED ? "refused" : "accepted");
+    for(i = PRODUCERS ; i < PRODUCERS + CONSUMERS ; i++)
+    {
+        pthread_join(threads[i], NULL);
+        printf("Consumer %d: %d jobs in %d wakeups\n", i - PRODUCERS, workers[i].count, workers[i].wakeups);
+        sum   += workers[i].sum;
+        total += workers[i].count;
+    }
+    printf("Jobs: %d (expected %d)\n", total, PRODUCERS * JOBS);
+    printf("Sum:  %ld (expected %ld)\n", sum, (long)PRODUCERS * JOBS * (PRODUCERS * JOBS - 1) / 2);
+
+    Jobs_free(jobs);
+
+    return 0;
+}
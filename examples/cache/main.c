@@ -0,0 +1,52 @@
+/**
+ * @file main.c
+ * @brief Main example file
+ * @author Baudouin FEILDEL
+ */
+#include <stdio.h>
+
+#include "../../src/cache.h"
+#include "../../src/helpers.h"
+
+// Cache of page contents by url, limited to 64 bytes of contents
+NEW_CACHE_DEFINITION(PageCache, char *, char *);
+
+size_t Page_size(char * content) { return strlen(content) + 1; }
+
+void Page_evicted(char * content)
+{
+    printf("Evicted: %s\n", content);
+    free(content);
+}
+
+int main(int argc, char ** argv)
+{
+    PageCache * cache = NULL;
+    char * urls[]     = {"/index", "/about", "/blog", "/contact", "/blog", "/shop", "/index"};
+    char * contents[] = {"<h1>Home</h1>", "<h1>About us</h1>", "<h1>Blog</h1>",
+                         "<h1>Contact</h1>", "<h1>Blog</h1>", "<h1>Shop</h1>", "<h1>Home</h1>"};
+    char ** content = NULL;
+    int i = 0;
+
+    printf("--- Cache (LRU, 64 bytes) ---\n");
+    cache = PageCache_new(CACHE_LRU, 64, Page_size);
+    cache->_freeValue = Page_evicted;
+
+    for(i = 0 ; i < 7 ; i++)
+    {
+        content = PageCache_get(cache, urls[i]);
+        if(content == NULL)
+            PageCache_add(cache, urls[i], contents[i]);
+        printf("%-8s %s\n", urls[i], content != NULL ? "hit" : "miss");
+    }
+
+    printf("Hits: %llu, misses: %llu, evictions: %llu, bytes: %zu\n",
+           cache->hits, cache->misses, cache->evictions, cache->used);
+
+    cache->_freeValue = Str_free;
+    PageCache_free(cache);
+
+    return 0;
+}
+
+IMPLEMENT_CACHE(PageCache, char *, char *, Str_copy, Str_copy, Str_cmp, Str_cmp, Str_free, Str_free, Str_hash);
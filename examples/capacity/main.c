@@ -0,0 +1,206 @@
+/**
+ * @file main.c
+ * @brief Main example file
+ * @author Baudouin FEILDEL
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Count the allocations and releases of the containers implemented below */
+static long allocations = 0;
+static long releases    = 0;
+
+static void * count_malloc(size_t size)
+{
+    allocations++;
+    return malloc(size);
+}
+
+static void * count_calloc(size_t count, size_t size)
+{
+    allocations++;
+    return calloc(count, size);
+}
+
+static void * count_realloc(void * ptr, size_t size)
+{
+    allocations++;
+    return realloc(ptr, size);
+}
+
+static void count_free(void * ptr)
+{
+    if(ptr != NULL) releases++;
+    free(ptr);
+}
+
+#define malloc(size)       count_malloc(size)
+#define calloc(count, size) count_calloc(count, size)
+#define realloc(ptr, size) count_realloc(ptr, size)
+#define free(ptr)          count_free(ptr)
+
+#include "../../src/list.h"
+#include "../../src/stack.h"
+#include "../../src/queue.h"
+#include "../../src/map.h"
+#include "../../src/set.h"
+#include "../../src/hmap.h"
+#include "../../src/cache.h"
+#include "../../src/cmap.h"
+#include "../../src/multimap.h"
+#include "../../src/multiset.h"
+#include "../../src/flatmap.h"
+#include "../../src/pqueue.h"
+#include "../../src/deque.h"
+#include "../../src/bqueue.h"
+#include "../../src/roaring.h"
+#include "../../src/helpers.h"
+
+NEW_LIST_DEFINITION(IntList, int);
+NEW_STACK_DEFINITION(IntStack, int);
+NEW_QUEUE_DEFINITION(IntQueue, int);
+NEW_MAP_DEFINITION(IntMap, int, int);
+NEW_SET_DEFINITION(IntSet, int);
+NEW_HMAP_DEFINITION(IntHmap, int, int);
+NEW_CACHE_DEFINITION(IntCache, int, int);
+NEW_CMAP_DEFINITION(IntCmap, int, int);
+NEW_MMAP_DEFINITION(IntMmap, int, int);
+NEW_MSET_DEFINITION(IntMset, int);
+NEW_FLATMAP_DEFINITION(IntFmap, int, int);
+NEW_PQUEUE_DEFINITION(IntPqueue, int);
+NEW_DEQUE_DEFINITION(IntDeque, int);
+NEW_BQUEUE_DEFINITION(IntBqueue, int);
+
+IMPLEMENT_LIST(IntList, int, Int_copy, Int_cmp, Int_free, Int_print);
+IMPLEMENT_STACK(IntStack, int, Int_copy, Int_cmp, Int_free, Int_print, 0);
+IMPLEMENT_QUEUE(IntQueue, int, Int_copy, Int_cmp, Int_free, Int_print, 0);
+IMPLEMENT_MAP(IntMap, int, int, Int_copy, Int_copy, Int_cmp, Int_cmp, Int_free, Int_free);
+IMPLEMENT_SET(IntSet, int, Int_copy, Int_cmp, Int_free, Int_print);
+IMPLEMENT_HMAP(IntHmap, int, int, Int_copy, Int_copy, Int_cmp, Int_cmp, Int_free, Int_free, Int_hash);
+IMPLEMENT_CACHE(IntCache, int, int, Int_copy, Int_copy, Int_cmp, Int_cmp, Int_free, Int_free, Int_hash);
+IMPLEMENT_CMAP(IntCmap, int, int, Int_copy, Int_copy, Int_cmp, Int_cmp, Int_free, Int_free, Int_hash);
+IMPLEMENT_MMAP(IntMmap, int, int, Int_copy, Int_copy, Int_cmp, Int_cmp, Int_free, Int_free, Int_hash);
+IMPLEMENT_MSET(IntMset, int, Int_copy, Int_cmp, Int_free, Int_hash);
+IMPLEMENT_FLATMAP(IntFmap, int, int, Int_copy, Int_copy, Int_cmp, Int_cmp, Int_free, Int_free);
+IMPLEMENT_PQUEUE(IntPqueue, int, 4, Int_copy, Int_cmp, Int_free, Int_print, 0);
+IMPLEMENT_DEQUE(IntDeque, int, Int_copy, Int_cmp, Int_free, Int_print, 0);
+IMPLEMENT_BQUEUE(IntBqueue, int, Int_copy, Int_cmp, Int_free, Int_print, 0);
+
+#define N 1000
+
+/*
+ For one container: fill it with N values, clear and refill it, then
+ reserve N values in a new one and fill it, and finally clear it and
+ shrink it. Prints the allocations of both fills and the releases of
+ _shrink_to_fit.
+ */
+#define CAPACITY_CHECK(NAME, TYPE, NEW, ADD) \
+{ \
+    TYPE * c = NEW; \
+    long refill = 0, reserved = 0, shrunk = 0; \
+    int i = 0; \
+    for(i = 0 ; i < N ; i++) ADD; \
+    TYPE ## _clear(c); \
+    refill = allocations; \
+    for(i = 0 ; i < N ; i++) ADD; \
+    refill = allocations - refill; \
+    TYPE ## _free(c); \
+    c = NEW; \
+    TYPE ## _reserve(c, N); \
+    reserved = allocations; \
+    for(i = 0 ; i < N ; i++) ADD; \
+    reserved = allocations - reserved; \
+    TYPE ## _clear(c); \
+    shrunk = releases; \
+    TYPE ## _shrink_to_fit(c); \
+    shrunk = releases - shrunk; \
+    TYPE ## _free(c); \
+    printf("%-10s %20ld %20ld %20ld\n", NAME, refill, reserved, shrunk); \
+}
+
+int main(int argc, char ** argv)
+{
+    IntList        * list = NULL;
+    IntList_elem_t * first = NULL;
+    IntHmap        * hmap = NULL;
+    long             count = 0;
+    int              i = 0, rehashing = 0;
+
+    printf("--- Storage reused by _clear ---\n");
+    list = IntList_new();
+    for(i = 0 ; i < N ; i++)
+        IntList_add(list, i, i);
+    first = list->begin;
+    IntList_clear(list);
+    printf("After _clear: size %d, %d elements kept\n", list->size, list->spareCount);
+    count = allocations;
+    for(i = 0 ; i < N ; i++)
+        IntList_add(list, i, i);
+    printf("Refilled with %ld allocations, first element at the same address: %s\n",
+           allocations - count, (list->begin == first) ? "yes" : "no");
+    IntList_free(list);
+
+    printf("\n--- _reserve allocates up front ---\n");
+    list = IntList_new();
+    count = allocations;
+    IntList_reserve(list, N);
+    printf("_reserve(%d): %ld allocations\n", N, allocations - count);
+    count = allocations;
+    for(i = 0 ; i < N ; i++)
+        IntList_add(list, i, i);
+    printf("%d insertions: %ld allocations\n", N, allocations - count);
+    count = allocations;
+    IntList_add(list, N, N);
+    printf("Insertion %d: %ld allocation\n", N + 1, allocations - count);
+
+    printf("\n--- _shrink_to_fit releases the kept elements ---\n");
+    for(i = 0 ; i < N / 2 ; i++)
+        IntList_remove(list, i);
+    printf("After %d removals: %d elements kept\n", N / 2, list->spareCount);
+    IntList_clear(list);
+    printf("After _clear: %d elements kept\n", list->spareCount);
+    count = releases;
+    IntList_shrink_to_fit(list);
+    printf("_shrink_to_fit: %ld releases, %d elements kept\n", releases - count, list->spareCount);
+    IntList_free(list);
+
+    printf("\n--- HMAP cleared during an incremental rehash ---\n");
+    hmap = IntHmap_new(HMAP_REHASH_INCREMENTAL);
+    for(i = 0 ; hmap->oldBuckets == NULL ; i++)
+        IntHmap_add(hmap, i, i);
+    IntHmap_add(hmap, i, i);
+    rehashing = (hmap->oldBuckets != NULL);
+    printf("%d elements, rehash running: %s (%d of %d old buckets moved)\n",
+           hmap->size, rehashing ? "yes" : "no", hmap->migrated, hmap->oldCount);
+    IntHmap_clear(hmap);
+    printf("After _clear: size %d, rehash running: %s, %d elements kept, key 0 %s\n",
+           hmap->size, (hmap->oldBuckets != NULL) ? "yes" : "no", hmap->spareCount,
+           (IntHmap_get(hmap, 0) == NULL) ? "absent" : "present");
+    for(i = 0 ; i < N ; i++)
+        IntHmap_add(hmap, i, i);
+    printf("Refilled with %d elements: size %d, key %d = %d\n",
+           N, hmap->size, N - 1, *IntHmap_get(hmap, N - 1));
+    IntHmap_free(hmap);
+
+    printf("\n--- %d values in every container ---\n", N);
+    printf("%-10s %20s %20s %20s\n", "Container", "Refill after _clear", "Fill after _reserve", "_shrink_to_fit frees");
+    CAPACITY_CHECK("LIST",     IntList,   IntList_new(),   IntList_add(c, i, i));
+    CAPACITY_CHECK("STACK",    IntStack,  IntStack_new(),  IntStack_push(c, i));
+    CAPACITY_CHECK("QUEUE",    IntQueue,  IntQueue_new(),  IntQueue_enqueue(c, i));
+    CAPACITY_CHECK("MAP",      IntMap,    IntMap_new(),    IntMap_add(c, i, i));
+    CAPACITY_CHECK("SET",      IntSet,    IntSet_new(),    IntSet_add(c, i));
+    CAPACITY_CHECK("HMAP",     IntHmap,   IntHmap_new(HMAP_REHASH_INCREMENTAL), IntHmap_add(c, i, i));
+    CAPACITY_CHECK("CACHE",    IntCache,  IntCache_new(CACHE_LRU, 2 * N, NULL), IntCache_add(c, i, i));
+    CAPACITY_CHECK("CMAP",     IntCmap,   IntCmap_new(4),  IntCmap_add(c, i, i));
+    CAPACITY_CHECK("MMAP",     IntMmap,   IntMmap_new(),   IntMmap_add(c, i, i));
+    CAPACITY_CHECK("MSET",     IntMset,   IntMset_new(),   IntMset_add(c, i, 1));
+    CAPACITY_CHECK("FLATMAP",  IntFmap,   IntFmap_new(),   IntFmap_add(c, i, i));
+    CAPACITY_CHECK("PQUEUE",   IntPqueue, IntPqueue_new(), IntPqueue_push(c, i));
+    CAPACITY_CHECK("DEQUE",    IntDeque,  IntDeque_new(),  IntDeque_pushBack(c, i));
+    CAPACITY_CHECK("BQUEUE",   IntBqueue, IntBqueue_new(0), IntBqueue_enqueue(c, i));
+    CAPACITY_CHECK("Roaring",  Roaring,   Roaring_new(),   Roaring_add(c, (uint32_t)i * 70000));
+
+    (void)(argc);
+    (void)(argv);
+    return 0;
+}
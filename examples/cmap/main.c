@@ -0,0 +1,111 @@
+/**
+ * @file main.c
+ * @brief Main example file
+ * @details Read scaling benchmark: every thread looks up random keys
+ * in a shared concurrent map.
+ * @author Baudouin FEILDEL
+ */
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "../../src/cmap.h"
+#include "../../src/helpers.h"
+
+NEW_CMAP_DEFINITION(HitMap, int, char *);
+
+#define KEYS          100000
+#define READS         2000000
+#define MAX_THREADS   64
+
+typedef struct Reader
+{
+    pthread_t      thread;
+    HitMap       * map;
+    char        ** keys;
+    unsigned int   seed;
+    long           found;
+} Reader;
+
+static void * read_keys(void * data)
+{
+    Reader * reader = data;
+    int i = 0, value = 0;
+    for(i = 0 ; i < READS ; i++)
+        reader->found += HitMap_get(reader->map, reader->keys[rand_r(&(reader->seed)) % KEYS], &value);
+    return NULL;
+}
+
+static int count_hit(int * value, int exists, void * data)
+{
+    (void)(data);
+    *value = exists ? *value + 1 : 1;
+    return 1;
+}
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char ** argv)
+{
+    HitMap * hits = NULL;
+    char  ** keys = NULL;
+    Reader   readers[MAX_THREADS];
+    char     buffer[32];
+    char   * name = buffer;
+    double   start = 0, elapsed = 0, reference = 0;
+    int      i = 0, threads = 0, cores = 0, value = 0;
+
+    printf("--- Concurrent map (read scaling) ---\n");
+    hits = HitMap_new(0);
+
+    keys = malloc(sizeof(char *) * KEYS);
+    for(i = 0 ; i < KEYS ; i++)
+    {
+        sprintf(buffer, "user-%d", i);
+        Str_copy(&(keys[i]), &name);
+        HitMap_add(hits, keys[i], 0);
+    }
+
+    // Atomic read-modify-write
+    HitMap_update_with(hits, "user-42", count_hit, NULL);
+    HitMap_update_with(hits, "user-42", count_hit, NULL);
+    HitMap_get(hits, "user-42", &value);
+    printf("%d keys, user-42 has %d hits\n", HitMap_size(hits), value);
+
+    // Usage: cmap [max threads], defaults to the number of cores
+    cores = (argc > 1) ? atoi(argv[1]) : sysconf(_SC_NPROCESSORS_ONLN);
+    if(cores > MAX_THREADS) cores = MAX_THREADS;
+    for(threads = 1 ; threads <= cores ; threads = (threads < cores && threads * 2 > cores) ? cores : threads * 2)
+    {
+        start = now();
+        for(i = 0 ; i < threads ; i++)
+        {
+            readers[i].map   = hits;
+            readers[i].keys  = keys;
+            readers[i].seed  = i + 1;
+            readers[i].found = 0;
+            pthread_create(&(readers[i].thread), NULL, read_keys, &(readers[i]));
+        }
+        for(i = 0 ; i < threads ; i++)
+            pthread_join(readers[i].thread, NULL);
+        elapsed = now() - start;
+        if(threads == 1) reference = elapsed;
+        printf("%2d thread(s): %6.2f Mreads/s, speedup %.2fx\n", threads,
+               threads * (READS / 1e6) / elapsed, threads * reference / elapsed);
+    }
+
+    for(i = 0 ; i < KEYS ; i++)
+        free(keys[i]);
+    free(keys);
+    HitMap_free(hits);
+
+	return 0;
+}
+
+IMPLEMENT_CMAP(HitMap, int, char *, Int_copy, Str_copy, Int_cmp, Str_cmp, Int_free, Str_free, Str_hash);
@@ -0,0 +1,104 @@
+/**
+ * @file main.c
+ * @brief Main example file
+ * @author Baudouin FEILDEL
+ */
+#include <stdio.h>
+#include <time.h>
+
+#include "../../src/cseq.h"
+#include "../../src/queue.h"
+#include "../../src/helpers.h"
+
+NEW_CSEQ_DEFINITION(EventIds, int);
+NEW_CSEQ_DEFINITION(Timestamps, int64_t);
+NEW_QUEUE_DEFINITION(IdQueue, int);
+
+IMPLEMENT_CSEQ(EventIds, int, -1);
+IMPLEMENT_CSEQ(Timestamps, int64_t, -1);
+IMPLEMENT_QUEUE(IdQueue, int, Int_copy, Int_cmp, Int_free, Int_print, -1);
+
+#define EVENTS (1 << 22)
+
+double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void sum_value(int value, void * data)
+{
+    *(long *)data += value;
+}
+
+int main(int argc, char ** argv)
+{
+    EventIds   * ids = NULL;
+    Timestamps * times = NULL;
+    IdQueue    * queue = NULL;
+    double       start = 0, seqTime = 0, queueTime = 0, ratio = 0;
+    size_t       memory = 0;
+    long         sum = 0;
+    int64_t      t = 1700000000000000LL;
+    unsigned     seed = 1;
+    int          i = 0, id = 0;
+
+    printf("--- Compressed sequence ---\n");
+    ids = EventIds_new();
+    EventIds_append(ids, 1000);
+    EventIds_append(ids, 1001);
+    EventIds_append(ids, 1005);
+    EventIds_append(ids, 990);
+    printf("Dequeue: %d, ", EventIds_dequeue(ids));
+    printf("head: %d, size: %d\n", EventIds_head(ids), ids->size);
+    EventIds_clear(ids);
+
+    printf("\n--- %d sorted event IDs: compressed sequence against QUEUE ---\n", EVENTS);
+    queue = IdQueue_new();
+    start = now();
+    for(i = 0, id = 0 ; i < EVENTS ; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        id  += 1 + (seed >> 16) % 8;
+        EventIds_append(ids, id);
+    }
+    EventIds_forEach(ids, sum_value, &sum);
+    memory = EventIds_memory(ids);
+    ratio  = EventIds_ratio(ids);
+    while(ids->size > 0)
+        sum -= EventIds_dequeue(ids);
+    seqTime = now() - start;
+
+    start = now();
+    for(i = 0, id = 0, seed = 1 ; i < EVENTS ; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        id  += 1 + (seed >> 16) % 8;
+        IdQueue_enqueue(queue, id);
+    }
+    while(queue->size > 0)
+        sum += IdQueue_dequeue(queue);
+    queueTime = now() - start;
+
+    printf("Memory: sequence %zu bytes (ratio %.2f against an array),"
+           " QUEUE %zu bytes (%.1fx more)\n", memory, ratio,
+           (size_t)EVENTS * queue->elemSize, (double)EVENTS * queue->elemSize / memory);
+    printf("Append, iterate and dequeue: sequence %.3f s, QUEUE %.3f s\n", seqTime, queueTime);
+    printf("Checksum: %ld\n", sum);
+    EventIds_free(ids);
+    IdQueue_free(queue);
+
+    printf("\n--- %d timestamps (microseconds, about 1 ms apart) ---\n", EVENTS);
+    times = Timestamps_new();
+    for(i = 0 ; i < EVENTS ; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        t   += 900 + (seed >> 16) % 200;
+        Timestamps_append(times, t);
+    }
+    printf("Memory: %zu bytes, ratio %.2f against an array\n", Timestamps_memory(times), Timestamps_ratio(times));
+    Timestamps_free(times);
+
+    return 0;
+}
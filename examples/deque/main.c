@@ -0,0 +1,54 @@
+/**
+ * @file main.c
+ * @brief Main example file
+ * @author Baudouin FEILDEL
+ */
+#include <stdio.h>
+
+#include "../../src/deque.h"
+#include "../../src/helpers.h"
+
+NEW_DEQUE_DEFINITION(MyDeque, int);
+
+#define RANDOM_MAX 10000
+
+int main(int argc, char ** argv)
+{
+    MyDeque * deque = NULL;
+    int * third = NULL;
+    int i = 0;
+
+    printf("--- Deque ---\n");
+    deque = MyDeque_new();
+
+    for(i = 0 ; i < 4 ; i++)
+    {
+        MyDeque_pushBack(deque, rand() % RANDOM_MAX);
+        MyDeque_pushFront(deque, -i);
+    }
+    printf("Deque: ");
+    MyDeque_print(deque);
+
+    // Elements never move: the pointer stays valid while pushing
+    third = MyDeque_at(deque, 2);
+    for(i = 0 ; i < 1000 ; i++)
+        MyDeque_pushFront(deque, i);
+    printf("Third element before the pushes: %d\n", *third);
+
+    printf("Front: %d, back: %d, size: %d\n", MyDeque_front(deque), MyDeque_back(deque), deque->size);
+    printf("Pop front: %d, pop back: %d\n", MyDeque_popFront(deque), MyDeque_popBack(deque));
+
+    // Used as a FIFO, the emptied blocks are reused: no allocation
+    for(i = 0 ; i < 100000 ; i++)
+    {
+        MyDeque_pushBack(deque, i);
+        MyDeque_popFront(deque);
+    }
+    printf("Size: %d, blocks: %d\n", deque->size, deque->blockCount);
+
+    MyDeque_free(deque);
+
+	return 0;
+}
+
+IMPLEMENT_DEQUE(MyDeque, int, Int_copy, Int_cmp, Int_free, Int_print, 0);
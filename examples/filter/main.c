@@ -0,0 +1,49 @@
+/**
+ * @file main.c
+ * @brief Main example file
+ * @author Baudouin FEILDEL
+ */
+#include <stdio.h>
+
+#include "../../src/filter.h"
+#include "../../src/helpers.h"
+
+#define ELEMENTS 100000
+
+int main(int argc, char ** argv)
+{
+    BloomFilter  * bloom  = NULL;
+    CuckooFilter * cuckoo = NULL;
+    int i = 0, bloomPositives = 0, cuckooPositives = 0;
+
+    printf("--- Filters ---\n");
+    bloom  = BloomFilter_new(ELEMENTS, 0);
+    cuckoo = CuckooFilter_new(ELEMENTS);
+
+    // Even numbers are added
+    for(i = 0 ; i < 2 * ELEMENTS ; i += 2)
+    {
+        BloomFilter_add(bloom, Int_hash(i));
+        CuckooFilter_add(cuckoo, Int_hash(i));
+    }
+
+    // Odd numbers were never added: every positive is a false positive
+    for(i = 1 ; i < 2 * ELEMENTS ; i += 2)
+    {
+        bloomPositives  += BloomFilter_contains(bloom, Int_hash(i));
+        cuckooPositives += CuckooFilter_contains(cuckoo, Int_hash(i));
+    }
+    printf("Bloom filter:  %zu bytes, %.3f%% false positives\n",
+           bloom->blockCount * 64, 100.0 * bloomPositives / ELEMENTS);
+    printf("Cuckoo filter: %zu bytes, %.3f%% false positives\n",
+           cuckoo->bucketCount * 8, 100.0 * cuckooPositives / ELEMENTS);
+
+    // Only the cuckoo filter can forget an element
+    CuckooFilter_remove(cuckoo, Int_hash(42));
+    printf("42 after removal: %s\n", CuckooFilter_contains(cuckoo, Int_hash(42)) ? "maybe present" : "absent");
+
+    BloomFilter_free(bloom);
+    CuckooFilter_free(cuckoo);
+
+    return 0;
+}
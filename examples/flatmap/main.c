@@ -0,0 +1,84 @@
+/**
+ * @file main.c
+ * @brief Main example file
+ * @author Baudouin FEILDEL
+ */
+#include <stdio.h>
+#include <math.h>
+
+#include "../../src/flatmap.h"
+#include "../../src/helpers.h"
+
+NEW_FLATMAP_DEFINITION(ScoreMap, int, int);
+// Same values, searched with the kernels of simd.h and with Double_cmp
+NEW_FLATMAP_DEFINITION(RatioMap, double, int);
+NEW_FLATMAP_DEFINITION(RatioMapCmp, double, int);
+
+#define PLAYERS   8
+#define SCORE_MAX 100
+
+int main(int argc, char ** argv)
+{
+	ScoreMap * scores = NULL;
+	RatioMap * ratios = NULL;
+	RatioMapCmp * ratiosCmp = NULL;
+	int * score = NULL;
+	int ids[PLAYERS], values[PLAYERS], positions[PLAYERS + 3];
+	int i = 0, count = 0;
+
+    printf("--- Flat map (scores) ---\n");
+	scores = ScoreMap_new();
+
+    // One by one
+    ScoreMap_add(scores, 42, rand() % SCORE_MAX);
+    ScoreMap_add(scores, 7,  rand() % SCORE_MAX);
+    ScoreMap_add(scores, 19, rand() % SCORE_MAX);
+
+    // Batch: sorted once, merged once. Player 7 is updated.
+    for(i = 0 ; i < PLAYERS ; i++)
+    {
+        ids[i]    = (i * 7) % 50;
+        values[i] = rand() % SCORE_MAX;
+    }
+    ScoreMap_addBatch(scores, ids, values, PLAYERS);
+
+    ScoreMap_remove(scores, 42);
+
+    for(i = 0 ; i < scores->size ; i++)
+        printf("Player %d scored %d\n", scores->index[i], scores->value[i]);
+
+    score = ScoreMap_get(scores, 19);
+    printf("Player 19: %d\n", score ? *score : -1);
+    score = ScoreMap_get(scores, 42);
+    printf("Player 42: %s\n", score ? "present" : "removed");
+
+    // Vectorized scan of the values
+    ScoreMap_add(scores, 3, 50);
+    ScoreMap_add(scores, 5, 50);
+    printf("%d players scored 50:", ScoreMap_count(scores, 50));
+    count = ScoreMap_find_all(scores, 50, positions);
+    for(i = 0 ; i < count ; i++)
+        printf(" %d", scores->index[positions[i]]);
+    printf("\n");
+
+    ScoreMap_free(scores);
+
+    // NaN matches NaN in both versions, as with Double_cmp
+    ratios    = RatioMap_new();
+    ratiosCmp = RatioMapCmp_new();
+    for(i = 0 ; i < PLAYERS ; i++)
+    {
+        RatioMap_add(ratios, i, (i % 3 == 0) ? NAN : 1.0 / (i + 1));
+        RatioMapCmp_add(ratiosCmp, i, (i % 3 == 0) ? NAN : 1.0 / (i + 1));
+    }
+    printf("Players without ratio: %d (vectorized), %d (Double_cmp)\n",
+           RatioMap_count(ratios, NAN), RatioMapCmp_count(ratiosCmp, NAN));
+    RatioMap_free(ratios);
+    RatioMapCmp_free(ratiosCmp);
+
+	return 0;
+}
+
+IMPLEMENT_FLATMAP_PRIMITIVE(ScoreMap, int, int, Int, Int_copy, Int_cmp, Int_free);
+IMPLEMENT_FLATMAP_PRIMITIVE(RatioMap, double, int, Double, Int_copy, Int_cmp, Int_free);
+IMPLEMENT_FLATMAP(RatioMapCmp, double, int, Double_copy, Int_copy, Double_cmp, Int_cmp, Double_free, Int_free);
@@ -0,0 +1,97 @@
+/**
+ * @file main.c
+ * @brief Main example file
+ * @author Baudouin FEILDEL
+ */
+#include <stdio.h>
+#include <time.h>
+
+#include "../../src/hmap.h"
+#include "../../src/helpers.h"
+
+NEW_HMAP_DEFINITION(Ages, int, char *);
+NEW_HMAP_DEFINITION(IntMap, int, int);
+
+IMPLEMENT_HMAP(Ages, int, char *, Int_copy, Str_copy, Int_cmp, Str_cmp, Int_free, Str_free, Str_hash);
+IMPLEMENT_HMAP(IntMap, int, int, Int_copy, Int_copy, Int_cmp, Int_cmp, Int_free, Int_free, Int_hash);
+
+#define INSERTS (1 << 20)
+
+void print_age(char * name, int * age, void * data)
+{
+    (void)(data);
+    printf("  %s: %d\n", name, *age);
+}
+
+long long now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+int cmp_latency(const void * a, const void * b)
+{
+    long long x = *(const long long *)a, y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+// Time every insertion and print the latency percentiles.
+// Maps are freed by the caller once every benchmark is done: freeing millions
+// of elements makes the next allocations pay for the allocator cleanup.
+IntMap * benchmark(const char * name, int mode, int reserve, long long * latencies)
+{
+    IntMap * map = IntMap_new(mode);
+    long long start = 0, total = 0;
+    int i = 0;
+
+    if(reserve)
+        IntMap_reserve(map, INSERTS);
+    for(i = 0 ; i < INSERTS ; i++)
+    {
+        start = now_ns();
+        IntMap_add(map, i, i);
+        latencies[i] = now_ns() - start;
+        total += latencies[i];
+    }
+    qsort(latencies, INSERTS, sizeof(long long), cmp_latency);
+    printf("%-12s %8.1f %8lld %8lld %8lld %10lld\n", name, (double)total / INSERTS,
+           latencies[INSERTS / 2], latencies[(long long)INSERTS * 99 / 100],
+           latencies[(long long)INSERTS * 999 / 1000], latencies[INSERTS - 1]);
+    return map;
+}
+
+int main(int argc, char ** argv)
+{
+    Ages      * ages = NULL;
+    IntMap    * maps[3];
+    long long * latencies = malloc(sizeof(long long) * INSERTS);
+    int       * age = NULL;
+    int         i = 0;
+
+    printf("--- Hash map ---\n");
+    ages = Ages_new(HMAP_REHASH_INCREMENTAL);
+    Ages_add(ages, "Alice", 31);
+    Ages_add(ages, "Bob", 27);
+    Ages_add(ages, "Carol", 45);
+    Ages_add(ages, "Bob", 28);
+    Ages_forEach(ages, print_age, NULL);
+    age = Ages_get(ages, "Carol");
+    printf("Get Carol: %d\n", age != NULL ? *age : -1);
+    Ages_remove(ages, "Alice");
+    printf("Get Alice after remove: %s\n", Ages_get(ages, "Alice") != NULL ? "found" : "not found");
+    printf("Size: %d\n", ages->size);
+    Ages_free(ages);
+
+    printf("\n--- Insert latency of %d ints (ns) ---\n", INSERTS);
+    printf("%-12s %8s %8s %8s %8s %10s\n", "mode", "mean", "p50", "p99", "p999", "max");
+    maps[0] = benchmark("full", HMAP_REHASH_FULL, 0, latencies);
+    maps[1] = benchmark("incremental", HMAP_REHASH_INCREMENTAL, 0, latencies);
+    maps[2] = benchmark("reserved", HMAP_REHASH_FULL, 1, latencies);
+    for(i = 0 ; i < 3 ; i++)
+        IntMap_free(maps[i]);
+
+    free(latencies);
+
+    return 0;
+}
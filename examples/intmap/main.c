@@ -0,0 +1,102 @@
+/**
+ * @file main.c
+ * @brief Main example file
+ * @author Baudouin FEILDEL
+ */
+#include <stdio.h>
+#include <time.h>
+
+#include "../../src/intmap.h"
+#include "../../src/hmap.h"
+#include "../../src/helpers.h"
+
+NEW_IMAP_DEFINITION(Users, char *);
+NEW_IMAP_DEFINITION(IntMap, int);
+NEW_HMAP_DEFINITION(IntHash, int, int);
+
+IMPLEMENT_IMAP(Users, char *, Str_copy, Str_cmp, Str_free);
+IMPLEMENT_IMAP(IntMap, int, Int_copy, Int_cmp, Int_free);
+IMPLEMENT_HMAP(IntHash, int, int, Int_copy, Int_copy, Int_cmp, Int_cmp, Int_free, Int_free, Int_hash);
+
+#define KEYS    (1 << 20)
+#define LOOKUPS (1 << 23)
+
+const char * modes[] = {"direct", "paged", "hash"};
+
+double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void print_user(unsigned int key, char ** value, void * data)
+{
+    (void)(data);
+    printf("  %u -> %s\n", key, *value);
+}
+
+// Keys of the benchmark: i-th key of a dense, clustered or random set
+unsigned int make_key(int set, unsigned int i)
+{
+    switch(set)
+    {
+        case 0:  return 1000 + i;
+        case 1:  return (i / 512) * 100000 + i % 512;
+        default: return (i * 2654435761u) & 0x7FFFFFFF;
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    Users   * users = NULL;
+    IntMap  * map = NULL;
+    IntHash * hash = NULL;
+    const char * names[] = {"dense", "clustered", "random"};
+    double    start = 0, mapTime = 0, hashTime = 0;
+    long      found = 0;
+    int       set = 0, i = 0;
+
+    printf("--- Integer map ---\n");
+    users = Users_new();
+    Users_add(users, 3, "carol");
+    Users_add(users, 1, "alice");
+    Users_add(users, 2, "bob");
+    printf("Users (%s layout):\n", modes[users->mode]);
+    Users_forEach(users, print_user, NULL);
+    Users_add(users, 4000000000u, "root");
+    printf("After adding 4000000000: %s layout, get 2: %s\n", modes[users->mode], *Users_get(users, 2));
+    Users_remove(users, 4000000000u);
+    Users_shrink_to_fit(users);
+    printf("After removing it and shrinking: %s layout\n", modes[users->mode]);
+    Users_free(users);
+
+    printf("\n--- %d keys, %d lookups: IMAP against HMAP ---\n", KEYS, LOOKUPS);
+    for(set = 0 ; set < 3 ; set++)
+    {
+        map  = IntMap_new();
+        hash = IntHash_new(HMAP_REHASH_FULL);
+        for(i = 0 ; i < KEYS ; i++)
+        {
+            IntMap_add(map, make_key(set, i), i);
+            IntHash_add(hash, (int)make_key(set, i), i);
+        }
+
+        start = now();
+        for(i = 0 ; i < LOOKUPS ; i++)
+            found += *IntMap_get(map, make_key(set, (i * 7919u) % KEYS));
+        mapTime = now() - start;
+        start = now();
+        for(i = 0 ; i < LOOKUPS ; i++)
+            found += *IntHash_get(hash, (int)make_key(set, (i * 7919u) % KEYS));
+        hashTime = now() - start;
+
+        printf("%-9s (%-6s layout): IMAP %.4f s, HMAP %.4f s (%.2fx)\n", names[set], modes[map->mode],
+               mapTime, hashTime, hashTime / mapTime);
+        IntMap_free(map);
+        IntHash_free(hash);
+    }
+    printf("Checksum: %ld\n", found);
+
+    return 0;
+}
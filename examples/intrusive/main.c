@@ -0,0 +1,78 @@
+/**
+ * @file main.c
+ * @brief Main example file
+ * @author Baudouin FEILDEL
+ */
+#include <stdio.h>
+
+#include "../../src/intrusive.h"
+
+// A task is in the list of all the tasks, and in the ready queue or in
+// the undo stack, without any node allocation
+typedef struct Task
+{
+    int id;
+    Intrusive_link all;   // Link of TaskList
+    Intrusive_link ready; // Link of ReadyQueue
+    Intrusive_link undo;  // Link of UndoStack
+} Task;
+
+NEW_ILIST_DEFINITION(TaskList, Task);
+NEW_IQUEUE_DEFINITION(ReadyQueue, Task);
+NEW_ISTACK_DEFINITION(UndoStack, Task);
+
+#define TASKS 6
+
+int main(int argc, char ** argv)
+{
+    Task tasks[TASKS];
+    TaskList   * all = NULL;
+    ReadyQueue   ready;
+    UndoStack  * undo = NULL;
+    Task * it = NULL;
+    int i = 0;
+
+    printf("--- Intrusive containers (tasks) ---\n");
+    all  = TaskList_new();
+    undo = UndoStack_new();
+    ReadyQueue_init(&ready); // On the stack
+
+    for(i = 0 ; i < TASKS ; i++)
+    {
+        tasks[i].id = i;
+        Intrusive_link_init(&(tasks[i].all));
+        Intrusive_link_init(&(tasks[i].ready));
+        Intrusive_link_init(&(tasks[i].undo));
+        TaskList_pushBack(all, &tasks[i]);
+        if(i % 2 == 0)
+            ReadyQueue_enqueue(&ready, &tasks[i]);
+    }
+
+    // O(1) removal from the middle of the queue, the task stays in the list
+    ReadyQueue_remove(&ready, &tasks[2]);
+    UndoStack_push(undo, &tasks[2]);
+    printf("Task 2 ready: %d, in undo stack: %d\n", ReadyQueue_isLinked(&tasks[2]), UndoStack_isLinked(&tasks[2]));
+
+    printf("All tasks:");
+    for(it = TaskList_first(all) ; it != NULL ; it = TaskList_next(all, it))
+        printf(" %d", it->id);
+    printf("\n");
+
+    printf("Ready tasks:");
+    while((it = ReadyQueue_dequeue(&ready)) != NULL)
+        printf(" %d", it->id);
+    printf("\n");
+
+    printf("Undo: %d\n", UndoStack_pop(undo)->id);
+
+    // The tasks are not freed by the containers
+    TaskList_free(all);
+    UndoStack_free(undo);
+    ReadyQueue_clear(&ready);
+
+    return 0;
+}
+
+IMPLEMENT_ILIST(TaskList, Task, all);
+IMPLEMENT_IQUEUE(ReadyQueue, Task, ready);
+IMPLEMENT_ISTACK(UndoStack, Task, undo);
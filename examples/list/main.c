@@ -9,6 +9,7 @@
 #include "../../src/helpers.h"
 
 NEW_LIST_DEFINITION(MyList, int);
+LIST_FN_RADIX_SORT(MyList);
 
 #define RANDOM_MAX 10000
 
@@ -42,9 +43,22 @@ int main(int argc, char ** argv)
     avg = sum/list->size;
     printf("Average value: %.2f\n", avg);
 
+    MyList_sort(list, 0);
+    printf("Sorted list: ");
+    MyList_print(list);
+
+    MyList_sortByIndex(list);
+    printf("Sorted by index: ");
+    MyList_print(list);
+
+    MyList_radixSort(list, 1);
+    printf("Radix sorted and reindexed: ");
+    MyList_print(list);
+
     MyList_free(list);
 
 	return 0;
 }
 
-IMPLEMENT_LIST(MyList, int, Int_copy, Int_cmp, Int_free, Int_print);
\ No newline at end of file
+IMPLEMENT_LIST(MyList, int, Int_copy, Int_cmp, Int_free, Int_print);
+IMPLEMENT_LIST_FN_RADIX_SORT(MyList, int);
\ No newline at end of file
@@ -41,6 +41,11 @@ int main(int argc, char ** argv)
     avg = sum/ages->size;
     printf("Average age: %.2f\n", avg);
 
+    // Absent names are rejected by the filter, without walking the map
+    AgeMap_attachFilter(ages, Str_hash);
+    printf("Ringo is %s\n", AgeMap_get(ages, "Ringo") != NULL ? "known" : "unknown");
+    printf("Mary is %s\n", AgeMap_get(ages, "Mary") != NULL ? "known" : "unknown");
+
     AgeMap_free(ages);
 
 	return 0;
@@ -0,0 +1,130 @@
+/**
+ * @file main.c
+ * @brief Main example file
+ * @author Baudouin FEILDEL
+ */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "../../src/multimap.h"
+#include "../../src/multiset.h"
+#include "../../src/hmap.h"
+#include "../../src/helpers.h"
+
+NEW_MMAP_DEFINITION(Classes, char *, char *);
+NEW_MSET_DEFINITION(Words, char *);
+NEW_MSET_DEFINITION(Histogram, int);
+NEW_HMAP_DEFINITION(Counts, int, int);
+
+IMPLEMENT_MMAP(Classes, char *, char *, Str_copy, Str_copy, Str_cmp, Str_cmp, Str_free, Str_free, Str_hash);
+IMPLEMENT_MSET(Words, char *, Str_copy, Str_cmp, Str_free, Str_hash);
+IMPLEMENT_MSET(Histogram, int, Int_copy, Int_cmp, Int_free, Int_hash);
+IMPLEMENT_HMAP(Counts, int, int, Int_copy, Int_copy, Int_cmp, Int_cmp, Int_free, Int_free, Int_hash);
+
+#define STREAM (1 << 23)
+#define TOP_K  10
+
+double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void print_class(char * name, char ** students, int count, void * data)
+{
+    int i = 0;
+    (void)(data);
+    printf("  %s (%d):", name, count);
+    for(i = 0 ; i < count ; i++)
+        printf(" %s", students[i]);
+    printf("\n");
+}
+
+// Skewed stream: small values are much more frequent than large ones
+int next_value(uint64_t * state)
+{
+    uint64_t x = *state;
+    x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+    *state = x;
+    return (int)((x & 0xFFFFF) % (1 + ((x >> 32) % 100000)));
+}
+
+int main(int argc, char ** argv)
+{
+    Classes   * classes = NULL;
+    Words     * words = NULL;
+    Histogram * histogram = NULL;
+    Counts    * counts = NULL;
+    char      * text[] = {"the", "cat", "and", "the", "dog", "and", "the", "bird", "saw", "the", "cat"};
+    char      * topWords[3];
+    char     ** students = NULL;
+    int         topValues[TOP_K];
+    uint64_t    topCounts[TOP_K];
+    uint64_t    state = 42;
+    double      start = 0, msetTime = 0, hmapTime = 0;
+    int       * count = NULL;
+    int         i = 0, n = 0, value = 0;
+
+    printf("--- Multimap ---\n");
+    classes = Classes_new();
+    Classes_add(classes, "Math", "Alice");
+    Classes_add(classes, "Math", "Bob");
+    Classes_add(classes, "Art", "Carol");
+    Classes_add(classes, "Math", "Dave");
+    Classes_add(classes, "Art", "Alice");
+    Classes_forEach(classes, print_class, NULL);
+    students = Classes_get_all(classes, "Math", &n);
+    printf("Math: %d students, first is %s\n", n, students[0]);
+    Classes_remove_one(classes, "Math", "Bob");
+    printf("Math after removing Bob: %d\n", Classes_count(classes, "Math"));
+    printf("Removed Art with its %d students\n", Classes_remove_all(classes, "Art"));
+    printf("Indexes: %d, values: %d\n", classes->keys, classes->size);
+    Classes_free(classes);
+
+    printf("\n--- Counting multiset ---\n");
+    words = Words_new();
+    for(i = 0 ; i < (int)(sizeof(text) / sizeof(text[0])) ; i++)
+        Words_add(words, text[i], 1);
+    printf("'the' seen %llu times, 'fish' %llu times\n",
+           (unsigned long long)Words_count(words, "the"), (unsigned long long)Words_count(words, "fish"));
+    Words_remove(words, "cat", 1);
+    n = Words_top(words, 3, topWords, topCounts);
+    printf("Top %d:", n);
+    for(i = 0 ; i < n ; i++)
+        printf(" %s (%llu)", topWords[i], (unsigned long long)topCounts[i]);
+    printf("\nDistinct: %d, total: %llu\n", words->size, (unsigned long long)words->total);
+    Words_free(words);
+
+    printf("\n--- Histogram of %d skewed ints ---\n", STREAM);
+    histogram = Histogram_new();
+    start = now();
+    for(i = 0 ; i < STREAM ; i++)
+        Histogram_add(histogram, next_value(&state), 1);
+    msetTime = now() - start;
+
+    state = 42;
+    counts = Counts_new(HMAP_REHASH_FULL);
+    start = now();
+    for(i = 0 ; i < STREAM ; i++)
+    {
+        value = next_value(&state);
+        if((count = Counts_get(counts, value)) != NULL)
+            (*count)++;
+        else
+            Counts_add(counts, value, 1);
+    }
+    hmapTime = now() - start;
+
+    printf("multiset: %.3f s, hash map: %.3f s (%d distinct values)\n", msetTime, hmapTime, histogram->size);
+    n = Histogram_top(histogram, TOP_K, topValues, topCounts);
+    printf("Top %d:", n);
+    for(i = 0 ; i < n ; i++)
+        printf(" %d (%llu)", topValues[i], (unsigned long long)topCounts[i]);
+    printf("\n");
+    Histogram_free(histogram);
+    Counts_free(counts);
+
+    return 0;
+}
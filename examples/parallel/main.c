@@ -0,0 +1,93 @@
+/**
+ * @file main.c
+ * @brief Main example file
+ * @author Baudouin FEILDEL
+ */
+#include <stdio.h>
+
+#include "../../src/parallel.h"
+#include "../../src/list.h"
+#include "../../src/helpers.h"
+
+NEW_LIST_DEFINITION(MyList, int);
+
+// Algorithms over int arrays, reducing to long
+NEW_PARALLEL_DEFINITION(ParInt, int, long);
+// Algorithms over double arrays, reducing to double
+NEW_PARALLEL_DEFINITION(ParDouble, double, double);
+// Algorithms over MyList, reducing to long
+NEW_PARALLEL_LINKED_DEFINITION(ParList, MyList, int, long);
+
+#define VALUES     1000000
+#define RANDOM_MAX 10000
+
+static long to_long(int value, void * data) { (void)(data); return value; }
+static long sum(long acc, long value) { return acc + value; }
+static double identity(double value, void * data) { (void)(data); return value; }
+static double sum_double(double acc, double value) { return acc + value; }
+static int  is_even(int value, void * data) { (void)(data); return value % 2 == 0; }
+static void twice(int * value, void * data) { (void)(data); *value *= 2; }
+
+int main(int argc, char ** argv)
+{
+    ThreadPool * pool = NULL, * single = NULL, * four = NULL;
+    MyList * list = NULL;
+    int * values = NULL, * evens = NULL;
+    double * reals = NULL;
+    int i = 0, count = 0;
+    long total = 0;
+    double oneThread = 0, fourThreads = 0;
+
+    printf("--- Parallel algorithms ---\n");
+    pool = ThreadPool_new(0);
+    printf("%d worker thread(s)\n", pool->threadCount);
+
+    values = malloc(sizeof(int) * VALUES);
+    evens  = malloc(sizeof(int) * VALUES);
+    for(i = 0 ; i < VALUES ; i++)
+        values[i] = rand() % RANDOM_MAX;
+
+    // Average, with a reduction that does not depend on the thread count
+    total = ParInt_map_reduce(pool, values, VALUES, 0, 0, to_long, sum, NULL, 1);
+    printf("Average value: %.2f\n", (double)total / VALUES);
+
+    // Floating point sums are rounded the same way with 1 or 4 threads
+    reals = malloc(sizeof(double) * VALUES);
+    for(i = 0 ; i < VALUES ; i++)
+        reals[i] = 1.0 / (i + 1);
+    single = ThreadPool_new(1);
+    four   = ThreadPool_new(4);
+    oneThread   = ParDouble_map_reduce(single, reals, VALUES, 0, 0, identity, sum_double, NULL, 1);
+    fourThreads = ParDouble_map_reduce(four, reals, VALUES, 0, 0, identity, sum_double, NULL, 1);
+    printf("Harmonic sum: %.17g with 1 thread, %.17g with 4: %s\n",
+           oneThread, fourThreads, (oneThread == fourThreads) ? "same bits" : "different");
+    ThreadPool_free(single);
+    ThreadPool_free(four);
+    free(reals);
+
+    count = ParInt_filter(pool, values, VALUES, 0, is_even, NULL, evens);
+    printf("%d even values\n", count);
+
+    ParInt_for_each(pool, values, VALUES, 4096, twice, NULL);
+    ParInt_sort(pool, values, VALUES, 0, Int_cmp);
+    printf("Doubled and sorted: %d %d %d ... %d\n", values[0], values[1], values[2], values[VALUES - 1]);
+
+    // Chunked iteration over a linked container
+    list = MyList_new();
+    for(i = 0 ; i < 10000 ; i++)
+        MyList_add(list, i, i);
+    total = ParList_map_reduce(pool, list, 0, 0, to_long, sum, NULL, 0);
+    printf("Sum of the list: %ld\n", total);
+
+    MyList_free(list);
+    free(values);
+    free(evens);
+    ThreadPool_free(pool);
+
+	return 0;
+}
+
+IMPLEMENT_LIST(MyList, int, Int_copy, Int_cmp, Int_free, Int_print);
+IMPLEMENT_PARALLEL(ParInt, int, long);
+IMPLEMENT_PARALLEL(ParDouble, double, double);
+IMPLEMENT_PARALLEL_LINKED(ParList, MyList, int, long);
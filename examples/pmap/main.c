@@ -0,0 +1,86 @@
+/**
+ * @file main.c
+ * @brief Main example file
+ * @author Baudouin FEILDEL
+ */
+#include <stdio.h>
+
+#include "../../src/pmap.h"
+#include "../../src/helpers.h"
+
+NEW_PMAP_DEFINITION(Config, char *, char *);
+
+#define READERS 4
+#define READS   100000
+
+Config * config = NULL;
+
+// Request threads read the configuration without any lock
+void * serve(void * arg)
+{
+    PMAP_reader_t * reader = Config_reader(config);
+    Config_version_t * version = NULL;
+    char ** timeout = NULL;
+    long served = 0;
+    int i = 0;
+
+    for(i = 0 ; i < READS ; i++)
+    {
+        version = Config_snapshot(config, reader);
+        timeout = Config_get(version, "timeout");
+        if(timeout != NULL && Config_get(version, "host") != NULL)
+            served++;
+        Config_release(reader);
+    }
+    Config_readerFree(reader);
+    return (void *)served;
+}
+
+int main(int argc, char ** argv)
+{
+    pthread_t threads[READERS];
+    PMAP_reader_t * reader = NULL;
+    Config_version_t * before = NULL;
+    Config_version_t * after = NULL;
+    char value[16];
+    void * served = NULL;
+    long total = 0;
+    int i = 0;
+
+    printf("--- Persistent map (configuration) ---\n");
+    config = Config_new();
+    Config_add(config, "host", "localhost");
+    Config_add(config, "timeout", "30");
+
+    // A snapshot keeps seeing its version while the map changes
+    reader = Config_reader(config);
+    before = Config_snapshot(config, reader);
+    Config_add(config, "timeout", "60");
+    printf("Timeout in the snapshot: %s\n", *Config_get(before, "timeout"));
+    Config_release(reader);
+    after = Config_snapshot(config, reader);
+    printf("Timeout in the new version: %s\n", *Config_get(after, "timeout"));
+    Config_release(reader);
+
+    for(i = 0 ; i < READERS ; i++)
+        pthread_create(&threads[i], NULL, serve, NULL);
+    // Reload the configuration while the requests are served
+    for(i = 0 ; i < 1000 ; i++)
+    {
+        snprintf(value, sizeof(value), "%d", i);
+        Config_add(config, "timeout", value);
+    }
+    for(i = 0 ; i < READERS ; i++)
+    {
+        pthread_join(threads[i], &served);
+        total += (long)served;
+    }
+    printf("Requests served: %ld, objects waiting for readers: %d\n", total, Config_reclaim(config));
+
+    Config_readerFree(reader);
+    Config_free(config);
+
+    return 0;
+}
+
+IMPLEMENT_PMAP(Config, char *, char *, Str_copy, Str_copy, Str_cmp, Str_cmp, Str_free, Str_free, Str_hash);
@@ -0,0 +1,52 @@
+/**
+ * @file main.c
+ * @brief Main example file
+ * @author Baudouin FEILDEL
+ */
+#include <stdio.h>
+
+#include "../../src/pqueue.h"
+#include "../../src/helpers.h"
+
+// 4-ary heap of priorities, lowest priority first
+NEW_PQUEUE_DEFINITION(JobQueue, int);
+
+#define JOBS 8
+
+int main(int argc, char ** argv)
+{
+    JobQueue * jobs = NULL;
+    int priorities[JOBS];
+    int handles[JOBS];
+    int i = 0, urgent = 0;
+
+    printf("--- Priority queue (jobs) ---\n");
+    jobs = JobQueue_new();
+
+    // Build the heap at once
+    for(i = 0 ; i < JOBS ; i++)
+        priorities[i] = 10 + rand() % 90;
+    JobQueue_heapify(jobs, priorities, JOBS, handles);
+
+    // Push one by one
+    urgent = JobQueue_push(jobs, 50);
+    JobQueue_push(jobs, 20);
+
+    printf("Heap: ");
+    JobQueue_print(jobs);
+
+    // Job 'urgent' must run first
+    JobQueue_decrease_key(jobs, urgent, 1);
+    printf("Top after decrease_key: %d\n", JobQueue_peek(jobs));
+
+    printf("Pop: ");
+    while(jobs->size > 0)
+        printf("%d, ", JobQueue_pop(jobs));
+    printf("\n");
+
+    JobQueue_free(jobs);
+
+	return 0;
+}
+
+IMPLEMENT_PQUEUE(JobQueue, int, 4, Int_copy, Int_cmp, Int_free, Int_print, 0);
@@ -0,0 +1,57 @@
+/**
+ * @file main.c
+ * @brief Main example file
+ * @author Baudouin FEILDEL
+ */
+#include <stdio.h>
+
+#include "../../src/roaring.h"
+
+#define IDS 2000000
+
+int main(int argc, char ** argv)
+{
+    Roaring * active  = NULL;
+    Roaring * premium = NULL;
+    Roaring * both    = NULL;
+    Roaring * any     = NULL;
+    uint32_t i = 0, id = 0;
+
+    printf("--- Roaring bitmap (user ids) ---\n");
+    active  = Roaring_new();
+    premium = Roaring_new();
+
+    // Active users: a contiguous block of ids plus every third id after it
+    for(i = 0 ; i < IDS ; i++)
+        Roaring_add(active, i < IDS / 2 ? i : IDS / 2 + 3 * i);
+    // Premium users: every seventh id
+    for(i = 0 ; i < IDS ; i += 7)
+        Roaring_add(premium, i);
+
+    printf("Active:  %llu ids in %zu bytes\n",
+           (unsigned long long)Roaring_cardinality(active), Roaring_bytes(active));
+    Roaring_optimize(active); // The contiguous block becomes runs
+    printf("Active after optimize: %zu bytes (%.2f bytes per id)\n",
+           Roaring_bytes(active), (double)Roaring_bytes(active) / Roaring_cardinality(active));
+    printf("Premium: %llu ids in %zu bytes\n",
+           (unsigned long long)Roaring_cardinality(premium), Roaring_bytes(premium));
+
+    both = Roaring_intersection(active, premium);
+    any  = Roaring_union(active, premium);
+    printf("Active and premium: %llu, active or premium: %llu\n",
+           (unsigned long long)Roaring_cardinality(both), (unsigned long long)Roaring_cardinality(any));
+
+    printf("Ids <= 1000000 active: %llu\n", (unsigned long long)Roaring_rank(active, 1000000));
+    if(Roaring_select(both, 1000, &id))
+        printf("1001st active premium id: %u\n", id);
+
+    Roaring_remove(premium, 7);
+    printf("7 premium: %d\n", Roaring_contains(premium, 7));
+
+    Roaring_free(active);
+    Roaring_free(premium);
+    Roaring_free(both);
+    Roaring_free(any);
+
+    return 0;
+}
@@ -14,4 +14,70 @@ echo ""
 ./stack/stack
 echo ""
 
-./set/set
\ No newline at end of file
+./set/set
+echo ""
+
+./flatmap/flatmap
+echo ""
+
+./pqueue/pqueue
+echo ""
+
+./cmap/cmap
+echo ""
+
+./parallel/parallel
+echo ""
+
+./intrusive/intrusive
+echo ""
+
+./deque/deque
+echo ""
+
+./cache/cache
+echo ""
+
+./filter/filter
+echo ""
+
+./roaring/roaring
+echo ""
+
+./spillqueue/spillqueue
+echo ""
+
+./walqueue/walqueue
+echo ""
+
+./pmap/pmap
+echo ""
+
+./bqueue/bqueue
+echo ""
+
+./scheduler/scheduler
+echo ""
+
+./hmap/hmap
+echo ""
+
+./capacity/capacity
+echo ""
+
+./multimap/multimap
+echo ""
+
+./art/art
+echo ""
+
+./skiplist/skiplist
+echo ""
+
+./intmap/intmap
+echo ""
+
+./cseq/cseq
+echo ""
+
+./small/small
\ No newline at end of file
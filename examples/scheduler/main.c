@@ -0,0 +1,180 @@
+/**
+ * @file main.c
+ * @brief Main example file
+ * @author Baudouin FEILDEL
+ */
+#include <stdio.h>
+#include <time.h>
+
+#include "../../src/scheduler.h"
+#include "../../src/helpers.h"
+
+NEW_WSDEQUE_DEFINITION(IntDeque, long);
+NEW_SCHEDULER_DEFINITION(Scheduler);
+
+IMPLEMENT_WSDEQUE(IntDeque, long);
+IMPLEMENT_SCHEDULER(Scheduler);
+
+#define FIB_N       36
+#define FIB_CUTOFF  18
+#define SORT_SIZE   (1 << 22)
+#define SORT_CUTOFF 4096
+
+double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Parallel fib: spawn one branch, compute the other, sync
+typedef struct Fib
+{
+    int  n;
+    long result;
+} Fib;
+
+long fib_serial(int n) { return n < 2 ? n : fib_serial(n - 1) + fib_serial(n - 2); }
+
+void fib(void * data)
+{
+    Fib * task = data;
+    Fib left, right;
+    Scheduler_group_t group = {0};
+
+    if(task->n < FIB_CUTOFF)
+    {
+        task->result = fib_serial(task->n);
+        return;
+    }
+    left.n  = task->n - 1;
+    right.n = task->n - 2;
+    Scheduler_spawn(&group, fib, &left);
+    fib(&right);
+    Scheduler_sync(&group);
+    task->result = left.result + right.result;
+}
+
+// Parallel quicksort: partition, spawn the left part, sort the right part
+typedef struct Sort
+{
+    int * values;
+    int   size;
+} Sort;
+
+void insertion_sort(int * values, int size)
+{
+    int i = 0, j = 0, value = 0;
+    for(i = 1 ; i < size ; i++)
+    {
+        value = values[i];
+        for(j = i ; j > 0 && values[j - 1] > value ; j--)
+            values[j] = values[j - 1];
+        values[j] = value;
+    }
+}
+
+void quicksort(void * data)
+{
+    Sort * task = data;
+    Sort left, right;
+    Scheduler_group_t group = {0};
+    int * values = task->values;
+    int i = 0, j = task->size - 1, tmp = 0, pivot = 0;
+
+    if(task->size <= 16)
+    {
+        insertion_sort(values, task->size);
+        return;
+    }
+    pivot = values[task->size / 2];
+    while(i <= j)
+    {
+        while(values[i] < pivot) i++;
+        while(values[j] > pivot) j--;
+        if(i <= j)
+        {
+            tmp = values[i]; values[i] = values[j]; values[j] = tmp;
+            i++; j--;
+        }
+    }
+    left.values  = values;
+    left.size    = j + 1;
+    right.values = values + i;
+    right.size   = task->size - i;
+    if(task->size > SORT_CUTOFF)
+    {
+        Scheduler_spawn(&group, quicksort, &left);
+        quicksort(&right);
+        Scheduler_sync(&group);
+    }
+    else
+    {
+        quicksort(&left);
+        quicksort(&right);
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    IntDeque  * deque     = NULL;
+    Scheduler * scheduler = NULL;
+    Fib         root;
+    Sort        sort;
+    int       * values = malloc(sizeof(int) * SORT_SIZE);
+    double      start = 0, fibBase = 0, sortBase = 0, fibTime = 0, sortTime = 0;
+    long        value = 0;
+    int         i = 0, cores = (int)sysconf(_SC_NPROCESSORS_ONLN), workers = 1, sorted = 1;
+
+    printf("--- Work-stealing deque ---\n");
+    deque = IntDeque_new(4);
+    printf("Push: ");
+    for(i = 0 ; i < 5 ; i++)
+    {
+        printf("%d, ", i);
+        IntDeque_push(deque, i);
+    }
+    IntDeque_steal(deque, &value);
+    printf("\nSteal (oldest, top): %ld\n", value);
+    IntDeque_pop(deque, &value);
+    printf("Pop (newest, bottom): %ld\n", value);
+    printf("Size: %ld\n", IntDeque_size(deque));
+    IntDeque_free(deque);
+
+    printf("\n--- Scheduler: fib(%d) and quicksort of %d ints ---\n", FIB_N, SORT_SIZE);
+    printf("workers   fib (s)  speedup   sort (s)  speedup\n");
+    if(cores < 1) cores = 1;
+    for(workers = 1 ; workers <= cores ; workers = (workers * 2 <= cores || workers == cores) ? workers * 2 : cores)
+    {
+        scheduler = Scheduler_new(workers);
+
+        root.n = FIB_N;
+        start = now();
+        Scheduler_run(scheduler, fib, &root);
+        fibTime = now() - start;
+
+        srand(42);
+        for(i = 0 ; i < SORT_SIZE ; i++)
+            values[i] = rand();
+        sort.values = values;
+        sort.size   = SORT_SIZE;
+        start = now();
+        Scheduler_run(scheduler, quicksort, &sort);
+        sortTime = now() - start;
+        for(i = 1 ; i < SORT_SIZE ; i++)
+            sorted &= (values[i - 1] <= values[i]);
+
+        if(workers == 1)
+        {
+            fibBase  = fibTime;
+            sortBase = sortTime;
+        }
+        printf("%7d %9.3f %7.2fx %10.3f %7.2fx\n", workers, fibTime, fibBase / fibTime, sortTime, sortBase / sortTime);
+        Scheduler_free(scheduler);
+    }
+    printf("fib(%d) = %ld, sorted: %s\n", FIB_N, root.result, sorted ? "yes" : "no");
+
+    free(values);
+
+    return 0;
+}
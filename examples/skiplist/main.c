@@ -0,0 +1,133 @@
+/**
+ * @file main.c
+ * @brief Main example file
+ * @author Baudouin FEILDEL
+ */
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../../src/skiplist.h"
+#include "../../src/helpers.h"
+
+NEW_SKIPLIST_DEFINITION(Scores, int);
+NEW_SKIPLIST_DEFINITION(IntSet, int);
+
+IMPLEMENT_SKIPLIST(Scores, int, Int_copy, Int_cmp, Int_free);
+IMPLEMENT_SKIPLIST(IntSet, int, Int_copy, Int_cmp, Int_free);
+
+#define KEYS        (1 << 16)
+#define OPS         500000
+#define MAX_THREADS 64
+
+typedef struct Worker
+{
+    IntSet * set;
+    int      readPercent;
+    unsigned seed;
+} Worker;
+
+double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int print_score(int * score, void * data)
+{
+    (void)(data);
+    printf("%d, ", *score);
+    return 0;
+}
+
+// Mixed workload: readPercent% of _get, the rest split between _add and _remove
+void * work(void * arg)
+{
+    Worker * worker = arg;
+    SKIPLIST_reader_t * reader = IntSet_reader(worker->set);
+    unsigned seed = worker->seed;
+    long found = 0;
+    int i = 0, key = 0, dice = 0;
+
+    for(i = 0 ; i < OPS ; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        key  = (seed >> 8) % KEYS;
+        dice = (seed >> 24) % 100;
+        if(dice < worker->readPercent)
+            found += IntSet_get(worker->set, reader, key) != NULL;
+        else if(dice % 2 == 0)
+            IntSet_add(worker->set, reader, key);
+        else
+            IntSet_remove(worker->set, reader, key);
+    }
+    IntSet_readerFree(reader);
+    return (void *)found;
+}
+
+int main(int argc, char ** argv)
+{
+    Scores * scores = NULL;
+    IntSet * set = NULL;
+    SKIPLIST_reader_t * reader = NULL;
+    pthread_t threads[MAX_THREADS];
+    Worker    workers[MAX_THREADS];
+    int       ratios[] = {100, 90, 50};
+    double    start = 0, elapsed = 0;
+    int       cores = (int)sysconf(_SC_NPROCESSORS_ONLN), count = 0, r = 0, i = 0;
+
+    printf("--- Concurrent skip list ---\n");
+    scores = Scores_new();
+    reader = Scores_reader(scores);
+    Scores_add(scores, reader, 42);
+    Scores_add(scores, reader, 7);
+    Scores_add(scores, reader, 99);
+    Scores_add(scores, reader, 23);
+    printf("Add 7 again: %d\n", Scores_add(scores, reader, 7));
+    printf("Scores between 10 and 50: ");
+    Scores_range(scores, reader, 10, 50, print_score, NULL);
+    Scores_remove(scores, reader, 42);
+    printf("\nGet 42 after remove: %s\n", Scores_get(scores, reader, 42) != NULL ? "found" : "not found");
+    printf("Size: %d\n", Scores_size(scores));
+    Scores_readerFree(reader);
+    Scores_free(scores);
+
+    printf("\n--- %d operations per thread on %d keys (Mops/s) ---\n", OPS, KEYS);
+    printf("threads");
+    for(r = 0 ; r < 3 ; r++)
+        printf("  %3d%% reads", ratios[r]);
+    printf("\n");
+    if(cores < 1) cores = 1;
+    if(cores > MAX_THREADS) cores = MAX_THREADS;
+    for(count = 1 ; count <= cores ; count = (count * 2 <= cores || count == cores) ? count * 2 : cores)
+    {
+        printf("%7d", count);
+        for(r = 0 ; r < 3 ; r++)
+        {
+            // Start half full so that adds and removes both succeed
+            set    = IntSet_new();
+            reader = IntSet_reader(set);
+            for(i = 0 ; i < KEYS ; i += 2)
+                IntSet_add(set, reader, i);
+            IntSet_readerFree(reader);
+
+            start = now();
+            for(i = 0 ; i < count ; i++)
+            {
+                workers[i].set         = set;
+                workers[i].readPercent = ratios[r];
+                workers[i].seed        = i + 1;
+                pthread_create(&threads[i], NULL, work, &workers[i]);
+            }
+            for(i = 0 ; i < count ; i++)
+                pthread_join(threads[i], NULL);
+            elapsed = now() - start;
+            printf("  %10.2f", (double)OPS * count / elapsed / 1e6);
+            IntSet_free(set);
+        }
+        printf("\n");
+    }
+
+    return 0;
+}
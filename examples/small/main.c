@@ -0,0 +1,97 @@
+/**
+ * @file main.c
+ * @brief Main example file
+ * @author Baudouin FEILDEL
+ */
+#include <stdio.h>
+#include <time.h>
+
+#include "../../src/list.h"
+#include "../../src/stack.h"
+#include "../../src/set.h"
+#include "../../src/helpers.h"
+
+NEW_LIST_DEFINITION(IntList, int);
+NEW_LIST_SMALL_DEFINITION(SmallList, int, 8);
+NEW_STACK_SMALL_DEFINITION(Path, char *, 8);
+NEW_SET_SMALL_DEFINITION(Tags, char *, 4);
+
+IMPLEMENT_LIST(IntList, int, Int_copy, Int_cmp, Int_free, Int_print);
+IMPLEMENT_LIST(SmallList, int, Int_copy, Int_cmp, Int_free, Int_print);
+IMPLEMENT_STACK(Path, char *, Str_copy, Str_cmp, Str_free, Str_print, NULL);
+IMPLEMENT_SET(Tags, char *, Str_copy, Str_cmp, Str_free, Str_print);
+
+#define CONTAINERS 2000000
+
+double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char ** argv)
+{
+    IntList * list = NULL;
+    SmallList small;
+    IntList_elem_t * it = NULL;
+    SmallList_elem_t * sit = NULL;
+    Path      path;
+    Tags      tags;
+    char    * dir = NULL;
+    double    start = 0, heapTime = 0, smallTime = 0;
+    long      sum = 0;
+    int       i = 0, j = 0;
+
+    printf("--- Small containers ---\n");
+    Path_init(&path);
+    Path_push(&path, "usr");
+    Path_push(&path, "local");
+    Path_push(&path, "lib");
+    dir = Path_pop(&path);
+    printf("Popped %s, %d inline elements left for the next pushes\n", dir, path.spareCount);
+    free(dir);
+    Path_destroy(&path);
+
+    Tags_init(&tags);
+    Tags_add(&tags, "red");
+    Tags_add(&tags, "green");
+    Tags_add(&tags, "blue");
+    Tags_add(&tags, "red");
+    Tags_add(&tags, "alpha");
+    Tags_add(&tags, "beta");
+    printf("Tags (%d, the first %d without allocation): ", tags.size, tags.inlineCount);
+    Tags_print(&tags);
+    Tags_destroy(&tags);
+
+    printf("\n--- %d lists of 1 to 8 elements ---\n", CONTAINERS);
+    start = now();
+    for(i = 0 ; i < CONTAINERS ; i++)
+    {
+        list = IntList_new();
+        for(j = 0 ; j <= i % 8 ; j++)
+            IntList_add(list, j, i + j);
+        for(it = list->begin ; it != NULL ; it = it->next)
+            sum += it->value;
+        IntList_free(list);
+    }
+    heapTime = now() - start;
+
+    start = now();
+    for(i = 0 ; i < CONTAINERS ; i++)
+    {
+        SmallList_init(&small);
+        for(j = 0 ; j <= i % 8 ; j++)
+            SmallList_add(&small, j, i + j);
+        for(sit = small.begin ; sit != NULL ; sit = sit->next)
+            sum -= sit->value;
+        SmallList_destroy(&small);
+    }
+    smallTime = now() - start;
+
+    printf("LIST with _new: %.3f s, small LIST with _init on the stack: %.3f s (%.1fx)\n",
+           heapTime, smallTime, heapTime / smallTime);
+    printf("Checksum: %ld\n", sum);
+
+    return 0;
+}
@@ -0,0 +1,67 @@
+/**
+ * @file main.c
+ * @brief Main example file
+ * @author Baudouin FEILDEL
+ */
+#include <stdio.h>
+
+#include "../../src/spillqueue.h"
+#include "../../src/helpers.h"
+
+// Strings are written without their terminating null byte
+size_t Str_serialize(char ** value, void * buffer, size_t capacity)
+{
+    size_t length = strlen(*value);
+    if(length <= capacity)
+        memcpy(buffer, *value, length);
+    return length;
+}
+
+void Str_deserialize(char ** dest, const void * buffer, size_t size)
+{
+    *dest = malloc(size + 1);
+    memcpy(*dest, buffer, size);
+    (*dest)[size] = '\0';
+}
+
+NEW_SPILLQUEUE_DEFINITION(Backlog, char *);
+
+#define MESSAGES 1000000
+
+int main(int argc, char ** argv)
+{
+    Backlog * backlog = NULL;
+    char message[64];
+    char * value = NULL;
+    int i = 0;
+
+    printf("--- Spill queue ---\n");
+    // At most 2 x 1000 messages in memory, the others go to /tmp
+    backlog = Backlog_new("/tmp", 1000);
+
+    // Downstream outage: the backlog grows
+    for(i = 0 ; i < MESSAGES ; i++)
+    {
+        snprintf(message, sizeof(message), "message %d", i);
+        Backlog_enqueue(backlog, message);
+    }
+    printf("Size: %zu, on disk: %zu, segments: %lu\n",
+           backlog->size, backlog->spilled, backlog->writeSegment + 1);
+
+    value = Backlog_dequeue(backlog);
+    printf("First: %s\n", value);
+    free(value);
+
+    // Drain the backlog in order
+    while(backlog->size > 1)
+        free(Backlog_dequeue(backlog));
+    value = Backlog_dequeue(backlog);
+    printf("Last: %s\n", value);
+    free(value);
+
+    Backlog_free(backlog);
+
+    return 0;
+}
+
+IMPLEMENT_SPILLQUEUE(Backlog, char *, Str_copy, Str_free, Str_print, Str_serialize, Str_deserialize, NULL);
@@ -0,0 +1,76 @@
+/**
+ * @file main.c
+ * @brief Main example file
+ * @author Baudouin FEILDEL
+ */
+#include <stdio.h>
+
+#include "../../src/walqueue.h"
+#include "../../src/helpers.h"
+
+// Strings are written without their terminating null byte
+size_t Str_serialize(char ** value, void * buffer, size_t capacity)
+{
+    size_t length = strlen(*value);
+    if(length <= capacity)
+        memcpy(buffer, *value, length);
+    return length;
+}
+
+void Str_deserialize(char ** dest, const void * buffer, size_t size)
+{
+    *dest = malloc(size + 1);
+    memcpy(*dest, buffer, size);
+    (*dest)[size] = '\0';
+}
+
+NEW_WALQUEUE_DEFINITION(Jobs, char *);
+
+#define LOG_PATH "/tmp/walqueue-example.log"
+
+int main(int argc, char ** argv)
+{
+    Jobs * jobs = NULL;
+    char job[32];
+    char * value = NULL;
+    int i = 0;
+
+    printf("--- Durable queue (write-ahead log) ---\n");
+    unlink(LOG_PATH);
+    unlink(LOG_PATH ".cursor");
+
+    // Every enqueue is on disk when it returns
+    jobs = Jobs_open(LOG_PATH, WALQUEUE_SYNC_ALWAYS);
+    for(i = 0 ; i < 5 ; i++)
+    {
+        snprintf(job, sizeof(job), "job %d", i);
+        Jobs_enqueue(jobs, job);
+    }
+    printf("%d jobs queued, %d ready to dequeue\n", jobs->size, Jobs_available(jobs));
+    value = Jobs_dequeue(jobs);
+    printf("Done: %s\n", value);
+    free(value);
+    Jobs_checkpoint(jobs); // "job 0" will not be replayed
+    value = Jobs_dequeue(jobs);
+    printf("Done without checkpoint: %s\n", value);
+    free(value);
+
+    // Simulate a crash: forget the queue without closing it
+    close(jobs->fd);
+    jobs->fd = -1;
+    jobs->failed = 1;
+    Jobs_close(jobs);
+
+    // The log is replayed from the last checkpoint: "job 1" comes back
+    jobs = Jobs_open(LOG_PATH, WALQUEUE_SYNC_BATCH);
+    printf("Recovered %d jobs: ", jobs->size);
+    Jobs_print(jobs);
+    Jobs_close(jobs);
+
+    unlink(LOG_PATH);
+    unlink(LOG_PATH ".cursor");
+
+    return 0;
+}
+
+IMPLEMENT_WALQUEUE(Jobs, char *, Str_copy, Str_free, Str_print, Str_serialize, Str_deserialize, NULL);
@@ -0,0 +1,882 @@
+/**
+ * @file art.h
+ * @brief Adaptive radix tree container definition
+ * @details A map from strings to values ordered byte by byte. Inner nodes
+ * grow and shrink with their number of children:
+ * - Node4   4 sorted key bytes and children
+ * - Node16  16 sorted key bytes, searched with one SSE2 comparison
+ * - Node48  a 256-byte index into 48 children
+ * - Node256 one child per byte
+ *
+ * Paths without branches are compressed: a node keeps the bytes its
+ * children share (up to ART_MAX_PREFIX, the rest is checked on a leaf).
+ * Leaves store the key with its terminating '\0', so that no key is a
+ * prefix of another and a key ending at a node lives under byte 0.
+ *
+ * Lookups cost the key length instead of the number of keys, and keys
+ * sharing a prefix are found in one walk: ART_prefix_iterate visits them
+ * in lexicographic order and ART_longest_prefix finds the longest key
+ * starting a string (routing tables, paths).
+ * Define CCONTAINERS_DISABLE_SIMD to search Node16 with a loop.
+ * @author Baudouin FEILDEL
+ */
+#ifndef __C_CONTAINERS_ART_H__
+#define __C_CONTAINERS_ART_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#if !defined(CCONTAINERS_DISABLE_SIMD) && defined(__SSE2__)
+#define CCONTAINERS_ART_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Node types */
+#define ART_NODE4   0
+#define ART_NODE16  1
+#define ART_NODE48  2
+#define ART_NODE256 3
+
+/** Compressed path bytes stored in a node */
+#ifndef ART_MAX_PREFIX
+#define ART_MAX_PREFIX 10
+#endif
+
+/** A child is a node, or a leaf tagged with its lowest bit */
+#define ART_IS_LEAF(child) (((uintptr_t)(child)) & 1)
+#define ART_LEAF(child)    ((ArtLeaf *)(((uintptr_t)(child)) & ~(uintptr_t)1))
+#define ART_TAG(leaf)      ((void *)(((uintptr_t)(leaf)) | 1))
+
+/**
+ Header of every inner node
+ */
+typedef struct ArtNode
+{
+	uint8_t  type;      /**< ART_NODE4, ART_NODE16, ART_NODE48 or ART_NODE256 */
+	uint16_t count;     /**< Number of children */
+	uint32_t prefixLen; /**< Length of the compressed path */
+	unsigned char prefix[ART_MAX_PREFIX]; /**< First bytes of the compressed path */
+} ArtNode;
+
+typedef struct ArtNode4
+{
+	ArtNode       node;
+	unsigned char keys[4];    /**< Sorted key bytes */
+	void        * children[4];
+} ArtNode4;
+
+typedef struct ArtNode16
+{
+	ArtNode       node;
+	unsigned char keys[16];   /**< Sorted key bytes */
+	void        * children[16];
+} ArtNode16;
+
+typedef struct ArtNode48
+{
+	ArtNode       node;
+	unsigned char index[256]; /**< Position + 1 of the child of each byte, 0 if none */
+	void        * children[48];
+} ArtNode48;
+
+typedef struct ArtNode256
+{
+	ArtNode       node;
+	void        * children[256];
+} ArtNode256;
+
+/**
+ Header of every leaf
+ */
+typedef struct ArtLeaf
+{
+	const unsigned char * key; /**< Key, with its terminating '\0' */
+	uint32_t keyLen;           /**< Length of key, '\0' included */
+} ArtLeaf;
+
+// =================
+//  Nodes
+// =================
+static inline size_t ArtNode_sizeof(int type)
+{
+	switch(type)
+	{
+		case ART_NODE4:  return sizeof(ArtNode4);
+		case ART_NODE16: return sizeof(ArtNode16);
+		case ART_NODE48: return sizeof(ArtNode48);
+		default:         return sizeof(ArtNode256);
+	}
+}
+
+static inline ArtNode * ArtNode_new(int type)
+{
+	ArtNode * node = calloc(1, ArtNode_sizeof(type));
+	node->type = type;
+	return node;
+}
+
+/* Slot of the child of byte c, or NULL */
+static inline void ** ArtNode_findChild(ArtNode * node, unsigned char c)
+{
+	ArtNode4   * n4 = NULL;
+	ArtNode16  * n16 = NULL;
+	ArtNode48  * n48 = NULL;
+	ArtNode256 * n256 = NULL;
+	int i = 0;
+#ifdef CCONTAINERS_ART_SSE2
+	unsigned int mask = 0;
+#endif
+	switch(node->type)
+	{
+		case ART_NODE4:
+			n4 = (ArtNode4 *)node;
+			for(i = 0 ; i < node->count ; i++)
+				if(n4->keys[i] == c)
+					return &(n4->children[i]);
+			return NULL;
+		case ART_NODE16:
+			n16 = (ArtNode16 *)node;
+#ifdef CCONTAINERS_ART_SSE2
+			/* Compare the 16 keys at once, ignore the unused ones */
+			mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8((char)c), _mm_loadu_si128((const __m128i *)n16->keys)));
+			mask &= (1u << node->count) - 1;
+			return mask != 0 ? &(n16->children[__builtin_ctz(mask)]) : NULL;
+#else
+			for(i = 0 ; i < node->count ; i++)
+				if(n16->keys[i] == c)
+					return &(n16->children[i]);
+			return NULL;
+#endif
+		case ART_NODE48:
+			n48 = (ArtNode48 *)node;
+			return n48->index[c] != 0 ? &(n48->children[n48->index[c] - 1]) : NULL;
+		default:
+			n256 = (ArtNode256 *)node;
+			return n256->children[c] != NULL ? &(n256->children[c]) : NULL;
+	}
+}
+
+/* Position of the first key byte greater than c in a sorted Node4 or Node16 */
+static inline int ArtNode_lowerBound(const unsigned char * keys, int count, unsigned char c)
+{
+	int i = 0;
+#ifdef CCONTAINERS_ART_SSE2
+	unsigned int mask = 0;
+	__m128i flip = _mm_set1_epi8((char)0x80);
+	if(count > 4)
+	{
+		/* Signed comparison of bytes with their top bit flipped is the unsigned one */
+		mask = _mm_movemask_epi8(_mm_cmplt_epi8(_mm_xor_si128(_mm_set1_epi8((char)c), flip),
+		                                        _mm_xor_si128(_mm_loadu_si128((const __m128i *)keys), flip)));
+		mask &= (1u << count) - 1;
+		return mask != 0 ? __builtin_ctz(mask) : count;
+	}
+#endif
+	while(i < count && keys[i] < c)
+		i++;
+	return i;
+}
+
+/* Next child in byte order from position *pos, or NULL at the end */
+static inline void ** ArtNode_next(ArtNode * node, int * pos)
+{
+	ArtNode48  * n48 = NULL;
+	ArtNode256 * n256 = NULL;
+	switch(node->type)
+	{
+		case ART_NODE4:
+			return *pos < node->count ? &(((ArtNode4 *)node)->children[(*pos)++]) : NULL;
+		case ART_NODE16:
+			return *pos < node->count ? &(((ArtNode16 *)node)->children[(*pos)++]) : NULL;
+		case ART_NODE48:
+			n48 = (ArtNode48 *)node;
+			for( ; *pos < 256 ; (*pos)++)
+				if(n48->index[*pos] != 0)
+					return &(n48->children[n48->index[(*pos)++] - 1]);
+			return NULL;
+		default:
+			n256 = (ArtNode256 *)node;
+			for( ; *pos < 256 ; (*pos)++)
+				if(n256->children[*pos] != NULL)
+					return &(n256->children[(*pos)++]);
+			return NULL;
+	}
+}
+
+/* Replace *ref by a node of another type holding the same children */
+static inline ArtNode * ArtNode_convert(ArtNode ** ref, int type)
+{
+	ArtNode * old = *ref, * node = ArtNode_new(type);
+	void ** child = NULL;
+	int pos = 0, i = 0, last = -1;
+	node->prefixLen = old->prefixLen;
+	memcpy(node->prefix, old->prefix, ART_MAX_PREFIX);
+	node->count = old->count;
+	while((child = ArtNode_next(old, &pos)) != NULL)
+	{
+		/* Byte of the child: its position, or the key stored beside it */
+		switch(old->type)
+		{
+			case ART_NODE4:  last = ((ArtNode4 *)old)->keys[pos - 1]; break;
+			case ART_NODE16: last = ((ArtNode16 *)old)->keys[pos - 1]; break;
+			default:         last = pos - 1; break;
+		}
+		switch(type)
+		{
+			case ART_NODE4:
+				((ArtNode4 *)node)->keys[i]     = last;
+				((ArtNode4 *)node)->children[i] = *child;
+				break;
+			case ART_NODE16:
+				((ArtNode16 *)node)->keys[i]     = last;
+				((ArtNode16 *)node)->children[i] = *child;
+				break;
+			case ART_NODE48:
+				((ArtNode48 *)node)->index[last] = i + 1;
+				((ArtNode48 *)node)->children[i] = *child;
+				break;
+			default:
+				((ArtNode256 *)node)->children[last] = *child;
+				break;
+		}
+		i++;
+	}
+	free(old);
+	*ref = node;
+	return node;
+}
+
+/* Add the child of byte c, growing the node when it is full */
+static inline void ArtNode_addChild(ArtNode ** ref, unsigned char c, void * child)
+{
+	ArtNode * node = *ref;
+	unsigned char * keys = NULL;
+	void ** children = NULL;
+	ArtNode48 * n48 = NULL;
+	int pos = 0;
+	switch(node->type)
+	{
+		case ART_NODE4:
+		case ART_NODE16:
+			if(node->count == (node->type == ART_NODE4 ? 4 : 16))
+			{
+				ArtNode_convert(ref, node->type == ART_NODE4 ? ART_NODE16 : ART_NODE48);
+				ArtNode_addChild(ref, c, child);
+				return;
+			}
+			keys     = node->type == ART_NODE4 ? ((ArtNode4 *)node)->keys : ((ArtNode16 *)node)->keys;
+			children = node->type == ART_NODE4 ? ((ArtNode4 *)node)->children : ((ArtNode16 *)node)->children;
+			pos = ArtNode_lowerBound(keys, node->count, c);
+			memmove(keys + pos + 1, keys + pos, node->count - pos);
+			memmove(children + pos + 1, children + pos, sizeof(void *) * (node->count - pos));
+			keys[pos]     = c;
+			children[pos] = child;
+			break;
+		case ART_NODE48:
+			if(node->count == 48)
+			{
+				ArtNode_convert(ref, ART_NODE256);
+				ArtNode_addChild(ref, c, child);
+				return;
+			}
+			n48 = (ArtNode48 *)node;
+			while(n48->children[pos] != NULL)
+				pos++;
+			n48->children[pos] = child;
+			n48->index[c] = pos + 1;
+			break;
+		default:
+			((ArtNode256 *)node)->children[c] = child;
+			break;
+	}
+	node->count++;
+}
+
+/* Remove the child of byte c held in slot, shrinking the node when it gets sparse */
+static inline void ArtNode_removeChild(ArtNode ** ref, unsigned char c, void ** slot)
+{
+	ArtNode * node = *ref, * child = NULL;
+	ArtNode4 * n4 = NULL;
+	ArtNode16 * n16 = NULL;
+	ArtNode48 * n48 = NULL;
+	uint32_t prefix = 0, sub = 0;
+	int pos = 0;
+	switch(node->type)
+	{
+		case ART_NODE4:
+			n4  = (ArtNode4 *)node;
+			pos = slot - n4->children;
+			memmove(n4->keys + pos, n4->keys + pos + 1, node->count - pos - 1);
+			memmove(n4->children + pos, n4->children + pos + 1, sizeof(void *) * (node->count - pos - 1));
+			if(--node->count > 1)
+				return;
+			/* One child left: it replaces the node, with the node path before its own */
+			if(!ART_IS_LEAF(n4->children[0]))
+			{
+				child  = n4->children[0];
+				prefix = node->prefixLen;
+				if(prefix < ART_MAX_PREFIX)
+					node->prefix[prefix] = n4->keys[0];
+				prefix++;
+				if(prefix < ART_MAX_PREFIX)
+				{
+					sub = child->prefixLen < ART_MAX_PREFIX - prefix ? child->prefixLen : ART_MAX_PREFIX - prefix;
+					memcpy(node->prefix + prefix, child->prefix, sub);
+					prefix += sub;
+				}
+				memcpy(child->prefix, node->prefix, prefix < ART_MAX_PREFIX ? prefix : ART_MAX_PREFIX);
+				child->prefixLen += node->prefixLen + 1;
+			}
+			*ref = n4->children[0];
+			free(node);
+			return;
+		case ART_NODE16:
+			n16 = (ArtNode16 *)node;
+			pos = slot - n16->children;
+			memmove(n16->keys + pos, n16->keys + pos + 1, node->count - pos - 1);
+			memmove(n16->children + pos, n16->children + pos + 1, sizeof(void *) * (node->count - pos - 1));
+			if(--node->count == 3)
+				ArtNode_convert(ref, ART_NODE4);
+			return;
+		case ART_NODE48:
+			n48 = (ArtNode48 *)node;
+			n48->children[n48->index[c] - 1] = NULL;
+			n48->index[c] = 0;
+			if(--node->count == 12)
+				ArtNode_convert(ref, ART_NODE16);
+			return;
+		default:
+			((ArtNode256 *)node)->children[c] = NULL;
+			if(--node->count == 37)
+				ArtNode_convert(ref, ART_NODE48);
+			return;
+	}
+}
+
+/* Leaf of the smallest key below a child */
+static inline ArtLeaf * ArtNode_minLeaf(void * child)
+{
+	int pos = 0;
+	while(!ART_IS_LEAF(child))
+	{
+		pos   = 0;
+		child = *ArtNode_next((ArtNode *)child, &pos);
+	}
+	return ART_LEAF(child);
+}
+
+/* Number of stored prefix bytes matching key from depth (the rest of a long prefix is not checked) */
+static inline uint32_t ArtNode_checkPrefix(ArtNode * node, const unsigned char * key, uint32_t len, uint32_t depth)
+{
+	uint32_t max = node->prefixLen < ART_MAX_PREFIX ? node->prefixLen : ART_MAX_PREFIX;
+	uint32_t i = 0;
+	if(max > len - depth) max = len - depth;
+	while(i < max && node->prefix[i] == key[depth + i])
+		i++;
+	return i;
+}
+
+/* Number of path bytes matching key from depth, a leaf gives the bytes not stored */
+static inline uint32_t ArtNode_prefixMismatch(ArtNode * node, const unsigned char * key, uint32_t len, uint32_t depth)
+{
+	uint32_t i = ArtNode_checkPrefix(node, key, len, depth), max = 0;
+	ArtLeaf * leaf = NULL;
+	if(i < ART_MAX_PREFIX || node->prefixLen <= ART_MAX_PREFIX)
+		return i;
+	leaf = ArtNode_minLeaf(node);
+	max  = (leaf->keyLen < len ? leaf->keyLen : len) - depth;
+	if(max > node->prefixLen) max = node->prefixLen;
+	while(i < max && leaf->key[depth + i] == key[depth + i])
+		i++;
+	return i;
+}
+
+static inline int ArtLeaf_matches(ArtLeaf * leaf, const unsigned char * key, uint32_t len)
+{
+	return leaf->keyLen == len && memcmp(leaf->key, key, len) == 0;
+}
+
+// =============
+//  Definitions
+// =============
+#define NEW_ART_LEAF(ART, LeafTypename, Valuetype) \
+/**
+ Leaf of an ART object, followed by its key
+ */ \
+typedef struct _ ## LeafTypename \
+{ \
+	ArtLeaf       leaf;  /**< Key of the leaf */\
+	Valuetype     value; /**< Value of the leaf */\
+	unsigned char key[]; /**< Bytes of the key, pointed by leaf.key */\
+} LeafTypename
+
+#define NEW_ART_TYPE(ART, Valuetype) \
+NEW_ART_LEAF(ART, ART ## _leaf_t, Valuetype); \
+typedef struct ART \
+{ \
+	void * root;       /**< Root node or leaf. NULL if the tree is empty */\
+	int    size;       /**< Number of keys in the tree */\
+	size_t elemSize;   /**< Size of one leaf, without its key */\
+	int    freeValue;  /**< Flag:<br>1: Automatically free the value<br>0: Do not automatically free the value */\
+	void (*_copyValue)(Valuetype * dest, Valuetype * src); /**< Pointer to a function used to copy a value */\
+	int (*_cmpValue)(Valuetype val1, Valuetype val2); /**< Pointer to a function used to compare two values */\
+	void (*_freeValue)(Valuetype value); /**< Pointer to a function used to free a value */\
+} ART
+
+#define ART_FN_NEW(ART) \
+/**
+ @brief Create a new ART object
+ @return A pointer to an allocated and initialized
+ ART object in memory
+ */ \
+ART * ART ## _new()
+
+#define ART_FN_FREE(ART) \
+/**
+ Destroy an ART object
+ @param tree A pointer to an ART object
+ */ \
+void ART ## _free(ART * tree)
+
+#define ART_FN_ADD(ART, Valuetype) \
+/**
+ Add an element to the tree
+ @details If the key is already present its value is updated.
+ @param tree  A pointer to a valid ART object
+ @param key   The key of the element, copied in the tree
+ @param value The value to set
+ @return      1 if the element was inserted. 0 if it was updated
+ */ \
+int ART ## _add(ART * tree, char * key, Valuetype value)
+
+#define ART_FN_GET(ART, Valuetype) \
+/**
+ Get the value of a key
+ @param tree A pointer to a valid ART object
+ @param key  The key to look for
+ @return     A pointer to the value, valid until the key is removed.
+ NULL if the key is not present
+ */ \
+Valuetype * ART ## _get(ART * tree, char * key)
+
+#define ART_FN_REMOVE(ART) \
+/**
+ Remove a key from the tree
+ @param tree A pointer to a valid ART object
+ @param key  The key to remove
+ @return     1 if the key was removed. 0 if it was not present
+ */ \
+int ART ## _remove(ART * tree, char * key)
+
+#define ART_FN_PREFIX_ITERATE(ART, Valuetype) \
+/**
+ Call a function on every key starting with a prefix
+ @details Keys are visited in lexicographic (byte) order. The tree must
+ not be modified by \c callback.
+
+ @param tree     A pointer to a valid ART object
+ @param prefix   The prefix. "" visits every key
+ @param callback Function called with the key, a pointer to the value and
+ \c data. Returns 0 to continue, anything else to stop
+ @param data     User data given to \c callback
+ @return         Number of calls to \c callback
+ */ \
+int ART ## _prefix_iterate(ART * tree, char * prefix, int (*callback)(char * key, Valuetype * value, void * data), void * data)
+
+#define ART_FN_LONGEST_PREFIX(ART, Valuetype) \
+/**
+ Find the longest key which is a prefix of a string
+ @param tree  A pointer to a valid ART object
+ @param str   The string to match
+ @param match Receives the key found, owned by the tree. May be NULL
+ @return      A pointer to the value of the key. NULL if no key is a
+ prefix of \c str
+ */ \
+Valuetype * ART ## _longest_prefix(ART * tree, char * str, char ** match)
+
+#define ART_FN_CLEAR(ART) \
+/**
+ Remove every element of the tree
+ @param tree A pointer to a valid ART object
+ */ \
+void ART ## _clear(ART * tree)
+
+#define ART_FN_MEMORY(ART) \
+/**
+ Count the memory used by the tree
+ @details Nodes, leaves and keys. The memory owned by the values is not
+ counted.
+ @param tree A pointer to a valid ART object
+ @return     Number of bytes allocated by the tree
+ */ \
+size_t ART ## _memory(ART * tree)
+
+// =================
+//  Implementations
+// =================
+#define IMPLEMENT_ART_FN_NEW(ART, Valuetype, FN_CPY_VAL, FN_CMP_VAL, FN_FREE_VAL) \
+ART * ART ## _new() \
+{ \
+	ART * tree = malloc(sizeof(ART)); \
+	tree->root       = NULL; \
+	tree->size       = 0; \
+	tree->elemSize   = sizeof(ART ## _leaf_t); \
+	tree->freeValue  = 1; \
+	tree->_copyValue = FN_CPY_VAL; \
+	tree->_cmpValue  = FN_CMP_VAL; \
+	tree->_freeValue = FN_FREE_VAL; \
+	return tree; \
+}
+
+/* Internal helpers: recursive insertion, removal and walks */
+#define IMPLEMENT_ART_FN_HELPERS(ART, Valuetype) \
+static void * ART ## _newLeaf(ART * tree, const unsigned char * key, uint32_t len, Valuetype * value) \
+{ \
+	ART ## _leaf_t * leaf = malloc(tree->elemSize + len); \
+	memcpy(leaf->key, key, len); \
+	leaf->leaf.key    = leaf->key; \
+	leaf->leaf.keyLen = len; \
+	tree->_copyValue(&(leaf->value), value); \
+	tree->size++; \
+	return ART_TAG(leaf); \
+} \
+static void ART ## _freeLeaf(ART * tree, void * child) \
+{ \
+	ART ## _leaf_t * leaf = (ART ## _leaf_t *)ART_LEAF(child); \
+	if(tree->freeValue) tree->_freeValue(leaf->value); \
+	free(leaf); \
+	tree->size--; \
+} \
+static int ART ## _insert(ART * tree, void ** ref, const unsigned char * key, uint32_t len, uint32_t depth, Valuetype * value) \
+{ \
+	ArtNode * node = NULL, * split = NULL; \
+	ArtLeaf * leaf = NULL; \
+	void ** child = NULL; \
+	uint32_t common = 0; \
+	if(*ref == NULL) \
+	{ \
+		*ref = ART ## _newLeaf(tree, key, len, value); \
+		return 1; \
+	} \
+	if(ART_IS_LEAF(*ref)) \
+	{ \
+		leaf = ART_LEAF(*ref); \
+		if(ArtLeaf_matches(leaf, key, len)) \
+		{ \
+			if(tree->freeValue) tree->_freeValue(((ART ## _leaf_t *)leaf)->value); \
+			tree->_copyValue(&(((ART ## _leaf_t *)leaf)->value), value); \
+			return 0; \
+		} \
+		/* Two keys: a Node4 holding their common bytes splits them */\
+		while(leaf->key[depth + common] == key[depth + common]) \
+			common++; \
+		split = ArtNode_new(ART_NODE4); \
+		split->prefixLen = common; \
+		memcpy(split->prefix, key + depth, common < ART_MAX_PREFIX ? common : ART_MAX_PREFIX); \
+		ArtNode_addChild(&split, leaf->key[depth + common], *ref); \
+		ArtNode_addChild(&split, key[depth + common], ART ## _newLeaf(tree, key, len, value)); \
+		*ref = split; \
+		return 1; \
+	} \
+	node = *ref; \
+	if(node->prefixLen > 0) \
+	{ \
+		common = ArtNode_prefixMismatch(node, key, len, depth); \
+		if(common < node->prefixLen) \
+		{ \
+			/* The key leaves the compressed path: split it */\
+			split = ArtNode_new(ART_NODE4); \
+			split->prefixLen = common; \
+			memcpy(split->prefix, node->prefix, common < ART_MAX_PREFIX ? common : ART_MAX_PREFIX); \
+			if(node->prefixLen <= ART_MAX_PREFIX) \
+			{ \
+				ArtNode_addChild(&split, node->prefix[common], node); \
+				node->prefixLen -= common + 1; \
+				memmove(node->prefix, node->prefix + common + 1, node->prefixLen); \
+			} \
+			else \
+			{ \
+				leaf = ArtNode_minLeaf(node); \
+				ArtNode_addChild(&split, leaf->key[depth + common], node); \
+				node->prefixLen -= common + 1; \
+				memcpy(node->prefix, leaf->key + depth + common + 1, node->prefixLen < ART_MAX_PREFIX ? node->prefixLen : ART_MAX_PREFIX); \
+			} \
+			ArtNode_addChild(&split, key[depth + common], ART ## _newLeaf(tree, key, len, value)); \
+			*ref = split; \
+			return 1; \
+		} \
+		depth += node->prefixLen; \
+	} \
+	if((child = ArtNode_findChild(node, key[depth])) != NULL) \
+		return ART ## _insert(tree, child, key, len, depth + 1, value); \
+	ArtNode_addChild((ArtNode **)ref, key[depth], ART ## _newLeaf(tree, key, len, value)); \
+	return 1; \
+} \
+static int ART ## _delete(ART * tree, void ** ref, const unsigned char * key, uint32_t len, uint32_t depth) \
+{ \
+	ArtNode * node = NULL; \
+	void ** child = NULL; \
+	if(*ref == NULL) \
+		return 0; \
+	if(ART_IS_LEAF(*ref)) \
+	{ \
+		if(!ArtLeaf_matches(ART_LEAF(*ref), key, len)) \
+			return 0; \
+		ART ## _freeLeaf(tree, *ref); \
+		*ref = NULL; \
+		return 1; \
+	} \
+	node = *ref; \
+	if(node->prefixLen > 0) \
+	{ \
+		if(ArtNode_checkPrefix(node, key, len, depth) != (node->prefixLen < ART_MAX_PREFIX ? node->prefixLen : ART_MAX_PREFIX)) \
+			return 0; \
+		depth += node->prefixLen; \
+	} \
+	if(depth >= len || (child = ArtNode_findChild(node, key[depth])) == NULL) \
+		return 0; \
+	if(!ART_IS_LEAF(*child)) \
+		return ART ## _delete(tree, child, key, len, depth + 1); \
+	if(!ArtLeaf_matches(ART_LEAF(*child), key, len)) \
+		return 0; \
+	ART ## _freeLeaf(tree, *child); \
+	ArtNode_removeChild((ArtNode **)ref, key[depth], child); \
+	return 1; \
+} \
+/* Call callback on every leaf below child, in order. Returns non-zero to stop */\
+static int ART ## _walk(void * child, int (*callback)(char * key, Valuetype * value, void * data), void * data, int * calls) \
+{ \
+	ART ## _leaf_t * leaf = NULL; \
+	void ** next = NULL; \
+	int pos = 0; \
+	if(ART_IS_LEAF(child)) \
+	{ \
+		leaf = (ART ## _leaf_t *)ART_LEAF(child); \
+		(*calls)++; \
+		return callback((char *)leaf->key, &(leaf->value), data); \
+	} \
+	while((next = ArtNode_next((ArtNode *)child, &pos)) != NULL) \
+		if(ART ## _walk(*next, callback, data, calls)) \
+			return 1; \
+	return 0; \
+} \
+/* Free the nodes and leaves below child, or count their memory if tree is NULL */\
+static size_t ART ## _destroy(ART * tree, void * child) \
+{ \
+	void ** next = NULL; \
+	size_t bytes = 0; \
+	int pos = 0; \
+	if(child == NULL) \
+		return 0; \
+	if(ART_IS_LEAF(child)) \
+	{ \
+		bytes = sizeof(ART ## _leaf_t) + ART_LEAF(child)->keyLen; \
+		if(tree != NULL) ART ## _freeLeaf(tree, child); \
+		return bytes; \
+	} \
+	while((next = ArtNode_next((ArtNode *)child, &pos)) != NULL) \
+		bytes += ART ## _destroy(tree, *next); \
+	bytes += ArtNode_sizeof(((ArtNode *)child)->type); \
+	if(tree != NULL) free(child); \
+	return bytes; \
+}
+
+#define IMPLEMENT_ART_FN_FREE(ART) \
+void ART ## _free(ART * tree) \
+{ \
+	if(tree == NULL) return; \
+	ART ## _destroy(tree, tree->root); \
+	free(tree); \
+}
+
+#define IMPLEMENT_ART_FN_ADD(ART, Valuetype) \
+int ART ## _add(ART * tree, char * key, Valuetype value) \
+{ \
+	if(tree == NULL || key == NULL) return 0; \
+	return ART ## _insert(tree, &(tree->root), (const unsigned char *)key, strlen(key) + 1, 0, &value); \
+}
+
+#define IMPLEMENT_ART_FN_GET(ART, Valuetype) \
+Valuetype * ART ## _get(ART * tree, char * key) \
+{ \
+	const unsigned char * bytes = (const unsigned char *)key; \
+	uint32_t len = 0, depth = 0; \
+	void * child = NULL; \
+	void ** next = NULL; \
+	ArtNode * node = NULL; \
+	if(tree == NULL || key == NULL) return NULL; \
+	len   = strlen(key) + 1; \
+	child = tree->root; \
+	while(child != NULL) \
+	{ \
+		if(ART_IS_LEAF(child)) \
+			return ArtLeaf_matches(ART_LEAF(child), bytes, len) ? &(((ART ## _leaf_t *)ART_LEAF(child))->value) : NULL; \
+		node = child; \
+		if(node->prefixLen > 0) \
+		{ \
+			/* Only the stored bytes are checked: the leaf checks the whole key */\
+			if(ArtNode_checkPrefix(node, bytes, len, depth) != (node->prefixLen < ART_MAX_PREFIX ? node->prefixLen : ART_MAX_PREFIX)) \
+				return NULL; \
+			depth += node->prefixLen; \
+		} \
+		if(depth >= len || (next = ArtNode_findChild(node, bytes[depth])) == NULL) \
+			return NULL; \
+		child = *next; \
+		depth++; \
+	} \
+	return NULL; \
+}
+
+#define IMPLEMENT_ART_FN_REMOVE(ART) \
+int ART ## _remove(ART * tree, char * key) \
+{ \
+	if(tree == NULL || key == NULL) return 0; \
+	return ART ## _delete(tree, &(tree->root), (const unsigned char *)key, strlen(key) + 1, 0); \
+}
+
+#define IMPLEMENT_ART_FN_PREFIX_ITERATE(ART, Valuetype) \
+int ART ## _prefix_iterate(ART * tree, char * prefix, int (*callback)(char * key, Valuetype * value, void * data), void * data) \
+{ \
+	const unsigned char * bytes = (const unsigned char *)prefix; \
+	uint32_t len = 0, depth = 0, common = 0; \
+	void * child = NULL; \
+	void ** next = NULL; \
+	ArtNode * node = NULL; \
+	ArtLeaf * leaf = NULL; \
+	int calls = 0; \
+	if(tree == NULL || prefix == NULL) return 0; \
+	len   = strlen(prefix); \
+	child = tree->root; \
+	while(child != NULL) \
+	{ \
+		if(ART_IS_LEAF(child)) \
+		{ \
+			leaf = ART_LEAF(child); \
+			if(leaf->keyLen > len && memcmp(leaf->key, bytes, len) == 0) \
+				ART ## _walk(child, callback, data, &calls); \
+			return calls; \
+		} \
+		if(depth == len) \
+		{ \
+			ART ## _walk(child, callback, data, &calls); \
+			return calls; \
+		} \
+		node = child; \
+		if(node->prefixLen > 0) \
+		{ \
+			common = ArtNode_prefixMismatch(node, bytes, len, depth); \
+			/* The prefix ends inside the compressed path: the whole subtree matches */\
+			if(depth + node->prefixLen >= len) \
+			{ \
+				if(common == len - depth) \
+					ART ## _walk(child, callback, data, &calls); \
+				return calls; \
+			} \
+			if(common < node->prefixLen) \
+				return calls; \
+			depth += node->prefixLen; \
+		} \
+		if((next = ArtNode_findChild(node, bytes[depth])) == NULL) \
+			return calls; \
+		child = *next; \
+		depth++; \
+	} \
+	return calls; \
+}
+
+#define IMPLEMENT_ART_FN_LONGEST_PREFIX(ART, Valuetype) \
+Valuetype * ART ## _longest_prefix(ART * tree, char * str, char ** match) \
+{ \
+	const unsigned char * bytes = (const unsigned char *)str; \
+	uint32_t len = 0, depth = 0; \
+	void * child = NULL; \
+	void ** next = NULL; \
+	ArtNode * node = NULL; \
+	ArtLeaf * leaf = NULL, * best = NULL; \
+	if(match != NULL) *match = NULL; \
+	if(tree == NULL || str == NULL) return NULL; \
+	len   = strlen(str); \
+	child = tree->root; \
+	while(child != NULL) \
+	{ \
+		if(ART_IS_LEAF(child)) \
+		{ \
+			leaf = ART_LEAF(child); \
+			if(leaf->keyLen - 1 <= len && memcmp(leaf->key, bytes, leaf->keyLen - 1) == 0) \
+				best = leaf; \
+			break; \
+		} \
+		node = child; \
+		depth += node->prefixLen; \
+		if(depth > len) \
+			break; \
+		/* A key ending here is the '\0' child: the longest match so far if it starts str */\
+		if((next = ArtNode_findChild(node, 0)) != NULL && ART_IS_LEAF(*next)) \
+		{ \
+			leaf = ART_LEAF(*next); \
+			if(leaf->keyLen - 1 <= len && memcmp(leaf->key, bytes, leaf->keyLen - 1) == 0) \
+				best = leaf; \
+			else \
+				break; \
+		} \
+		if(depth == len || (next = ArtNode_findChild(node, bytes[depth])) == NULL) \
+			break; \
+		child = *next; \
+		depth++; \
+	} \
+	if(best == NULL) \
+		return NULL; \
+	if(match != NULL) *match = (char *)best->key; \
+	return &(((ART ## _leaf_t *)best)->value); \
+}
+
+#define IMPLEMENT_ART_FN_CLEAR(ART) \
+void ART ## _clear(ART * tree) \
+{ \
+	if(tree == NULL) return; \
+	ART ## _destroy(tree, tree->root); \
+	tree->root = NULL; \
+}
+
+#define IMPLEMENT_ART_FN_MEMORY(ART) \
+size_t ART ## _memory(ART * tree) \
+{ \
+	if(tree == NULL) return 0; \
+	return sizeof(ART) + ART ## _destroy(NULL, tree->root); \
+}
+
+// MACRO HELPERS (One line definitions && implementations)
+#define NEW_ART_DEFINITION(ART, VALUETYPE) \
+NEW_ART_TYPE(ART, VALUETYPE); \
+ART_FN_NEW(ART); \
+ART_FN_FREE(ART); \
+ART_FN_ADD(ART, VALUETYPE); \
+ART_FN_GET(ART, VALUETYPE); \
+ART_FN_REMOVE(ART); \
+ART_FN_PREFIX_ITERATE(ART, VALUETYPE); \
+ART_FN_LONGEST_PREFIX(ART, VALUETYPE); \
+ART_FN_CLEAR(ART); \
+ART_FN_MEMORY(ART)
+
+#define IMPLEMENT_ART(ART, VALUETYPE, FN_CPY_VAL, FN_CMP_VAL, FN_FREE_VAL) \
+IMPLEMENT_ART_FN_NEW(ART, VALUETYPE, FN_CPY_VAL, FN_CMP_VAL, FN_FREE_VAL); \
+IMPLEMENT_ART_FN_HELPERS(ART, VALUETYPE); \
+IMPLEMENT_ART_FN_FREE(ART); \
+IMPLEMENT_ART_FN_ADD(ART, VALUETYPE); \
+IMPLEMENT_ART_FN_GET(ART, VALUETYPE); \
+IMPLEMENT_ART_FN_REMOVE(ART); \
+IMPLEMENT_ART_FN_PREFIX_ITERATE(ART, VALUETYPE); \
+IMPLEMENT_ART_FN_LONGEST_PREFIX(ART, VALUETYPE); \
+IMPLEMENT_ART_FN_CLEAR(ART); \
+IMPLEMENT_ART_FN_MEMORY(ART)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __C_CONTAINERS_ART_H__
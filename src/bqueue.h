@@ -0,0 +1,557 @@
+/**
+ * @file bqueue.h
+ * @brief Blocking queue container definition
+ * @details A blocking queue is a thread safe queue for producer and
+ * consumer threads. Values are stored in a circular buffer.
+ * - With a capacity limit, producers wait while the queue is full
+ *   (backpressure).
+ * - Consumers wait while the queue is empty, and can take up to N values
+ *   per wakeup with BQUEUE_dequeue_batch.
+ * - Waiting threads are only signaled when somebody waits, not for every
+ *   value.
+ *
+ * Shutdown: BQUEUE_close refuses the next values and wakes everybody up,
+ * consumers still get the values left in the queue, then BQUEUE_CLOSED.
+ * BQUEUE_drain waits until the consumers have taken every value.
+ *
+ * Timeouts are in milliseconds: 0 does not wait, a negative timeout
+ * waits forever. Link with -pthread.
+ * @author Baudouin FEILDEL
+ */
+#ifndef __BQUEUE_H__
+#define __BQUEUE_H__
+
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Results of the waiting functions */
+#define BQUEUE_OK       1
+#define BQUEUE_TIMEOUT  0
+#define BQUEUE_CLOSED  -1
+
+/* Deadline of a timeout, on the monotonic clock */
+static inline void BQueue_deadline(struct timespec * deadline, long timeout)
+{
+	clock_gettime(CLOCK_MONOTONIC, deadline);
+	deadline->tv_sec  += timeout / 1000;
+	deadline->tv_nsec += (timeout % 1000) * 1000000;
+	if(deadline->tv_nsec >= 1000000000)
+	{
+		deadline->tv_sec++;
+		deadline->tv_nsec -= 1000000000;
+	}
+}
+
+/* Wait on a condition. Returns 0 when the deadline is over */
+static inline int BQueue_wait(pthread_cond_t * cond, pthread_mutex_t * lock, long timeout, const struct timespec * deadline)
+{
+	if(timeout == 0)
+		return 0;
+	if(timeout < 0)
+		return pthread_cond_wait(cond, lock) == 0;
+	return pthread_cond_timedwait(cond, lock, deadline) != ETIMEDOUT;
+}
+
+// =============
+//  Definitions
+// =============
+#define NEW_BQUEUE_TYPE(BQUEUE, ValueType) \
+typedef struct BQUEUE \
+{ \
+	ValueType * values;    /**< Circular buffer of the values */\
+	int    first;          /**< Position of the first value */\
+	int    slots;          /**< Number of slots in values */\
+	int    size;           /**< Queue size */\
+	int    capacity;       /**< Maximum size. 0 if unlimited */\
+	int    closed;         /**< Flag:<br>1: Closed, values are refused<br>0: Open */\
+	int    consumers;      /**< Number of consumers waiting for a value */\
+	int    producers;      /**< Number of producers waiting for a free slot */\
+	int    drainers;       /**< Number of threads waiting for an empty queue */\
+	pthread_mutex_t lock;  /**< Lock of the queue */\
+	pthread_cond_t  notEmpty; /**< Signaled when a value is added */\
+	pthread_cond_t  notFull;  /**< Signaled when a slot is freed */\
+	pthread_cond_t  empty;    /**< Signaled when the queue becomes empty */\
+	size_t elemSize;       /**< Size of one element in the queue */\
+	int    freeValue;      /**< Flag:<br>1: Automatically free the value<br>0: Do not automatically free the value */\
+	void (*_copyValue) (ValueType * dest, ValueType * src); /**< Pointer to a function used to copy a value */\
+	int  (*_cmpValue)  (ValueType val1, ValueType val2);    /**< Pointer to a function used to compare two values */\
+	void (*_freeValue) (ValueType value);                   /**< Pointer to a function used to free a value */\
+	void (*_print)     (ValueType value);                   /**< Pointer to a function used to print a value */\
+} BQUEUE
+
+#define BQUEUE_FN_NEW(BQUEUE) \
+/**
+ @brief Create a new BQUEUE object
+ @param capacity Maximum number of values in the queue. 0 for no limit
+ @return A pointer to an allocated and initialized
+ BQUEUE object in memory
+ */ \
+BQUEUE * BQUEUE ## _new(int capacity)
+
+#define BQUEUE_FN_FREE(BQUEUE) \
+/**
+ Destroy a BQUEUE object
+ @details No other thread may use the queue anymore.
+ @param queue A pointer to a BQUEUE object
+ */ \
+void BQUEUE ## _free(BQUEUE * queue)
+
+#define BQUEUE_FN_ENQUEUE_STRUCT(BQUEUE, ValueType) \
+/**
+ Add a value to the queue, waiting while the queue is full
+ @param queue A pointer to a valid BQUEUE object
+ @param value The value to add
+ @return      BQUEUE_OK. BQUEUE_CLOSED if the queue is closed
+ */ \
+int BQUEUE ## _enqueue(BQUEUE * queue, ValueType value)
+
+#define BQUEUE_FN_ENQUEUE_WAIT_STRUCT(BQUEUE, ValueType) \
+/**
+ Add a value to the queue, waiting at most timeout while the queue is full
+ @param queue   A pointer to a valid BQUEUE object
+ @param value   The value to add
+ @param timeout Maximum time to wait in milliseconds
+ @return        BQUEUE_OK, BQUEUE_TIMEOUT or BQUEUE_CLOSED
+ */ \
+int BQUEUE ## _enqueue_wait(BQUEUE * queue, ValueType value, long timeout)
+
+#define BQUEUE_FN_DEQUEUE_STRUCT(BQUEUE, ValueType) \
+/**
+ Remove a value from the queue, waiting while the queue is empty
+ @details The caller becomes the owner of the returned value.
+
+ @param queue A pointer to a valid BQUEUE object
+ @return      The first value. The default value once closed and empty
+ */ \
+ValueType BQUEUE ## _dequeue(BQUEUE * queue)
+
+#define BQUEUE_FN_DEQUEUE_WAIT_STRUCT(BQUEUE, ValueType) \
+/**
+ Remove a value from the queue, waiting at most timeout while the queue is empty
+ @param queue   A pointer to a valid BQUEUE object
+ @param value   Receives the first value, the caller becomes its owner
+ @param timeout Maximum time to wait in milliseconds
+ @return        BQUEUE_OK, BQUEUE_TIMEOUT or BQUEUE_CLOSED (closed and empty)
+ */ \
+int BQUEUE ## _dequeue_wait(BQUEUE * queue, ValueType * value, long timeout)
+
+#define BQUEUE_FN_DEQUEUE_BATCH_STRUCT(BQUEUE, ValueType) \
+/**
+ Remove up to max values, waiting at most timeout for the first one
+ @param queue   A pointer to a valid BQUEUE object
+ @param values  Array of at least max values, receives the values
+ @param max     Maximum number of values to take
+ @param timeout Maximum time to wait in milliseconds
+ @return        Number of values taken, 0 on timeout.
+ BQUEUE_CLOSED if the queue is closed and empty
+ */ \
+int BQUEUE ## _dequeue_batch(BQUEUE * queue, ValueType * values, int max, long timeout)
+
+#define BQUEUE_FN_CLOSE(BQUEUE) \
+/**
+ Close the queue
+ @details Next enqueues are refused, every waiting thread wakes up.
+ Consumers still get the values left in the queue.
+
+ @param queue A pointer to a valid BQUEUE object
+ */ \
+void BQUEUE ## _close(BQUEUE * queue)
+
+#define BQUEUE_FN_DRAIN(BQUEUE) \
+/**
+ Wait until the queue is empty
+ @param queue   A pointer to a valid BQUEUE object
+ @param timeout Maximum time to wait in milliseconds
+ @return        BQUEUE_OK if empty. BQUEUE_TIMEOUT otherwise
+ */ \
+int BQUEUE ## _drain(BQUEUE * queue, long timeout)
+
+#define BQUEUE_FN_SIZE(BQUEUE) \
+/**
+ Count the values of the queue
+ @param queue A pointer to a valid BQUEUE object
+ @return      Number of values in the queue
+ */ \
+int BQUEUE ## _size(BQUEUE * queue)
+
+#define BQUEUE_FN_CLEAR(BQUEUE) \
+/**
+ Remove every value of the queue
+ @details The buffer is kept. Waiting producers and drainers wake up.
+ @param queue A pointer to a valid BQUEUE object
+ */ \
+void BQUEUE ## _clear(BQUEUE * queue)
+
+#define BQUEUE_FN_RESERVE(BQUEUE) \
+/**
+ Allocate the buffer for n values
+ @details Limited to the capacity of the queue.
+ @param queue A pointer to a valid BQUEUE object
+ @param n     Number of values to hold without allocating
+ */ \
+void BQUEUE ## _reserve(BQUEUE * queue, int n)
+
+#define BQUEUE_FN_SHRINK_TO_FIT(BQUEUE) \
+/**
+ Shrink the buffer to the values of the queue
+ @param queue A pointer to a valid BQUEUE object
+ */ \
+void BQUEUE ## _shrink_to_fit(BQUEUE * queue)
+
+#define BQUEUE_FN_PRINT_STRUCT(BQUEUE) \
+/**
+ Print a queue
+ @param queue A pointer to a valid BQUEUE object
+ */ \
+void BQUEUE ## _print(BQUEUE * queue)
+
+// =================
+//  Implementations
+// =================
+#define IMPLEMENT_BQUEUE_FN_NEW(BQUEUE, Valuetype, FN_CPY_VAL, FN_CMP_VAL, FN_FREE_VAL, FN_PRINT_VAL) \
+BQUEUE * BQUEUE ## _new(int capacity) \
+{ \
+	BQUEUE * queue = malloc(sizeof(BQUEUE)); \
+	pthread_condattr_t attributes; \
+	queue->slots     = (capacity > 0 && capacity < 16) ? capacity : 16; \
+	queue->values    = malloc(sizeof(Valuetype) * queue->slots); \
+	queue->first     = 0; \
+	queue->size      = 0; \
+	queue->capacity  = capacity > 0 ? capacity : 0; \
+	queue->closed    = 0; \
+	queue->consumers = 0; \
+	queue->producers = 0; \
+	queue->drainers  = 0; \
+	/* Timed waits use the monotonic clock */\
+	pthread_condattr_init(&attributes); \
+	pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC); \
+	pthread_mutex_init(&(queue->lock), NULL); \
+	pthread_cond_init(&(queue->notEmpty), &attributes); \
+	pthread_cond_init(&(queue->notFull), &attributes); \
+	pthread_cond_init(&(queue->empty), &attributes); \
+	pthread_condattr_destroy(&attributes); \
+	queue->elemSize   = sizeof(Valuetype); \
+	queue->freeValue  = 1; \
+	queue->_copyValue = FN_CPY_VAL; \
+	queue->_cmpValue  = FN_CMP_VAL; \
+	queue->_freeValue = FN_FREE_VAL; \
+	queue->_print     = FN_PRINT_VAL; \
+	return queue; \
+}
+
+#define IMPLEMENT_BQUEUE_FN_FREE(BQUEUE) \
+void BQUEUE ## _free(BQUEUE * queue) \
+{ \
+	int i = 0; \
+	if(queue == NULL) return; \
+	if(queue->freeValue) \
+		for(i = 0 ; i < queue->size ; i++) \
+			queue->_freeValue(queue->values[(queue->first + i) % queue->slots]); \
+	pthread_mutex_destroy(&(queue->lock)); \
+	pthread_cond_destroy(&(queue->notEmpty)); \
+	pthread_cond_destroy(&(queue->notFull)); \
+	pthread_cond_destroy(&(queue->empty)); \
+	free(queue->values); \
+	free(queue); \
+}
+
+/* Internal helpers, called with the lock held */
+#define IMPLEMENT_BQUEUE_FN_HELPERS(BQUEUE, Valuetype) \
+/* Move the values to a buffer of 'slots' slots, unrolling the circular order */\
+static void BQUEUE ## _resize(BQUEUE * queue, int slots) \
+{ \
+	Valuetype * values = NULL; \
+	int i = 0; \
+	if((values = malloc(sizeof(Valuetype) * slots)) == NULL) \
+		return; \
+	for(i = 0 ; i < queue->size ; i++) \
+		values[i] = queue->values[(queue->first + i) % queue->slots]; \
+	free(queue->values); \
+	queue->values = values; \
+	queue->slots  = slots; \
+	queue->first  = 0; \
+} \
+static void BQUEUE ## _push(BQUEUE * queue, Valuetype * value) \
+{ \
+	int slots = 0; \
+	if(queue->size == queue->slots) \
+	{ \
+		slots = queue->slots * 2; \
+		if(queue->capacity > 0 && slots > queue->capacity) \
+			slots = queue->capacity; \
+		BQUEUE ## _resize(queue, slots); \
+	} \
+	queue->_copyValue(&(queue->values[(queue->first + queue->size) % queue->slots]), value); \
+	queue->size++; \
+	if(queue->consumers > 0) \
+		pthread_cond_signal(&(queue->notEmpty)); \
+} \
+static Valuetype BQUEUE ## _pop(BQUEUE * queue) \
+{ \
+	Valuetype value = queue->values[queue->first]; \
+	queue->first = (queue->first + 1) % queue->slots; \
+	queue->size--; \
+	return value; \
+} \
+/* Wake the producers and drainers after values were taken */\
+static void BQUEUE ## _taken(BQUEUE * queue, int count) \
+{ \
+	if(queue->producers > 0) \
+	{ \
+		if(count > 1) pthread_cond_broadcast(&(queue->notFull)); \
+		else          pthread_cond_signal(&(queue->notFull)); \
+	} \
+	if(queue->size == 0 && queue->drainers > 0) \
+		pthread_cond_broadcast(&(queue->empty)); \
+} \
+/* Wait for a value. Returns BQUEUE_OK, BQUEUE_TIMEOUT or BQUEUE_CLOSED */\
+static int BQUEUE ## _waitValue(BQUEUE * queue, long timeout) \
+{ \
+	struct timespec deadline; \
+	int waiting = 1; \
+	if(timeout > 0) \
+		BQueue_deadline(&deadline, timeout); \
+	while(queue->size == 0 && !queue->closed && waiting) \
+	{ \
+		queue->consumers++; \
+		waiting = BQueue_wait(&(queue->notEmpty), &(queue->lock), timeout, &deadline); \
+		queue->consumers--; \
+	} \
+	if(queue->size > 0) return BQUEUE_OK; \
+	return queue->closed ? BQUEUE_CLOSED : BQUEUE_TIMEOUT; \
+}
+
+#define IMPLEMENT_BQUEUE_FN_ENQUEUE_WAIT_STRUCT(BQUEUE, Valuetype) \
+int BQUEUE ## _enqueue_wait(BQUEUE * queue, Valuetype value, long timeout) \
+{ \
+	struct timespec deadline; \
+	int waiting = 1; \
+	if(queue == NULL) return BQUEUE_CLOSED; \
+	if(timeout > 0) \
+		BQueue_deadline(&deadline, timeout); \
+	pthread_mutex_lock(&(queue->lock)); \
+	while(!queue->closed && queue->capacity > 0 && queue->size >= queue->capacity && waiting) \
+	{ \
+		queue->producers++; \
+		waiting = BQueue_wait(&(queue->notFull), &(queue->lock), timeout, &deadline); \
+		queue->producers--; \
+	} \
+	if(queue->closed) \
+	{ \
+		pthread_mutex_unlock(&(queue->lock)); \
+		return BQUEUE_CLOSED; \
+	} \
+	if(queue->capacity > 0 && queue->size >= queue->capacity) \
+	{ \
+		pthread_mutex_unlock(&(queue->lock)); \
+		return BQUEUE_TIMEOUT; \
+	} \
+	BQUEUE ## _push(queue, &value); \
+	pthread_mutex_unlock(&(queue->lock)); \
+	return BQUEUE_OK; \
+}
+
+#define IMPLEMENT_BQUEUE_FN_ENQUEUE_STRUCT(BQUEUE, Valuetype) \
+int BQUEUE ## _enqueue(BQUEUE * queue, Valuetype value) \
+{ \
+	return BQUEUE ## _enqueue_wait(queue, value, -1); \
+}
+
+#define IMPLEMENT_BQUEUE_FN_DEQUEUE_WAIT_STRUCT(BQUEUE, Valuetype) \
+int BQUEUE ## _dequeue_wait(BQUEUE * queue, Valuetype * value, long timeout) \
+{ \
+	int result = BQUEUE_CLOSED; \
+	if(queue == NULL) return BQUEUE_CLOSED; \
+	pthread_mutex_lock(&(queue->lock)); \
+	result = BQUEUE ## _waitValue(queue, timeout); \
+	if(result == BQUEUE_OK) \
+	{ \
+		*value = BQUEUE ## _pop(queue); \
+		BQUEUE ## _taken(queue, 1); \
+	} \
+	pthread_mutex_unlock(&(queue->lock)); \
+	return result; \
+}
+
+#define IMPLEMENT_BQUEUE_FN_DEQUEUE_STRUCT(BQUEUE, Valuetype, DEFAULT_VALUE) \
+Valuetype BQUEUE ## _dequeue(BQUEUE * queue) \
+{ \
+	Valuetype value = DEFAULT_VALUE; \
+	BQUEUE ## _dequeue_wait(queue, &value, -1); \
+	return value; \
+}
+
+#define IMPLEMENT_BQUEUE_FN_DEQUEUE_BATCH_STRUCT(BQUEUE, Valuetype) \
+int BQUEUE ## _dequeue_batch(BQUEUE * queue, Valuetype * values, int max, long timeout) \
+{ \
+	int result = BQUEUE_CLOSED, count = 0; \
+	if(queue == NULL) return BQUEUE_CLOSED; \
+	if(max <= 0) return 0; \
+	pthread_mutex_lock(&(queue->lock)); \
+	result = BQUEUE ## _waitValue(queue, timeout); \
+	if(result == BQUEUE_OK) \
+	{ \
+		while(count < max && queue->size > 0) \
+			values[count++] = BQUEUE ## _pop(queue); \
+		BQUEUE ## _taken(queue, count); \
+	} \
+	pthread_mutex_unlock(&(queue->lock)); \
+	return result == BQUEUE_OK ? count : result; \
+}
+
+#define IMPLEMENT_BQUEUE_FN_CLOSE(BQUEUE) \
+void BQUEUE ## _close(BQUEUE * queue) \
+{ \
+	if(queue == NULL) return; \
+	pthread_mutex_lock(&(queue->lock)); \
+	queue->closed = 1; \
+	pthread_cond_broadcast(&(queue->notEmpty)); \
+	pthread_cond_broadcast(&(queue->notFull)); \
+	pthread_mutex_unlock(&(queue->lock)); \
+}
+
+#define IMPLEMENT_BQUEUE_FN_DRAIN(BQUEUE) \
+int BQUEUE ## _drain(BQUEUE * queue, long timeout) \
+{ \
+	struct timespec deadline; \
+	int waiting = 1, empty = 0; \
+	if(queue == NULL) return BQUEUE_OK; \
+	if(timeout > 0) \
+		BQueue_deadline(&deadline, timeout); \
+	pthread_mutex_lock(&(queue->lock)); \
+	while(queue->size > 0 && waiting) \
+	{ \
+		queue->drainers++; \
+		waiting = BQueue_wait(&(queue->empty), &(queue->lock), timeout, &deadline); \
+		queue->drainers--; \
+	} \
+	empty = (queue->size == 0); \
+	pthread_mutex_unlock(&(queue->lock)); \
+	return empty ? BQUEUE_OK : BQUEUE_TIMEOUT; \
+}
+
+#define IMPLEMENT_BQUEUE_FN_SIZE(BQUEUE) \
+int BQUEUE ## _size(BQUEUE * queue) \
+{ \
+	int size = 0; \
+	if(queue == NULL) return 0; \
+	pthread_mutex_lock(&(queue->lock)); \
+	size = queue->size; \
+	pthread_mutex_unlock(&(queue->lock)); \
+	return size; \
+}
+
+#define IMPLEMENT_BQUEUE_FN_CLEAR(BQUEUE) \
+void BQUEUE ## _clear(BQUEUE * queue) \
+{ \
+	int i = 0; \
+	if(queue == NULL) return; \
+	pthread_mutex_lock(&(queue->lock)); \
+	if(queue->freeValue) \
+		for(i = 0 ; i < queue->size ; i++) \
+			queue->_freeValue(queue->values[(queue->first + i) % queue->slots]); \
+	i = queue->size; \
+	queue->size  = 0; \
+	queue->first = 0; \
+	BQUEUE ## _taken(queue, i); \
+	pthread_mutex_unlock(&(queue->lock)); \
+}
+
+#define IMPLEMENT_BQUEUE_FN_RESERVE(BQUEUE) \
+void BQUEUE ## _reserve(BQUEUE * queue, int n) \
+{ \
+	if(queue == NULL) return; \
+	pthread_mutex_lock(&(queue->lock)); \
+	if(queue->capacity > 0 && n > queue->capacity) \
+		n = queue->capacity; \
+	if(n > queue->slots) \
+		BQUEUE ## _resize(queue, n); \
+	pthread_mutex_unlock(&(queue->lock)); \
+}
+
+#define IMPLEMENT_BQUEUE_FN_SHRINK_TO_FIT(BQUEUE) \
+void BQUEUE ## _shrink_to_fit(BQUEUE * queue) \
+{ \
+	int slots = 0; \
+	if(queue == NULL) return; \
+	pthread_mutex_lock(&(queue->lock)); \
+	/* Never below the initial buffer */\
+	slots = (queue->capacity > 0 && queue->capacity < 16) ? queue->capacity : 16; \
+	if(slots < queue->size) \
+		slots = queue->size; \
+	if(slots < queue->slots) \
+		BQUEUE ## _resize(queue, slots); \
+	pthread_mutex_unlock(&(queue->lock)); \
+}
+
+#ifdef CCONTAINERS_DISABLE_PRINT
+#define IMPLEMENT_BQUEUE_FN_PRINT(BQUEUE) \
+void BQUEUE ## _print(BQUEUE * queue) \
+{ \
+	(void)(queue); \
+}
+#else
+#define IMPLEMENT_BQUEUE_FN_PRINT(BQUEUE) \
+void BQUEUE ## _print(BQUEUE * queue) \
+{ \
+	int i = 0; \
+	pthread_mutex_lock(&(queue->lock)); \
+	printf("["); \
+	for(i = 0 ; i < queue->size ; i++) \
+	{ \
+		queue->_print(queue->values[(queue->first + i) % queue->slots]); \
+		if(i + 1 < queue->size) \
+			printf(", "); \
+	} \
+	printf("]\n"); \
+	pthread_mutex_unlock(&(queue->lock)); \
+}
+#endif
+
+
+// MACRO HELPERS (One line definitions && implementations)
+#define NEW_BQUEUE_DEFINITION(BQUEUE, VALUETYPE) \
+NEW_BQUEUE_TYPE(BQUEUE, VALUETYPE); \
+BQUEUE_FN_NEW(BQUEUE); \
+BQUEUE_FN_FREE(BQUEUE); \
+BQUEUE_FN_ENQUEUE_STRUCT(BQUEUE, VALUETYPE); \
+BQUEUE_FN_ENQUEUE_WAIT_STRUCT(BQUEUE, VALUETYPE); \
+BQUEUE_FN_DEQUEUE_STRUCT(BQUEUE, VALUETYPE); \
+BQUEUE_FN_DEQUEUE_WAIT_STRUCT(BQUEUE, VALUETYPE); \
+BQUEUE_FN_DEQUEUE_BATCH_STRUCT(BQUEUE, VALUETYPE); \
+BQUEUE_FN_CLOSE(BQUEUE); \
+BQUEUE_FN_DRAIN(BQUEUE); \
+BQUEUE_FN_SIZE(BQUEUE); \
+BQUEUE_FN_CLEAR(BQUEUE); \
+BQUEUE_FN_RESERVE(BQUEUE); \
+BQUEUE_FN_SHRINK_TO_FIT(BQUEUE); \
+BQUEUE_FN_PRINT_STRUCT(BQUEUE)
+
+#define IMPLEMENT_BQUEUE(BQUEUE, VALUETYPE, FN_CPY_VAL, FN_CMP_VAL, FN_FREE_VAL, FN_PRINT_VAL, DEFAULT_VALUE) \
+IMPLEMENT_BQUEUE_FN_NEW(BQUEUE, VALUETYPE, FN_CPY_VAL, FN_CMP_VAL, FN_FREE_VAL, FN_PRINT_VAL); \
+IMPLEMENT_BQUEUE_FN_FREE(BQUEUE); \
+IMPLEMENT_BQUEUE_FN_HELPERS(BQUEUE, VALUETYPE); \
+IMPLEMENT_BQUEUE_FN_ENQUEUE_WAIT_STRUCT(BQUEUE, VALUETYPE); \
+IMPLEMENT_BQUEUE_FN_ENQUEUE_STRUCT(BQUEUE, VALUETYPE); \
+IMPLEMENT_BQUEUE_FN_DEQUEUE_WAIT_STRUCT(BQUEUE, VALUETYPE); \
+IMPLEMENT_BQUEUE_FN_DEQUEUE_STRUCT(BQUEUE, VALUETYPE, DEFAULT_VALUE); \
+IMPLEMENT_BQUEUE_FN_DEQUEUE_BATCH_STRUCT(BQUEUE, VALUETYPE); \
+IMPLEMENT_BQUEUE_FN_CLOSE(BQUEUE); \
+IMPLEMENT_BQUEUE_FN_DRAIN(BQUEUE); \
+IMPLEMENT_BQUEUE_FN_SIZE(BQUEUE); \
+IMPLEMENT_BQUEUE_FN_CLEAR(BQUEUE); \
+IMPLEMENT_BQUEUE_FN_RESERVE(BQUEUE); \
+IMPLEMENT_BQUEUE_FN_SHRINK_TO_FIT(BQUEUE); \
+IMPLEMENT_BQUEUE_FN_PRINT(BQUEUE)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __BQUEUE_H__
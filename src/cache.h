@@ -0,0 +1,607 @@
+/**
+ * @file cache.h
+ * @brief Cache container definition
+ * @details A cache is a hash map with a capacity. When an insertion makes
+ * the cache exceed its capacity, elements are evicted according to the
+ * policy given to CACHE_new:
+ * - CACHE_LRU   evicts the least recently used element
+ * - CACHE_CLOCK evicts an element not used since the clock hand last
+ *   passed (second chance). Hits only set a flag, they never relink.
+ * - CACHE_LFU   evicts the least frequently used element, the least
+ *   recently used one among equals
+ *
+ * Lookups are hashed and every policy touches and evicts in O(1)
+ * (amortized for CLOCK). The capacity counts elements, or bytes when a
+ * size function is given.
+ *
+ * Evicted elements are released with _freeValue and _freeIndex: set
+ * _freeValue to your own function to be notified of the evictions.
+ * @author Baudouin FEILDEL
+ */
+#ifndef __CACHE_H__
+#define __CACHE_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "intrusive.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Eviction policies */
+#define CACHE_LRU   0
+#define CACHE_CLOCK 1
+#define CACHE_LFU   2
+
+// =============
+//  Definitions
+// =============
+#define NEW_CACHE_ELEM(CACHE, ElemTypename, Valuetype, Indextype) \
+/**
+ Frequency class of the LFU policy: the elements used \c count times
+ */ \
+typedef struct CACHE ## _freq_t \
+{ \
+	unsigned long long count; /**< Number of uses of the elements */\
+	Intrusive_link items;     /**< Elements, least recently used first */\
+	Intrusive_link link;      /**< Link in the frequency list, lowest count first */\
+} CACHE ## _freq_t; \
+/**
+ Element of a CACHE object
+ */ \
+typedef struct _ ## ElemTypename \
+{ \
+	Valuetype value;  /**< Value of the element */\
+	Indextype index;  /**< Index of the element */\
+	uint64_t  hash;   /**< Hash of the index */\
+	size_t    weight; /**< Part of the capacity used by the element */\
+	int       referenced; /**< CLOCK policy: used since the hand last passed */\
+	CACHE ## _freq_t * freq; /**< LFU policy: frequency class of the element */\
+	struct _ ## ElemTypename * next; /**< Pointer to the next element in the bucket */\
+	Intrusive_link link; /**< Link in the recency order or in the frequency class */\
+} ElemTypename
+
+#define NEW_CACHE_TYPE(CACHE, Valuetype, Indextype) \
+NEW_CACHE_ELEM(CACHE, CACHE ## _elem_t, Valuetype, Indextype); \
+typedef struct CACHE \
+{ \
+	CACHE ## _elem_t ** buckets; /**< Hash buckets */\
+	int    bucketCount;   /**< Number of buckets, a power of two */\
+	int    size;          /**< Number of elements in the cache */\
+	int    policy;        /**< CACHE_LRU, CACHE_CLOCK or CACHE_LFU */\
+	size_t capacity;      /**< Maximum number of elements, or of bytes with _sizeOf */\
+	size_t used;          /**< Part of the capacity in use */\
+	Intrusive_link order; /**< LRU and CLOCK: elements, most recently inserted or used first */\
+	Intrusive_link freqs; /**< LFU: frequency classes, lowest count first */\
+	CACHE ## _elem_t * spare; /**< Released elements kept for the next insertions, linked by next */\
+	int    spareCount;    /**< Number of elements in spare */\
+	unsigned long long hits;      /**< Number of successful CACHE_get */\
+	unsigned long long misses;    /**< Number of failed CACHE_get */\
+	unsigned long long evictions; /**< Number of evicted elements */\
+	size_t elemSize;   /**< Size of one element in the cache */\
+	int    freeValue;  /**< Flag:<br>1: Automatically free the value<br>0: Do not automatically free the value */\
+	int    freeIndex;  /**< Flag:<br>1: Automatically free the index<br>0: Do not automatically free the index */\
+	void (*_copyValue)(Valuetype * dest, Valuetype * src); /**< Pointer to a function used to copy a value */\
+	void (*_copyIndex)(Indextype * dest, Indextype * src); /**< Pointer to a function used to copy an index */\
+	int (*_cmpValue)(Valuetype val1, Valuetype val2); /**< Pointer to a function used to compare two values */\
+	int (*_cmpIndex)(Indextype val1, Indextype val2); /**< Pointer to a function used to compare two indexes */\
+	void (*_freeValue)(Valuetype value); /**< Pointer to a function used to free a value, called on eviction */\
+	void (*_freeIndex)(Indextype index); /**< Pointer to a function used to free an index */\
+	uint64_t (*_hashIndex)(Indextype index); /**< Pointer to a function used to hash an index */\
+	size_t (*_sizeOf)(Valuetype value); /**< Pointer to a function giving the size of a value. NULL to count elements */\
+} CACHE
+
+#define CACHE_FN_NEW(CACHE, Valuetype) \
+/**
+ @brief Create a new CACHE object
+ @param policy   CACHE_LRU, CACHE_CLOCK or CACHE_LFU
+ @param capacity Maximum number of elements, or of bytes when \c sizeOf is given
+ @param sizeOf   Function giving the size in bytes of a value. NULL to count elements
+ @return A pointer to an allocated and initialized
+ CACHE object in memory
+ */ \
+CACHE * CACHE ## _new(int policy, size_t capacity, size_t (*sizeOf)(Valuetype value))
+
+#define CACHE_FN_FREE(CACHE) \
+/**
+ Destroy a CACHE object
+ @param cache A pointer to a CACHE object
+ */ \
+void CACHE ## _free(CACHE * cache)
+
+#define CACHE_FN_ADD_STRUCT(CACHE, Valuetype, Indextype) \
+/**
+ Add an element to the cache
+ @details If an element already have this index
+ its value will be updated. Elements are evicted until the
+ cache fits in its capacity; the added element is never evicted
+ by its own insertion.
+
+ @param cache A pointer to a valid CACHE object
+ @param index The index of the element to add
+ @param value The value to set
+ @return      1 if the element was inserted. 0 if it was updated.
+ -1 if the value alone exceeds the capacity: it is not cached
+ (and an older value of this index is removed)
+ */ \
+int CACHE ## _add(CACHE * cache, Indextype index, Valuetype value)
+
+#define CACHE_FN_GET_STRUCT(CACHE, Valuetype, Indextype) \
+/**
+ Get the value of an element and mark it as used
+ @details Counts a hit or a miss.
+ @param cache A pointer to a valid CACHE object
+ @param index The index of the element to get
+ @return      A pointer to the value, valid until the element is
+ evicted or removed. NULL if the element is not cached
+ */ \
+Valuetype * CACHE ## _get(CACHE * cache, Indextype index)
+
+#define CACHE_FN_PEEK_STRUCT(CACHE, Valuetype, Indextype) \
+/**
+ Get the value of an element without marking it as used
+ @details The counters are not updated.
+ @param cache A pointer to a valid CACHE object
+ @param index The index of the element to get
+ @return      A pointer to the value. NULL if the element is not cached
+ */ \
+Valuetype * CACHE ## _peek(CACHE * cache, Indextype index)
+
+#define CACHE_FN_REMOVE_STRUCT(CACHE, Indextype) \
+/**
+ Remove an element from the cache
+ @details This is not counted as an eviction.
+ @param cache A pointer to a valid CACHE object
+ @param index The index of the element to remove
+ @return      1 if the element was removed. 0 if it was not present
+ */ \
+int CACHE ## _remove(CACHE * cache, Indextype index)
+
+#define CACHE_FN_CLEAR(CACHE) \
+/**
+ Remove every element of the cache
+ @details Not counted as evictions. The buckets and the elements are
+ kept for the next insertions.
+ @param cache A pointer to a valid CACHE object
+ */ \
+void CACHE ## _clear(CACHE * cache)
+
+#define CACHE_FN_RESERVE(CACHE) \
+/**
+ Size the table and allocate the elements for n elements
+ @details The cache then holds n elements without allocating.
+ @param cache A pointer to a valid CACHE object
+ @param n     Number of elements to hold
+ */ \
+void CACHE ## _reserve(CACHE * cache, int n)
+
+#define CACHE_FN_SHRINK_TO_FIT(CACHE) \
+/**
+ Release the unused elements and shrink the table to the cache size
+ @param cache A pointer to a valid CACHE object
+ */ \
+void CACHE ## _shrink_to_fit(CACHE * cache)
+
+// =================
+//  Implementations
+// =================
+#define IMPLEMENT_CACHE_FN_NEW(CACHE, Valuetype, Indextype, FN_CPY_VAL, FN_CPY_IDX, FN_CMP_VAL, FN_CMP_IDX, FN_FREE_VAL, FN_FREE_IDX, FN_HASH_IDX) \
+CACHE * CACHE ## _new(int policy, size_t capacity, size_t (*sizeOf)(Valuetype value)) \
+{ \
+	CACHE * cache = malloc(sizeof(CACHE)); \
+	cache->bucketCount = 16; \
+	cache->buckets     = calloc(16, sizeof(CACHE ## _elem_t *)); \
+	cache->size        = 0; \
+	cache->policy      = policy; \
+	cache->capacity    = capacity; \
+	cache->used        = 0; \
+	cache->spare       = NULL; \
+	cache->spareCount  = 0; \
+	cache->hits        = 0; \
+	cache->misses      = 0; \
+	cache->evictions   = 0; \
+	cache->order.next  = &(cache->order); \
+	cache->order.prev  = &(cache->order); \
+	cache->freqs.next  = &(cache->freqs); \
+	cache->freqs.prev  = &(cache->freqs); \
+	cache->elemSize   = sizeof(CACHE ## _elem_t); \
+	cache->freeValue  = 1; \
+	cache->freeIndex  = 1; \
+	cache->_copyValue = FN_CPY_VAL; \
+	cache->_copyIndex = FN_CPY_IDX; \
+	cache->_cmpValue  = FN_CMP_VAL; \
+	cache->_cmpIndex  = FN_CMP_IDX; \
+	cache->_freeValue = FN_FREE_VAL; \
+	cache->_freeIndex = FN_FREE_IDX; \
+	cache->_hashIndex = FN_HASH_IDX; \
+	cache->_sizeOf    = sizeOf; \
+	return cache; \
+}
+
+#define IMPLEMENT_CACHE_FN_FREE(CACHE) \
+void CACHE ## _free(CACHE * cache) \
+{ \
+	CACHE ## _elem_t * it = NULL, * next = NULL; \
+	Intrusive_link * freq = NULL; \
+	int b = 0; \
+	if(cache == NULL) return; \
+	for(b = 0 ; b < cache->bucketCount ; b++) \
+	{ \
+		for(it = cache->buckets[b] ; it != NULL ; it = next) \
+		{ \
+			next = it->next; \
+			if(cache->freeValue) cache->_freeValue(it->value); \
+			if(cache->freeIndex) cache->_freeIndex(it->index); \
+			free(it); \
+		} \
+	} \
+	while((freq = cache->freqs.next) != &(cache->freqs)) \
+	{ \
+		Intrusive_link_remove(freq); \
+		free(container_of(freq, CACHE ## _freq_t, link)); \
+	} \
+	for(it = cache->spare ; it != NULL ; it = next) \
+	{ \
+		next = it->next; \
+		free(it); \
+	} \
+	free(cache->buckets); \
+	free(cache); \
+}
+
+/* Internal helpers: hash table and eviction policies */
+#define IMPLEMENT_CACHE_FN_POLICY(CACHE, Indextype) \
+static CACHE ## _elem_t ** CACHE ## _find(CACHE * cache, Indextype index, uint64_t hash) \
+{ \
+	CACHE ## _elem_t ** it = &(cache->buckets[hash & (uint64_t)(cache->bucketCount - 1)]); \
+	while(*it != NULL) \
+	{ \
+		if((*it)->hash == hash && cache->_cmpIndex((*it)->index, index) == 0) \
+			return it; \
+		it = &((*it)->next); \
+	} \
+	return it; \
+} \
+static void CACHE ## _resize(CACHE * cache, int count) \
+{ \
+	CACHE ## _elem_t ** buckets = NULL; \
+	CACHE ## _elem_t * it = NULL, * next = NULL; \
+	int b = 0; \
+	buckets = calloc(count, sizeof(CACHE ## _elem_t *)); \
+	for(b = 0 ; b < cache->bucketCount ; b++) \
+	{ \
+		for(it = cache->buckets[b] ; it != NULL ; it = next) \
+		{ \
+			next = it->next; \
+			it->next = buckets[it->hash & (uint64_t)(count - 1)]; \
+			buckets[it->hash & (uint64_t)(count - 1)] = it; \
+		} \
+	} \
+	free(cache->buckets); \
+	cache->buckets     = buckets; \
+	cache->bucketCount = count; \
+} \
+/* LFU: move elem to the class count + 1 (or 1 when new), creating it after 'from' if needed */\
+static void CACHE ## _promote(CACHE * cache, CACHE ## _elem_t * elem) \
+{ \
+	CACHE ## _freq_t * from = elem->freq, * to = NULL; \
+	Intrusive_link * after = (from != NULL) ? &(from->link) : &(cache->freqs); \
+	unsigned long long count = (from != NULL) ? from->count + 1 : 1; \
+	if(after->next != &(cache->freqs) && container_of(after->next, CACHE ## _freq_t, link)->count == count) \
+		to = container_of(after->next, CACHE ## _freq_t, link); \
+	else \
+	{ \
+		to = malloc(sizeof(CACHE ## _freq_t)); \
+		to->count = count; \
+		to->items.next = &(to->items); \
+		to->items.prev = &(to->items); \
+		Intrusive_link_insert(&(to->link), after, after->next); \
+	} \
+	if(from != NULL) \
+	{ \
+		Intrusive_link_remove(&(elem->link)); \
+		if(from->items.next == &(from->items)) \
+		{ \
+			Intrusive_link_remove(&(from->link)); \
+			free(from); \
+		} \
+	} \
+	Intrusive_link_insert(&(elem->link), to->items.prev, &(to->items)); \
+	elem->freq = to; \
+} \
+/* Record a use of elem */\
+static void CACHE ## _touch(CACHE * cache, CACHE ## _elem_t * elem) \
+{ \
+	switch(cache->policy) \
+	{ \
+		case CACHE_CLOCK: \
+			elem->referenced = 1; \
+			break; \
+		case CACHE_LFU: \
+			CACHE ## _promote(cache, elem); \
+			break; \
+		default: \
+			if(cache->order.next != &(elem->link)) \
+			{ \
+				Intrusive_link_remove(&(elem->link)); \
+				Intrusive_link_insert(&(elem->link), &(cache->order), cache->order.next); \
+			} \
+			break; \
+	} \
+} \
+/* Insert a new element in the eviction order */\
+static void CACHE ## _enter(CACHE * cache, CACHE ## _elem_t * elem) \
+{ \
+	elem->referenced = 0; \
+	elem->freq       = NULL; \
+	if(cache->policy == CACHE_LFU) \
+		CACHE ## _promote(cache, elem); \
+	else \
+		Intrusive_link_insert(&(elem->link), &(cache->order), cache->order.next); \
+} \
+/* Remove an element from the eviction order */\
+static void CACHE ## _leave(CACHE * cache, CACHE ## _elem_t * elem) \
+{ \
+	CACHE ## _freq_t * freq = elem->freq; \
+	Intrusive_link_remove(&(elem->link)); \
+	if(cache->policy == CACHE_LFU && freq->items.next == &(freq->items)) \
+	{ \
+		Intrusive_link_remove(&(freq->link)); \
+		free(freq); \
+	} \
+} \
+/* Choose the element to evict, never 'keep'. NULL if there is none */\
+static CACHE ## _elem_t * CACHE ## _victim(CACHE * cache, CACHE ## _elem_t * keep) \
+{ \
+	Intrusive_link * freq = NULL, * it = NULL; \
+	CACHE ## _elem_t * elem = NULL; \
+	if(cache->policy == CACHE_LFU) \
+	{ \
+		for(freq = cache->freqs.next ; freq != &(cache->freqs) ; freq = freq->next) \
+		{ \
+			for(it = container_of(freq, CACHE ## _freq_t, link)->items.next ; \
+			    it != &(container_of(freq, CACHE ## _freq_t, link)->items) ; it = it->next) \
+			{ \
+				if(it != &(keep->link)) \
+					return container_of(it, CACHE ## _elem_t, link); \
+			} \
+		} \
+		return NULL; \
+	} \
+	/* The oldest element is at the end of the order */\
+	for(it = cache->order.prev ; it != &(cache->order) ; it = cache->order.prev) \
+	{ \
+		elem = container_of(it, CACHE ## _elem_t, link); \
+		if(elem == keep) \
+		{ \
+			if(it->prev == &(cache->order)) return NULL; \
+			elem = container_of(it->prev, CACHE ## _elem_t, link); \
+		} \
+		if(cache->policy != CACHE_CLOCK || !elem->referenced) \
+			return elem; \
+		/* Second chance: clear the flag, move in front of the hand */\
+		elem->referenced = 0; \
+		Intrusive_link_remove(&(elem->link)); \
+		Intrusive_link_insert(&(elem->link), &(cache->order), cache->order.next); \
+	} \
+	return NULL; \
+} \
+/* Unlink elem from the table and the order, then release it */\
+static void CACHE ## _drop(CACHE * cache, CACHE ## _elem_t * elem, int evicted) \
+{ \
+	CACHE ## _elem_t ** slot = CACHE ## _find(cache, elem->index, elem->hash); \
+	*slot = elem->next; \
+	CACHE ## _leave(cache, elem); \
+	cache->size--; \
+	cache->used -= elem->weight; \
+	if(evicted) cache->evictions++; \
+	if(cache->freeValue) cache->_freeValue(elem->value); \
+	if(cache->freeIndex) cache->_freeIndex(elem->index); \
+	/* Keep a single released element for the next insertion */\
+	if(cache->spare == NULL) \
+	{ \
+		elem->next   = NULL; \
+		cache->spare = elem; \
+		cache->spareCount++; \
+	} \
+	else \
+		free(elem); \
+} \
+static void CACHE ## _shrink(CACHE * cache, CACHE ## _elem_t * keep) \
+{ \
+	CACHE ## _elem_t * victim = NULL; \
+	while(cache->used > cache->capacity && (victim = CACHE ## _victim(cache, keep)) != NULL) \
+		CACHE ## _drop(cache, victim, 1); \
+}
+
+#define IMPLEMENT_CACHE_FN_ADD_STRUCT(CACHE, Valuetype, Indextype) \
+int CACHE ## _add(CACHE * cache, Indextype index, Valuetype value) \
+{ \
+	CACHE ## _elem_t ** slot = NULL; \
+	CACHE ## _elem_t * elem = NULL; \
+	uint64_t hash = 0; \
+	size_t weight = 1; \
+	if(cache == NULL) \
+		return -1; \
+	if(cache->_sizeOf != NULL) \
+		weight = cache->_sizeOf(value); \
+	hash = cache->_hashIndex(index); \
+	slot = CACHE ## _find(cache, index, hash); \
+	if(weight > cache->capacity) \
+	{ \
+		if(*slot != NULL) CACHE ## _drop(cache, *slot, 0); \
+		return -1; \
+	} \
+	if(*slot != NULL) \
+	{ \
+		elem = *slot; \
+		if(cache->freeValue) cache->_freeValue(elem->value); \
+		cache->_copyValue(&(elem->value), &(value)); \
+		cache->used += weight - elem->weight; \
+		elem->weight = weight; \
+		CACHE ## _touch(cache, elem); \
+		CACHE ## _shrink(cache, elem); \
+		return 0; \
+	} \
+	/* Create the element, reusing a released one */\
+	if(cache->spare != NULL) \
+	{ \
+		elem = cache->spare; \
+		cache->spare = elem->next; \
+		cache->spareCount--; \
+	} \
+	else \
+		elem = malloc(cache->elemSize); \
+	elem->hash   = hash; \
+	elem->weight = weight; \
+	elem->next   = NULL; \
+	cache->_copyIndex(&(elem->index), &(index)); \
+	cache->_copyValue(&(elem->value), &(value)); \
+	*slot = elem; \
+	CACHE ## _enter(cache, elem); \
+	cache->size++; \
+	cache->used += weight; \
+	CACHE ## _shrink(cache, elem); \
+	if(cache->size > cache->bucketCount) \
+		CACHE ## _resize(cache, cache->bucketCount * 2); \
+	return 1; \
+}
+
+#define IMPLEMENT_CACHE_FN_GET_STRUCT(CACHE, Valuetype, Indextype) \
+Valuetype * CACHE ## _get(CACHE * cache, Indextype index) \
+{ \
+	CACHE ## _elem_t * elem = NULL; \
+	if(cache == NULL) return NULL; \
+	elem = *(CACHE ## _find(cache, index, cache->_hashIndex(index))); \
+	if(elem == NULL) \
+	{ \
+		cache->misses++; \
+		return NULL; \
+	} \
+	cache->hits++; \
+	CACHE ## _touch(cache, elem); \
+	return &(elem->value); \
+}
+
+#define IMPLEMENT_CACHE_FN_PEEK_STRUCT(CACHE, Valuetype, Indextype) \
+Valuetype * CACHE ## _peek(CACHE * cache, Indextype index) \
+{ \
+	CACHE ## _elem_t * elem = NULL; \
+	if(cache == NULL) return NULL; \
+	elem = *(CACHE ## _find(cache, index, cache->_hashIndex(index))); \
+	return (elem != NULL) ? &(elem->value) : NULL; \
+}
+
+#define IMPLEMENT_CACHE_FN_REMOVE_STRUCT(CACHE, Indextype) \
+int CACHE ## _remove(CACHE * cache, Indextype index) \
+{ \
+	CACHE ## _elem_t * elem = NULL; \
+	if(cache == NULL) return 0; \
+	elem = *(CACHE ## _find(cache, index, cache->_hashIndex(index))); \
+	if(elem == NULL) \
+		return 0; \
+	CACHE ## _drop(cache, elem, 0); \
+	return 1; \
+}
+
+#define IMPLEMENT_CACHE_FN_CLEAR(CACHE) \
+void CACHE ## _clear(CACHE * cache) \
+{ \
+	CACHE ## _elem_t * it = NULL, * next = NULL; \
+	Intrusive_link * freq = NULL; \
+	int b = 0; \
+	if(cache == NULL) return; \
+	for(b = 0 ; b < cache->bucketCount ; b++) \
+	{ \
+		for(it = cache->buckets[b] ; it != NULL ; it = next) \
+		{ \
+			next = it->next; \
+			if(cache->freeValue) cache->_freeValue(it->value); \
+			if(cache->freeIndex) cache->_freeIndex(it->index); \
+			it->next     = cache->spare; \
+			cache->spare = it; \
+			cache->spareCount++; \
+		} \
+		cache->buckets[b] = NULL; \
+	} \
+	while((freq = cache->freqs.next) != &(cache->freqs)) \
+	{ \
+		Intrusive_link_remove(freq); \
+		free(container_of(freq, CACHE ## _freq_t, link)); \
+	} \
+	cache->order.next = &(cache->order); \
+	cache->order.prev = &(cache->order); \
+	cache->size = 0; \
+	cache->used = 0; \
+}
+
+#define IMPLEMENT_CACHE_FN_RESERVE(CACHE) \
+void CACHE ## _reserve(CACHE * cache, int n) \
+{ \
+	CACHE ## _elem_t * elem = NULL; \
+	int count = 0; \
+	if(cache == NULL) return; \
+	for(count = cache->bucketCount ; count < n ; count *= 2); \
+	if(count > cache->bucketCount) \
+		CACHE ## _resize(cache, count); \
+	while(cache->size + cache->spareCount < n) \
+	{ \
+		if((elem = malloc(cache->elemSize)) == NULL) \
+			return; \
+		elem->next   = cache->spare; \
+		cache->spare = elem; \
+		cache->spareCount++; \
+	} \
+}
+
+#define IMPLEMENT_CACHE_FN_SHRINK_TO_FIT(CACHE) \
+void CACHE ## _shrink_to_fit(CACHE * cache) \
+{ \
+	CACHE ## _elem_t * it = NULL, * next = NULL; \
+	int count = 16; \
+	if(cache == NULL) return; \
+	for(it = cache->spare ; it != NULL ; it = next) \
+	{ \
+		next = it->next; \
+		free(it); \
+	} \
+	cache->spare      = NULL; \
+	cache->spareCount = 0; \
+	while(count < cache->size) \
+		count *= 2; \
+	if(count < cache->bucketCount) \
+		CACHE ## _resize(cache, count); \
+}
+
+// MACRO HELPERS (One line definitions && implementations)
+#define NEW_CACHE_DEFINITION(CACHE, VALUETYPE, INDEXTYPE) \
+NEW_CACHE_TYPE(CACHE, VALUETYPE, INDEXTYPE); \
+CACHE_FN_NEW(CACHE, VALUETYPE); \
+CACHE_FN_FREE(CACHE); \
+CACHE_FN_ADD_STRUCT(CACHE, VALUETYPE, INDEXTYPE); \
+CACHE_FN_GET_STRUCT(CACHE, VALUETYPE, INDEXTYPE); \
+CACHE_FN_PEEK_STRUCT(CACHE, VALUETYPE, INDEXTYPE); \
+CACHE_FN_REMOVE_STRUCT(CACHE, INDEXTYPE); \
+CACHE_FN_CLEAR(CACHE); \
+CACHE_FN_RESERVE(CACHE); \
+CACHE_FN_SHRINK_TO_FIT(CACHE)
+
+#define IMPLEMENT_CACHE(CACHE, VALUETYPE, INDEXTYPE, FN_CPY_VAL, FN_CPY_IDX, FN_CMP_VAL, FN_CMP_IDX, FN_FREE_VAL, FN_FREE_IDX, FN_HASH_IDX) \
+IMPLEMENT_CACHE_FN_NEW(CACHE, VALUETYPE, INDEXTYPE, FN_CPY_VAL, FN_CPY_IDX, FN_CMP_VAL, FN_CMP_IDX, FN_FREE_VAL, FN_FREE_IDX, FN_HASH_IDX); \
+IMPLEMENT_CACHE_FN_FREE(CACHE); \
+IMPLEMENT_CACHE_FN_POLICY(CACHE, INDEXTYPE); \
+IMPLEMENT_CACHE_FN_ADD_STRUCT(CACHE, VALUETYPE, INDEXTYPE); \
+IMPLEMENT_CACHE_FN_GET_STRUCT(CACHE, VALUETYPE, INDEXTYPE); \
+IMPLEMENT_CACHE_FN_PEEK_STRUCT(CACHE, VALUETYPE, INDEXTYPE); \
+IMPLEMENT_CACHE_FN_REMOVE_STRUCT(CACHE, INDEXTYPE); \
+IMPLEMENT_CACHE_FN_CLEAR(CACHE); \
+IMPLEMENT_CACHE_FN_RESERVE(CACHE); \
+IMPLEMENT_CACHE_FN_SHRINK_TO_FIT(CACHE)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __CACHE_H__
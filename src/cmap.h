@@ -0,0 +1,569 @@
+/**
+ * @file cmap.h
+ * @brief Concurrent map container definition
+ * @details A concurrent map is a hash map split in shards. The hash of an
+ * index selects its shard, and every shard has its own reader-writer lock,
+ * so threads working on different shards never wait for each other and
+ * readers of a same shard run in parallel.
+ *
+ * Values never leave the map by pointer: CMAP_get copies the value out
+ * while the shard is locked, and CMAP_update_with runs a callback on the
+ * value while the shard is locked for writing.
+ *
+ * Every shard keeps the elements released by CMAP_clear or allocated by
+ * CMAP_reserve for its next insertions, until CMAP_shrink_to_fit.
+ * @author Baudouin FEILDEL
+ */
+#ifndef __CMAP_H__
+#define __CMAP_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Number of shards used when CMAP_new is called with 0 */
+#ifndef CMAP_DEFAULT_SHARDS
+#define CMAP_DEFAULT_SHARDS 64
+#endif
+
+/** Average number of elements per bucket before a shard grows */
+#ifndef CMAP_MAX_LOAD
+#define CMAP_MAX_LOAD 1
+#endif
+
+// =============
+//  Definitions
+// =============
+#define NEW_CMAP_ELEM(CMAP, ElemTypename, Valuetype, Indextype) \
+/**
+ Element of a CMAP object
+ */ \
+typedef struct _ ## ElemTypename \
+{ \
+	Valuetype value; /**< Value of the element */\
+	Indextype index; /**< Index of the element */\
+	uint64_t  hash;  /**< Hash of the index */\
+	struct _ ## ElemTypename * next; /**< Pointer to the next element in the bucket */\
+} ElemTypename
+
+#define NEW_CMAP_SHARD(CMAP, ShardTypename) \
+/**
+ Shard of a CMAP object
+ @details Aligned on a cache line so that two locks never share one.
+ */ \
+typedef struct _ ## ShardTypename \
+{ \
+	pthread_rwlock_t  lock;    /**< Lock of the shard */\
+	CMAP ## _elem_t ** buckets; /**< Buckets of the shard */\
+	int bucketCount;           /**< Number of buckets, a power of two */\
+	int size;                  /**< Number of elements in the shard */\
+	CMAP ## _elem_t * spare;   /**< Unused elements kept for reuse, linked by next */\
+	int spareCount;            /**< Number of elements in spare */\
+} __attribute__((aligned(64))) ShardTypename
+
+#define NEW_CMAP_TYPE(CMAP, Valuetype, Indextype) \
+NEW_CMAP_ELEM(CMAP, CMAP ## _elem_t, Valuetype, Indextype); \
+NEW_CMAP_SHARD(CMAP, CMAP ## _shard_t); \
+typedef struct CMAP \
+{ \
+	CMAP ## _shard_t * shards; /**< Array of shards */\
+	int    shardCount; /**< Number of shards, a power of two */\
+	size_t elemSize;   /**< Size of one element in the map */\
+	int    freeValue;  /**< Flag:<br>1: Automatically free the value<br>0: Do not automatically free the value */\
+	int    freeIndex;  /**< Flag:<br>1: Automatically free the index<br>0: Do not automatically free the index */\
+	void (*_copyValue)(Valuetype * dest, Valuetype * src); /**< Pointer to a function used to copy a value */\
+	void (*_copyIndex)(Indextype * dest, Indextype * src); /**< Pointer to a function used to copy an index */\
+	int (*_cmpValue)(Valuetype val1, Valuetype val2); /**< Pointer to a function used to compare two values */\
+	int (*_cmpIndex)(Indextype val1, Indextype val2); /**< Pointer to a function used to compare two indexes */\
+	void (*_freeValue)(Valuetype value); /**< Pointer to a function used to free a value */\
+	void (*_freeIndex)(Indextype index); /**< Pointer to a function used to free an index */\
+	uint64_t (*_hashIndex)(Indextype index); /**< Pointer to a function used to hash an index */\
+} CMAP
+
+#define CMAP_FN_NEW(CMAP) \
+/**
+ @brief Create a new CMAP object
+ @param shards Number of shards, rounded up to a power of two.
+ 0 to use CMAP_DEFAULT_SHARDS
+ @return A pointer to an allocated and initialized
+ CMAP object in memory
+ */ \
+CMAP * CMAP ## _new(int shards)
+
+#define CMAP_FN_FREE(CMAP) \
+/**
+ Destroy a CMAP object
+ @details No other thread may use the map anymore.
+ @param cmap A pointer to a CMAP object
+ */ \
+void CMAP ## _free(CMAP * cmap)
+
+#define CMAP_FN_ADD_STRUCT(CMAP, Valuetype, Indextype) \
+/**
+ Add an element to the map
+ @details If an element already have this index
+ its value will be updated.
+
+ @param cmap  The map to use
+ @param index The index of the element to add
+ @param value The value to set
+ @return      1 if the element was inserted. 0 if it was updated
+ */ \
+int CMAP ## _add(CMAP * cmap, Indextype index, Valuetype value)
+
+#define CMAP_FN_REMOVE_STRUCT(CMAP, Indextype) \
+/**
+ Remove an element from the map
+ @param cmap  A pointer to a valid CMAP object
+ @param index The index of the element to remove
+ @return      1 if the element was removed. 0 if it was not present
+ */ \
+int CMAP ## _remove(CMAP * cmap, Indextype index)
+
+#define CMAP_FN_GET_STRUCT(CMAP, Valuetype, Indextype) \
+/**
+ Get a copy of the value of an element
+ @details The value is copied with _copyValue while the shard is locked,
+ the caller owns the copy.
+
+ @param cmap  A pointer to a valid CMAP object
+ @param index The index of the element to get
+ @param value Receives a copy of the value. Can be NULL to only test presence
+ @return      1 if the element is present. 0 otherwise
+ */ \
+int CMAP ## _get(CMAP * cmap, Indextype index, Valuetype * value)
+
+#define CMAP_FN_UPDATE_WITH_STRUCT(CMAP, Valuetype, Indextype) \
+/**
+ Atomically read, modify and write an element
+ @details \c callback runs while the shard is locked for writing.
+ It receives a pointer to the value and a flag telling if the element
+ exists. When it does not, the callback may fill the value.
+ The callback returns 0 to remove (or not insert) the element and
+ any other value to keep (or insert) it.
+
+ @param cmap     A pointer to a valid CMAP object
+ @param index    The index of the element to update
+ @param callback Function called with the value, the existence flag and \c data
+ @param data     User data given to \c callback
+ @return         1 if the element is present after the update. 0 otherwise
+ */ \
+int CMAP ## _update_with(CMAP * cmap, Indextype index, int (*callback)(Valuetype * value, int exists, void * data), void * data)
+
+#define CMAP_FN_SIZE_STRUCT(CMAP) \
+/**
+ Count the elements of the map
+ @details Shards are locked one after the other, the result is
+ not a snapshot when other threads write at the same time.
+
+ @param cmap A pointer to a valid CMAP object
+ @return     Number of elements in the map
+ */ \
+int CMAP ## _size(CMAP * cmap)
+
+#define CMAP_FN_CLEAR(CMAP) \
+/**
+ Remove every element of the map
+ @details Shards are cleared one after the other. The buckets and the
+ elements are kept for the next insertions.
+ @param cmap A pointer to a valid CMAP object
+ */ \
+void CMAP ## _clear(CMAP * cmap)
+
+#define CMAP_FN_RESERVE(CMAP) \
+/**
+ Size every shard for its part of n elements
+ @details Elements are spread by their hash, so a shard receiving more
+ than its part may still allocate.
+ @param cmap A pointer to a valid CMAP object
+ @param n    Number of elements to hold
+ */ \
+void CMAP ## _reserve(CMAP * cmap, int n)
+
+#define CMAP_FN_SHRINK_TO_FIT(CMAP) \
+/**
+ Release the unused elements and shrink every shard to its size
+ @param cmap A pointer to a valid CMAP object
+ */ \
+void CMAP ## _shrink_to_fit(CMAP * cmap)
+
+// =================
+//  Implementations
+// =================
+#define IMPLEMENT_CMAP_FN_NEW(CMAP, Valuetype, Indextype, FN_CPY_VAL, FN_CPY_IDX, FN_CMP_VAL, FN_CMP_IDX, FN_FREE_VAL, FN_FREE_IDX, FN_HASH_IDX) \
+CMAP * CMAP ## _new(int shards) \
+{ \
+	CMAP * cmap = NULL; \
+	void * memory = NULL; \
+	int i = 0, count = 1; \
+	if(shards <= 0) shards = CMAP_DEFAULT_SHARDS; \
+	while(count < shards) \
+		count *= 2; \
+	if(posix_memalign(&memory, 64, sizeof(CMAP ## _shard_t) * count) != 0) \
+		return NULL; \
+	cmap = malloc(sizeof(CMAP)); \
+	cmap->shards     = memory; \
+	cmap->shardCount = count; \
+	for(i = 0 ; i < count ; i++) \
+	{ \
+		pthread_rwlock_init(&(cmap->shards[i].lock), NULL); \
+		cmap->shards[i].bucketCount = 16; \
+		cmap->shards[i].buckets     = calloc(16, sizeof(CMAP ## _elem_t *)); \
+		cmap->shards[i].size        = 0; \
+		cmap->shards[i].spare       = NULL; \
+		cmap->shards[i].spareCount  = 0; \
+	} \
+	cmap->elemSize   = sizeof(CMAP ## _elem_t); \
+	cmap->freeValue  = 1; \
+	cmap->freeIndex  = 1; \
+	cmap->_copyValue = FN_CPY_VAL; \
+	cmap->_copyIndex = FN_CPY_IDX; \
+	cmap->_cmpValue  = FN_CMP_VAL; \
+	cmap->_cmpIndex  = FN_CMP_IDX; \
+	cmap->_freeValue = FN_FREE_VAL; \
+	cmap->_freeIndex = FN_FREE_IDX; \
+	cmap->_hashIndex = FN_HASH_IDX; \
+	return cmap; \
+}
+
+#define IMPLEMENT_CMAP_FN_FREE(CMAP) \
+void CMAP ## _free(CMAP * cmap) \
+{ \
+	CMAP ## _elem_t * it = NULL, * next = NULL; \
+	int s = 0, b = 0; \
+	if(cmap == NULL) return; \
+	for(s = 0 ; s < cmap->shardCount ; s++) \
+	{ \
+		for(b = 0 ; b < cmap->shards[s].bucketCount ; b++) \
+		{ \
+			for(it = cmap->shards[s].buckets[b] ; it != NULL ; it = next) \
+			{ \
+				next = it->next; \
+				if(cmap->freeValue) cmap->_freeValue(it->value); \
+				if(cmap->freeIndex) cmap->_freeIndex(it->index); \
+				free(it); \
+			} \
+		} \
+		for(it = cmap->shards[s].spare ; it != NULL ; it = next) \
+		{ \
+			next = it->next; \
+			free(it); \
+		} \
+		free(cmap->shards[s].buckets); \
+		pthread_rwlock_destroy(&(cmap->shards[s].lock)); \
+	} \
+	free(cmap->shards); \
+	free(cmap); \
+}
+
+/* Internal helpers, the shard must be locked by the caller */
+#define IMPLEMENT_CMAP_FN_SHARD(CMAP, Indextype) \
+static CMAP ## _shard_t * CMAP ## _shardOf(CMAP * cmap, uint64_t hash) \
+{ \
+	/* High bits select the shard, low bits select the bucket */\
+	return &(cmap->shards[(hash >> 40) & (uint64_t)(cmap->shardCount - 1)]); \
+} \
+static CMAP ## _elem_t ** CMAP ## _find(CMAP * cmap, CMAP ## _shard_t * shard, Indextype index, uint64_t hash) \
+{ \
+	CMAP ## _elem_t ** it = &(shard->buckets[hash & (uint64_t)(shard->bucketCount - 1)]); \
+	while(*it != NULL) \
+	{ \
+		if((*it)->hash == hash && cmap->_cmpIndex((*it)->index, index) == 0) \
+			return it; \
+		it = &((*it)->next); \
+	} \
+	return it; \
+} \
+static void CMAP ## _resize(CMAP ## _shard_t * shard, int count) \
+{ \
+	CMAP ## _elem_t ** buckets = NULL; \
+	CMAP ## _elem_t * it = NULL, * next = NULL; \
+	int b = 0; \
+	buckets = calloc(count, sizeof(CMAP ## _elem_t *)); \
+	for(b = 0 ; b < shard->bucketCount ; b++) \
+	{ \
+		for(it = shard->buckets[b] ; it != NULL ; it = next) \
+		{ \
+			next = it->next; \
+			it->next = buckets[it->hash & (uint64_t)(count - 1)]; \
+			buckets[it->hash & (uint64_t)(count - 1)] = it; \
+		} \
+	} \
+	free(shard->buckets); \
+	shard->buckets     = buckets; \
+	shard->bucketCount = count; \
+} \
+static void CMAP ## _insert(CMAP * cmap, CMAP ## _shard_t * shard, CMAP ## _elem_t ** slot, CMAP ## _elem_t * elem) \
+{ \
+	(void)(cmap); \
+	elem->next = NULL; \
+	*slot = elem; \
+	shard->size++; \
+	if(shard->size > shard->bucketCount * CMAP_MAX_LOAD) \
+		CMAP ## _resize(shard, shard->bucketCount * 2); \
+} \
+static CMAP ## _elem_t * CMAP ## _take(CMAP * cmap, CMAP ## _shard_t * shard) \
+{ \
+	CMAP ## _elem_t * elem = shard->spare; \
+	if(elem == NULL) \
+		return malloc(cmap->elemSize); \
+	shard->spare = elem->next; \
+	shard->spareCount--; \
+	return elem; \
+}
+
+#define IMPLEMENT_CMAP_FN_ADD_STRUCT(CMAP, Valuetype, Indextype) \
+int CMAP ## _add(CMAP * cmap, Indextype index, Valuetype value) \
+{ \
+	CMAP ## _shard_t * shard = NULL; \
+	CMAP ## _elem_t ** slot = NULL; \
+	CMAP ## _elem_t * elem = NULL; \
+	uint64_t hash = 0; \
+	/* Test if map is NULL */\
+	if(cmap == NULL) \
+		return 0; \
+	hash  = cmap->_hashIndex(index); \
+	shard = CMAP ## _shardOf(cmap, hash); \
+	pthread_rwlock_wrlock(&(shard->lock)); \
+	slot = CMAP ## _find(cmap, shard, index, hash); \
+	if(*slot != NULL) \
+	{ \
+		if(cmap->freeValue) cmap->_freeValue((*slot)->value); \
+		cmap->_copyValue(&((*slot)->value), &(value)); \
+		pthread_rwlock_unlock(&(shard->lock)); \
+		return 0; \
+	} \
+	/* Create the element, reusing a spare one */\
+	elem = CMAP ## _take(cmap, shard); \
+	elem->hash = hash; \
+	cmap->_copyIndex(&(elem->index), &(index)); \
+	cmap->_copyValue(&(elem->value), &(value)); \
+	CMAP ## _insert(cmap, shard, slot, elem); \
+	pthread_rwlock_unlock(&(shard->lock)); \
+	return 1; \
+}
+
+#define IMPLEMENT_CMAP_FN_REMOVE_STRUCT(CMAP, Indextype) \
+int CMAP ## _remove(CMAP * cmap, Indextype index) \
+{ \
+	CMAP ## _shard_t * shard = NULL; \
+	CMAP ## _elem_t ** slot = NULL; \
+	CMAP ## _elem_t * elem = NULL; \
+	uint64_t hash = 0; \
+	if(cmap == NULL) return 0; \
+	hash  = cmap->_hashIndex(index); \
+	shard = CMAP ## _shardOf(cmap, hash); \
+	pthread_rwlock_wrlock(&(shard->lock)); \
+	slot = CMAP ## _find(cmap, shard, index, hash); \
+	elem = *slot; \
+	if(elem != NULL) \
+	{ \
+		*slot = elem->next; \
+		shard->size--; \
+	} \
+	pthread_rwlock_unlock(&(shard->lock)); \
+	if(elem == NULL) \
+		return 0; \
+	/* Free outside of the lock */\
+	if(cmap->freeValue) cmap->_freeValue(elem->value); \
+	if(cmap->freeIndex) cmap->_freeIndex(elem->index); \
+	free(elem); \
+	return 1; \
+}
+
+#define IMPLEMENT_CMAP_FN_GET_STRUCT(CMAP, Valuetype, Indextype) \
+int CMAP ## _get(CMAP * cmap, Indextype index, Valuetype * value) \
+{ \
+	CMAP ## _shard_t * shard = NULL; \
+	CMAP ## _elem_t * elem = NULL; \
+	uint64_t hash = 0; \
+	if(cmap == NULL) return 0; \
+	hash  = cmap->_hashIndex(index); \
+	shard = CMAP ## _shardOf(cmap, hash); \
+	pthread_rwlock_rdlock(&(shard->lock)); \
+	elem = *(CMAP ## _find(cmap, shard, index, hash)); \
+	if(elem != NULL && value != NULL) \
+		cmap->_copyValue(value, &(elem->value)); \
+	pthread_rwlock_unlock(&(shard->lock)); \
+	return elem != NULL; \
+}
+
+#define IMPLEMENT_CMAP_FN_UPDATE_WITH_STRUCT(CMAP, Valuetype, Indextype) \
+int CMAP ## _update_with(CMAP * cmap, Indextype index, int (*callback)(Valuetype * value, int exists, void * data), void * data) \
+{ \
+	CMAP ## _shard_t * shard = NULL; \
+	CMAP ## _elem_t ** slot = NULL; \
+	CMAP ## _elem_t * elem = NULL; \
+	uint64_t hash = 0; \
+	int keep = 0; \
+	if(cmap == NULL) return 0; \
+	hash  = cmap->_hashIndex(index); \
+	shard = CMAP ## _shardOf(cmap, hash); \
+	pthread_rwlock_wrlock(&(shard->lock)); \
+	slot = CMAP ## _find(cmap, shard, index, hash); \
+	if(*slot != NULL) \
+	{ \
+		keep = callback(&((*slot)->value), 1, data); \
+		if(!keep) \
+		{ \
+			elem  = *slot; \
+			*slot = elem->next; \
+			shard->size--; \
+		} \
+		pthread_rwlock_unlock(&(shard->lock)); \
+		if(elem != NULL) \
+		{ \
+			if(cmap->freeValue) cmap->_freeValue(elem->value); \
+			if(cmap->freeIndex) cmap->_freeIndex(elem->index); \
+			free(elem); \
+		} \
+		return keep != 0; \
+	} \
+	/* Let the callback create the value in place */\
+	elem = CMAP ## _take(cmap, shard); \
+	keep = callback(&(elem->value), 0, data); \
+	if(keep) \
+	{ \
+		elem->hash = hash; \
+		cmap->_copyIndex(&(elem->index), &(index)); \
+		CMAP ## _insert(cmap, shard, slot, elem); \
+	} \
+	else \
+	{ \
+		elem->next   = shard->spare; \
+		shard->spare = elem; \
+		shard->spareCount++; \
+	} \
+	pthread_rwlock_unlock(&(shard->lock)); \
+	return keep != 0; \
+}
+
+#define IMPLEMENT_CMAP_FN_SIZE_STRUCT(CMAP) \
+int CMAP ## _size(CMAP * cmap) \
+{ \
+	int s = 0, size = 0; \
+	if(cmap == NULL) return 0; \
+	for(s = 0 ; s < cmap->shardCount ; s++) \
+	{ \
+		pthread_rwlock_rdlock(&(cmap->shards[s].lock)); \
+		size += cmap->shards[s].size; \
+		pthread_rwlock_unlock(&(cmap->shards[s].lock)); \
+	} \
+	return size; \
+}
+
+#define IMPLEMENT_CMAP_FN_CLEAR(CMAP) \
+void CMAP ## _clear(CMAP * cmap) \
+{ \
+	CMAP ## _shard_t * shard = NULL; \
+	CMAP ## _elem_t * it = NULL, * next = NULL; \
+	int s = 0, b = 0; \
+	if(cmap == NULL) return; \
+	for(s = 0 ; s < cmap->shardCount ; s++) \
+	{ \
+		shard = &(cmap->shards[s]); \
+		pthread_rwlock_wrlock(&(shard->lock)); \
+		for(b = 0 ; b < shard->bucketCount ; b++) \
+		{ \
+			for(it = shard->buckets[b] ; it != NULL ; it = next) \
+			{ \
+				next = it->next; \
+				if(cmap->freeValue) cmap->_freeValue(it->value); \
+				if(cmap->freeIndex) cmap->_freeIndex(it->index); \
+				it->next     = shard->spare; \
+				shard->spare = it; \
+				shard->spareCount++; \
+			} \
+			shard->buckets[b] = NULL; \
+		} \
+		shard->size = 0; \
+		pthread_rwlock_unlock(&(shard->lock)); \
+	} \
+}
+
+#define IMPLEMENT_CMAP_FN_RESERVE(CMAP) \
+void CMAP ## _reserve(CMAP * cmap, int n) \
+{ \
+	CMAP ## _shard_t * shard = NULL; \
+	CMAP ## _elem_t * elem = NULL; \
+	int s = 0, count = 0, part = 0; \
+	if(cmap == NULL || n <= 0) return; \
+	part = (n + cmap->shardCount - 1) / cmap->shardCount; \
+	for(s = 0 ; s < cmap->shardCount ; s++) \
+	{ \
+		shard = &(cmap->shards[s]); \
+		pthread_rwlock_wrlock(&(shard->lock)); \
+		for(count = shard->bucketCount ; count * CMAP_MAX_LOAD < part ; count *= 2); \
+		if(count > shard->bucketCount) \
+			CMAP ## _resize(shard, count); \
+		while(shard->size + shard->spareCount < part && (elem = malloc(cmap->elemSize)) != NULL) \
+		{ \
+			elem->next   = shard->spare; \
+			shard->spare = elem; \
+			shard->spareCount++; \
+		} \
+		pthread_rwlock_unlock(&(shard->lock)); \
+	} \
+}
+
+#define IMPLEMENT_CMAP_FN_SHRINK_TO_FIT(CMAP) \
+void CMAP ## _shrink_to_fit(CMAP * cmap) \
+{ \
+	CMAP ## _shard_t * shard = NULL; \
+	CMAP ## _elem_t * it = NULL, * next = NULL; \
+	int s = 0, count = 0; \
+	if(cmap == NULL) return; \
+	for(s = 0 ; s < cmap->shardCount ; s++) \
+	{ \
+		shard = &(cmap->shards[s]); \
+		pthread_rwlock_wrlock(&(shard->lock)); \
+		for(it = shard->spare ; it != NULL ; it = next) \
+		{ \
+			next = it->next; \
+			free(it); \
+		} \
+		shard->spare      = NULL; \
+		shard->spareCount = 0; \
+		for(count = 16 ; count * CMAP_MAX_LOAD < shard->size ; count *= 2); \
+		if(count < shard->bucketCount) \
+			CMAP ## _resize(shard, count); \
+		pthread_rwlock_unlock(&(shard->lock)); \
+	} \
+}
+
+// MACRO HELPERS (One line definitions && implementations)
+#define NEW_CMAP_DEFINITION(CMAP, VALUETYPE, INDEXTYPE) \
+NEW_CMAP_TYPE(CMAP, VALUETYPE, INDEXTYPE); \
+CMAP_FN_NEW(CMAP); \
+CMAP_FN_FREE(CMAP); \
+CMAP_FN_ADD_STRUCT(CMAP, VALUETYPE, INDEXTYPE); \
+CMAP_FN_REMOVE_STRUCT(CMAP, INDEXTYPE); \
+CMAP_FN_GET_STRUCT(CMAP, VALUETYPE, INDEXTYPE); \
+CMAP_FN_UPDATE_WITH_STRUCT(CMAP, VALUETYPE, INDEXTYPE); \
+CMAP_FN_SIZE_STRUCT(CMAP); \
+CMAP_FN_CLEAR(CMAP); \
+CMAP_FN_RESERVE(CMAP); \
+CMAP_FN_SHRINK_TO_FIT(CMAP)
+
+#define IMPLEMENT_CMAP(CMAP, VALUETYPE, INDEXTYPE, FN_CPY_VAL, FN_CPY_IDX, FN_CMP_VAL, FN_CMP_IDX, FN_FREE_VAL, FN_FREE_IDX, FN_HASH_IDX) \
+IMPLEMENT_CMAP_FN_NEW(CMAP, VALUETYPE, INDEXTYPE, FN_CPY_VAL, FN_CPY_IDX, FN_CMP_VAL, FN_CMP_IDX, FN_FREE_VAL, FN_FREE_IDX, FN_HASH_IDX); \
+IMPLEMENT_CMAP_FN_FREE(CMAP); \
+IMPLEMENT_CMAP_FN_SHARD(CMAP, INDEXTYPE); \
+IMPLEMENT_CMAP_FN_ADD_STRUCT(CMAP, VALUETYPE, INDEXTYPE); \
+IMPLEMENT_CMAP_FN_REMOVE_STRUCT(CMAP, INDEXTYPE); \
+IMPLEMENT_CMAP_FN_GET_STRUCT(CMAP, VALUETYPE, INDEXTYPE); \
+IMPLEMENT_CMAP_FN_UPDATE_WITH_STRUCT(CMAP, VALUETYPE, INDEXTYPE); \
+IMPLEMENT_CMAP_FN_SIZE_STRUCT(CMAP); \
+IMPLEMENT_CMAP_FN_CLEAR(CMAP); \
+IMPLEMENT_CMAP_FN_RESERVE(CMAP); \
+IMPLEMENT_CMAP_FN_SHRINK_TO_FIT(CMAP)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __CMAP_H__
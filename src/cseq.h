@@ -0,0 +1,359 @@
+/**
+ * @file cseq.h
+ * @brief Compressed integer sequence container definition
+ * @details A queue of integers (event IDs, timestamps...) stored in blocks
+ * of CSEQ_BLOCK_BYTES bytes instead of one node per value. A block keeps
+ * its first value as is, then the difference of every value with the
+ * previous one, zigzag and varint encoded: 7 bits per byte, so a sorted
+ * stream with gaps under 128 costs one byte per value.
+ *
+ * Values are appended at the tail, read in order with _forEach and
+ * dequeued from the head; there is no random access.
+ * @author Baudouin FEILDEL
+ */
+#ifndef __CSEQ_H__
+#define __CSEQ_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Bytes of encoded differences per block */
+#ifndef CSEQ_BLOCK_BYTES
+#define CSEQ_BLOCK_BYTES 512
+#endif
+
+/* Write the zigzag varint of a difference, return its length (at most 10) */
+static inline int CSEQ_encode(unsigned char * out, uint64_t delta)
+{
+	uint64_t z = (delta << 1) ^ (uint64_t)((int64_t)delta >> 63);
+	int len = 0;
+	while(z >= 0x80)
+	{
+		out[len++] = (unsigned char)(z | 0x80);
+		z >>= 7;
+	}
+	out[len++] = (unsigned char)z;
+	return len;
+}
+
+/* Read a zigzag varint difference, return its length */
+static inline int CSEQ_decode(const unsigned char * in, uint64_t * delta)
+{
+	uint64_t z = 0;
+	int len = 0, shift = 0;
+	do
+	{
+		z |= (uint64_t)(in[len] & 0x7f) << shift;
+		shift += 7;
+	} while(in[len++] & 0x80);
+	*delta = (z >> 1) ^ (0 - (z & 1));
+	return len;
+}
+
+// =============
+//  Definitions
+// =============
+#define NEW_CSEQ_BLOCK(CSEQ, BlockTypename, Valuetype) \
+/**
+ Block of values of a CSEQ object
+ */ \
+typedef struct _ ## BlockTypename \
+{ \
+	struct _ ## BlockTypename * next; /**< Next block, towards the tail */\
+	Valuetype first; /**< First value left in the block */\
+	int       count; /**< Number of values left in the block, first included */\
+	int       start; /**< Offset of the difference of the second value */\
+	int       end;   /**< Offset after the last difference */\
+	unsigned char data[CSEQ_BLOCK_BYTES]; /**< Encoded differences */\
+} BlockTypename
+
+#define NEW_CSEQ_TYPE(CSEQ, Valuetype) \
+NEW_CSEQ_BLOCK(CSEQ, CSEQ ## _block_t, Valuetype); \
+typedef struct CSEQ \
+{ \
+	CSEQ ## _block_t * head;  /**< Block holding the head of the sequence */\
+	CSEQ ## _block_t * tail;  /**< Block holding the last value */\
+	Valuetype last;           /**< Last value appended */\
+	int    size;              /**< Number of values */\
+	int    blockCount;        /**< Number of blocks in use */\
+	CSEQ ## _block_t * spare; /**< Unused blocks kept for reuse */\
+	int    spareCount;        /**< Number of blocks in spare */\
+	size_t elemSize;          /**< Size of one value uncompressed */\
+} CSEQ
+
+#define CSEQ_FN_NEW(CSEQ) \
+/**
+ @brief Create a new CSEQ object
+ @return A pointer to an allocated and initialized
+ CSEQ object in memory
+ */ \
+CSEQ * CSEQ ## _new()
+
+#define CSEQ_FN_FREE(CSEQ) \
+/**
+ Destroy a CSEQ object
+ @param seq A pointer to a CSEQ object
+ */ \
+void CSEQ ## _free(CSEQ * seq)
+
+#define CSEQ_FN_APPEND(CSEQ, Valuetype) \
+/**
+ Add a value at the tail of the sequence
+ @details Values close to the previous one take less space: one byte
+ for a difference between -64 and 63.
+ @param seq   A pointer to a valid CSEQ object
+ @param value The value to add
+ @return      The size of the sequence
+ */ \
+int CSEQ ## _append(CSEQ * seq, Valuetype value)
+
+#define CSEQ_FN_DEQUEUE(CSEQ, Valuetype) \
+/**
+ Remove the value at the head of the sequence
+ @param seq A pointer to a valid CSEQ object
+ @return    The value at the head of the sequence. The default value if empty
+ */ \
+Valuetype CSEQ ## _dequeue(CSEQ * seq)
+
+#define CSEQ_FN_HEAD(CSEQ, Valuetype) \
+/**
+ Get the value at the head of the sequence
+ @param seq A pointer to a valid CSEQ object
+ @return    The value at the head of the sequence. The default value if empty
+ */ \
+Valuetype CSEQ ## _head(CSEQ * seq)
+
+#define CSEQ_FN_FOR_EACH(CSEQ, Valuetype) \
+/**
+ Call a function on every value, from head to tail
+ @param seq      A pointer to a valid CSEQ object
+ @param callback Function called with the value and \c data
+ @param data     User data given to \c callback
+ */ \
+void CSEQ ## _forEach(CSEQ * seq, void (*callback)(Valuetype value, void * data), void * data)
+
+#define CSEQ_FN_CLEAR(CSEQ) \
+/**
+ Remove every value of the sequence
+ @details The blocks are kept for the next insertions.
+ @param seq A pointer to a valid CSEQ object
+ */ \
+void CSEQ ## _clear(CSEQ * seq)
+
+#define CSEQ_FN_SHRINK_TO_FIT(CSEQ) \
+/**
+ Release the blocks kept for reuse
+ @param seq A pointer to a valid CSEQ object
+ */ \
+void CSEQ ## _shrink_to_fit(CSEQ * seq)
+
+#define CSEQ_FN_MEMORY(CSEQ) \
+/**
+ Memory used by the sequence
+ @param seq A pointer to a valid CSEQ object
+ @return    Bytes of the CSEQ object and of its blocks, spare ones included
+ */ \
+size_t CSEQ ## _memory(CSEQ * seq)
+
+#define CSEQ_FN_RATIO(CSEQ) \
+/**
+ Compression ratio of the sequence
+ @param seq A pointer to a valid CSEQ object
+ @return    Size of the values in an array (size * elemSize) divided
+ by the memory used by the sequence
+ */ \
+double CSEQ ## _ratio(CSEQ * seq)
+
+// =================
+//  Implementations
+// =================
+#define IMPLEMENT_CSEQ_FN_NEW(CSEQ, Valuetype) \
+CSEQ * CSEQ ## _new() \
+{ \
+	CSEQ * seq = calloc(1, sizeof(CSEQ)); \
+	seq->elemSize = sizeof(Valuetype); \
+	return seq; \
+}
+
+#define IMPLEMENT_CSEQ_FN_FREE(CSEQ) \
+void CSEQ ## _free(CSEQ * seq) \
+{ \
+	if(seq == NULL) return; \
+	CSEQ ## _clear(seq); \
+	CSEQ ## _shrink_to_fit(seq); \
+	free(seq); \
+}
+
+#define IMPLEMENT_CSEQ_FN_APPEND(CSEQ, Valuetype) \
+int CSEQ ## _append(CSEQ * seq, Valuetype value) \
+{ \
+	CSEQ ## _block_t * block = NULL; \
+	unsigned char buffer[10]; \
+	int len = 0; \
+	if(seq == NULL) return 0; \
+	if(seq->tail != NULL) \
+	{ \
+		len = CSEQ_encode(buffer, (uint64_t)(int64_t)value - (uint64_t)(int64_t)seq->last); \
+		if(seq->tail->end + len <= CSEQ_BLOCK_BYTES) \
+		{ \
+			memcpy(seq->tail->data + seq->tail->end, buffer, len); \
+			seq->tail->end += len; \
+			seq->tail->count++; \
+			seq->last = value; \
+			return ++seq->size; \
+		} \
+	} \
+	/* Start a new block with the value as is */\
+	if(seq->spare != NULL) \
+	{ \
+		block = seq->spare; \
+		seq->spare = block->next; \
+		seq->spareCount--; \
+	} \
+	else \
+		block = malloc(sizeof(CSEQ ## _block_t)); \
+	block->next  = NULL; \
+	block->first = value; \
+	block->count = 1; \
+	block->start = 0; \
+	block->end   = 0; \
+	if(seq->tail != NULL) seq->tail->next = block; \
+	else                  seq->head = block; \
+	seq->tail = block; \
+	seq->last = value; \
+	seq->blockCount++; \
+	return ++seq->size; \
+}
+
+#define IMPLEMENT_CSEQ_FN_DEQUEUE(CSEQ, Valuetype, DEFAULT_VALUE) \
+Valuetype CSEQ ## _dequeue(CSEQ * seq) \
+{ \
+	CSEQ ## _block_t * block = NULL; \
+	Valuetype value = DEFAULT_VALUE; \
+	uint64_t delta = 0; \
+	if(seq == NULL || seq->head == NULL) return value; \
+	block = seq->head; \
+	value = block->first; \
+	if(--block->count > 0) \
+	{ \
+		block->start += CSEQ_decode(block->data + block->start, &delta); \
+		block->first  = (Valuetype)((uint64_t)(int64_t)block->first + delta); \
+	} \
+	else \
+	{ \
+		seq->head = block->next; \
+		if(seq->head == NULL) seq->tail = NULL; \
+		block->next = seq->spare; \
+		seq->spare  = block; \
+		seq->spareCount++; \
+		seq->blockCount--; \
+	} \
+	seq->size--; \
+	return value; \
+}
+
+#define IMPLEMENT_CSEQ_FN_HEAD(CSEQ, Valuetype, DEFAULT_VALUE) \
+Valuetype CSEQ ## _head(CSEQ * seq) \
+{ \
+	if(seq == NULL || seq->head == NULL) return DEFAULT_VALUE; \
+	return seq->head->first; \
+}
+
+#define IMPLEMENT_CSEQ_FN_FOR_EACH(CSEQ, Valuetype) \
+void CSEQ ## _forEach(CSEQ * seq, void (*callback)(Valuetype value, void * data), void * data) \
+{ \
+	CSEQ ## _block_t * block = NULL; \
+	Valuetype value; \
+	uint64_t delta = 0; \
+	int i = 0, offset = 0; \
+	if(seq == NULL) return; \
+	for(block = seq->head ; block != NULL ; block = block->next) \
+	{ \
+		value  = block->first; \
+		offset = block->start; \
+		callback(value, data); \
+		for(i = 1 ; i < block->count ; i++) \
+		{ \
+			offset += CSEQ_decode(block->data + offset, &delta); \
+			value   = (Valuetype)((uint64_t)(int64_t)value + delta); \
+			callback(value, data); \
+		} \
+	} \
+}
+
+#define IMPLEMENT_CSEQ_FN_CLEAR(CSEQ) \
+void CSEQ ## _clear(CSEQ * seq) \
+{ \
+	if(seq == NULL || seq->head == NULL) return; \
+	seq->tail->next = seq->spare; \
+	seq->spare      = seq->head; \
+	seq->spareCount += seq->blockCount; \
+	seq->head       = NULL; \
+	seq->tail       = NULL; \
+	seq->blockCount = 0; \
+	seq->size       = 0; \
+}
+
+#define IMPLEMENT_CSEQ_FN_SHRINK_TO_FIT(CSEQ) \
+void CSEQ ## _shrink_to_fit(CSEQ * seq) \
+{ \
+	CSEQ ## _block_t * block = NULL; \
+	if(seq == NULL) return; \
+	while((block = seq->spare) != NULL) \
+	{ \
+		seq->spare = block->next; \
+		free(block); \
+	} \
+	seq->spareCount = 0; \
+}
+
+#define IMPLEMENT_CSEQ_FN_MEMORY(CSEQ) \
+size_t CSEQ ## _memory(CSEQ * seq) \
+{ \
+	if(seq == NULL) return 0; \
+	return sizeof(CSEQ) + (size_t)(seq->blockCount + seq->spareCount) * sizeof(CSEQ ## _block_t); \
+}
+
+#define IMPLEMENT_CSEQ_FN_RATIO(CSEQ) \
+double CSEQ ## _ratio(CSEQ * seq) \
+{ \
+	if(seq == NULL) return 0; \
+	return (double)seq->size * seq->elemSize / CSEQ ## _memory(seq); \
+}
+
+// MACRO HELPERS (One line definitions && implementations)
+#define NEW_CSEQ_DEFINITION(CSEQ, VALUETYPE) \
+NEW_CSEQ_TYPE(CSEQ, VALUETYPE); \
+CSEQ_FN_NEW(CSEQ); \
+CSEQ_FN_FREE(CSEQ); \
+CSEQ_FN_APPEND(CSEQ, VALUETYPE); \
+CSEQ_FN_DEQUEUE(CSEQ, VALUETYPE); \
+CSEQ_FN_HEAD(CSEQ, VALUETYPE); \
+CSEQ_FN_FOR_EACH(CSEQ, VALUETYPE); \
+CSEQ_FN_CLEAR(CSEQ); \
+CSEQ_FN_SHRINK_TO_FIT(CSEQ); \
+CSEQ_FN_MEMORY(CSEQ); \
+CSEQ_FN_RATIO(CSEQ)
+
+#define IMPLEMENT_CSEQ(CSEQ, VALUETYPE, DEFAULT_VALUE) \
+IMPLEMENT_CSEQ_FN_NEW(CSEQ, VALUETYPE); \
+IMPLEMENT_CSEQ_FN_FREE(CSEQ); \
+IMPLEMENT_CSEQ_FN_APPEND(CSEQ, VALUETYPE); \
+IMPLEMENT_CSEQ_FN_DEQUEUE(CSEQ, VALUETYPE, DEFAULT_VALUE); \
+IMPLEMENT_CSEQ_FN_HEAD(CSEQ, VALUETYPE, DEFAULT_VALUE); \
+IMPLEMENT_CSEQ_FN_FOR_EACH(CSEQ, VALUETYPE); \
+IMPLEMENT_CSEQ_FN_CLEAR(CSEQ); \
+IMPLEMENT_CSEQ_FN_SHRINK_TO_FIT(CSEQ); \
+IMPLEMENT_CSEQ_FN_MEMORY(CSEQ); \
+IMPLEMENT_CSEQ_FN_RATIO(CSEQ)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __CSEQ_H__
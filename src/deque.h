@@ -0,0 +1,497 @@
+/**
+ * @file deque.h
+ * @brief Double ended queue container definition
+ * @details A deque stores its values in fixed-size blocks, referenced by a
+ * circular map of block pointers. Pushing or popping at both ends is O(1),
+ * accessing the n-th element is O(1), and elements never move in memory
+ * while they are in the deque.
+ *
+ * Blocks emptied by a pop are kept aside and reused by the next pushes, so
+ * a deque used as a FIFO or a LIFO of bounded size stops allocating once
+ * it has reached its working size. DEQUE_reserve allocates the blocks up
+ * front, DEQUE_shrink_to_fit releases the blocks kept aside.
+ * @author Baudouin FEILDEL
+ */
+#ifndef __DEQUE_H__
+#define __DEQUE_H__
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Target size of a block in bytes. A block holds at least 16 values */
+#ifndef DEQUE_BLOCK_BYTES
+#define DEQUE_BLOCK_BYTES 4096
+#endif
+
+/** Maximum number of empty blocks kept for reuse, unless reserved */
+#ifndef DEQUE_SPARE_BLOCKS
+#define DEQUE_SPARE_BLOCKS 4
+#endif
+
+// =============
+//  Definitions
+// =============
+#define NEW_DEQUE_TYPE(DEQUE, ValueType) \
+typedef struct DEQUE \
+{ \
+	ValueType ** map;        /**< Circular array of block pointers */\
+	int    mapCapacity;      /**< Number of slots in map, a power of 2 */\
+	int    firstBlock;       /**< Slot in map of the first block */\
+	int    blockCount;       /**< Number of blocks in use */\
+	int    offset;           /**< Position of the first value in the first block */\
+	int    blockShift;       /**< A block holds (1 << blockShift) values */\
+	ValueType ** spare;      /**< Empty blocks kept for reuse */\
+	int    spareCount;       /**< Number of blocks in spare */\
+	int    spareMax;         /**< Number of slots in spare */\
+	int    size;             /**< Deque size */\
+	size_t elemSize;         /**< Size of one element in the deque */\
+	int    freeValue;        /**< Flag:<br>1: Automatically free the value<br>0: Do not automatically free the value */\
+	void (*_copyValue) (ValueType * dest, ValueType * src); /**< Pointer to a function used to copy a value */\
+	int  (*_cmpValue)  (ValueType val1, ValueType val2);    /**< Pointer to a function used to compare two values */\
+	void (*_freeValue) (ValueType value);                   /**< Pointer to a function used to free a value */\
+	void (*_print)     (ValueType value);                   /**< Pointer to a function used to print a value */\
+} DEQUE
+
+#define DEQUE_FN_NEW(DEQUE) \
+/**
+ @brief Create a new DEQUE object
+ @return A pointer to an allocated and initialized
+ DEQUE object in memory
+ */ \
+DEQUE * DEQUE ## _new()
+
+#define DEQUE_FN_FREE(DEQUE) \
+/**
+ Destroy a DEQUE object
+ @param deque A pointer to a DEQUE object
+ */ \
+void DEQUE ## _free(DEQUE * deque)
+
+#define DEQUE_FN_PUSH_BACK_STRUCT(DEQUE, ValueType) \
+/**
+ Add a value at the end of the deque
+ @param deque A pointer to a valid DEQUE object
+ @param value The value to add
+ @return      A pointer to the stored value, valid until it is popped. NULL on error
+ */ \
+ValueType * DEQUE ## _pushBack(DEQUE * deque, ValueType value)
+
+#define DEQUE_FN_PUSH_FRONT_STRUCT(DEQUE, ValueType) \
+/**
+ Add a value at the beginning of the deque
+ @param deque A pointer to a valid DEQUE object
+ @param value The value to add
+ @return      A pointer to the stored value, valid until it is popped. NULL on error
+ */ \
+ValueType * DEQUE ## _pushFront(DEQUE * deque, ValueType value)
+
+#define DEQUE_FN_POP_BACK_STRUCT(DEQUE, ValueType) \
+/**
+ Remove the value at the end of the deque
+ @details The caller becomes the owner of the returned value.
+
+ @param deque A pointer to a valid DEQUE object
+ @return      The last value. The default value if empty
+ */ \
+ValueType DEQUE ## _popBack(DEQUE * deque)
+
+#define DEQUE_FN_POP_FRONT_STRUCT(DEQUE, ValueType) \
+/**
+ Remove the value at the beginning of the deque
+ @details The caller becomes the owner of the returned value.
+
+ @param deque A pointer to a valid DEQUE object
+ @return      The first value. The default value if empty
+ */ \
+ValueType DEQUE ## _popFront(DEQUE * deque)
+
+#define DEQUE_FN_FRONT_STRUCT(DEQUE, ValueType) \
+/**
+ Get the value at the beginning of the deque
+ @param deque A pointer to a valid DEQUE object
+ @return      The first value. The default value if empty
+ */ \
+ValueType DEQUE ## _front(DEQUE * deque)
+
+#define DEQUE_FN_BACK_STRUCT(DEQUE, ValueType) \
+/**
+ Get the value at the end of the deque
+ @param deque A pointer to a valid DEQUE object
+ @return      The last value. The default value if empty
+ */ \
+ValueType DEQUE ## _back(DEQUE * deque)
+
+#define DEQUE_FN_AT_STRUCT(DEQUE, ValueType) \
+/**
+ Get a value from its position in O(1)
+ @param deque    A pointer to a valid DEQUE object
+ @param position Position of the value, 0 is the front
+ @return         A pointer to the value. NULL if position is out of range
+ */ \
+ValueType * DEQUE ## _at(DEQUE * deque, int position)
+
+#define DEQUE_FN_CLEAR(DEQUE) \
+/**
+ Remove every value of the deque
+ @details The blocks are kept for the next pushes.
+ @param deque A pointer to a valid DEQUE object
+ */ \
+void DEQUE ## _clear(DEQUE * deque)
+
+#define DEQUE_FN_RESERVE(DEQUE) \
+/**
+ Allocate the blocks needed to hold n values
+ @details The deque then holds n values, pushed at either end, without
+ allocating. Reserved blocks are kept when emptied.
+ @param deque A pointer to a valid DEQUE object
+ @param n     Number of values to hold
+ */ \
+void DEQUE ## _reserve(DEQUE * deque, int n)
+
+#define DEQUE_FN_SHRINK_TO_FIT(DEQUE) \
+/**
+ Release the empty blocks and the unused slots of the block map
+ @param deque A pointer to a valid DEQUE object
+ */ \
+void DEQUE ## _shrink_to_fit(DEQUE * deque)
+
+#define DEQUE_FN_PRINT_STRUCT(DEQUE) \
+/**
+ Print a deque
+ @param deque A pointer to a valid DEQUE object
+ */ \
+void DEQUE ## _print(DEQUE * deque)
+
+// =================
+//  Implementations
+// =================
+#define IMPLEMENT_DEQUE_FN_NEW(DEQUE, Valuetype, FN_CPY_VAL, FN_CMP_VAL, FN_FREE_VAL, FN_PRINT_VAL) \
+DEQUE * DEQUE ## _new() \
+{ \
+	DEQUE * deque = malloc(sizeof(DEQUE)); \
+	deque->map         = NULL; \
+	deque->mapCapacity = 0; \
+	deque->firstBlock  = 0; \
+	deque->blockCount  = 0; \
+	deque->offset      = 0; \
+	deque->spare       = NULL; \
+	deque->spareCount  = 0; \
+	deque->spareMax    = 0; \
+	deque->size        = 0; \
+	/* Largest power of 2 values fitting in DEQUE_BLOCK_BYTES, at least 16 */\
+	deque->blockShift  = 4; \
+	while(((size_t)2 << deque->blockShift) * sizeof(Valuetype) <= DEQUE_BLOCK_BYTES) \
+		deque->blockShift++; \
+	deque->elemSize   = sizeof(Valuetype); \
+	deque->freeValue  = 1; \
+	deque->_copyValue = FN_CPY_VAL; \
+	deque->_cmpValue  = FN_CMP_VAL; \
+	deque->_freeValue = FN_FREE_VAL; \
+	deque->_print     = FN_PRINT_VAL; \
+	return deque; \
+}
+
+#define IMPLEMENT_DEQUE_FN_FREE(DEQUE) \
+void DEQUE ## _free(DEQUE * deque) \
+{ \
+	int i = 0; \
+	if(deque == NULL) return; \
+	if(deque->freeValue) \
+		for(i = 0 ; i < deque->size ; i++) \
+			deque->_freeValue(*DEQUE ## _at(deque, i)); \
+	for(i = 0 ; i < deque->blockCount ; i++) \
+		free(deque->map[(deque->firstBlock + i) & (deque->mapCapacity - 1)]); \
+	for(i = 0 ; i < deque->spareCount ; i++) \
+		free(deque->spare[i]); \
+	free(deque->spare); \
+	free(deque->map); \
+	free(deque); \
+}
+
+/* Internal helpers: resize the map, resize spare, get an empty block, release an empty block */
+#define IMPLEMENT_DEQUE_FN_BLOCKS(DEQUE, Valuetype) \
+static int DEQUE ## _resizeMap(DEQUE * deque, int capacity) \
+{ \
+	Valuetype ** map = NULL; \
+	int i = 0; \
+	/* Unroll the circular order */\
+	if(capacity > 0 && (map = malloc(sizeof(Valuetype *) * capacity)) == NULL) \
+		return 0; \
+	for(i = 0 ; i < deque->blockCount ; i++) \
+		map[i] = deque->map[(deque->firstBlock + i) & (deque->mapCapacity - 1)]; \
+	free(deque->map); \
+	deque->map         = map; \
+	deque->mapCapacity = capacity; \
+	deque->firstBlock  = 0; \
+	return 1; \
+} \
+static int DEQUE ## _resizeSpare(DEQUE * deque, int capacity) \
+{ \
+	Valuetype ** spare = NULL; \
+	if(capacity == 0) \
+	{ \
+		free(deque->spare); \
+		deque->spare = NULL; \
+	} \
+	else if((spare = realloc(deque->spare, sizeof(Valuetype *) * capacity)) == NULL) \
+		return 0; \
+	else \
+		deque->spare = spare; \
+	deque->spareMax = capacity; \
+	return 1; \
+} \
+static Valuetype * DEQUE ## _takeBlock(DEQUE * deque) \
+{ \
+	/* Grow the map when full */\
+	if(deque->blockCount == deque->mapCapacity \
+	   && !DEQUE ## _resizeMap(deque, deque->mapCapacity ? deque->mapCapacity * 2 : 8)) \
+		return NULL; \
+	if(deque->spareCount > 0) \
+		return deque->spare[--deque->spareCount]; \
+	return malloc(sizeof(Valuetype) << deque->blockShift); \
+} \
+static void DEQUE ## _releaseBlock(DEQUE * deque, Valuetype * block) \
+{ \
+	if(deque->spareCount == deque->spareMax && deque->spareMax < DEQUE_SPARE_BLOCKS) \
+		DEQUE ## _resizeSpare(deque, DEQUE_SPARE_BLOCKS); \
+	if(deque->spareCount < deque->spareMax) \
+		deque->spare[deque->spareCount++] = block; \
+	else \
+		free(block); \
+}
+
+#define IMPLEMENT_DEQUE_FN_PUSH_BACK_STRUCT(DEQUE, Valuetype) \
+Valuetype * DEQUE ## _pushBack(DEQUE * deque, Valuetype value) \
+{ \
+	Valuetype * block = NULL; \
+	Valuetype * slot  = NULL; \
+	int end = 0; \
+	if(deque == NULL) return NULL; \
+	end = deque->offset + deque->size; \
+	/* The last block is full: append a block */\
+	if(end == (deque->blockCount << deque->blockShift)) \
+	{ \
+		if((block = DEQUE ## _takeBlock(deque)) == NULL) \
+			return NULL; \
+		deque->map[(deque->firstBlock + deque->blockCount) & (deque->mapCapacity - 1)] = block; \
+		deque->blockCount++; \
+	} \
+	slot = deque->map[(deque->firstBlock + (end >> deque->blockShift)) & (deque->mapCapacity - 1)] \
+		+ (end & ((1 << deque->blockShift) - 1)); \
+	deque->_copyValue(slot, &value); \
+	deque->size++; \
+	return slot; \
+}
+
+#define IMPLEMENT_DEQUE_FN_PUSH_FRONT_STRUCT(DEQUE, Valuetype) \
+Valuetype * DEQUE ## _pushFront(DEQUE * deque, Valuetype value) \
+{ \
+	Valuetype * block = NULL; \
+	if(deque == NULL) return NULL; \
+	/* The first block is full: prepend a block */\
+	if(deque->offset == 0) \
+	{ \
+		if((block = DEQUE ## _takeBlock(deque)) == NULL) \
+			return NULL; \
+		deque->firstBlock = (deque->firstBlock - 1) & (deque->mapCapacity - 1); \
+		deque->map[deque->firstBlock] = block; \
+		deque->blockCount++; \
+		deque->offset = 1 << deque->blockShift; \
+	} \
+	deque->offset--; \
+	deque->size++; \
+	deque->_copyValue(deque->map[deque->firstBlock] + deque->offset, &value); \
+	return deque->map[deque->firstBlock] + deque->offset; \
+}
+
+#define IMPLEMENT_DEQUE_FN_POP_BACK_STRUCT(DEQUE, Valuetype, DEFAULT_VALUE) \
+Valuetype DEQUE ## _popBack(DEQUE * deque) \
+{ \
+	Valuetype value = DEFAULT_VALUE; \
+	int last = 0; \
+	if(deque == NULL || deque->size == 0) \
+		return DEFAULT_VALUE; \
+	value = *DEQUE ## _at(deque, deque->size - 1); \
+	deque->size--; \
+	/* Release the last block once empty */\
+	last = (deque->blockCount - 1) << deque->blockShift; \
+	if(deque->offset + deque->size <= last) \
+	{ \
+		deque->blockCount--; \
+		DEQUE ## _releaseBlock(deque, deque->map[(deque->firstBlock + deque->blockCount) & (deque->mapCapacity - 1)]); \
+	} \
+	if(deque->size == 0 && deque->blockCount == 0) \
+		deque->offset = 0; \
+	return value; \
+}
+
+#define IMPLEMENT_DEQUE_FN_POP_FRONT_STRUCT(DEQUE, Valuetype, DEFAULT_VALUE) \
+Valuetype DEQUE ## _popFront(DEQUE * deque) \
+{ \
+	Valuetype value = DEFAULT_VALUE; \
+	if(deque == NULL || deque->size == 0) \
+		return DEFAULT_VALUE; \
+	value = deque->map[deque->firstBlock][deque->offset]; \
+	deque->offset++; \
+	deque->size--; \
+	/* Release the first block once empty */\
+	if(deque->offset == (1 << deque->blockShift) || deque->size == 0) \
+	{ \
+		DEQUE ## _releaseBlock(deque, deque->map[deque->firstBlock]); \
+		deque->firstBlock = (deque->firstBlock + 1) & (deque->mapCapacity - 1); \
+		deque->blockCount--; \
+		deque->offset = 0; \
+	} \
+	return value; \
+}
+
+#define IMPLEMENT_DEQUE_FN_FRONT_STRUCT(DEQUE, Valuetype, DEFAULT_VALUE) \
+Valuetype DEQUE ## _front(DEQUE * deque) \
+{ \
+	if(deque == NULL || deque->size == 0) return DEFAULT_VALUE; \
+	return deque->map[deque->firstBlock][deque->offset]; \
+}
+
+#define IMPLEMENT_DEQUE_FN_BACK_STRUCT(DEQUE, Valuetype, DEFAULT_VALUE) \
+Valuetype DEQUE ## _back(DEQUE * deque) \
+{ \
+	if(deque == NULL || deque->size == 0) return DEFAULT_VALUE; \
+	return *DEQUE ## _at(deque, deque->size - 1); \
+}
+
+#define IMPLEMENT_DEQUE_FN_AT_STRUCT(DEQUE, Valuetype) \
+Valuetype * DEQUE ## _at(DEQUE * deque, int position) \
+{ \
+	if(deque == NULL || position < 0 || position >= deque->size) \
+		return NULL; \
+	position += deque->offset; \
+	return deque->map[(deque->firstBlock + (position >> deque->blockShift)) & (deque->mapCapacity - 1)] \
+		+ (position & ((1 << deque->blockShift) - 1)); \
+}
+
+#define IMPLEMENT_DEQUE_FN_CLEAR(DEQUE) \
+void DEQUE ## _clear(DEQUE * deque) \
+{ \
+	int i = 0; \
+	if(deque == NULL) return; \
+	if(deque->freeValue) \
+		for(i = 0 ; i < deque->size ; i++) \
+			deque->_freeValue(*DEQUE ## _at(deque, i)); \
+	/* Keep every block, even above DEQUE_SPARE_BLOCKS */\
+	if(deque->spareCount + deque->blockCount > deque->spareMax \
+	   && !DEQUE ## _resizeSpare(deque, deque->spareCount + deque->blockCount)) \
+	{ \
+		for(i = 0 ; i < deque->blockCount ; i++) \
+			free(deque->map[(deque->firstBlock + i) & (deque->mapCapacity - 1)]); \
+	} \
+	else \
+	{ \
+		for(i = 0 ; i < deque->blockCount ; i++) \
+			deque->spare[deque->spareCount++] = deque->map[(deque->firstBlock + i) & (deque->mapCapacity - 1)]; \
+	} \
+	deque->firstBlock = 0; \
+	deque->blockCount = 0; \
+	deque->offset     = 0; \
+	deque->size       = 0; \
+}
+
+#define IMPLEMENT_DEQUE_FN_RESERVE(DEQUE, Valuetype) \
+void DEQUE ## _reserve(DEQUE * deque, int n) \
+{ \
+	Valuetype * block = NULL; \
+	int blocks = 0, capacity = 0; \
+	if(deque == NULL || n <= 0) return; \
+	/* The values may straddle one more block than n needs */\
+	blocks = ((n - 1) >> deque->blockShift) + 2; \
+	for(capacity = deque->mapCapacity ? deque->mapCapacity : 8 ; capacity < blocks ; capacity *= 2); \
+	if(capacity > deque->mapCapacity && !DEQUE ## _resizeMap(deque, capacity)) \
+		return; \
+	if(blocks - deque->blockCount > deque->spareMax \
+	   && !DEQUE ## _resizeSpare(deque, blocks - deque->blockCount)) \
+		return; \
+	while(deque->blockCount + deque->spareCount < blocks) \
+	{ \
+		if((block = malloc(sizeof(Valuetype) << deque->blockShift)) == NULL) \
+			return; \
+		deque->spare[deque->spareCount++] = block; \
+	} \
+}
+
+#define IMPLEMENT_DEQUE_FN_SHRINK_TO_FIT(DEQUE) \
+void DEQUE ## _shrink_to_fit(DEQUE * deque) \
+{ \
+	int capacity = 0; \
+	if(deque == NULL) return; \
+	while(deque->spareCount > 0) \
+		free(deque->spare[--deque->spareCount]); \
+	DEQUE ## _resizeSpare(deque, 0); \
+	if(deque->blockCount > 0) \
+		for(capacity = 8 ; capacity < deque->blockCount ; capacity *= 2); \
+	if(capacity < deque->mapCapacity) \
+		DEQUE ## _resizeMap(deque, capacity); \
+}
+
+#ifdef CCONTAINERS_DISABLE_PRINT
+#define IMPLEMENT_DEQUE_FN_PRINT(DEQUE) \
+void DEQUE ## _print(DEQUE * deque) \
+{ \
+	(void)(deque); \
+}
+#else
+#define IMPLEMENT_DEQUE_FN_PRINT(DEQUE) \
+void DEQUE ## _print(DEQUE * deque) \
+{ \
+	int i = 0; \
+	printf("["); \
+	for(i = 0 ; i < deque->size ; i++) \
+	{ \
+		deque->_print(*DEQUE ## _at(deque, i)); \
+		if(i + 1 < deque->size) \
+			printf(", "); \
+	} \
+	printf("]\n"); \
+}
+#endif
+
+
+// MACRO HELPERS (One line definitions && implementations)
+#define NEW_DEQUE_DEFINITION(DEQUE, VALUETYPE) \
+NEW_DEQUE_TYPE(DEQUE, VALUETYPE); \
+DEQUE_FN_NEW(DEQUE); \
+DEQUE_FN_FREE(DEQUE); \
+DEQUE_FN_PUSH_BACK_STRUCT(DEQUE, VALUETYPE); \
+DEQUE_FN_PUSH_FRONT_STRUCT(DEQUE, VALUETYPE); \
+DEQUE_FN_POP_BACK_STRUCT(DEQUE, VALUETYPE); \
+DEQUE_FN_POP_FRONT_STRUCT(DEQUE, VALUETYPE); \
+DEQUE_FN_FRONT_STRUCT(DEQUE, VALUETYPE); \
+DEQUE_FN_BACK_STRUCT(DEQUE, VALUETYPE); \
+DEQUE_FN_AT_STRUCT(DEQUE, VALUETYPE); \
+DEQUE_FN_CLEAR(DEQUE); \
+DEQUE_FN_RESERVE(DEQUE); \
+DEQUE_FN_SHRINK_TO_FIT(DEQUE); \
+DEQUE_FN_PRINT_STRUCT(DEQUE)
+
+#define IMPLEMENT_DEQUE(DEQUE, VALUETYPE, FN_CPY_VAL, FN_CMP_VAL, FN_FREE_VAL, FN_PRINT_VAL, DEFAULT_VALUE) \
+IMPLEMENT_DEQUE_FN_NEW(DEQUE, VALUETYPE, FN_CPY_VAL, FN_CMP_VAL, FN_FREE_VAL, FN_PRINT_VAL); \
+IMPLEMENT_DEQUE_FN_FREE(DEQUE); \
+IMPLEMENT_DEQUE_FN_BLOCKS(DEQUE, VALUETYPE); \
+IMPLEMENT_DEQUE_FN_PUSH_BACK_STRUCT(DEQUE, VALUETYPE); \
+IMPLEMENT_DEQUE_FN_PUSH_FRONT_STRUCT(DEQUE, VALUETYPE); \
+IMPLEMENT_DEQUE_FN_POP_BACK_STRUCT(DEQUE, VALUETYPE, DEFAULT_VALUE); \
+IMPLEMENT_DEQUE_FN_POP_FRONT_STRUCT(DEQUE, VALUETYPE, DEFAULT_VALUE); \
+IMPLEMENT_DEQUE_FN_FRONT_STRUCT(DEQUE, VALUETYPE, DEFAULT_VALUE); \
+IMPLEMENT_DEQUE_FN_BACK_STRUCT(DEQUE, VALUETYPE, DEFAULT_VALUE); \
+IMPLEMENT_DEQUE_FN_AT_STRUCT(DEQUE, VALUETYPE); \
+IMPLEMENT_DEQUE_FN_CLEAR(DEQUE); \
+IMPLEMENT_DEQUE_FN_RESERVE(DEQUE, VALUETYPE); \
+IMPLEMENT_DEQUE_FN_SHRINK_TO_FIT(DEQUE); \
+IMPLEMENT_DEQUE_FN_PRINT(DEQUE)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __DEQUE_H__
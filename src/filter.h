@@ -0,0 +1,368 @@
+/**
+ * @file filter.h
+ * @brief Approximate membership filters
+ * @details A filter answers "maybe present" or "surely absent" for a
+ * hash, using a few bits per element. False positives happen at a low
+ * controlled rate, false negatives never happen.
+ *
+ * - BloomFilter is a blocked Bloom filter: every hash sets 8 bits in a
+ *   single 64-byte block (one bit per 64-bit word), so a lookup touches
+ *   one cache line and is checked with two AVX2 instructions when the
+ *   CPU supports them. Elements cannot be removed.
+ * - CuckooFilter stores a 16-bit fingerprint of every hash in one of two
+ *   buckets of 4 fingerprints (8 bytes). Elements can be removed.
+ *
+ * Both work on 64-bit hashes (see Int_hash and Str_hash in helpers.h).
+ * @author Baudouin FEILDEL
+ */
+#ifndef __C_CONTAINERS_FILTER_H__
+#define __C_CONTAINERS_FILTER_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "simd.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Bits per element used when BloomFilter_new is called with 0 (about 0.5% false positives) */
+#ifndef BLOOM_DEFAULT_BITS_PER_KEY
+#define BLOOM_DEFAULT_BITS_PER_KEY 12
+#endif
+
+/** Number of relocations tried before a cuckoo filter is declared full */
+#ifndef CUCKOO_MAX_KICKS
+#define CUCKOO_MAX_KICKS 500
+#endif
+
+// =================
+//  Bloom filter
+// =================
+/**
+ Blocked Bloom filter
+ */
+typedef struct BloomFilter
+{
+	uint64_t * blocks;     /**< blockCount blocks of 8 words, aligned on 64 bytes */
+	size_t     blockCount; /**< Number of 64-byte blocks */
+	size_t     size;       /**< Number of added hashes */
+	int (*_contains)(const uint64_t * block, uint32_t key); /**< Kernel selected for the running CPU */
+} BloomFilter;
+
+/* Odd multipliers giving the bit set in each word of a block */
+static const uint32_t BloomFilter_salts[8] = {
+	0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+	0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+};
+
+static inline int BloomFilter_contains_scalar(const uint64_t * block, uint32_t key)
+{
+	int i = 0;
+	for(i = 0 ; i < 8 ; i++)
+		if(!((block[i] >> ((key * BloomFilter_salts[i]) >> 26)) & 1))
+			return 0;
+	return 1;
+}
+
+#ifdef CCONTAINERS_SIMD_X86
+static inline __attribute__((target("avx2"))) int BloomFilter_contains_avx2(const uint64_t * block, uint32_t key)
+{
+	const __m256i salts = _mm256_loadu_si256((const __m256i *)BloomFilter_salts);
+	const __m256i one   = _mm256_set1_epi64x(1);
+	__m256i bits = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32((int)key), salts), 26);
+	__m256i low  = _mm256_sllv_epi64(one, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(bits)));
+	__m256i high = _mm256_sllv_epi64(one, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(bits, 1)));
+	/* testc: every bit of the mask is set in the block */
+	return _mm256_testc_si256(_mm256_load_si256((const __m256i *)block), low)
+	     & _mm256_testc_si256(_mm256_load_si256((const __m256i *)(block + 4)), high);
+}
+#endif
+
+/* The high half of the hash selects the block, the low half the bits */
+static inline uint64_t * BloomFilter_block(const BloomFilter * filter, uint64_t hash)
+{
+	return filter->blocks + (((hash >> 32) * filter->blockCount) >> 32) * 8;
+}
+
+/**
+ @brief Create a new BloomFilter object
+ @param expected   Expected number of elements
+ @param bitsPerKey Bits of memory per element. 0 to use BLOOM_DEFAULT_BITS_PER_KEY
+ @return A pointer to an allocated and initialized
+ BloomFilter object in memory. NULL on error
+ */
+static inline BloomFilter * BloomFilter_new(size_t expected, int bitsPerKey)
+{
+	BloomFilter * filter = NULL;
+	void * memory = NULL;
+	size_t blocks = 0;
+	if(bitsPerKey <= 0) bitsPerKey = BLOOM_DEFAULT_BITS_PER_KEY;
+	blocks = (expected * bitsPerKey + 511) / 512;
+	if(blocks == 0) blocks = 1;
+	if(blocks > 0xffffffffULL) return NULL;
+	if(posix_memalign(&memory, 64, blocks * 64) != 0)
+		return NULL;
+	memset(memory, 0, blocks * 64);
+	filter = malloc(sizeof(BloomFilter));
+	filter->blocks     = memory;
+	filter->blockCount = blocks;
+	filter->size       = 0;
+	filter->_contains  = BloomFilter_contains_scalar;
+#ifdef CCONTAINERS_SIMD_X86
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("avx2"))
+		filter->_contains = BloomFilter_contains_avx2;
+#endif
+	return filter;
+}
+
+/**
+ Destroy a BloomFilter object
+ @param filter A pointer to a BloomFilter object
+ */
+static inline void BloomFilter_free(BloomFilter * filter)
+{
+	if(filter == NULL) return;
+	free(filter->blocks);
+	free(filter);
+}
+
+/**
+ Add a hash to a Bloom filter
+ @param filter A pointer to a valid BloomFilter object
+ @param hash   The hash of the element
+ */
+static inline void BloomFilter_add(BloomFilter * filter, uint64_t hash)
+{
+	uint64_t * block = BloomFilter_block(filter, hash);
+	uint32_t key = (uint32_t)hash;
+	int i = 0;
+	for(i = 0 ; i < 8 ; i++)
+		block[i] |= 1ULL << ((key * BloomFilter_salts[i]) >> 26);
+	filter->size++;
+}
+
+/**
+ Test if a hash may have been added to a Bloom filter
+ @param filter A pointer to a valid BloomFilter object
+ @param hash   The hash of the element
+ @return       0 if the element is surely absent. 1 if it may be present
+ */
+static inline int BloomFilter_contains(const BloomFilter * filter, uint64_t hash)
+{
+	return filter->_contains(BloomFilter_block(filter, hash), (uint32_t)hash);
+}
+
+/**
+ Remove every hash from a Bloom filter
+ @param filter A pointer to a valid BloomFilter object
+ */
+static inline void BloomFilter_clear(BloomFilter * filter)
+{
+	memset(filter->blocks, 0, filter->blockCount * 64);
+	filter->size = 0;
+}
+
+// =================
+//  Cuckoo filter
+// =================
+/**
+ Cuckoo filter
+ */
+typedef struct CuckooFilter
+{
+	uint64_t * buckets;     /**< Buckets of 4 fingerprints of 16 bits, 0 marks an empty slot */
+	size_t     bucketCount; /**< Number of buckets, a power of two */
+	size_t     size;        /**< Number of stored fingerprints */
+	int        hasVictim;   /**< Flag:<br>1: The last insertion failed, its fingerprint is in victim<br>0: The filter is not full */
+	uint16_t   victim;      /**< Fingerprint that found no slot */
+	size_t     victimIndex; /**< Bucket of victim */
+	uint32_t   random;      /**< State of the generator choosing the slot to kick out */
+} CuckooFilter;
+
+#define CUCKOO_LANES 0x0001000100010001ULL
+
+/* The top 16 bits of the hash are the fingerprint, never 0 */
+static inline uint16_t CuckooFilter_fingerprint(uint64_t hash)
+{
+	uint16_t fingerprint = (uint16_t)(hash >> 48);
+	return fingerprint ? fingerprint : 1;
+}
+
+/* The alternate bucket only depends on the bucket and the fingerprint */
+static inline size_t CuckooFilter_alternate(const CuckooFilter * filter, size_t index, uint16_t fingerprint)
+{
+	return (index ^ ((size_t)fingerprint * 0x5bd1e995U)) & (filter->bucketCount - 1);
+}
+
+/* Non-zero if a 16-bit lane of bucket equals fingerprint: the lowest set bit is bit 15 of the first such lane */
+static inline uint64_t CuckooFilter_match(uint64_t bucket, uint16_t fingerprint)
+{
+	uint64_t x = bucket ^ (CUCKOO_LANES * fingerprint);
+	return (x - CUCKOO_LANES) & ~x & (CUCKOO_LANES << 15);
+}
+
+/* Store fingerprint in an empty slot of bucket index */
+static inline int CuckooFilter_put(CuckooFilter * filter, size_t index, uint16_t fingerprint)
+{
+	uint64_t empty = CuckooFilter_match(filter->buckets[index], 0);
+	if(empty == 0)
+		return 0;
+	filter->buckets[index] |= (uint64_t)fingerprint << (__builtin_ctzll(empty) - 15);
+	return 1;
+}
+
+/* Insert a fingerprint, relocating others. Keeps the homeless one in victim */
+static inline int CuckooFilter_insert(CuckooFilter * filter, size_t index, uint16_t fingerprint)
+{
+	uint16_t evicted = 0;
+	int kick = 0, slot = 0;
+	if(CuckooFilter_put(filter, index, fingerprint)) return 1;
+	index = CuckooFilter_alternate(filter, index, fingerprint);
+	for(kick = 0 ; kick < CUCKOO_MAX_KICKS ; kick++)
+	{
+		if(CuckooFilter_put(filter, index, fingerprint)) return 1;
+		/* Swap with a random slot, then move the evicted fingerprint */
+		filter->random = filter->random * 1103515245U + 12345U;
+		slot = (filter->random >> 16) & 3;
+		evicted = (uint16_t)(filter->buckets[index] >> (slot * 16));
+		filter->buckets[index] &= ~(0xffffULL << (slot * 16));
+		filter->buckets[index] |= (uint64_t)fingerprint << (slot * 16);
+		fingerprint = evicted;
+		index = CuckooFilter_alternate(filter, index, fingerprint);
+	}
+	filter->hasVictim   = 1;
+	filter->victim      = fingerprint;
+	filter->victimIndex = index;
+	return 0;
+}
+
+/**
+ @brief Create a new CuckooFilter object
+ @param capacity Maximum number of elements. The filter can be full a bit
+ earlier as the buckets are filled up to about 95%
+ @return A pointer to an allocated and initialized
+ CuckooFilter object in memory. NULL on error
+ */
+static inline CuckooFilter * CuckooFilter_new(size_t capacity)
+{
+	CuckooFilter * filter = malloc(sizeof(CuckooFilter));
+	size_t count = 1;
+	while(count * 4 * 95 / 100 < capacity)
+		count *= 2;
+	filter->buckets     = calloc(count, sizeof(uint64_t));
+	filter->bucketCount = count;
+	filter->size        = 0;
+	filter->hasVictim   = 0;
+	filter->victim      = 0;
+	filter->victimIndex = 0;
+	filter->random      = 0x2545f491U;
+	if(filter->buckets == NULL)
+	{
+		free(filter);
+		return NULL;
+	}
+	return filter;
+}
+
+/**
+ Destroy a CuckooFilter object
+ @param filter A pointer to a CuckooFilter object
+ */
+static inline void CuckooFilter_free(CuckooFilter * filter)
+{
+	if(filter == NULL) return;
+	free(filter->buckets);
+	free(filter);
+}
+
+/**
+ Add a hash to a cuckoo filter
+ @details Adding the same hash twice stores it twice:
+ it must then be removed twice.
+ @param filter A pointer to a valid CuckooFilter object
+ @param hash   The hash of the element
+ @return       1 on success. 0 if the filter is full: the hash is
+ still remembered, but the next additions will fail
+ */
+static inline int CuckooFilter_add(CuckooFilter * filter, uint64_t hash)
+{
+	if(filter->hasVictim) return 0;
+	filter->size++;
+	return CuckooFilter_insert(filter, hash & (filter->bucketCount - 1), CuckooFilter_fingerprint(hash));
+}
+
+/**
+ Test if a hash may be in a cuckoo filter
+ @param filter A pointer to a valid CuckooFilter object
+ @param hash   The hash of the element
+ @return       0 if the element is surely absent. 1 if it may be present
+ */
+static inline int CuckooFilter_contains(const CuckooFilter * filter, uint64_t hash)
+{
+	uint16_t fingerprint = CuckooFilter_fingerprint(hash);
+	size_t index     = hash & (filter->bucketCount - 1);
+	size_t alternate = CuckooFilter_alternate(filter, index, fingerprint);
+	if(CuckooFilter_match(filter->buckets[index], fingerprint)
+	|| CuckooFilter_match(filter->buckets[alternate], fingerprint))
+		return 1;
+	return filter->hasVictim && filter->victim == fingerprint
+		&& (filter->victimIndex == index || filter->victimIndex == alternate);
+}
+
+/**
+ Remove a hash from a cuckoo filter
+ @details Only remove hashes that were added, otherwise another
+ element sharing the fingerprint could be removed.
+ @param filter A pointer to a valid CuckooFilter object
+ @param hash   The hash of the element
+ @return       1 if the hash was removed. 0 if it was not found
+ */
+static inline int CuckooFilter_remove(CuckooFilter * filter, uint64_t hash)
+{
+	uint16_t fingerprint = CuckooFilter_fingerprint(hash);
+	size_t index     = hash & (filter->bucketCount - 1);
+	size_t alternate = CuckooFilter_alternate(filter, index, fingerprint);
+	uint64_t match = 0;
+	if(filter->hasVictim && filter->victim == fingerprint
+	&& (filter->victimIndex == index || filter->victimIndex == alternate))
+	{
+		filter->hasVictim = 0;
+		filter->size--;
+		return 1;
+	}
+	if((match = CuckooFilter_match(filter->buckets[index], fingerprint)) == 0)
+	{
+		index = alternate;
+		if((match = CuckooFilter_match(filter->buckets[index], fingerprint)) == 0)
+			return 0;
+	}
+	filter->buckets[index] &= ~(0xffffULL << (__builtin_ctzll(match) - 15));
+	filter->size--;
+	/* A slot is free again: give the victim another chance */
+	if(filter->hasVictim)
+	{
+		filter->hasVictim = 0;
+		CuckooFilter_insert(filter, filter->victimIndex, filter->victim);
+	}
+	return 1;
+}
+
+/**
+ Remove every hash from a cuckoo filter
+ @param filter A pointer to a valid CuckooFilter object
+ */
+static inline void CuckooFilter_clear(CuckooFilter * filter)
+{
+	memset(filter->buckets, 0, filter->bucketCount * sizeof(uint64_t));
+	filter->size      = 0;
+	filter->hasVictim = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __C_CONTAINERS_FILTER_H__
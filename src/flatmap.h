@@ -0,0 +1,532 @@
+/**
+ * @file flatmap.h
+ * @brief Flat map container definition
+ * @details A flat map keeps its indexes sorted in one contiguous array and
+ * its values in a second contiguous array (value[i] belongs to index[i]).
+ * Lookups are branchless binary searches over the index array, which is
+ * far more cache friendly than the linked chain used by map.h.
+ * Insertions are O(n), use FMAP_addBatch to insert many elements with a
+ * single sort and merge.
+ *
+ * For int, float and double values, IMPLEMENT_FLATMAP_PRIMITIVE searches
+ * the value array with the vectorized kernels of simd.h.
+ * @author Baudouin FEILDEL
+ */
+#ifndef __FLATMAP_H__
+#define __FLATMAP_H__
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "simd.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============
+//  Definitions
+// =============
+#define NEW_FLATMAP_TYPE(FMAP, Valuetype, Indextype) \
+typedef struct FMAP \
+{ \
+	Indextype * index; /**< Sorted array of indexes */\
+	Valuetype * value; /**< Array of values, value[i] belongs to index[i] */\
+	int    size;       /**< Number of elements in the map */\
+	int    capacity;   /**< Number of allocated slots in index and value arrays */\
+	int    freeValue;  /**< Flag:<br>1: Automatically free the value<br>0: Do not automatically free the value */\
+	int    freeIndex;  /**< Flag:<br>1: Automatically free the index<br>0: Do not automatically free the index */\
+	void (*_copyValue)(Valuetype * dest, Valuetype * src); /**< Pointer to a function used to copy a value */\
+	void (*_copyIndex)(Indextype * dest, Indextype * src); /**< Pointer to a function used to copy an index */\
+	int (*_cmpValue)(Valuetype val1, Valuetype val2); /**< Pointer to a function used to compare two values */\
+	int (*_cmpIndex)(Indextype val1, Indextype val2); /**< Pointer to a function used to order two indexes */\
+	void (*_freeValue)(Valuetype value); /**< Pointer to a function used to free a value */\
+	void (*_freeIndex)(Indextype index); /**< Pointer to a function used to free an index */\
+} FMAP
+
+#define FLATMAP_FN_NEW(FMAP) \
+/**
+ @brief Create a new FMAP object
+ @return A pointer to an allocated and initialized
+ FMAP object in memory
+ */ \
+FMAP * FMAP ## _new()
+
+#define FLATMAP_FN_FREE(FMAP) \
+/**
+ Destroy a FMAP object
+ @param fmap A pointer to a FMAP object
+ */ \
+void FMAP ## _free(FMAP * fmap)
+
+#define FLATMAP_FN_LOWER_BOUND(FMAP, Indextype) \
+/**
+ Find the position of the first index not lower than \c index
+ @details Branchless binary search: the loop always runs
+ log2(size) times and the compiler emits a conditional move
+ instead of a hard to predict branch.
+
+ @param fmap  A pointer to a valid FMAP object
+ @param index The index to look for
+ @return      A position in [0, size]
+ */ \
+int FMAP ## _lowerBound(FMAP * fmap, Indextype index)
+
+#define FLATMAP_FN_ADD_STRUCT(FMAP, Valuetype, Indextype) \
+/**
+ Add an element to the map, or replace the value of its index
+ @details Unlike MAP_add, which returns the element already having the
+ index unchanged, the old value is freed and replaced by a copy of
+ \c value (as FMAP_addBatch does).
+
+ @param fmap  The map to use
+ @param index The index of the element to add
+ @param value The value to set
+ @return      A pointer to the stored value, valid until the next
+              insertion or removal (which may move the values).
+              NULL if \c fmap is NULL
+ */ \
+Valuetype * FMAP ## _add(FMAP * fmap, Indextype index, Valuetype value)
+
+#define FLATMAP_FN_ADD_BATCH_STRUCT(FMAP, Valuetype, Indextype) \
+/**
+ Add several elements to the map at once
+ @details The batch is sorted once then merged with the map
+ in a single pass, which is O(n + m.log(m)) instead of O(n.m)
+ for m calls to FMAP_add. When the batch contains the same
+ index several times, the last value wins.
+
+ @param fmap    The map to use
+ @param indexes Array of \c count indexes
+ @param values  Array of \c count values
+ @param count   Number of elements in the batch
+ @return        The pointer to the FMAP object
+ */ \
+FMAP * FMAP ## _addBatch(FMAP * fmap, Indextype * indexes, Valuetype * values, int count)
+
+#define FLATMAP_FN_REMOVE_STRUCT(FMAP, Indextype) \
+/**
+ Remove an element from the map
+ @param fmap  A pointer to a valid FMAP object
+ @param index The index of the element to remove
+ @return      The pointer to the FMAP object
+ */ \
+FMAP * FMAP ## _remove(FMAP * fmap, Indextype index)
+
+#define FLATMAP_FN_GET_STRUCT(FMAP, Valuetype, Indextype) \
+/**
+ Get the value of an element from a FMAP
+ @param fmap  A pointer to a valid FMAP object
+ @param index The index of the element to get
+ @return      Pointer to the value if present. NULL otherwise
+ */ \
+Valuetype * FMAP ## _get(FMAP * fmap, Indextype index)
+
+#define FLATMAP_FN_SEARCH_STRUCT(FMAP, Valuetype) \
+/**
+ Search for a value in map
+ @param fmap   A pointer to a valid FMAP object
+ @param search The value to search in the map. Must be a valid ValueType object
+ @return       Pointer to the value if found. NULL otherwise
+ */ \
+Valuetype * FMAP ## _search(FMAP * fmap, Valuetype search)
+
+#define FLATMAP_FN_COUNT_STRUCT(FMAP, Valuetype) \
+/**
+ Count the elements having a value
+ @param fmap   A pointer to a valid FMAP object
+ @param search The value to count. Must be a valid ValueType object
+ @return       Number of elements whose value equals \c search
+ */ \
+int FMAP ## _count(FMAP * fmap, Valuetype search)
+
+#define FLATMAP_FN_FIND_ALL_STRUCT(FMAP, Valuetype) \
+/**
+ Find every element having a value, in one pass
+ @param fmap      A pointer to a valid FMAP object
+ @param search    The value to search. Must be a valid ValueType object
+ @param positions Output array, must be able to hold \c size positions
+ @return          Number of positions written in \c positions
+ */ \
+int FMAP ## _find_all(FMAP * fmap, Valuetype search, int * positions)
+
+#define FLATMAP_FN_CLEAR(FMAP) \
+/**
+ Remove every element of the map
+ @details The arrays are kept for the next insertions.
+ @param fmap A pointer to a valid FMAP object
+ */ \
+void FMAP ## _clear(FMAP * fmap)
+
+#define FLATMAP_FN_RESERVE(FMAP) \
+/**
+ Allocate room for n elements
+ @details The map then holds n elements without reallocating.
+ @param fmap A pointer to a valid FMAP object
+ @param n    Number of elements to hold
+ */ \
+void FMAP ## _reserve(FMAP * fmap, int n)
+
+#define FLATMAP_FN_SHRINK_TO_FIT(FMAP) \
+/**
+ Release the slots not used by the elements
+ @param fmap A pointer to a valid FMAP object
+ */ \
+void FMAP ## _shrink_to_fit(FMAP * fmap)
+
+// =================
+//  Implementations
+// =================
+#define IMPLEMENT_FLATMAP_FN_NEW(FMAP, Valuetype, Indextype, FN_CPY_VAL, FN_CPY_IDX, FN_CMP_VAL, FN_CMP_IDX, FN_FREE_VAL, FN_FREE_IDX) \
+FMAP * FMAP ## _new() \
+{ \
+	FMAP * fmap = malloc(sizeof(FMAP)); \
+	fmap->index    = NULL; \
+	fmap->value    = NULL; \
+	fmap->size     = 0; \
+	fmap->capacity = 0; \
+	fmap->freeValue  = 1; \
+	fmap->freeIndex  = 1; \
+	fmap->_copyValue = FN_CPY_VAL; \
+	fmap->_copyIndex = FN_CPY_IDX; \
+	fmap->_cmpValue  = FN_CMP_VAL; \
+	fmap->_cmpIndex  = FN_CMP_IDX; \
+	fmap->_freeValue = FN_FREE_VAL; \
+	fmap->_freeIndex = FN_FREE_IDX; \
+	return fmap; \
+}
+
+#define IMPLEMENT_FLATMAP_FN_FREE(FMAP) \
+void FMAP ## _free(FMAP * fmap) \
+{ \
+	int i = 0; \
+	if(fmap == NULL) return; \
+	for(i = 0 ; i < fmap->size ; i++) \
+	{ \
+		if(fmap->freeValue) fmap->_freeValue(fmap->value[i]); \
+		if(fmap->freeIndex) fmap->_freeIndex(fmap->index[i]); \
+	} \
+	free(fmap->index); \
+	free(fmap->value); \
+	free(fmap); \
+}
+
+#define IMPLEMENT_FLATMAP_FN_LOWER_BOUND(FMAP, Indextype) \
+int FMAP ## _lowerBound(FMAP * fmap, Indextype index) \
+{ \
+	Indextype * base = NULL; \
+	int n = 0, half = 0; \
+	if(fmap == NULL)     return 0; \
+	if(fmap->size == 0)  return 0; \
+	base = fmap->index; \
+	n    = fmap->size; \
+	while(n > 1) \
+	{ \
+		half = n / 2; \
+		base = (fmap->_cmpIndex(base[half], index) < 0) ? base + half : base; \
+		n   -= half; \
+	} \
+	return (int)(base - fmap->index) + (fmap->_cmpIndex(*base, index) < 0); \
+}
+
+#define IMPLEMENT_FLATMAP_FN_ADD_STRUCT(FMAP, Valuetype, Indextype) \
+Valuetype * FMAP ## _add(FMAP * fmap, Indextype index, Valuetype value) \
+{ \
+	int pos = 0; \
+	/* Test if map is NULL */\
+	if(fmap == NULL) \
+		return NULL; \
+	/* Test if index exists */\
+	pos = FMAP ## _lowerBound(fmap, index); \
+	if(pos < fmap->size && fmap->_cmpIndex(fmap->index[pos], index) == 0) \
+	{ \
+		if(fmap->freeValue) fmap->_freeValue(fmap->value[pos]); \
+		fmap->_copyValue(&(fmap->value[pos]), &(value)); \
+		return &(fmap->value[pos]); \
+	} \
+	/* Grow the arrays */\
+	if(fmap->size == fmap->capacity) \
+	{ \
+		fmap->capacity = (fmap->capacity == 0) ? 8 : fmap->capacity * 2; \
+		fmap->index = realloc(fmap->index, sizeof(Indextype) * fmap->capacity); \
+		fmap->value = realloc(fmap->value, sizeof(Valuetype) * fmap->capacity); \
+	} \
+	/* Insert the element */\
+	memmove(&(fmap->index[pos + 1]), &(fmap->index[pos]), sizeof(Indextype) * (fmap->size - pos)); \
+	memmove(&(fmap->value[pos + 1]), &(fmap->value[pos]), sizeof(Valuetype) * (fmap->size - pos)); \
+	fmap->_copyIndex(&(fmap->index[pos]), &(index)); \
+	fmap->_copyValue(&(fmap->value[pos]), &(value)); \
+	fmap->size++; \
+	return &(fmap->value[pos]); \
+}
+
+#define IMPLEMENT_FLATMAP_FN_ADD_BATCH_STRUCT(FMAP, Valuetype, Indextype) \
+FMAP * FMAP ## _addBatch(FMAP * fmap, Indextype * indexes, Valuetype * values, int count) \
+{ \
+	int * order = NULL, * tmp = NULL, * swap = NULL; \
+	int width = 0, lo = 0, mid = 0, hi = 0, a = 0, b = 0, k = 0; \
+	int i = 0, j = 0, c = 0; \
+	Indextype * newIndex = NULL; \
+	Valuetype * newValue = NULL; \
+	if(fmap == NULL) return NULL; \
+	if(count <= 0)   return fmap; \
+	/* Stable bottom-up merge sort of the batch positions */\
+	order = malloc(sizeof(int) * count); \
+	tmp   = malloc(sizeof(int) * count); \
+	for(i = 0 ; i < count ; i++) \
+		order[i] = i; \
+	for(width = 1 ; width < count ; width *= 2) \
+	{ \
+		for(lo = 0 ; lo < count ; lo += 2 * width) \
+		{ \
+			mid = (lo + width < count) ? lo + width : count; \
+			hi  = (lo + 2 * width < count) ? lo + 2 * width : count; \
+			a = lo; b = mid; k = lo; \
+			while(a < mid && b < hi) \
+			{ \
+				if(fmap->_cmpIndex(indexes[order[b]], indexes[order[a]]) < 0) \
+					tmp[k++] = order[b++]; \
+				else \
+					tmp[k++] = order[a++]; \
+			} \
+			while(a < mid) tmp[k++] = order[a++]; \
+			while(b < hi)  tmp[k++] = order[b++]; \
+		} \
+		swap = order; order = tmp; tmp = swap; \
+	} \
+	free(tmp); \
+	/* Merge the sorted batch with the map */\
+	newIndex = malloc(sizeof(Indextype) * (fmap->size + count)); \
+	newValue = malloc(sizeof(Valuetype) * (fmap->size + count)); \
+	i = 0; j = 0; k = 0; \
+	while(i < fmap->size || j < count) \
+	{ \
+		/* The last duplicate of the batch wins */\
+		while(j + 1 < count && fmap->_cmpIndex(indexes[order[j]], indexes[order[j + 1]]) == 0) \
+			j++; \
+		if(j >= count) \
+			c = -1; \
+		else if(i >= fmap->size) \
+			c = 1; \
+		else \
+			c = fmap->_cmpIndex(fmap->index[i], indexes[order[j]]); \
+		if(c < 0) \
+		{ \
+			newIndex[k] = fmap->index[i]; \
+			newValue[k] = fmap->value[i]; \
+			i++; \
+		} \
+		else if(c > 0) \
+		{ \
+			fmap->_copyIndex(&(newIndex[k]), &(indexes[order[j]])); \
+			fmap->_copyValue(&(newValue[k]), &(values[order[j]])); \
+			j++; \
+		} \
+		else \
+		{ \
+			newIndex[k] = fmap->index[i]; \
+			if(fmap->freeValue) fmap->_freeValue(fmap->value[i]); \
+			fmap->_copyValue(&(newValue[k]), &(values[order[j]])); \
+			i++; \
+			j++; \
+		} \
+		k++; \
+	} \
+	free(order); \
+	free(fmap->index); \
+	free(fmap->value); \
+	fmap->capacity = fmap->size + count; \
+	fmap->index    = newIndex; \
+	fmap->value    = newValue; \
+	fmap->size     = k; \
+	return fmap; \
+}
+
+#define IMPLEMENT_FLATMAP_FN_REMOVE_STRUCT(FMAP, Indextype) \
+FMAP * FMAP ## _remove(FMAP * fmap, Indextype index) \
+{ \
+	int pos = 0; \
+	if(fmap == NULL) return NULL; \
+	pos = FMAP ## _lowerBound(fmap, index); \
+	if(pos < fmap->size && fmap->_cmpIndex(fmap->index[pos], index) == 0) \
+	{ \
+		if(fmap->freeValue) fmap->_freeValue(fmap->value[pos]); \
+		if(fmap->freeIndex) fmap->_freeIndex(fmap->index[pos]); \
+		memmove(&(fmap->index[pos]), &(fmap->index[pos + 1]), sizeof(*(fmap->index)) * (fmap->size - pos - 1)); \
+		memmove(&(fmap->value[pos]), &(fmap->value[pos + 1]), sizeof(*(fmap->value)) * (fmap->size - pos - 1)); \
+		fmap->size--; \
+	} \
+	return fmap; \
+}
+
+#define IMPLEMENT_FLATMAP_FN_GET_STRUCT(FMAP, Valuetype, Indextype) \
+Valuetype * FMAP ## _get(FMAP * fmap, Indextype index) \
+{ \
+	int pos = 0; \
+	/* Check empty map */ \
+	if(fmap == NULL)     return NULL; \
+	if(fmap->size == 0)  return NULL; \
+	pos = FMAP ## _lowerBound(fmap, index); \
+	if(pos < fmap->size && fmap->_cmpIndex(fmap->index[pos], index) == 0) \
+		return &(fmap->value[pos]); \
+	return NULL; \
+}
+
+#define IMPLEMENT_FLATMAP_FN_SEARCH_STRUCT(FMAP, Valuetype) \
+Valuetype * FMAP ## _search(FMAP * fmap, Valuetype search) \
+{ \
+	int i = 0; \
+	/* Check empty map */ \
+	if(fmap == NULL) return NULL; \
+	for(i = 0 ; i < fmap->size ; i++) \
+	{ \
+		if(fmap->_cmpValue(fmap->value[i], search) == 0) \
+			return &(fmap->value[i]); \
+	} \
+	return NULL; \
+}
+
+#define IMPLEMENT_FLATMAP_FN_COUNT_STRUCT(FMAP, Valuetype) \
+int FMAP ## _count(FMAP * fmap, Valuetype search) \
+{ \
+	int i = 0, count = 0; \
+	if(fmap == NULL) return 0; \
+	for(i = 0 ; i < fmap->size ; i++) \
+		count += (fmap->_cmpValue(fmap->value[i], search) == 0); \
+	return count; \
+}
+
+#define IMPLEMENT_FLATMAP_FN_FIND_ALL_STRUCT(FMAP, Valuetype) \
+int FMAP ## _find_all(FMAP * fmap, Valuetype search, int * positions) \
+{ \
+	int i = 0, count = 0; \
+	if(fmap == NULL) return 0; \
+	for(i = 0 ; i < fmap->size ; i++) \
+	{ \
+		if(fmap->_cmpValue(fmap->value[i], search) == 0) \
+			positions[count++] = i; \
+	} \
+	return count; \
+}
+
+/* Vectorized versions, Prefix is Int, Float or Double (see simd.h) */
+#define IMPLEMENT_FLATMAP_FN_SEARCH_SIMD(FMAP, Valuetype, Prefix) \
+Valuetype * FMAP ## _search(FMAP * fmap, Valuetype search) \
+{ \
+	int pos = 0; \
+	if(fmap == NULL) return NULL; \
+	pos = Prefix ## _search(fmap->value, fmap->size, search); \
+	return (pos < 0) ? NULL : &(fmap->value[pos]); \
+}
+
+#define IMPLEMENT_FLATMAP_FN_COUNT_SIMD(FMAP, Valuetype, Prefix) \
+int FMAP ## _count(FMAP * fmap, Valuetype search) \
+{ \
+	if(fmap == NULL) return 0; \
+	return Prefix ## _count(fmap->value, fmap->size, search); \
+}
+
+#define IMPLEMENT_FLATMAP_FN_FIND_ALL_SIMD(FMAP, Valuetype, Prefix) \
+int FMAP ## _find_all(FMAP * fmap, Valuetype search, int * positions) \
+{ \
+	if(fmap == NULL) return 0; \
+	return Prefix ## _find_all(fmap->value, fmap->size, search, positions); \
+}
+
+#define IMPLEMENT_FLATMAP_FN_CLEAR(FMAP) \
+void FMAP ## _clear(FMAP * fmap) \
+{ \
+	int i = 0; \
+	if(fmap == NULL) return; \
+	for(i = 0 ; i < fmap->size ; i++) \
+	{ \
+		if(fmap->freeValue) fmap->_freeValue(fmap->value[i]); \
+		if(fmap->freeIndex) fmap->_freeIndex(fmap->index[i]); \
+	} \
+	fmap->size = 0; \
+}
+
+/* Reallocate the arrays to exactly 'capacity' slots */
+#define IMPLEMENT_FLATMAP_FN_RESERVE(FMAP) \
+static void FMAP ## _resize(FMAP * fmap, int capacity) \
+{ \
+	if(capacity == 0) \
+	{ \
+		free(fmap->index); \
+		free(fmap->value); \
+		fmap->index = NULL; \
+		fmap->value = NULL; \
+	} \
+	else \
+	{ \
+		fmap->index = realloc(fmap->index, sizeof(*(fmap->index)) * capacity); \
+		fmap->value = realloc(fmap->value, sizeof(*(fmap->value)) * capacity); \
+	} \
+	fmap->capacity = capacity; \
+} \
+void FMAP ## _reserve(FMAP * fmap, int n) \
+{ \
+	if(fmap == NULL || n <= fmap->capacity) return; \
+	FMAP ## _resize(fmap, n); \
+}
+
+#define IMPLEMENT_FLATMAP_FN_SHRINK_TO_FIT(FMAP) \
+void FMAP ## _shrink_to_fit(FMAP * fmap) \
+{ \
+	if(fmap == NULL || fmap->size == fmap->capacity) return; \
+	FMAP ## _resize(fmap, fmap->size); \
+}
+
+// MACRO HELPERS (One line definitions && implementations)
+#define NEW_FLATMAP_DEFINITION(FMAP, VALUETYPE, INDEXTYPE) \
+NEW_FLATMAP_TYPE(FMAP, VALUETYPE, INDEXTYPE); \
+FLATMAP_FN_NEW(FMAP); \
+FLATMAP_FN_FREE(FMAP); \
+FLATMAP_FN_LOWER_BOUND(FMAP, INDEXTYPE); \
+FLATMAP_FN_ADD_STRUCT(FMAP, VALUETYPE, INDEXTYPE); \
+FLATMAP_FN_ADD_BATCH_STRUCT(FMAP, VALUETYPE, INDEXTYPE); \
+FLATMAP_FN_REMOVE_STRUCT(FMAP, INDEXTYPE); \
+FLATMAP_FN_GET_STRUCT(FMAP, VALUETYPE, INDEXTYPE); \
+FLATMAP_FN_SEARCH_STRUCT(FMAP, VALUETYPE); \
+FLATMAP_FN_COUNT_STRUCT(FMAP, VALUETYPE); \
+FLATMAP_FN_FIND_ALL_STRUCT(FMAP, VALUETYPE); \
+FLATMAP_FN_CLEAR(FMAP); \
+FLATMAP_FN_RESERVE(FMAP); \
+FLATMAP_FN_SHRINK_TO_FIT(FMAP)
+
+#define IMPLEMENT_FLATMAP(FMAP, VALUETYPE, INDEXTYPE, FN_CPY_VAL, FN_CPY_IDX, FN_CMP_VAL, FN_CMP_IDX, FN_FREE_VAL, FN_FREE_IDX) \
+IMPLEMENT_FLATMAP_FN_NEW(FMAP, VALUETYPE, INDEXTYPE, FN_CPY_VAL, FN_CPY_IDX, FN_CMP_VAL, FN_CMP_IDX, FN_FREE_VAL, FN_FREE_IDX); \
+IMPLEMENT_FLATMAP_FN_FREE(FMAP); \
+IMPLEMENT_FLATMAP_FN_LOWER_BOUND(FMAP, INDEXTYPE); \
+IMPLEMENT_FLATMAP_FN_ADD_STRUCT(FMAP, VALUETYPE, INDEXTYPE); \
+IMPLEMENT_FLATMAP_FN_ADD_BATCH_STRUCT(FMAP, VALUETYPE, INDEXTYPE); \
+IMPLEMENT_FLATMAP_FN_REMOVE_STRUCT(FMAP, INDEXTYPE); \
+IMPLEMENT_FLATMAP_FN_GET_STRUCT(FMAP, VALUETYPE, INDEXTYPE); \
+IMPLEMENT_FLATMAP_FN_SEARCH_STRUCT(FMAP, VALUETYPE); \
+IMPLEMENT_FLATMAP_FN_COUNT_STRUCT(FMAP, VALUETYPE); \
+IMPLEMENT_FLATMAP_FN_FIND_ALL_STRUCT(FMAP, VALUETYPE); \
+IMPLEMENT_FLATMAP_FN_CLEAR(FMAP); \
+IMPLEMENT_FLATMAP_FN_RESERVE(FMAP); \
+IMPLEMENT_FLATMAP_FN_SHRINK_TO_FIT(FMAP)
+
+/* Flat map of int, float or double values (PREFIX is Int, Float or Double) */
+#define IMPLEMENT_FLATMAP_PRIMITIVE(FMAP, VALUETYPE, INDEXTYPE, PREFIX, FN_CPY_IDX, FN_CMP_IDX, FN_FREE_IDX) \
+IMPLEMENT_FLATMAP_FN_NEW(FMAP, VALUETYPE, INDEXTYPE, PREFIX ## _copy, FN_CPY_IDX, PREFIX ## _cmp, FN_CMP_IDX, PREFIX ## _free, FN_FREE_IDX); \
+IMPLEMENT_FLATMAP_FN_FREE(FMAP); \
+IMPLEMENT_FLATMAP_FN_LOWER_BOUND(FMAP, INDEXTYPE); \
+IMPLEMENT_FLATMAP_FN_ADD_STRUCT(FMAP, VALUETYPE, INDEXTYPE); \
+IMPLEMENT_FLATMAP_FN_ADD_BATCH_STRUCT(FMAP, VALUETYPE, INDEXTYPE); \
+IMPLEMENT_FLATMAP_FN_REMOVE_STRUCT(FMAP, INDEXTYPE); \
+IMPLEMENT_FLATMAP_FN_GET_STRUCT(FMAP, VALUETYPE, INDEXTYPE); \
+IMPLEMENT_FLATMAP_FN_SEARCH_SIMD(FMAP, VALUETYPE, PREFIX); \
+IMPLEMENT_FLATMAP_FN_COUNT_SIMD(FMAP, VALUETYPE, PREFIX); \
+IMPLEMENT_FLATMAP_FN_FIND_ALL_SIMD(FMAP, VALUETYPE, PREFIX); \
+IMPLEMENT_FLATMAP_FN_CLEAR(FMAP); \
+IMPLEMENT_FLATMAP_FN_RESERVE(FMAP); \
+IMPLEMENT_FLATMAP_FN_SHRINK_TO_FIT(FMAP)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __FLATMAP_H__
@@ -9,6 +9,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -16,33 +17,47 @@ extern "C" {
 
 /**
  * Compare two integers
+ * @details Branchless and without overflow (n1 - n2 overflows
+ * for INT_MIN and INT_MAX).
  * @param n1 First integer
  * @param n2 Second integer
  * @return   0 if n1 == n2. <br>
- * A value > 0 if n1 > n2.  <br>
- * A value < 0 if n1 < n2.  <br>
+ * 1 if n1 > n2.  <br>
+ * -1 if n1 < n2.  <br>
  */
-int Int_cmp(int n1, int n2) { return n1 - n2; }
+int Int_cmp(int n1, int n2) { return (n1 > n2) - (n1 < n2); }
 
 /**
  * Compare two float
+ * @details A total order: NaN is equal to NaN and greater than
+ * every other value, -0.0 is equal to 0.0.
  * @param n1 First float
  * @param n2 Second float
  * @return   0 if n1 == n2. <br>
- * A value > 0 if n1 > n2.  <br>
- * A value < 0 if n1 < n2.  <br>
+ * 1 if n1 > n2.  <br>
+ * -1 if n1 < n2.  <br>
  */
-int Float_cmp(float n1, float n2) { return n1 - n2; }
+int Float_cmp(float n1, float n2)
+{
+	int nan1 = n1 != n1, nan2 = n2 != n2;
+	return (nan1 | nan2) ? nan1 - nan2 : (n1 > n2) - (n1 < n2);
+}
 
 /**
  * Compare two double
+ * @details A total order: NaN is equal to NaN and greater than
+ * every other value, -0.0 is equal to 0.0.
  * @param n1 First double
  * @param n2 Second double
  * @return   0 if n1 == n2. <br>
- * A value > 0 if n1 > n2.  <br>
- * A value < 0 if n1 < n2.  <br>
+ * 1 if n1 > n2.  <br>
+ * -1 if n1 < n2.  <br>
  */
-int Double_cmp(double n1, double n2) { return n1 - n2; }
+int Double_cmp(double n1, double n2)
+{
+	int nan1 = n1 != n1, nan2 = n2 != n2;
+	return (nan1 | nan2) ? nan1 - nan2 : (n1 > n2) - (n1 < n2);
+}
 
 /**
  * Compare two strings
@@ -55,6 +70,20 @@ int Double_cmp(double n1, double n2) { return n1 - n2; }
  */
 int Str_cmp(char * str1, char * str2) { return strcmp(str1, str2); }
 
+/**
+ * Equality only comparators
+ * @details For hashed containers (hmap, cmap, multimap, multiset, cache...)
+ * which only test the result of their comparator against 0: they skip the
+ * ordering work of the _cmp functions. They are not an order, do not give
+ * them to ordered containers (list, map, set, pqueue, skip list...).
+ * @return 0 if the values are equal (as with the _cmp functions),
+ * 1 otherwise
+ */
+int Int_cmpEq(int n1, int n2) { return n1 != n2; }
+int Float_cmpEq(float n1, float n2) { return !(n1 == n2 || (n1 != n1 && n2 != n2)); }
+int Double_cmpEq(double n1, double n2) { return !(n1 == n2 || (n1 != n1 && n2 != n2)); }
+int Str_cmpEq(char * str1, char * str2) { return str1 != str2 && (str1[0] != str2[0] || strcmp(str1, str2) != 0); }
+
 /**
  * Copy integer value
  * @param dest Destination
@@ -84,12 +113,144 @@ void Double_copy(double * dest, double * src) { *dest = *src; }
 void Str_copy(char ** dest, char ** src)
 {
 	int i = 0, len = strlen(*src);
-	*dest = calloc(sizeof(char) * len, sizeof(char));
+	*dest = calloc(len + 1, sizeof(char));
 	for(i = 0 ; i < len ; i++)
 		(*dest)[i] = (*src)[i];
 	(*dest)[len] = '\0';
 }
 
+/**
+ * Hash an integer
+ * @details Mix the bits of the integer (splitmix64 finalizer)
+ * so that consecutive integers land far from each other.
+ * @param val The integer to hash
+ * @return    A 64 bits hash of val
+ */
+uint64_t Int_hash(int val)
+{
+	uint64_t h = (uint64_t)(unsigned int)val;
+	h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+	return h ^ (h >> 31);
+}
+
+/* 64 x 64 -> 128 bits multiply, both halves */
+static inline void Hash_mum(uint64_t * a, uint64_t * b)
+{
+#ifdef __SIZEOF_INT128__
+	__uint128_t r = (__uint128_t)(*a) * (*b);
+	*a = (uint64_t)r;
+	*b = (uint64_t)(r >> 64);
+#else
+	uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t)(*a), lb = (uint32_t)(*b);
+	uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb, t = rl + (rm0 << 32), c = t < rl, lo = 0;
+	lo = t + (rm1 << 32);
+	c += lo < t;
+	*a = lo;
+	*b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+static inline uint64_t Hash_mix(uint64_t a, uint64_t b) { Hash_mum(&a, &b); return a ^ b; }
+static inline uint64_t Hash_read8(const unsigned char * p) { uint64_t v; memcpy(&v, p, 8); return v; }
+static inline uint64_t Hash_read4(const unsigned char * p) { uint32_t v; memcpy(&v, p, 4); return v; }
+
+/**
+ * Hash a block of memory
+ * @details wyhash style: the bytes are read 8 or 16 at a time and mixed with
+ * 64 x 128 bits multiplications, three independent lanes for long keys.
+ * @param data The bytes to hash
+ * @param len  Number of bytes
+ * @return     A 64 bits hash of the bytes
+ */
+uint64_t Mem_hash(const void * data, size_t len)
+{
+	static const uint64_t secret[4] = {0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL, 0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL};
+	const unsigned char * p = data;
+	uint64_t seed = Hash_mix(secret[0], secret[1]), a = 0, b = 0, see1 = 0, see2 = 0;
+	size_t i = len;
+	if(len <= 16)
+	{
+		if(len >= 4)
+		{
+			a = (Hash_read4(p) << 32) | Hash_read4(p + ((len >> 3) << 2));
+			b = (Hash_read4(p + len - 4) << 32) | Hash_read4(p + len - 4 - ((len >> 3) << 2));
+		}
+		else if(len > 0)
+			a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+	}
+	else
+	{
+		if(i > 48)
+		{
+			see1 = seed;
+			see2 = seed;
+			do
+			{
+				seed = Hash_mix(Hash_read8(p) ^ secret[1], Hash_read8(p + 8) ^ seed);
+				see1 = Hash_mix(Hash_read8(p + 16) ^ secret[2], Hash_read8(p + 24) ^ see1);
+				see2 = Hash_mix(Hash_read8(p + 32) ^ secret[3], Hash_read8(p + 40) ^ see2);
+				p += 48;
+				i -= 48;
+			} while(i > 48);
+			seed ^= see1 ^ see2;
+		}
+		while(i > 16)
+		{
+			seed = Hash_mix(Hash_read8(p) ^ secret[1], Hash_read8(p + 8) ^ seed);
+			p += 16;
+			i -= 16;
+		}
+		a = Hash_read8(p + i - 16);
+		b = Hash_read8(p + i - 8);
+	}
+	a ^= secret[1];
+	b ^= seed;
+	Hash_mum(&a, &b);
+	return Hash_mix(a ^ secret[0] ^ len, b ^ secret[1]);
+}
+
+/**
+ * Hash a string
+ * @details Mem_hash of the characters, the length coming from strlen
+ * (vectorized by the C library)
+ * @param str The string to hash
+ * @return    A 64 bits hash of str
+ */
+uint64_t Str_hash(char * str) { return Mem_hash(str, strlen(str)); }
+
+/**
+ * Hash a float
+ * @details Hash of the bits, with -0.0 hashed as 0.0 and every NaN alike
+ * so that values equal for Float_cmp get the same hash.
+ * @param val The float to hash
+ * @return    A 64 bits hash of val
+ */
+uint64_t Float_hash(float val)
+{
+	uint32_t bits = 0;
+	if(val != val) bits = 0x7fc00000u;
+	else if(val != 0) memcpy(&bits, &val, sizeof(bits));
+	return Int_hash((int)bits);
+}
+
+/**
+ * Hash a double
+ * @details Hash of the bits, with -0.0 hashed as 0.0 and every NaN alike
+ * so that values equal for Double_cmp get the same hash.
+ * @param val The double to hash
+ * @return    A 64 bits hash of val
+ */
+uint64_t Double_hash(double val)
+{
+	uint64_t h = 0;
+	if(val != val) h = 0x7ff8000000000000ULL;
+	else if(val != 0) memcpy(&h, &val, sizeof(h));
+	h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+	return h ^ (h >> 31);
+}
+
 void Int_free    (int      val) { (void)(val); }
 void Float_free  (float    val) { (void)(val); }
 void Double_free (double   val) { (void)(val); }
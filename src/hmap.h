@@ -0,0 +1,470 @@
+/**
+ * @file hmap.h
+ * @brief Hash map container definition
+ * @details A hash map with chained buckets and two ways to grow, chosen
+ * with HMAP_new:
+ * - HMAP_REHASH_FULL moves every element to a table twice larger at once.
+ *   Cheapest in total, but the insertion which triggers the growth stalls
+ *   for a time proportional to the map size.
+ * - HMAP_REHASH_INCREMENTAL allocates the larger table and keeps the old
+ *   one. Every _add, _get and _remove then moves HMAP_MIGRATE_BUCKETS
+ *   buckets of the old table, and lookups search both tables until the
+ *   old one is empty. No operation pays for the whole rehash.
+ *
+ * HMAP_reserve sizes the table and allocates the elements up front, so
+ * that inserting up to n elements never rehashes nor allocates. Elements
+ * left by HMAP_clear or HMAP_reserve are kept for the next insertions until
+ * HMAP_shrink_to_fit.
+ * @author Baudouin FEILDEL
+ */
+#ifndef __HMAP_H__
+#define __HMAP_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Growth modes */
+#define HMAP_REHASH_FULL        0
+#define HMAP_REHASH_INCREMENTAL 1
+
+/** Average number of elements per bucket before the map grows */
+#ifndef HMAP_MAX_LOAD
+#define HMAP_MAX_LOAD 1
+#endif
+
+/** Old buckets moved by every operation during an incremental rehash */
+#ifndef HMAP_MIGRATE_BUCKETS
+#define HMAP_MIGRATE_BUCKETS 8
+#endif
+
+// =============
+//  Definitions
+// =============
+#define NEW_HMAP_ELEM(HMAP, ElemTypename, Valuetype, Indextype) \
+/**
+ Element of a HMAP object
+ */ \
+typedef struct _ ## ElemTypename \
+{ \
+	Valuetype value; /**< Value of the element */\
+	Indextype index; /**< Index of the element */\
+	uint64_t  hash;  /**< Hash of the index */\
+	struct _ ## ElemTypename * next; /**< Pointer to the next element in the bucket */\
+} ElemTypename
+
+#define NEW_HMAP_TYPE(HMAP, Valuetype, Indextype) \
+NEW_HMAP_ELEM(HMAP, HMAP ## _elem_t, Valuetype, Indextype); \
+typedef struct HMAP \
+{ \
+	HMAP ## _elem_t ** buckets;    /**< Hash buckets */\
+	int    bucketCount;            /**< Number of buckets, a power of two */\
+	HMAP ## _elem_t ** oldBuckets; /**< Buckets being migrated. NULL if no rehash is running */\
+	int    oldCount;               /**< Number of buckets of oldBuckets */\
+	int    migrated;               /**< Number of buckets of oldBuckets already moved */\
+	int    size;                   /**< Number of elements in the map */\
+	HMAP ## _elem_t * spare;       /**< Unused elements kept for reuse, linked by next */\
+	int    spareCount;             /**< Number of elements in spare */\
+	int    mode;                   /**< HMAP_REHASH_FULL or HMAP_REHASH_INCREMENTAL */\
+	size_t elemSize;   /**< Size of one element in the map */\
+	int    freeValue;  /**< Flag:<br>1: Automatically free the value<br>0: Do not automatically free the value */\
+	int    freeIndex;  /**< Flag:<br>1: Automatically free the index<br>0: Do not automatically free the index */\
+	void (*_copyValue)(Valuetype * dest, Valuetype * src); /**< Pointer to a function used to copy a value */\
+	void (*_copyIndex)(Indextype * dest, Indextype * src); /**< Pointer to a function used to copy an index */\
+	int (*_cmpValue)(Valuetype val1, Valuetype val2); /**< Pointer to a function used to compare two values */\
+	int (*_cmpIndex)(Indextype val1, Indextype val2); /**< Pointer to a function used to compare two indexes */\
+	void (*_freeValue)(Valuetype value); /**< Pointer to a function used to free a value */\
+	void (*_freeIndex)(Indextype index); /**< Pointer to a function used to free an index */\
+	uint64_t (*_hashIndex)(Indextype index); /**< Pointer to a function used to hash an index */\
+} HMAP
+
+#define HMAP_FN_NEW(HMAP) \
+/**
+ @brief Create a new HMAP object
+ @param mode HMAP_REHASH_FULL or HMAP_REHASH_INCREMENTAL
+ @return A pointer to an allocated and initialized
+ HMAP object in memory
+ */ \
+HMAP * HMAP ## _new(int mode)
+
+#define HMAP_FN_FREE(HMAP) \
+/**
+ Destroy a HMAP object
+ @param map A pointer to a HMAP object
+ */ \
+void HMAP ## _free(HMAP * map)
+
+#define HMAP_FN_ADD_STRUCT(HMAP, Valuetype, Indextype) \
+/**
+ Add an element to the map
+ @details If an element already have this index
+ its value will be updated.
+
+ @param map   A pointer to a valid HMAP object
+ @param index The index of the element to add
+ @param value The value to set
+ @return      1 if the element was inserted. 0 if it was updated
+ */ \
+int HMAP ## _add(HMAP * map, Indextype index, Valuetype value)
+
+#define HMAP_FN_GET_STRUCT(HMAP, Valuetype, Indextype) \
+/**
+ Get the value of an element
+ @param map   A pointer to a valid HMAP object
+ @param index The index of the element to get
+ @return      A pointer to the value, valid until the element is removed.
+ NULL if the element is not present
+ */ \
+Valuetype * HMAP ## _get(HMAP * map, Indextype index)
+
+#define HMAP_FN_REMOVE_STRUCT(HMAP, Indextype) \
+/**
+ Remove an element from the map
+ @param map   A pointer to a valid HMAP object
+ @param index The index of the element to remove
+ @return      1 if the element was removed. 0 if it was not present
+ */ \
+int HMAP ## _remove(HMAP * map, Indextype index)
+
+#define HMAP_FN_RESERVE(HMAP) \
+/**
+ Size the map for n elements
+ @details Finishes a running incremental rehash, then grows the table at
+ once and allocates the elements so that the map holds n elements without
+ rehashing nor allocating.
+
+ @param map A pointer to a valid HMAP object
+ @param n   Number of elements to hold
+ */ \
+void HMAP ## _reserve(HMAP * map, int n)
+
+#define HMAP_FN_CLEAR(HMAP) \
+/**
+ Remove every element of the map
+ @details The buckets and the elements are kept for the next insertions.
+ @param map A pointer to a valid HMAP object
+ */ \
+void HMAP ## _clear(HMAP * map)
+
+#define HMAP_FN_SHRINK_TO_FIT(HMAP) \
+/**
+ Release the unused elements and shrink the table to the map size
+ @param map A pointer to a valid HMAP object
+ */ \
+void HMAP ## _shrink_to_fit(HMAP * map)
+
+#define HMAP_FN_FOR_EACH(HMAP, Valuetype, Indextype) \
+/**
+ Call a function on every element of the map
+ @details The map must not be modified by \c callback.
+ @param map      A pointer to a valid HMAP object
+ @param callback Function called with the index, a pointer to the value and \c data
+ @param data     User data given to \c callback
+ */ \
+void HMAP ## _forEach(HMAP * map, void (*callback)(Indextype index, Valuetype * value, void * data), void * data)
+
+// =================
+//  Implementations
+// =================
+#define IMPLEMENT_HMAP_FN_NEW(HMAP, Valuetype, Indextype, FN_CPY_VAL, FN_CPY_IDX, FN_CMP_VAL, FN_CMP_IDX, FN_FREE_VAL, FN_FREE_IDX, FN_HASH_IDX) \
+HMAP * HMAP ## _new(int mode) \
+{ \
+	HMAP * map = malloc(sizeof(HMAP)); \
+	map->bucketCount = 16; \
+	map->buckets     = calloc(16, sizeof(HMAP ## _elem_t *)); \
+	map->oldBuckets  = NULL; \
+	map->oldCount    = 0; \
+	map->migrated    = 0; \
+	map->size        = 0; \
+	map->spare       = NULL; \
+	map->spareCount  = 0; \
+	map->mode        = mode; \
+	map->elemSize   = sizeof(HMAP ## _elem_t); \
+	map->freeValue  = 1; \
+	map->freeIndex  = 1; \
+	map->_copyValue = FN_CPY_VAL; \
+	map->_copyIndex = FN_CPY_IDX; \
+	map->_cmpValue  = FN_CMP_VAL; \
+	map->_cmpIndex  = FN_CMP_IDX; \
+	map->_freeValue = FN_FREE_VAL; \
+	map->_freeIndex = FN_FREE_IDX; \
+	map->_hashIndex = FN_HASH_IDX; \
+	return map; \
+}
+
+#define IMPLEMENT_HMAP_FN_FREE(HMAP) \
+void HMAP ## _free(HMAP * map) \
+{ \
+	HMAP ## _elem_t * it = NULL, * next = NULL; \
+	int b = 0; \
+	if(map == NULL) return; \
+	for(b = map->migrated ; b < map->oldCount ; b++) \
+	{ \
+		for(it = map->oldBuckets[b] ; it != NULL ; it = next) \
+		{ \
+			next = it->next; \
+			if(map->freeValue) map->_freeValue(it->value); \
+			if(map->freeIndex) map->_freeIndex(it->index); \
+			free(it); \
+		} \
+	} \
+	for(b = 0 ; b < map->bucketCount ; b++) \
+	{ \
+		for(it = map->buckets[b] ; it != NULL ; it = next) \
+		{ \
+			next = it->next; \
+			if(map->freeValue) map->_freeValue(it->value); \
+			if(map->freeIndex) map->_freeIndex(it->index); \
+			free(it); \
+		} \
+	} \
+	for(it = map->spare ; it != NULL ; it = next) \
+	{ \
+		next = it->next; \
+		free(it); \
+	} \
+	free(map->oldBuckets); \
+	free(map->buckets); \
+	free(map); \
+}
+
+/* Internal helpers: lookup in both tables and rehash */
+#define IMPLEMENT_HMAP_FN_HELPERS(HMAP, Indextype) \
+/* Move up to 'steps' old buckets to the new table */\
+static void HMAP ## _migrate(HMAP * map, int steps) \
+{ \
+	HMAP ## _elem_t * it = NULL, * next = NULL; \
+	uint64_t mask = (uint64_t)(map->bucketCount - 1); \
+	while(map->oldBuckets != NULL && steps-- > 0) \
+	{ \
+		for(it = map->oldBuckets[map->migrated] ; it != NULL ; it = next) \
+		{ \
+			next = it->next; \
+			it->next = map->buckets[it->hash & mask]; \
+			map->buckets[it->hash & mask] = it; \
+		} \
+		map->oldBuckets[map->migrated] = NULL; \
+		if(++map->migrated == map->oldCount) \
+		{ \
+			free(map->oldBuckets); \
+			map->oldBuckets = NULL; \
+			map->oldCount   = 0; \
+			map->migrated   = 0; \
+		} \
+	} \
+} \
+/* Switch to a table of 'count' buckets, moving the elements at once or incrementally */\
+static void HMAP ## _rehash(HMAP * map, int count, int incremental) \
+{ \
+	HMAP ## _migrate(map, INT_MAX); \
+	map->oldBuckets  = map->buckets; \
+	map->oldCount    = map->bucketCount; \
+	map->migrated    = 0; \
+	map->buckets     = calloc(count, sizeof(HMAP ## _elem_t *)); \
+	map->bucketCount = count; \
+	if(!incremental) \
+		HMAP ## _migrate(map, INT_MAX); \
+} \
+/* Slot of the element with this index, or the empty slot where to insert it */\
+static HMAP ## _elem_t ** HMAP ## _find(HMAP * map, Indextype index, uint64_t hash) \
+{ \
+	HMAP ## _elem_t ** it = NULL; \
+	uint64_t b = 0; \
+	if(map->oldBuckets != NULL) \
+	{ \
+		b = hash & (uint64_t)(map->oldCount - 1); \
+		if(b >= (uint64_t)map->migrated) \
+		{ \
+			for(it = &(map->oldBuckets[b]) ; *it != NULL ; it = &((*it)->next)) \
+				if((*it)->hash == hash && map->_cmpIndex((*it)->index, index) == 0) \
+					return it; \
+		} \
+	} \
+	it = &(map->buckets[hash & (uint64_t)(map->bucketCount - 1)]); \
+	while(*it != NULL) \
+	{ \
+		if((*it)->hash == hash && map->_cmpIndex((*it)->index, index) == 0) \
+			return it; \
+		it = &((*it)->next); \
+	} \
+	return it; \
+}
+
+#define IMPLEMENT_HMAP_FN_ADD_STRUCT(HMAP, Valuetype, Indextype) \
+int HMAP ## _add(HMAP * map, Indextype index, Valuetype value) \
+{ \
+	HMAP ## _elem_t ** slot = NULL; \
+	HMAP ## _elem_t * elem = NULL; \
+	uint64_t hash = 0; \
+	if(map == NULL) \
+		return 0; \
+	HMAP ## _migrate(map, HMAP_MIGRATE_BUCKETS); \
+	hash = map->_hashIndex(index); \
+	slot = HMAP ## _find(map, index, hash); \
+	if(*slot != NULL) \
+	{ \
+		if(map->freeValue) map->_freeValue((*slot)->value); \
+		map->_copyValue(&((*slot)->value), &(value)); \
+		return 0; \
+	} \
+	/* Create the element, reusing a spare one */\
+	if((elem = map->spare) != NULL) \
+	{ \
+		map->spare = elem->next; \
+		map->spareCount--; \
+	} \
+	else \
+		elem = malloc(map->elemSize); \
+	elem->hash = hash; \
+	elem->next = NULL; \
+	map->_copyIndex(&(elem->index), &(index)); \
+	map->_copyValue(&(elem->value), &(value)); \
+	*slot = elem; \
+	map->size++; \
+	if(map->size > map->bucketCount * HMAP_MAX_LOAD) \
+		HMAP ## _rehash(map, map->bucketCount * 2, map->mode == HMAP_REHASH_INCREMENTAL); \
+	return 1; \
+}
+
+#define IMPLEMENT_HMAP_FN_GET_STRUCT(HMAP, Valuetype, Indextype) \
+Valuetype * HMAP ## _get(HMAP * map, Indextype index) \
+{ \
+	HMAP ## _elem_t * elem = NULL; \
+	if(map == NULL) return NULL; \
+	HMAP ## _migrate(map, HMAP_MIGRATE_BUCKETS); \
+	elem = *(HMAP ## _find(map, index, map->_hashIndex(index))); \
+	return (elem != NULL) ? &(elem->value) : NULL; \
+}
+
+#define IMPLEMENT_HMAP_FN_REMOVE_STRUCT(HMAP, Indextype) \
+int HMAP ## _remove(HMAP * map, Indextype index) \
+{ \
+	HMAP ## _elem_t ** slot = NULL; \
+	HMAP ## _elem_t * elem = NULL; \
+	if(map == NULL) return 0; \
+	HMAP ## _migrate(map, HMAP_MIGRATE_BUCKETS); \
+	slot = HMAP ## _find(map, index, map->_hashIndex(index)); \
+	elem = *slot; \
+	if(elem == NULL) \
+		return 0; \
+	*slot = elem->next; \
+	map->size--; \
+	if(map->freeValue) map->_freeValue(elem->value); \
+	if(map->freeIndex) map->_freeIndex(elem->index); \
+	free(elem); \
+	return 1; \
+}
+
+#define IMPLEMENT_HMAP_FN_RESERVE(HMAP) \
+void HMAP ## _reserve(HMAP * map, int n) \
+{ \
+	HMAP ## _elem_t * elem = NULL; \
+	int count = 0; \
+	if(map == NULL) return; \
+	HMAP ## _migrate(map, INT_MAX); \
+	count = map->bucketCount; \
+	while(count * HMAP_MAX_LOAD < n) \
+		count *= 2; \
+	if(count > map->bucketCount) \
+		HMAP ## _rehash(map, count, 0); \
+	while(map->size + map->spareCount < n) \
+	{ \
+		if((elem = malloc(map->elemSize)) == NULL) \
+			return; \
+		elem->next = map->spare; \
+		map->spare = elem; \
+		map->spareCount++; \
+	} \
+}
+
+#define IMPLEMENT_HMAP_FN_CLEAR(HMAP) \
+void HMAP ## _clear(HMAP * map) \
+{ \
+	HMAP ## _elem_t * it = NULL, * next = NULL; \
+	int b = 0; \
+	if(map == NULL) return; \
+	HMAP ## _migrate(map, INT_MAX); \
+	for(b = 0 ; b < map->bucketCount ; b++) \
+	{ \
+		for(it = map->buckets[b] ; it != NULL ; it = next) \
+		{ \
+			next = it->next; \
+			if(map->freeValue) map->_freeValue(it->value); \
+			if(map->freeIndex) map->_freeIndex(it->index); \
+			it->next = map->spare; \
+			map->spare = it; \
+			map->spareCount++; \
+		} \
+		map->buckets[b] = NULL; \
+	} \
+	map->size = 0; \
+}
+
+#define IMPLEMENT_HMAP_FN_SHRINK_TO_FIT(HMAP) \
+void HMAP ## _shrink_to_fit(HMAP * map) \
+{ \
+	HMAP ## _elem_t * it = NULL, * next = NULL; \
+	int count = 16; \
+	if(map == NULL) return; \
+	for(it = map->spare ; it != NULL ; it = next) \
+	{ \
+		next = it->next; \
+		free(it); \
+	} \
+	map->spare      = NULL; \
+	map->spareCount = 0; \
+	HMAP ## _migrate(map, INT_MAX); \
+	while(count * HMAP_MAX_LOAD < map->size) \
+		count *= 2; \
+	if(count < map->bucketCount) \
+		HMAP ## _rehash(map, count, 0); \
+}
+
+#define IMPLEMENT_HMAP_FN_FOR_EACH(HMAP, Valuetype, Indextype) \
+void HMAP ## _forEach(HMAP * map, void (*callback)(Indextype index, Valuetype * value, void * data), void * data) \
+{ \
+	HMAP ## _elem_t * it = NULL; \
+	int b = 0; \
+	if(map == NULL) return; \
+	for(b = map->migrated ; b < map->oldCount ; b++) \
+		for(it = map->oldBuckets[b] ; it != NULL ; it = it->next) \
+			callback(it->index, &(it->value), data); \
+	for(b = 0 ; b < map->bucketCount ; b++) \
+		for(it = map->buckets[b] ; it != NULL ; it = it->next) \
+			callback(it->index, &(it->value), data); \
+}
+
+// MACRO HELPERS (One line definitions && implementations)
+#define NEW_HMAP_DEFINITION(HMAP, VALUETYPE, INDEXTYPE) \
+NEW_HMAP_TYPE(HMAP, VALUETYPE, INDEXTYPE); \
+HMAP_FN_NEW(HMAP); \
+HMAP_FN_FREE(HMAP); \
+HMAP_FN_ADD_STRUCT(HMAP, VALUETYPE, INDEXTYPE); \
+HMAP_FN_GET_STRUCT(HMAP, VALUETYPE, INDEXTYPE); \
+HMAP_FN_REMOVE_STRUCT(HMAP, INDEXTYPE); \
+HMAP_FN_RESERVE(HMAP); \
+HMAP_FN_CLEAR(HMAP); \
+HMAP_FN_SHRINK_TO_FIT(HMAP); \
+HMAP_FN_FOR_EACH(HMAP, VALUETYPE, INDEXTYPE)
+
+#define IMPLEMENT_HMAP(HMAP, VALUETYPE, INDEXTYPE, FN_CPY_VAL, FN_CPY_IDX, FN_CMP_VAL, FN_CMP_IDX, FN_FREE_VAL, FN_FREE_IDX, FN_HASH_IDX) \
+IMPLEMENT_HMAP_FN_NEW(HMAP, VALUETYPE, INDEXTYPE, FN_CPY_VAL, FN_CPY_IDX, FN_CMP_VAL, FN_CMP_IDX, FN_FREE_VAL, FN_FREE_IDX, FN_HASH_IDX); \
+IMPLEMENT_HMAP_FN_FREE(HMAP); \
+IMPLEMENT_HMAP_FN_HELPERS(HMAP, INDEXTYPE); \
+IMPLEMENT_HMAP_FN_ADD_STRUCT(HMAP, VALUETYPE, INDEXTYPE); \
+IMPLEMENT_HMAP_FN_GET_STRUCT(HMAP, VALUETYPE, INDEXTYPE); \
+IMPLEMENT_HMAP_FN_REMOVE_STRUCT(HMAP, INDEXTYPE); \
+IMPLEMENT_HMAP_FN_RESERVE(HMAP); \
+IMPLEMENT_HMAP_FN_CLEAR(HMAP); \
+IMPLEMENT_HMAP_FN_SHRINK_TO_FIT(HMAP); \
+IMPLEMENT_HMAP_FN_FOR_EACH(HMAP, VALUETYPE, INDEXTYPE)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __HMAP_H__
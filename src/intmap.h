@@ -0,0 +1,605 @@
+/**
+ * @file intmap.h
+ * @brief Integer keyed map container definition
+ * @details A map from unsigned int keys to values, stored in one of three
+ * layouts chosen from the density of the keys:
+ * - IMAP_DIRECT  one slot per key of [base, base + capacity): a lookup is
+ *   a subtraction, a bit test and an array access. Used while the key range
+ *   holds at most IMAP_DIRECT_DENSITY slots per key.
+ * - IMAP_PAGED   pages of IMAP_PAGE_SIZE slots, allocated for the key
+ *   ranges in use, under a table of pages: two array accesses. Used while
+ *   the pages hold at most IMAP_PAGED_DENSITY slots per key.
+ * - IMAP_HASH    open addressing with linear probing and Fibonacci
+ *   hashing, for keys spread too thinly for the two others.
+ *
+ * The layout is chosen again whenever the current one must grow (a key out
+ * of the direct range, a new page, a full hash table) and by
+ * IMAP_shrink_to_fit, so a map filled in any order ends up direct or paged
+ * once its keys are dense enough.
+ * @author Baudouin FEILDEL
+ */
+#ifndef __IMAP_H__
+#define __IMAP_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Layouts */
+#define IMAP_DIRECT 0
+#define IMAP_PAGED  1
+#define IMAP_HASH   2
+
+/** log2 of the number of slots of a page */
+#ifndef IMAP_PAGE_BITS
+#define IMAP_PAGE_BITS 8
+#endif
+#define IMAP_PAGE_SIZE (1u << IMAP_PAGE_BITS)
+
+/** Maximum slots per key of the direct layout */
+#ifndef IMAP_DIRECT_DENSITY
+#define IMAP_DIRECT_DENSITY 4
+#endif
+
+/** Maximum slots per key of the allocated pages */
+#ifndef IMAP_PAGED_DENSITY
+#define IMAP_PAGED_DENSITY 8
+#endif
+
+/** Key ranges this small always use the direct layout */
+#define IMAP_MIN_SLOTS 64
+
+static inline int IMAP_test(const uint64_t * bits, uint64_t i) { return (bits[i >> 6] >> (i & 63)) & 1; }
+static inline void IMAP_set(uint64_t * bits, uint64_t i) { bits[i >> 6] |= 1ULL << (i & 63); }
+static inline void IMAP_unset(uint64_t * bits, uint64_t i) { bits[i >> 6] &= ~(1ULL << (i & 63)); }
+
+/* Home slot of a key in a hash table of 2^(64 - shift) slots */
+static inline uint64_t IMAP_home(unsigned int key, int shift) { return ((uint64_t)key * 0x9E3779B97F4A7C15ULL) >> shift; }
+
+static inline uint64_t IMAP_pow2(uint64_t n)
+{
+	uint64_t p = 1;
+	while(p < n)
+		p *= 2;
+	return p;
+}
+
+// =============
+//  Definitions
+// =============
+#define NEW_IMAP_PAGE(IMAP, PageTypename, SlotTypename, Valuetype) \
+/**
+ Page of a IMAP object in the paged layout
+ */ \
+typedef struct _ ## PageTypename \
+{ \
+	uint64_t  present[IMAP_PAGE_SIZE / 64]; /**< Bit set for every slot holding a value */\
+	int       count;                        /**< Number of values in the page */\
+	Valuetype values[IMAP_PAGE_SIZE];       /**< Value of every key of the page */\
+} PageTypename; \
+/**
+ Slot of a IMAP object in the hash layout
+ */ \
+typedef struct _ ## SlotTypename \
+{ \
+	unsigned int key;   /**< Key of the slot */\
+	int          used;  /**< Flag:<br>1: The slot holds a value<br>0: Empty slot */\
+	Valuetype    value; /**< Value of the key */\
+} SlotTypename
+
+#define NEW_IMAP_TYPE(IMAP, Valuetype) \
+NEW_IMAP_PAGE(IMAP, IMAP ## _page_t, IMAP ## _slot_t, Valuetype); \
+typedef struct IMAP \
+{ \
+	int          mode;     /**< IMAP_DIRECT, IMAP_PAGED or IMAP_HASH */\
+	int          size;     /**< Number of elements in the map */\
+	unsigned int minKey;   /**< Lowest key added since the last layout (a bound) */\
+	unsigned int maxKey;   /**< Highest key added since the last layout (a bound) */\
+	uint64_t     base;     /**< Direct: first key. Paged: first page */\
+	uint64_t     capacity; /**< Direct: slots. Paged: entries of pages. Hash: slots, a power of two */\
+	Valuetype  * values;   /**< Direct: value of every key */\
+	uint64_t   * present;  /**< Direct: bit set for every key holding a value */\
+	IMAP ## _page_t ** pages; /**< Paged: table of pages, NULL for unused ranges */\
+	int          pageCount;   /**< Paged: number of allocated pages */\
+	IMAP ## _slot_t * slots;  /**< Hash: slots */\
+	int          hashShift;   /**< Hash: 64 - log2(capacity) */\
+	size_t elemSize;  /**< Size of one value in the map */\
+	int    freeValue; /**< Flag:<br>1: Automatically free the value<br>0: Do not automatically free the value */\
+	void (*_copyValue)(Valuetype * dest, Valuetype * src); /**< Pointer to a function used to copy a value */\
+	int (*_cmpValue)(Valuetype val1, Valuetype val2); /**< Pointer to a function used to compare two values */\
+	void (*_freeValue)(Valuetype value); /**< Pointer to a function used to free a value */\
+} IMAP
+
+#define IMAP_FN_NEW(IMAP) \
+/**
+ @brief Create a new IMAP object
+ @return A pointer to an allocated and initialized
+ IMAP object in memory
+ */ \
+IMAP * IMAP ## _new()
+
+#define IMAP_FN_FREE(IMAP) \
+/**
+ Destroy a IMAP object
+ @param map A pointer to a IMAP object
+ */ \
+void IMAP ## _free(IMAP * map)
+
+#define IMAP_FN_ADD(IMAP, Valuetype) \
+/**
+ Add an element to the map
+ @details If an element already have this key
+ its value will be updated.
+
+ @param map   A pointer to a valid IMAP object
+ @param key   The key of the element to add
+ @param value The value to set
+ @return      1 if the element was inserted. 0 if it was updated
+ */ \
+int IMAP ## _add(IMAP * map, unsigned int key, Valuetype value)
+
+#define IMAP_FN_GET(IMAP, Valuetype) \
+/**
+ Get the value of an element
+ @param map A pointer to a valid IMAP object
+ @param key The key of the element to get
+ @return    A pointer to the value, valid until the next _add, _remove
+ or _shrink_to_fit. NULL if the element is not present
+ */ \
+Valuetype * IMAP ## _get(IMAP * map, unsigned int key)
+
+#define IMAP_FN_REMOVE(IMAP) \
+/**
+ Remove an element from the map
+ @param map A pointer to a valid IMAP object
+ @param key The key of the element to remove
+ @return    1 if the element was removed. 0 if it was not present
+ */ \
+int IMAP ## _remove(IMAP * map, unsigned int key)
+
+#define IMAP_FN_CLEAR(IMAP) \
+/**
+ Remove every element of the map
+ @details The layout and its memory are kept for the next insertions.
+ @param map A pointer to a valid IMAP object
+ */ \
+void IMAP ## _clear(IMAP * map)
+
+#define IMAP_FN_SHRINK_TO_FIT(IMAP) \
+/**
+ Choose the layout again from the keys of the map and size it to them
+ @param map A pointer to a valid IMAP object
+ */ \
+void IMAP ## _shrink_to_fit(IMAP * map)
+
+#define IMAP_FN_FOR_EACH(IMAP, Valuetype) \
+/**
+ Call a function on every element of the map
+ @details Keys come in increasing order in the direct and paged layouts,
+ in no particular order in the hash layout. The map must not be modified
+ by \c callback.
+
+ @param map      A pointer to a valid IMAP object
+ @param callback Function called with the key, a pointer to the value and \c data
+ @param data     User data given to \c callback
+ */ \
+void IMAP ## _forEach(IMAP * map, void (*callback)(unsigned int key, Valuetype * value, void * data), void * data)
+
+// =================
+//  Implementations
+// =================
+#define IMPLEMENT_IMAP_FN_NEW(IMAP, Valuetype, FN_CPY_VAL, FN_CMP_VAL, FN_FREE_VAL) \
+IMAP * IMAP ## _new() \
+{ \
+	IMAP * map = calloc(1, sizeof(IMAP)); \
+	map->mode       = IMAP_DIRECT; \
+	map->elemSize   = sizeof(Valuetype); \
+	map->freeValue  = 1; \
+	map->_copyValue = FN_CPY_VAL; \
+	map->_cmpValue  = FN_CMP_VAL; \
+	map->_freeValue = FN_FREE_VAL; \
+	return map; \
+}
+
+/* Internal helpers: lookup, iteration and layout changes */
+#define IMPLEMENT_IMAP_FN_HELPERS(IMAP, Valuetype) \
+static Valuetype * IMAP ## _lookup(IMAP * map, unsigned int key) \
+{ \
+	IMAP ## _page_t * page = NULL; \
+	uint64_t i = 0, mask = 0; \
+	switch(map->mode) \
+	{ \
+		case IMAP_DIRECT: \
+			i = (uint64_t)key - map->base; \
+			return (key >= map->base && i < map->capacity && IMAP_test(map->present, i)) ? &(map->values[i]) : NULL; \
+		case IMAP_PAGED: \
+			i = (uint64_t)(key >> IMAP_PAGE_BITS) - map->base; \
+			if((key >> IMAP_PAGE_BITS) < map->base || i >= map->capacity || (page = map->pages[i]) == NULL) \
+				return NULL; \
+			return IMAP_test(page->present, key & (IMAP_PAGE_SIZE - 1)) ? &(page->values[key & (IMAP_PAGE_SIZE - 1)]) : NULL; \
+		default: \
+			if(map->capacity == 0) return NULL; \
+			mask = map->capacity - 1; \
+			for(i = IMAP_home(key, map->hashShift) ; map->slots[i].used ; i = (i + 1) & mask) \
+				if(map->slots[i].key == key) \
+					return &(map->slots[i].value); \
+			return NULL; \
+	} \
+} \
+/* Next element from position *pos (0 to start), or NULL at the end */\
+static Valuetype * IMAP ## _next(IMAP * map, uint64_t * pos, unsigned int * key) \
+{ \
+	IMAP ## _page_t * page = NULL; \
+	uint64_t word = 0; \
+	switch(map->mode) \
+	{ \
+		case IMAP_DIRECT: \
+			while(*pos < map->capacity) \
+			{ \
+				word = map->present[*pos >> 6] >> (*pos & 63); \
+				if(word == 0) \
+				{ \
+					*pos = (*pos | 63) + 1; \
+					continue; \
+				} \
+				*pos += __builtin_ctzll(word); \
+				*key = (unsigned int)(map->base + *pos); \
+				return &(map->values[(*pos)++]); \
+			} \
+			return NULL; \
+		case IMAP_PAGED: \
+			while(*pos < map->capacity * IMAP_PAGE_SIZE) \
+			{ \
+				if((page = map->pages[*pos >> IMAP_PAGE_BITS]) == NULL) \
+				{ \
+					*pos = ((*pos >> IMAP_PAGE_BITS) + 1) << IMAP_PAGE_BITS; \
+					continue; \
+				} \
+				word = page->present[(*pos & (IMAP_PAGE_SIZE - 1)) >> 6] >> (*pos & 63); \
+				if(word == 0) \
+				{ \
+					*pos = (*pos | 63) + 1; \
+					continue; \
+				} \
+				*pos += __builtin_ctzll(word); \
+				*key = (unsigned int)(((map->base + (*pos >> IMAP_PAGE_BITS)) << IMAP_PAGE_BITS) | (*pos & (IMAP_PAGE_SIZE - 1))); \
+				return &(page->values[(*pos)++ & (IMAP_PAGE_SIZE - 1)]); \
+			} \
+			return NULL; \
+		default: \
+			for( ; *pos < map->capacity ; (*pos)++) \
+			{ \
+				if(map->slots[*pos].used) \
+				{ \
+					*key = map->slots[*pos].key; \
+					return &(map->slots[(*pos)++].value); \
+				} \
+			} \
+			return NULL; \
+	} \
+} \
+/* Exact bounds of the keys in the map */\
+static void IMAP ## _bounds(IMAP * map) \
+{ \
+	uint64_t pos = 0; \
+	unsigned int key = 0; \
+	map->minKey = UINT32_MAX; \
+	map->maxKey = 0; \
+	while(IMAP ## _next(map, &pos, &key) != NULL) \
+	{ \
+		if(key < map->minKey) map->minKey = key; \
+		if(key > map->maxKey) map->maxKey = key; \
+	} \
+} \
+/* Whether key can be inserted without changing the layout */\
+static int IMAP ## _fits(IMAP * map, unsigned int key) \
+{ \
+	uint64_t i = 0; \
+	switch(map->mode) \
+	{ \
+		case IMAP_DIRECT: \
+			return key >= map->base && (uint64_t)key - map->base < map->capacity; \
+		case IMAP_PAGED: \
+			i = (uint64_t)(key >> IMAP_PAGE_BITS) - map->base; \
+			if((key >> IMAP_PAGE_BITS) < map->base || i >= map->capacity) \
+				return 0; \
+			return map->pages[i] != NULL || map->pageCount == 0 \
+			    || (uint64_t)(map->pageCount + 1) * IMAP_PAGE_SIZE <= (uint64_t)IMAP_PAGED_DENSITY * (map->size + 1); \
+		default: \
+			return (uint64_t)(map->size + 1) * 2 <= map->capacity; \
+	} \
+} \
+/* Put a value known to be absent, the layout having room for it */\
+static void IMAP ## _store(IMAP * map, unsigned int key, Valuetype * value, int copy) \
+{ \
+	IMAP ## _page_t * page = NULL; \
+	Valuetype * slot = NULL; \
+	uint64_t i = 0; \
+	switch(map->mode) \
+	{ \
+		case IMAP_DIRECT: \
+			i = (uint64_t)key - map->base; \
+			IMAP_set(map->present, i); \
+			slot = &(map->values[i]); \
+			break; \
+		case IMAP_PAGED: \
+			i = (uint64_t)(key >> IMAP_PAGE_BITS) - map->base; \
+			if((page = map->pages[i]) == NULL) \
+			{ \
+				page = map->pages[i] = calloc(1, sizeof(IMAP ## _page_t)); \
+				map->pageCount++; \
+			} \
+			IMAP_set(page->present, key & (IMAP_PAGE_SIZE - 1)); \
+			page->count++; \
+			slot = &(page->values[key & (IMAP_PAGE_SIZE - 1)]); \
+			break; \
+		default: \
+			for(i = IMAP_home(key, map->hashShift) ; map->slots[i].used ; i = (i + 1) & (map->capacity - 1)); \
+			map->slots[i].key  = key; \
+			map->slots[i].used = 1; \
+			slot = &(map->slots[i].value); \
+			break; \
+	} \
+	if(copy) map->_copyValue(slot, value); \
+	else     *slot = *value; \
+} \
+static void IMAP ## _release(IMAP * map) \
+{ \
+	uint64_t i = 0; \
+	for(i = 0 ; map->pages != NULL && i < map->capacity ; i++) \
+		free(map->pages[i]); \
+	free(map->values); \
+	free(map->present); \
+	free(map->pages); \
+	free(map->slots); \
+	map->values  = NULL; \
+	map->present = NULL; \
+	map->pages   = NULL; \
+	map->slots   = NULL; \
+	map->pageCount = 0; \
+	map->capacity  = 0; \
+} \
+/* Choose the layout of the elements and of the pending key if any, */\
+/* n keys in [lo, hi], and move the elements into it. */\
+/* With margin, leave room to grow on both sides of the range */\
+static void IMAP ## _layout(IMAP * map, const unsigned int * pending, unsigned int lo, unsigned int hi, int n, int margin) \
+{ \
+	IMAP old = *map; \
+	Valuetype * value = NULL; \
+	uint64_t span = (uint64_t)hi - lo + 1, pages = 0, used = 0, pos = 0, extra = 0; \
+	uint64_t first = lo >> IMAP_PAGE_BITS, last = hi >> IMAP_PAGE_BITS; \
+	uint64_t * touched = NULL; \
+	unsigned int key = 0; \
+	map->values  = NULL; \
+	map->present = NULL; \
+	map->pages   = NULL; \
+	map->slots   = NULL; \
+	map->pageCount = 0; \
+	if(span <= IMAP_MIN_SLOTS || span <= (uint64_t)IMAP_DIRECT_DENSITY * n) \
+	{ \
+		map->mode     = IMAP_DIRECT; \
+		map->capacity = margin ? IMAP_pow2(span) * 2 : span; \
+		if(map->capacity < IMAP_MIN_SLOTS) map->capacity = IMAP_MIN_SLOTS; \
+		if(map->capacity > (1ULL << 32)) map->capacity = 1ULL << 32; \
+		extra = (map->capacity - span) / 2; \
+		map->base = lo > extra ? lo - extra : 0; \
+		if(map->base + map->capacity > (1ULL << 32)) map->base = (1ULL << 32) - map->capacity; \
+		map->values  = malloc(sizeof(Valuetype) * map->capacity); \
+		map->present = calloc((map->capacity + 63) / 64, sizeof(uint64_t)); \
+	} \
+	else \
+	{ \
+		/* Count the pages the keys would use, if the table of pages stays small */\
+		pages = last - first + 1; \
+		if(pages <= (uint64_t)n * 2) \
+		{ \
+			touched = calloc((pages + 63) / 64, sizeof(uint64_t)); \
+			while((value = IMAP ## _next(&old, &pos, &key)) != NULL) \
+				IMAP_set(touched, (key >> IMAP_PAGE_BITS) - first); \
+			if(pending != NULL) \
+				IMAP_set(touched, (*pending >> IMAP_PAGE_BITS) - first); \
+			for(pos = 0 ; pos < (pages + 63) / 64 ; pos++) \
+				used += __builtin_popcountll(touched[pos]); \
+			free(touched); \
+			pos = 0; \
+		} \
+		if(used > 0 && (used == 1 || used * IMAP_PAGE_SIZE <= (uint64_t)IMAP_PAGED_DENSITY * n)) \
+		{ \
+			map->mode     = IMAP_PAGED; \
+			map->capacity = margin ? IMAP_pow2(pages) * 2 : pages; \
+			if(map->capacity > (1ULL << (32 - IMAP_PAGE_BITS))) map->capacity = 1ULL << (32 - IMAP_PAGE_BITS); \
+			extra = (map->capacity - pages) / 2; \
+			map->base = first > extra ? first - extra : 0; \
+			if(map->base + map->capacity > (1ULL << (32 - IMAP_PAGE_BITS))) map->base = (1ULL << (32 - IMAP_PAGE_BITS)) - map->capacity; \
+			map->pages = calloc(map->capacity, sizeof(IMAP ## _page_t *)); \
+		} \
+		else \
+		{ \
+			map->mode      = IMAP_HASH; \
+			map->capacity  = IMAP_pow2((uint64_t)n * (margin ? 4 : 2)); \
+			if(map->capacity < 16) map->capacity = 16; \
+			map->hashShift = 64 - __builtin_ctzll(map->capacity); \
+			map->slots     = calloc(map->capacity, sizeof(IMAP ## _slot_t)); \
+		} \
+	} \
+	/* Move the values, without copying them */\
+	pos = 0; \
+	while((value = IMAP ## _next(&old, &pos, &key)) != NULL) \
+		IMAP ## _store(map, key, value, 0); \
+	old.freeValue = 0; \
+	IMAP ## _release(&old); \
+}
+
+#define IMPLEMENT_IMAP_FN_FREE(IMAP) \
+void IMAP ## _free(IMAP * map) \
+{ \
+	if(map == NULL) return; \
+	IMAP ## _clear(map); \
+	IMAP ## _release(map); \
+	free(map); \
+}
+
+#define IMPLEMENT_IMAP_FN_ADD(IMAP, Valuetype) \
+int IMAP ## _add(IMAP * map, unsigned int key, Valuetype value) \
+{ \
+	Valuetype * slot = NULL; \
+	if(map == NULL) return 0; \
+	if((slot = IMAP ## _lookup(map, key)) != NULL) \
+	{ \
+		if(map->freeValue) map->_freeValue(*slot); \
+		map->_copyValue(slot, &(value)); \
+		return 0; \
+	} \
+	if(map->size == 0) \
+	{ \
+		map->minKey = key; \
+		map->maxKey = key; \
+	} \
+	if(key < map->minKey) map->minKey = key; \
+	if(key > map->maxKey) map->maxKey = key; \
+	if(!IMAP ## _fits(map, key)) \
+	{ \
+		/* _remove does not narrow the bounds: take them from the keys left */\
+		IMAP ## _bounds(map); \
+		if(key < map->minKey) map->minKey = key; \
+		if(key > map->maxKey) map->maxKey = key; \
+		IMAP ## _layout(map, &key, map->minKey, map->maxKey, map->size + 1, 1); \
+	} \
+	IMAP ## _store(map, key, &(value), 1); \
+	map->size++; \
+	return 1; \
+}
+
+#define IMPLEMENT_IMAP_FN_GET(IMAP, Valuetype) \
+Valuetype * IMAP ## _get(IMAP * map, unsigned int key) \
+{ \
+	if(map == NULL) return NULL; \
+	return IMAP ## _lookup(map, key); \
+}
+
+#define IMPLEMENT_IMAP_FN_REMOVE(IMAP) \
+int IMAP ## _remove(IMAP * map, unsigned int key) \
+{ \
+	uint64_t i = 0, hole = 0, mask = 0, home = 0; \
+	if(map == NULL || IMAP ## _lookup(map, key) == NULL) \
+		return 0; \
+	switch(map->mode) \
+	{ \
+		case IMAP_DIRECT: \
+			i = (uint64_t)key - map->base; \
+			if(map->freeValue) map->_freeValue(map->values[i]); \
+			IMAP_unset(map->present, i); \
+			break; \
+		case IMAP_PAGED: \
+			i = (uint64_t)(key >> IMAP_PAGE_BITS) - map->base; \
+			if(map->freeValue) map->_freeValue(map->pages[i]->values[key & (IMAP_PAGE_SIZE - 1)]); \
+			IMAP_unset(map->pages[i]->present, key & (IMAP_PAGE_SIZE - 1)); \
+			if(--map->pages[i]->count == 0) \
+			{ \
+				free(map->pages[i]); \
+				map->pages[i] = NULL; \
+				map->pageCount--; \
+			} \
+			break; \
+		default: \
+			mask = map->capacity - 1; \
+			for(hole = IMAP_home(key, map->hashShift) ; map->slots[hole].key != key ; hole = (hole + 1) & mask); \
+			if(map->freeValue) map->_freeValue(map->slots[hole].value); \
+			map->slots[hole].used = 0; \
+			/* Backward shift: move back the next keys which may not be found past the hole */\
+			for(i = (hole + 1) & mask ; map->slots[i].used ; i = (i + 1) & mask) \
+			{ \
+				home = IMAP_home(map->slots[i].key, map->hashShift); \
+				if(((i - home) & mask) >= ((i - hole) & mask)) \
+				{ \
+					map->slots[hole] = map->slots[i]; \
+					map->slots[i].used = 0; \
+					hole = i; \
+				} \
+			} \
+			break; \
+	} \
+	map->size--; \
+	return 1; \
+}
+
+#define IMPLEMENT_IMAP_FN_CLEAR(IMAP, Valuetype) \
+void IMAP ## _clear(IMAP * map) \
+{ \
+	Valuetype * value = NULL; \
+	uint64_t pos = 0, i = 0; \
+	unsigned int key = 0; \
+	if(map == NULL) return; \
+	while(map->freeValue && (value = IMAP ## _next(map, &pos, &key)) != NULL) \
+		map->_freeValue(*value); \
+	if(map->present != NULL) \
+		memset(map->present, 0, sizeof(uint64_t) * ((map->capacity + 63) / 64)); \
+	for(i = 0 ; map->pages != NULL && i < map->capacity ; i++) \
+	{ \
+		free(map->pages[i]); \
+		map->pages[i] = NULL; \
+	} \
+	for(i = 0 ; map->slots != NULL && i < map->capacity ; i++) \
+		map->slots[i].used = 0; \
+	map->pageCount = 0; \
+	map->size      = 0; \
+}
+
+#define IMPLEMENT_IMAP_FN_SHRINK_TO_FIT(IMAP, Valuetype) \
+void IMAP ## _shrink_to_fit(IMAP * map) \
+{ \
+	if(map == NULL) return; \
+	if(map->size == 0) \
+	{ \
+		IMAP ## _release(map); \
+		map->mode = IMAP_DIRECT; \
+		map->base = 0; \
+		return; \
+	} \
+	IMAP ## _bounds(map); \
+	IMAP ## _layout(map, NULL, map->minKey, map->maxKey, map->size, 0); \
+}
+
+#define IMPLEMENT_IMAP_FN_FOR_EACH(IMAP, Valuetype) \
+void IMAP ## _forEach(IMAP * map, void (*callback)(unsigned int key, Valuetype * value, void * data), void * data) \
+{ \
+	Valuetype * value = NULL; \
+	uint64_t pos = 0; \
+	unsigned int key = 0; \
+	if(map == NULL) return; \
+	while((value = IMAP ## _next(map, &pos, &key)) != NULL) \
+		callback(key, value, data); \
+}
+
+// MACRO HELPERS (One line definitions && implementations)
+#define NEW_IMAP_DEFINITION(IMAP, VALUETYPE) \
+NEW_IMAP_TYPE(IMAP, VALUETYPE); \
+IMAP_FN_NEW(IMAP); \
+IMAP_FN_FREE(IMAP); \
+IMAP_FN_ADD(IMAP, VALUETYPE); \
+IMAP_FN_GET(IMAP, VALUETYPE); \
+IMAP_FN_REMOVE(IMAP); \
+IMAP_FN_CLEAR(IMAP); \
+IMAP_FN_SHRINK_TO_FIT(IMAP); \
+IMAP_FN_FOR_EACH(IMAP, VALUETYPE)
+
+#define IMPLEMENT_IMAP(IMAP, VALUETYPE, FN_CPY_VAL, FN_CMP_VAL, FN_FREE_VAL) \
+IMPLEMENT_IMAP_FN_NEW(IMAP, VALUETYPE, FN_CPY_VAL, FN_CMP_VAL, FN_FREE_VAL); \
+IMPLEMENT_IMAP_FN_HELPERS(IMAP, VALUETYPE); \
+IMPLEMENT_IMAP_FN_CLEAR(IMAP, VALUETYPE); \
+IMPLEMENT_IMAP_FN_FREE(IMAP); \
+IMPLEMENT_IMAP_FN_ADD(IMAP, VALUETYPE); \
+IMPLEMENT_IMAP_FN_GET(IMAP, VALUETYPE); \
+IMPLEMENT_IMAP_FN_REMOVE(IMAP); \
+IMPLEMENT_IMAP_FN_SHRINK_TO_FIT(IMAP, VALUETYPE); \
+IMPLEMENT_IMAP_FN_FOR_EACH(IMAP, VALUETYPE)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __IMAP_H__
@@ -0,0 +1,601 @@
+/**
+ * @file intrusive.h
+ * @brief Intrusive list, queue and stack containers definition
+ * @details The links are embedded in the user structure (an
+ * Intrusive_link member), so inserting or removing an element never
+ * allocates nor copies anything. The containers do not own their
+ * elements: they are never freed by the container.
+ * A structure with several Intrusive_link members can be in several
+ * containers at the same time, one per member.
+ *
+ * Every container is a circular doubly linked list around a sentinel
+ * stored in the container itself, which makes the removal of an element
+ * O(1) from its pointer alone. As a consequence a container must not be
+ * moved in memory once initialized, and the links of a new element must
+ * be initialized (Intrusive_link_init, or a zeroed allocation).
+ * @author Baudouin FEILDEL
+ */
+#ifndef __INTRUSIVE_H__
+#define __INTRUSIVE_H__
+
+#include <stdlib.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ Get a pointer to the structure of type \c type containing \c ptr,
+ \c ptr being a pointer to its \c member field
+ */
+#ifndef container_of
+#define container_of(ptr, type, member) ((type *)((char *)(ptr) - offsetof(type, member)))
+#endif
+
+/**
+ Link embedded in an element of an intrusive container
+ */
+typedef struct Intrusive_link
+{
+	struct Intrusive_link * next; /**< Next link, NULL when not in a container */
+	struct Intrusive_link * prev; /**< Previous link, NULL when not in a container */
+} Intrusive_link;
+
+/**
+ Initialize a link that is in no container
+ @param link A pointer to a link
+ */
+static inline void Intrusive_link_init(Intrusive_link * link)
+{
+	link->next = NULL;
+	link->prev = NULL;
+}
+
+/**
+ Check if a link is in a container
+ @param link A pointer to a link
+ @return     1 if the link is in a container. 0 otherwise
+ */
+static inline int Intrusive_link_linked(const Intrusive_link * link)
+{
+	return link->next != NULL;
+}
+
+/* Insert link between prev and next */
+static inline void Intrusive_link_insert(Intrusive_link * link, Intrusive_link * prev, Intrusive_link * next)
+{
+	link->prev = prev;
+	link->next = next;
+	prev->next = link;
+	next->prev = link;
+}
+
+/* Remove link from its container and mark it unlinked */
+static inline void Intrusive_link_remove(Intrusive_link * link)
+{
+	link->prev->next = link->next;
+	link->next->prev = link->prev;
+	link->next = NULL;
+	link->prev = NULL;
+}
+
+/* Unlink every link of the ring of sentinel, then make it empty */
+static inline void Intrusive_link_clear(Intrusive_link * sentinel)
+{
+	Intrusive_link * it = sentinel->next, * next = NULL;
+	while(it != sentinel)
+	{
+		next = it->next;
+		Intrusive_link_init(it);
+		it = next;
+	}
+	sentinel->next = sentinel;
+	sentinel->prev = sentinel;
+}
+
+// =============
+//  Definitions
+// =============
+#define NEW_ILIST_TYPE(ILIST) \
+/**
+ Intrusive list
+ */ \
+typedef struct ILIST \
+{ \
+	Intrusive_link head; /**< Sentinel: head.next is the first element, head.prev the last one */\
+	int size;            /**< List size */\
+} ILIST
+
+#define ILIST_FN_NEW(ILIST) \
+/**
+ @brief Create a new ILIST object
+ @return A pointer to an allocated and initialized
+ ILIST object in memory
+ */ \
+ILIST * ILIST ## _new()
+
+#define ILIST_FN_INIT(ILIST) \
+/**
+ @brief Initialize an ILIST object allocated by the caller
+ @details Used for lists on the stack or embedded in another structure.
+ Such a list is released with ILIST_clear, not ILIST_free.
+ @param list A pointer to an ILIST object
+ @return     The pointer to the ILIST object
+ */ \
+ILIST * ILIST ## _init(ILIST * list)
+
+#define ILIST_FN_FREE(ILIST) \
+/**
+ Destroy an ILIST object
+ @details The elements are unlinked, not freed.
+ @param list A pointer to an ILIST object
+ */ \
+void ILIST ## _free(ILIST * list)
+
+#define ILIST_FN_CLEAR(ILIST) \
+/**
+ Unlink every element of a list
+ @details The elements are not freed.
+ @param list A pointer to a valid ILIST object
+ @return     The pointer to the ILIST object
+ */ \
+ILIST * ILIST ## _clear(ILIST * list)
+
+#define ILIST_FN_PUSH_FRONT(ILIST, Type) \
+/**
+ Insert an element at the beginning of the list
+ @param list A pointer to a valid ILIST object
+ @param elem The element to insert, not already in a list through this link
+ @return     The element
+ */ \
+Type * ILIST ## _pushFront(ILIST * list, Type * elem)
+
+#define ILIST_FN_PUSH_BACK(ILIST, Type) \
+/**
+ Insert an element at the end of the list
+ @param list A pointer to a valid ILIST object
+ @param elem The element to insert, not already in a list through this link
+ @return     The element
+ */ \
+Type * ILIST ## _pushBack(ILIST * list, Type * elem)
+
+#define ILIST_FN_INSERT_BEFORE(ILIST, Type) \
+/**
+ Insert an element before another one
+ @param list     A pointer to a valid ILIST object
+ @param position An element of the list. NULL to insert at the end
+ @param elem     The element to insert, not already in a list through this link
+ @return         The element
+ */ \
+Type * ILIST ## _insertBefore(ILIST * list, Type * position, Type * elem)
+
+#define ILIST_FN_REMOVE(ILIST, Type) \
+/**
+ Remove an element from the list in O(1)
+ @details The element is not freed.
+ @param list A pointer to a valid ILIST object
+ @param elem An element of the list
+ @return     The element
+ */ \
+Type * ILIST ## _remove(ILIST * list, Type * elem)
+
+#define ILIST_FN_POP_FRONT(ILIST, Type) \
+/**
+ Remove the first element of the list
+ @param list A pointer to a valid ILIST object
+ @return     The removed element. NULL if the list is empty
+ */ \
+Type * ILIST ## _popFront(ILIST * list)
+
+#define ILIST_FN_POP_BACK(ILIST, Type) \
+/**
+ Remove the last element of the list
+ @param list A pointer to a valid ILIST object
+ @return     The removed element. NULL if the list is empty
+ */ \
+Type * ILIST ## _popBack(ILIST * list)
+
+#define ILIST_FN_FIRST(ILIST, Type) \
+/**
+ Get the first element of the list
+ @param list A pointer to a valid ILIST object
+ @return     The first element. NULL if the list is empty
+ */ \
+Type * ILIST ## _first(ILIST * list)
+
+#define ILIST_FN_LAST(ILIST, Type) \
+/**
+ Get the last element of the list
+ @param list A pointer to a valid ILIST object
+ @return     The last element. NULL if the list is empty
+ */ \
+Type * ILIST ## _last(ILIST * list)
+
+#define ILIST_FN_NEXT(ILIST, Type) \
+/**
+ Get the element following another one
+ @param list A pointer to a valid ILIST object
+ @param elem An element of the list
+ @return     The next element. NULL if \c elem is the last one
+ */ \
+Type * ILIST ## _next(ILIST * list, Type * elem)
+
+#define ILIST_FN_PREV(ILIST, Type) \
+/**
+ Get the element preceding another one
+ @param list A pointer to a valid ILIST object
+ @param elem An element of the list
+ @return     The previous element. NULL if \c elem is the first one
+ */ \
+Type * ILIST ## _prev(ILIST * list, Type * elem)
+
+#define ILIST_FN_IS_LINKED(ILIST, Type) \
+/**
+ Check if an element is in a list through the link of this list type
+ @param elem A pointer to an element
+ @return     1 if the element is in a list. 0 otherwise
+ */ \
+int ILIST ## _isLinked(Type * elem)
+
+#define NEW_IQUEUE_TYPE(IQUEUE) \
+/**
+ Intrusive queue
+ */ \
+typedef struct IQUEUE \
+{ \
+	Intrusive_link head; /**< Sentinel: head.next is the head of the queue, head.prev its tail */\
+	int size;            /**< Queue size */\
+} IQUEUE
+
+#define IQUEUE_FN_NEW(IQUEUE) \
+/**
+ @brief Create a new IQUEUE object
+ @return A pointer to an allocated and initialized
+ IQUEUE object in memory
+ */ \
+IQUEUE * IQUEUE ## _new()
+
+#define IQUEUE_FN_INIT(IQUEUE) \
+/**
+ @brief Initialize an IQUEUE object allocated by the caller
+ @param queue A pointer to an IQUEUE object
+ @return      The pointer to the IQUEUE object
+ */ \
+IQUEUE * IQUEUE ## _init(IQUEUE * queue)
+
+#define IQUEUE_FN_FREE(IQUEUE) \
+/**
+ Destroy an IQUEUE object
+ @details The elements are unlinked, not freed.
+ @param queue A pointer to an IQUEUE object
+ */ \
+void IQUEUE ## _free(IQUEUE * queue)
+
+#define IQUEUE_FN_CLEAR(IQUEUE) \
+/**
+ Unlink every element of a queue
+ @param queue A pointer to a valid IQUEUE object
+ @return      The pointer to the IQUEUE object
+ */ \
+IQUEUE * IQUEUE ## _clear(IQUEUE * queue)
+
+#define IQUEUE_FN_ENQUEUE(IQUEUE, Type) \
+/**
+ Add an element at the end of the queue
+ @param queue A pointer to a valid IQUEUE object
+ @param elem  The element to add, not already in a queue through this link
+ @return      The element
+ */ \
+Type * IQUEUE ## _enqueue(IQUEUE * queue, Type * elem)
+
+#define IQUEUE_FN_DEQUEUE(IQUEUE, Type) \
+/**
+ Remove the element at the head of the queue
+ @param queue A pointer to a valid IQUEUE object
+ @return      The removed element. NULL if the queue is empty
+ */ \
+Type * IQUEUE ## _dequeue(IQUEUE * queue)
+
+#define IQUEUE_FN_HEAD(IQUEUE, Type) \
+/**
+ Get the element at the head of the queue
+ @param queue A pointer to a valid IQUEUE object
+ @return      The head element. NULL if the queue is empty
+ */ \
+Type * IQUEUE ## _head(IQUEUE * queue)
+
+#define IQUEUE_FN_REMOVE(IQUEUE, Type) \
+/**
+ Remove an element from anywhere in the queue in O(1)
+ @param queue A pointer to a valid IQUEUE object
+ @param elem  An element of the queue
+ @return      The element
+ */ \
+Type * IQUEUE ## _remove(IQUEUE * queue, Type * elem)
+
+#define IQUEUE_FN_IS_LINKED(IQUEUE, Type) \
+/**
+ Check if an element is in a queue through the link of this queue type
+ @param elem A pointer to an element
+ @return     1 if the element is in a queue. 0 otherwise
+ */ \
+int IQUEUE ## _isLinked(Type * elem)
+
+#define NEW_ISTACK_TYPE(ISTACK) \
+/**
+ Intrusive stack
+ */ \
+typedef struct ISTACK \
+{ \
+	Intrusive_link top; /**< Sentinel: top.next is the top of the stack */\
+	int size;           /**< Stack size */\
+} ISTACK
+
+#define ISTACK_FN_NEW(ISTACK) \
+/**
+ @brief Create a new ISTACK object
+ @return A pointer to an allocated and initialized ISTACK object in memory
+ */ \
+ISTACK * ISTACK ## _new()
+
+#define ISTACK_FN_INIT(ISTACK) \
+/**
+ @brief Initialize an ISTACK object allocated by the caller
+ @param stack A pointer to an ISTACK object
+ @return      The pointer to the ISTACK object
+ */ \
+ISTACK * ISTACK ## _init(ISTACK * stack)
+
+#define ISTACK_FN_FREE(ISTACK) \
+/**
+ Destroy an ISTACK object
+ @details The elements are unlinked, not freed.
+ @param stack A pointer to an ISTACK object
+ */ \
+void ISTACK ## _free(ISTACK * stack)
+
+#define ISTACK_FN_CLEAR(ISTACK) \
+/**
+ Unlink every element of a stack
+ @param stack A pointer to a valid ISTACK object
+ @return      The pointer to the ISTACK object
+ */ \
+ISTACK * ISTACK ## _clear(ISTACK * stack)
+
+#define ISTACK_FN_PUSH(ISTACK, Type) \
+/**
+ Push an element on the stack
+ @param stack A pointer to a valid ISTACK object
+ @param elem  The element to push, not already in a stack through this link
+ @return      The element
+ */ \
+Type * ISTACK ## _push(ISTACK * stack, Type * elem)
+
+#define ISTACK_FN_POP(ISTACK, Type) \
+/**
+ Pop the element on top of the stack
+ @param stack A pointer to a valid ISTACK object
+ @return      The removed element. NULL if the stack is empty
+ */ \
+Type * ISTACK ## _pop(ISTACK * stack)
+
+#define ISTACK_FN_PEEK(ISTACK, Type) \
+/**
+ Get the element on top of the stack
+ @param stack A pointer to a valid ISTACK object
+ @return      The top element. NULL if the stack is empty
+ */ \
+Type * ISTACK ## _peek(ISTACK * stack)
+
+#define ISTACK_FN_REMOVE(ISTACK, Type) \
+/**
+ Remove an element from anywhere in the stack in O(1)
+ @param stack A pointer to a valid ISTACK object
+ @param elem  An element of the stack
+ @return      The element
+ */ \
+Type * ISTACK ## _remove(ISTACK * stack, Type * elem)
+
+#define ISTACK_FN_IS_LINKED(ISTACK, Type) \
+/**
+ Check if an element is in a stack through the link of this stack type
+ @param elem A pointer to an element
+ @return     1 if the element is in a stack. 0 otherwise
+ */ \
+int ISTACK ## _isLinked(Type * elem)
+
+// =================
+//  Implementations
+// =================
+/* Common implementation of the three containers, SENTINEL is the name of the sentinel field */
+#define IMPLEMENT_INTRUSIVE_FN_NEW(CONTAINER, SENTINEL) \
+CONTAINER * CONTAINER ## _init(CONTAINER * container) \
+{ \
+	if(container == NULL) return NULL; \
+	container->SENTINEL.next = &(container->SENTINEL); \
+	container->SENTINEL.prev = &(container->SENTINEL); \
+	container->size = 0; \
+	return container; \
+} \
+CONTAINER * CONTAINER ## _new() \
+{ \
+	return CONTAINER ## _init(malloc(sizeof(CONTAINER))); \
+}
+
+#define IMPLEMENT_INTRUSIVE_FN_FREE(CONTAINER, SENTINEL) \
+CONTAINER * CONTAINER ## _clear(CONTAINER * container) \
+{ \
+	if(container == NULL) return NULL; \
+	Intrusive_link_clear(&(container->SENTINEL)); \
+	container->size = 0; \
+	return container; \
+} \
+void CONTAINER ## _free(CONTAINER * container) \
+{ \
+	if(container == NULL) return; \
+	CONTAINER ## _clear(container); \
+	free(container); \
+}
+
+#define IMPLEMENT_INTRUSIVE_FN_ACCESS(CONTAINER, SENTINEL, NAME, DIRECTION, Type, MEMBER) \
+Type * CONTAINER ## NAME(CONTAINER * container) \
+{ \
+	if(container == NULL || container->SENTINEL.DIRECTION == &(container->SENTINEL)) \
+		return NULL; \
+	return container_of(container->SENTINEL.DIRECTION, Type, MEMBER); \
+}
+
+#define IMPLEMENT_INTRUSIVE_FN_REMOVE(CONTAINER, Type, MEMBER) \
+Type * CONTAINER ## _remove(CONTAINER * container, Type * elem) \
+{ \
+	if(container == NULL || elem == NULL || !Intrusive_link_linked(&(elem->MEMBER))) \
+		return NULL; \
+	Intrusive_link_remove(&(elem->MEMBER)); \
+	container->size--; \
+	return elem; \
+} \
+int CONTAINER ## _isLinked(Type * elem) \
+{ \
+	return elem != NULL && Intrusive_link_linked(&(elem->MEMBER)); \
+}
+
+#define IMPLEMENT_INTRUSIVE_FN_POP(CONTAINER, SENTINEL, NAME, DIRECTION, Type, MEMBER) \
+Type * CONTAINER ## NAME(CONTAINER * container) \
+{ \
+	if(container == NULL || container->SENTINEL.DIRECTION == &(container->SENTINEL)) \
+		return NULL; \
+	return CONTAINER ## _remove(container, container_of(container->SENTINEL.DIRECTION, Type, MEMBER)); \
+}
+
+#define IMPLEMENT_ILIST_FN_INSERT(ILIST, Type, MEMBER) \
+Type * ILIST ## _insertBefore(ILIST * list, Type * position, Type * elem) \
+{ \
+	Intrusive_link * next = NULL; \
+	if(list == NULL || elem == NULL) return NULL; \
+	next = (position != NULL) ? &(position->MEMBER) : &(list->head); \
+	Intrusive_link_insert(&(elem->MEMBER), next->prev, next); \
+	list->size++; \
+	return elem; \
+} \
+Type * ILIST ## _pushFront(ILIST * list, Type * elem) \
+{ \
+	if(list == NULL || elem == NULL) return NULL; \
+	Intrusive_link_insert(&(elem->MEMBER), &(list->head), list->head.next); \
+	list->size++; \
+	return elem; \
+} \
+Type * ILIST ## _pushBack(ILIST * list, Type * elem) \
+{ \
+	return ILIST ## _insertBefore(list, NULL, elem); \
+}
+
+#define IMPLEMENT_ILIST_FN_ITERATE(ILIST, Type, MEMBER) \
+Type * ILIST ## _next(ILIST * list, Type * elem) \
+{ \
+	if(list == NULL || elem == NULL || elem->MEMBER.next == &(list->head)) \
+		return NULL; \
+	return container_of(elem->MEMBER.next, Type, MEMBER); \
+} \
+Type * ILIST ## _prev(ILIST * list, Type * elem) \
+{ \
+	if(list == NULL || elem == NULL || elem->MEMBER.prev == &(list->head)) \
+		return NULL; \
+	return container_of(elem->MEMBER.prev, Type, MEMBER); \
+}
+
+#define IMPLEMENT_IQUEUE_FN_ENQUEUE(IQUEUE, Type, MEMBER) \
+Type * IQUEUE ## _enqueue(IQUEUE * queue, Type * elem) \
+{ \
+	if(queue == NULL || elem == NULL) return NULL; \
+	Intrusive_link_insert(&(elem->MEMBER), queue->head.prev, &(queue->head)); \
+	queue->size++; \
+	return elem; \
+}
+
+#define IMPLEMENT_ISTACK_FN_PUSH(ISTACK, Type, MEMBER) \
+Type * ISTACK ## _push(ISTACK * stack, Type * elem) \
+{ \
+	if(stack == NULL || elem == NULL) return NULL; \
+	Intrusive_link_insert(&(elem->MEMBER), &(stack->top), stack->top.next); \
+	stack->size++; \
+	return elem; \
+}
+
+
+// MACRO HELPERS (One line definitions && implementations)
+#define NEW_ILIST_DEFINITION(ILIST, TYPE) \
+NEW_ILIST_TYPE(ILIST); \
+ILIST_FN_NEW(ILIST); \
+ILIST_FN_INIT(ILIST); \
+ILIST_FN_FREE(ILIST); \
+ILIST_FN_CLEAR(ILIST); \
+ILIST_FN_PUSH_FRONT(ILIST, TYPE); \
+ILIST_FN_PUSH_BACK(ILIST, TYPE); \
+ILIST_FN_INSERT_BEFORE(ILIST, TYPE); \
+ILIST_FN_REMOVE(ILIST, TYPE); \
+ILIST_FN_POP_FRONT(ILIST, TYPE); \
+ILIST_FN_POP_BACK(ILIST, TYPE); \
+ILIST_FN_FIRST(ILIST, TYPE); \
+ILIST_FN_LAST(ILIST, TYPE); \
+ILIST_FN_NEXT(ILIST, TYPE); \
+ILIST_FN_PREV(ILIST, TYPE); \
+ILIST_FN_IS_LINKED(ILIST, TYPE)
+
+/* MEMBER is the Intrusive_link field of TYPE used by the container */
+#define IMPLEMENT_ILIST(ILIST, TYPE, MEMBER) \
+IMPLEMENT_INTRUSIVE_FN_NEW(ILIST, head) \
+IMPLEMENT_INTRUSIVE_FN_FREE(ILIST, head) \
+IMPLEMENT_INTRUSIVE_FN_REMOVE(ILIST, TYPE, MEMBER) \
+IMPLEMENT_ILIST_FN_INSERT(ILIST, TYPE, MEMBER) \
+IMPLEMENT_INTRUSIVE_FN_POP(ILIST, head, _popFront, next, TYPE, MEMBER) \
+IMPLEMENT_INTRUSIVE_FN_POP(ILIST, head, _popBack, prev, TYPE, MEMBER) \
+IMPLEMENT_INTRUSIVE_FN_ACCESS(ILIST, head, _first, next, TYPE, MEMBER) \
+IMPLEMENT_INTRUSIVE_FN_ACCESS(ILIST, head, _last, prev, TYPE, MEMBER) \
+IMPLEMENT_ILIST_FN_ITERATE(ILIST, TYPE, MEMBER)
+
+#define NEW_IQUEUE_DEFINITION(IQUEUE, TYPE) \
+NEW_IQUEUE_TYPE(IQUEUE); \
+IQUEUE_FN_NEW(IQUEUE); \
+IQUEUE_FN_INIT(IQUEUE); \
+IQUEUE_FN_FREE(IQUEUE); \
+IQUEUE_FN_CLEAR(IQUEUE); \
+IQUEUE_FN_ENQUEUE(IQUEUE, TYPE); \
+IQUEUE_FN_DEQUEUE(IQUEUE, TYPE); \
+IQUEUE_FN_HEAD(IQUEUE, TYPE); \
+IQUEUE_FN_REMOVE(IQUEUE, TYPE); \
+IQUEUE_FN_IS_LINKED(IQUEUE, TYPE)
+
+#define IMPLEMENT_IQUEUE(IQUEUE, TYPE, MEMBER) \
+IMPLEMENT_INTRUSIVE_FN_NEW(IQUEUE, head) \
+IMPLEMENT_INTRUSIVE_FN_FREE(IQUEUE, head) \
+IMPLEMENT_INTRUSIVE_FN_REMOVE(IQUEUE, TYPE, MEMBER) \
+IMPLEMENT_IQUEUE_FN_ENQUEUE(IQUEUE, TYPE, MEMBER) \
+IMPLEMENT_INTRUSIVE_FN_POP(IQUEUE, head, _dequeue, next, TYPE, MEMBER) \
+IMPLEMENT_INTRUSIVE_FN_ACCESS(IQUEUE, head, _head, next, TYPE, MEMBER)
+
+#define NEW_ISTACK_DEFINITION(ISTACK, TYPE) \
+NEW_ISTACK_TYPE(ISTACK); \
+ISTACK_FN_NEW(ISTACK); \
+ISTACK_FN_INIT(ISTACK); \
+ISTACK_FN_FREE(ISTACK); \
+ISTACK_FN_CLEAR(ISTACK); \
+ISTACK_FN_PUSH(ISTACK, TYPE); \
+ISTACK_FN_POP(ISTACK, TYPE); \
+ISTACK_FN_PEEK(ISTACK, TYPE); \
+ISTACK_FN_REMOVE(ISTACK, TYPE); \
+ISTACK_FN_IS_LINKED(ISTACK, TYPE)
+
+#define IMPLEMENT_ISTACK(ISTACK, TYPE, MEMBER) \
+IMPLEMENT_INTRUSIVE_FN_NEW(ISTACK, top) \
+IMPLEMENT_INTRUSIVE_FN_FREE(ISTACK, top) \
+IMPLEMENT_INTRUSIVE_FN_REMOVE(ISTACK, TYPE, MEMBER) \
+IMPLEMENT_ISTACK_FN_PUSH(ISTACK, TYPE, MEMBER) \
+IMPLEMENT_INTRUSIVE_FN_POP(ISTACK, top, _pop, next, TYPE, MEMBER) \
+IMPLEMENT_INTRUSIVE_FN_ACCESS(ISTACK, top, _peek, next, TYPE, MEMBER)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __INTRUSIVE_H__
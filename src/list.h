@@ -7,11 +7,17 @@
 #define __LIST_H__
 
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/** Number of bits sorted by a pass of LIST_radixSort */
+#define LIST_RADIX_BITS    11
+#define LIST_RADIX_BUCKETS (1 << LIST_RADIX_BITS)
+
 // =============
 //  Definitions
 // =============
@@ -27,21 +33,47 @@ typedef struct _ ## ElemTypename \
 	struct _ ## ElemTypename * prev; /**< Pointer to the previous element in the list */\
 } ElemTypename
 
-#define NEW_LIST_TYPE(LIST, ValueType) \
+#define NEW_LIST_STRUCT(LIST, ValueType, InlineStorage) \
 NEW_LIST_ELEM(LIST, LIST ## _elem_t, ValueType); \
 typedef struct LIST \
 { \
 	LIST ## _elem_t * begin; /**< Beginning of the list */\
 	LIST ## _elem_t * end; /**< End of the list */\
 	int    size; /**< List size */\
+	LIST ## _elem_t * spare; /**< Unused elements kept for reuse, linked by next */\
+	int    spareCount; /**< Number of elements in spare */\
 	size_t elemSize; /**< Size of one element in the list */\
 	int    freeValue; /**< Flag:<br>1: Automatically free the value<br>0: Do not automatically free the value */\
 	void (*_copyValue) (ValueType * dest, ValueType * src); /**< Pointer to a function used to copy a value */\
 	int  (*_cmpValue)  (ValueType val1, ValueType val2); /**< Pointer to a function used to compare two values */\
 	void (*_freeValue) (ValueType value); /**< Pointer to a function used to free a value */\
 	void (*_print)     (ValueType value); /**< Pointer to a function used to print a value */\
+	LIST ## _elem_t * inlineElems; /**< Elements stored in the LIST object itself. NULL without inline storage */\
+	int    inlineCount; /**< Number of elements in inlineElems */\
+	InlineStorage \
 } LIST
 
+/* Inline storage of a LIST object, and whether an element belongs to it (not to free) */
+#define LIST_FN_INLINE_STORAGE(LIST, STORAGE, N) \
+static inline LIST ## _elem_t * LIST ## _inlineStorage(LIST * list, int * count) \
+{ \
+	(void)(list); \
+	*count = N; \
+	return STORAGE; \
+} \
+static inline int LIST ## _isInline(LIST * list, LIST ## _elem_t * elem) \
+{ \
+	return (uintptr_t)elem - (uintptr_t)list->inlineElems < (uintptr_t)list->inlineCount * sizeof(LIST ## _elem_t); \
+}
+
+#define NEW_LIST_TYPE(LIST, ValueType) \
+NEW_LIST_STRUCT(LIST, ValueType, ); \
+LIST_FN_INLINE_STORAGE(LIST, NULL, 0)
+
+#define NEW_LIST_SMALL_TYPE(LIST, ValueType, N) \
+NEW_LIST_STRUCT(LIST, ValueType, LIST ## _elem_t inlineStorage[N]; /**< Storage of the first N elements */); \
+LIST_FN_INLINE_STORAGE(LIST, list->inlineStorage, N)
+
 #define LIST_FN_NEW(LIST) \
 /**
  @brief Create a new LIST object
@@ -50,6 +82,18 @@ typedef struct LIST \
  */ \
 LIST * LIST ## _new()
 
+#define LIST_FN_INIT(LIST) \
+/**
+ @brief Initialize a LIST object in place
+ @details For a LIST object on the stack or inside another structure,
+ released by LIST_destroy. The object must not be copied or moved
+ afterwards: its inline storage (see NEW_LIST_SMALL_DEFINITION) is linked
+ to it.
+ @param list A pointer to the LIST object to initialize
+ @return     The pointer to the LIST object
+ */ \
+LIST * LIST ## _init(LIST * list)
+
 #define LIST_FN_FREE(LIST) \
 /**
  Destroy a LIST object
@@ -57,6 +101,14 @@ LIST * LIST ## _new()
  */ \
 void LIST ## _free(LIST * list)
 
+#define LIST_FN_DESTROY(LIST) \
+/**
+ Release the elements of a LIST object initialized by LIST_init
+ @details The LIST object itself is not freed.
+ @param list A pointer to a LIST object
+ */ \
+void LIST ## _destroy(LIST * list)
+
 #define LIST_FN_ADD_STRUCT(LIST, Valuetype) \
 /**
  Add an element to the list
@@ -106,6 +158,72 @@ LIST ## _elem_t * LIST ## _search(LIST * list, Valuetype search)
  */ \
 LIST * LIST ## _updateIndex(LIST * list)
 
+#define LIST_FN_SORT(LIST) \
+/**
+ Sort the elements of \c list by value
+ @details Stable bottom-up merge sort of the chain, using _cmpValue.
+ No element is allocated, copied or moved in memory: only the
+ next and prev pointers are relinked.
+
+ @param list        A pointer to a valid LIST object
+ @param updateIndex Flag:<br>1: Re-index the elements in their new order (see LIST_updateIndex)<br>0: Keep the indexes
+ @return            The pointer to the LIST object
+ */ \
+LIST * LIST ## _sort(LIST * list, int updateIndex)
+
+#define LIST_FN_SORT_BY_INDEX(LIST) \
+/**
+ Sort the elements of \c list by index
+ @details Stable bottom-up merge sort of the chain.
+
+ @param list A pointer to a valid LIST object
+ @return     The pointer to the LIST object
+ */ \
+LIST * LIST ## _sortByIndex(LIST * list)
+
+#define LIST_FN_RADIX_SORT(LIST) \
+/**
+ Sort the elements of \c list by value, for integer values only
+ @details Stable LSD radix sort of the chain on (value - minimum), one
+ pass per LIST_RADIX_BITS bits of the largest key: values spanning a
+ range of a million need two passes.
+ O(n) instead of O(n.log(n)), and no call to _cmpValue.
+ Not part of NEW_LIST_DEFINITION: declare it after the definition of
+ a list of integers (int, unsigned, long...) and implement it with
+ IMPLEMENT_LIST_FN_RADIX_SORT.
+
+ @param list        A pointer to a valid LIST object
+ @param updateIndex Flag:<br>1: Re-index the elements in their new order (see LIST_updateIndex)<br>0: Keep the indexes
+ @return            The pointer to the LIST object
+ */ \
+LIST * LIST ## _radixSort(LIST * list, int updateIndex)
+
+#define LIST_FN_CLEAR(LIST) \
+/**
+ Remove every element of the list
+ @details The elements are kept for the next insertions.
+ @param list A pointer to a valid LIST object
+ */ \
+void LIST ## _clear(LIST * list)
+
+#define LIST_FN_RESERVE(LIST) \
+/**
+ Allocate the elements for n elements
+ @details The list then holds n elements without allocating.
+ @param list A pointer to a valid LIST object
+ @param n    Number of elements to hold
+ */ \
+void LIST ## _reserve(LIST * list, int n)
+
+#define LIST_FN_SHRINK_TO_FIT(LIST) \
+/**
+ Release the elements kept for reuse
+ @details Elements left by LIST_clear and LIST_reserve are kept for the
+ next insertions until this call.
+ @param list A pointer to a valid LIST object
+ */ \
+void LIST ## _shrink_to_fit(LIST * list)
+
 /*
 #define LIST_FN_GET_PREVIOUS(LIST, Indextype) \
 LIST ## _elem_t LIST ## _find_previous(LIST * list, Indextype index)
@@ -122,31 +240,61 @@ void LIST ## _print(LIST * list)
 //  Implementations
 // =================
 #define IMPLEMENT_LIST_FN_NEW(LIST, Valuetype, FN_CPY_VAL, FN_CMP_VAL, FN_FREE_VAL, FN_PRINT_VAL) \
-LIST * LIST ## _new() \
+LIST * LIST ## _init(LIST * list) \
 { \
-	LIST * list = malloc(sizeof(LIST)); \
+	int i = 0; \
 	list->size  = 0; \
 	list->begin = NULL; \
 	list->end   = NULL; \
+	list->spare = NULL; \
+	list->spareCount = 0; \
 	list->elemSize   = sizeof(LIST ## _elem_t); \
 	list->freeValue  = 1; \
 	list->_copyValue = FN_CPY_VAL; \
 	list->_cmpValue  = FN_CMP_VAL; \
 	list->_freeValue = FN_FREE_VAL; \
 	list->_print     = FN_PRINT_VAL; \
+	/* The inline elements are the first spare ones */\
+	list->inlineElems = LIST ## _inlineStorage(list, &(list->inlineCount)); \
+	for(i = list->inlineCount - 1 ; i >= 0 ; i--) \
+	{ \
+		list->inlineElems[i].next = list->spare; \
+		list->spare = &(list->inlineElems[i]); \
+	} \
+	list->spareCount = list->inlineCount; \
 	return list; \
+} \
+LIST * LIST ## _new() \
+{ \
+	return LIST ## _init(malloc(sizeof(LIST))); \
 }
 
 #define IMPLEMENT_LIST_FN_FREE(LIST) \
-void LIST ## _free(LIST * list) \
+void LIST ## _destroy(LIST * list) \
 { \
-	LIST ## _elem_t * it = NULL; \
+	LIST ## _elem_t * it = NULL, * next = NULL; \
 	if(list == NULL) return; \
-	for(it = list->begin ; it != NULL ; it = it->next) \
+	for(it = list->begin ; it != NULL ; it = next) \
 	{ \
-		if(it->prev) free(it->prev); \
+		next = it->next; \
 		if(list->freeValue) list->_freeValue(it->value); \
+		if(!LIST ## _isInline(list, it)) free(it); \
+	} \
+	for(it = list->spare ; it != NULL ; it = next) \
+	{ \
+		next = it->next; \
+		if(!LIST ## _isInline(list, it)) free(it); \
 	} \
+	list->begin = NULL; \
+	list->end   = NULL; \
+	list->spare = NULL; \
+	list->size  = 0; \
+	list->spareCount = 0; \
+} \
+void LIST ## _free(LIST * list) \
+{ \
+	if(list == NULL) return; \
+	LIST ## _destroy(list); \
 	free(list); \
 }
 
@@ -165,8 +313,14 @@ LIST ## _elem_t * LIST ## _add(LIST * list, unsigned int index, Valuetype value)
 		list->_copyValue(&(elem->value), &(value)); \
 		return elem; \
 	} \
-	/* Create the element */\
-	elem = malloc(list->elemSize); \
+	/* Create the element, reusing a spare one */\
+	if((elem = list->spare) != NULL) \
+	{ \
+		list->spare = elem->next; \
+		list->spareCount--; \
+	} \
+	else \
+		elem = malloc(list->elemSize); \
 	elem->prev = NULL; \
 	elem->next = NULL; \
 	elem->index = index; \
@@ -197,9 +351,19 @@ LIST * LIST ## _remove(LIST * list, unsigned int index) \
 	if(elem != NULL) \
 	{ \
 		if(list->freeValue) list->_freeValue(elem->value); \
-		elem->prev->next = elem->next; \
-		elem->next->prev = elem->prev; \
-		free(elem); \
+		if(elem->prev != NULL) elem->prev->next = elem->next; \
+		else                   list->begin      = elem->next; \
+		if(elem->next != NULL) elem->next->prev = elem->prev; \
+		else                   list->end        = elem->prev; \
+		/* Inline elements go back to spare, the others are freed */\
+		if(LIST ## _isInline(list, elem)) \
+		{ \
+			elem->next  = list->spare; \
+			list->spare = elem; \
+			list->spareCount++; \
+		} \
+		else \
+			free(elem); \
 		list->size--; \
 	} \
 	return list; \
@@ -270,6 +434,192 @@ LIST * LIST ## _updateIndex(LIST * list) \
 	return list; \
 }
 
+/* Internal helpers: merge two sorted chains, relink prev pointers */
+#define IMPLEMENT_LIST_FN_SORT_HELPERS(LIST) \
+static LIST ## _elem_t * LIST ## _merge(LIST * list, LIST ## _elem_t * left, LIST ## _elem_t * right, int byIndex) \
+{ \
+	LIST ## _elem_t head; \
+	LIST ## _elem_t * tail = &head; \
+	int rightFirst = 0; \
+	while(left != NULL && right != NULL) \
+	{ \
+		/* Take left on ties: the sort is stable */\
+		if(byIndex) rightFirst = right->index < left->index; \
+		else        rightFirst = list->_cmpValue(right->value, left->value) < 0; \
+		if(rightFirst) { tail->next = right; right = right->next; } \
+		else           { tail->next = left;  left  = left->next;  } \
+		tail = tail->next; \
+	} \
+	tail->next = (left != NULL) ? left : right; \
+	return head.next; \
+} \
+static void LIST ## _relink(LIST * list, LIST ## _elem_t * first, int updateIndex) \
+{ \
+	LIST ## _elem_t * it = NULL, * prev = NULL; \
+	unsigned int index = 0; \
+	list->begin = first; \
+	for(it = first ; it != NULL ; it = it->next) \
+	{ \
+		it->prev = prev; \
+		if(updateIndex) it->index = index++; \
+		prev = it; \
+	} \
+	list->end = prev; \
+} \
+static LIST * LIST ## _mergeSort(LIST * list, int byIndex, int updateIndex) \
+{ \
+	/* bins[i] holds a sorted chain of 2^i elements, older than lower bins */\
+	LIST ## _elem_t * bins[64]; \
+	LIST ## _elem_t * it = NULL, * next = NULL, * carry = NULL; \
+	int i = 0, used = 0; \
+	if(list == NULL) return NULL; \
+	for(it = list->begin ; it != NULL ; it = next) \
+	{ \
+		next = it->next; \
+		it->next = NULL; \
+		carry = it; \
+		for(i = 0 ; i < used && bins[i] != NULL ; i++) \
+		{ \
+			carry = LIST ## _merge(list, bins[i], carry, byIndex); \
+			bins[i] = NULL; \
+		} \
+		if(i == used) used++; \
+		bins[i] = carry; \
+	} \
+	carry = NULL; \
+	for(i = 0 ; i < used ; i++) \
+	{ \
+		if(bins[i] != NULL) \
+			carry = LIST ## _merge(list, bins[i], carry, byIndex); \
+	} \
+	LIST ## _relink(list, carry, updateIndex); \
+	return list; \
+}
+
+#define IMPLEMENT_LIST_FN_SORT(LIST) \
+LIST * LIST ## _sort(LIST * list, int updateIndex) \
+{ \
+	return LIST ## _mergeSort(list, 0, updateIndex); \
+}
+
+#define IMPLEMENT_LIST_FN_SORT_BY_INDEX(LIST) \
+LIST * LIST ## _sortByIndex(LIST * list) \
+{ \
+	return LIST ## _mergeSort(list, 1, 0); \
+}
+
+/* Valuetype must be an integer type */
+#define IMPLEMENT_LIST_FN_RADIX_SORT(LIST, Valuetype) \
+LIST * LIST ## _radixSort(LIST * list, int updateIndex) \
+{ \
+	LIST ## _elem_t * heads[LIST_RADIX_BUCKETS]; \
+	LIST ## _elem_t * tails[LIST_RADIX_BUCKETS]; \
+	LIST ## _elem_t * it = NULL, * first = NULL, * last = NULL; \
+	unsigned long long range = 0, digit = 0; \
+	unsigned int shift = 0, index = 0; \
+	int lastPass = 0; \
+	Valuetype min, max; \
+	if(list == NULL)        return NULL; \
+	if(list->begin == NULL) return list; \
+	/* Sort the keys (value - min): small ranges need fewer passes */\
+	min = list->begin->value; \
+	max = list->begin->value; \
+	for(it = list->begin ; it != NULL ; it = it->next) \
+	{ \
+		if(it->value < min) min = it->value; \
+		if(it->value > max) max = it->value; \
+	} \
+	range = (unsigned long long)(long long)max - (unsigned long long)(long long)min; \
+	first = list->begin; \
+	for(shift = 0 ; shift == 0 || (shift < 64 && (range >> shift) != 0) ; shift += LIST_RADIX_BITS) \
+	{ \
+		/* The last pass also rebuilds the prev links inside the buckets */\
+		lastPass = (shift + LIST_RADIX_BITS >= 64 || (range >> (shift + LIST_RADIX_BITS)) == 0); \
+		memset(heads, 0, sizeof(heads)); \
+		for(it = first ; it != NULL ; it = it->next) \
+		{ \
+			digit = (((unsigned long long)(long long)it->value - (unsigned long long)(long long)min) >> shift) & (LIST_RADIX_BUCKETS - 1); \
+			if(heads[digit] == NULL) heads[digit] = it; \
+			else                     tails[digit]->next = it; \
+			if(lastPass) it->prev = tails[digit]; \
+			tails[digit] = it; \
+		} \
+		/* Concatenate the buckets */\
+		first = NULL; \
+		last  = NULL; \
+		for(digit = 0 ; digit < LIST_RADIX_BUCKETS ; digit++) \
+		{ \
+			if(heads[digit] == NULL) continue; \
+			if(last == NULL) first = heads[digit]; \
+			else             last->next = heads[digit]; \
+			if(lastPass) heads[digit]->prev = last; \
+			last = tails[digit]; \
+		} \
+		last->next = NULL; \
+	} \
+	list->begin = first; \
+	list->end   = last; \
+	if(updateIndex) \
+		for(it = first ; it != NULL ; it = it->next) \
+			it->index = index++; \
+	return list; \
+}
+
+#define IMPLEMENT_LIST_FN_CLEAR(LIST) \
+void LIST ## _clear(LIST * list) \
+{ \
+	LIST ## _elem_t * it = NULL; \
+	if(list == NULL || list->begin == NULL) return; \
+	if(list->freeValue) \
+		for(it = list->begin ; it != NULL ; it = it->next) \
+			list->_freeValue(it->value); \
+	/* Put the whole chain in front of spare */\
+	list->end->next  = list->spare; \
+	list->spare      = list->begin; \
+	list->spareCount += list->size; \
+	list->begin = NULL; \
+	list->end   = NULL; \
+	list->size  = 0; \
+}
+
+#define IMPLEMENT_LIST_FN_RESERVE(LIST) \
+void LIST ## _reserve(LIST * list, int n) \
+{ \
+	LIST ## _elem_t * elem = NULL; \
+	if(list == NULL) return; \
+	while(list->size + list->spareCount < n) \
+	{ \
+		if((elem = malloc(list->elemSize)) == NULL) \
+			return; \
+		elem->next  = list->spare; \
+		list->spare = elem; \
+		list->spareCount++; \
+	} \
+}
+
+#define IMPLEMENT_LIST_FN_SHRINK_TO_FIT(LIST) \
+void LIST ## _shrink_to_fit(LIST * list) \
+{ \
+	LIST ## _elem_t * it = NULL, * next = NULL; \
+	if(list == NULL) return; \
+	it = list->spare; \
+	list->spare      = NULL; \
+	list->spareCount = 0; \
+	for( ; it != NULL ; it = next) \
+	{ \
+		next = it->next; \
+		if(!LIST ## _isInline(list, it)) \
+		{ \
+			free(it); \
+			continue; \
+		} \
+		/* Inline elements stay spare */\
+		it->next    = list->spare; \
+		list->spare = it; \
+		list->spareCount++; \
+	} \
+}
+
 #ifdef CCONTAINERS_DISABLE_PRINT
 #define IMPLEMENT_LIST_FN_PRINT(LIST) \
 void LIST ## _print(LIST * list) \
@@ -296,13 +646,28 @@ void LIST ## _print(LIST * list) \
 // MACRO HELPERS (One line definitions && implementations)
 #define NEW_LIST_DEFINITION(LIST, VALUETYPE) \
 NEW_LIST_TYPE(LIST, VALUETYPE); \
+NEW_LIST_FUNCTIONS(LIST, VALUETYPE)
+
+/* LIST holding its first N elements: they cost no allocation */
+#define NEW_LIST_SMALL_DEFINITION(LIST, VALUETYPE, N) \
+NEW_LIST_SMALL_TYPE(LIST, VALUETYPE, N); \
+NEW_LIST_FUNCTIONS(LIST, VALUETYPE)
+
+#define NEW_LIST_FUNCTIONS(LIST, VALUETYPE) \
 LIST_FN_NEW(LIST); \
+LIST_FN_INIT(LIST); \
 LIST_FN_FREE(LIST); \
+LIST_FN_DESTROY(LIST); \
 LIST_FN_ADD_STRUCT(LIST, VALUETYPE); \
 LIST_FN_REMOVE_STRUCT(LIST); \
 LIST_FN_GET_STRUCT(LIST); \
 LIST_FN_SEARCH_STRUCT(LIST, VALUETYPE); \
 LIST_FN_UPDATE_IDX(LIST); \
+LIST_FN_SORT(LIST); \
+LIST_FN_SORT_BY_INDEX(LIST); \
+LIST_FN_CLEAR(LIST); \
+LIST_FN_RESERVE(LIST); \
+LIST_FN_SHRINK_TO_FIT(LIST); \
 LIST_FN_PRINT_STRUCT(LIST)
 
 #define IMPLEMENT_LIST(LIST, VALUETYPE, FN_CPY_VAL, FN_CMP_VAL, FN_FREE_VAL, FN_PRINT_VAL) \
@@ -313,6 +678,12 @@ IMPLEMENT_LIST_FN_REMOVE_STRUCT(LIST); \
 IMPLEMENT_LIST_FN_GET_STRUCT(LIST); \
 IMPLEMENT_LIST_FN_SEARCH_STRUCT(LIST, VALUETYPE); \
 IMPLEMENT_LIST_FN_UPDATE_IDX(LIST); \
+IMPLEMENT_LIST_FN_SORT_HELPERS(LIST); \
+IMPLEMENT_LIST_FN_SORT(LIST); \
+IMPLEMENT_LIST_FN_SORT_BY_INDEX(LIST); \
+IMPLEMENT_LIST_FN_CLEAR(LIST); \
+IMPLEMENT_LIST_FN_RESERVE(LIST); \
+IMPLEMENT_LIST_FN_SHRINK_TO_FIT(LIST); \
 IMPLEMENT_LIST_FN_PRINT(LIST)
 
 
@@ -7,6 +7,9 @@
 #define __MAP_H__
 
 #include <stdlib.h>
+#include <stdint.h>
+
+#include "filter.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -34,6 +37,8 @@ typedef struct MAP \
 	MAP ## _elem_t * begin; /**< Beginning of the map */\
 	MAP ## _elem_t * end;   /**< End of the map */\
 	int    size; /**< Map size */\
+	MAP ## _elem_t * spare; /**< Unused elements kept for reuse, linked by next */\
+	int    spareCount; /**< Number of elements in spare */\
 	size_t elemSize; /**< Size of one element in the map */\
 	int    freeValue; /**< Flag:<br>1: Automatically free the value<br>0: Do not automatically free the value */\
 	int    freeIndex; /**< Flag:<br>1: Automatically free the index<br>0: Do not automatically free the index */\
@@ -43,6 +48,8 @@ typedef struct MAP \
 	int (*_cmpIndex)(Indextype val1, Indextype val2); /**< Pointer to a function used to compare two indexes */\
 	void (*_freeValue)(Valuetype value); /**< Pointer to a function used to free a value */\
 	void (*_freeIndex)(Indextype index); /**< Pointer to a function used to free an index */\
+	CuckooFilter * filter; /**< Filter answering the lookups of absent indexes. NULL if none is attached */\
+	uint64_t (*_hashIndex)(Indextype index); /**< Pointer to a function used to hash an index for the filter */\
 } MAP
 
 #define MAP_FN_NEW(MAP) \
@@ -64,7 +71,7 @@ void MAP ## _free(MAP * map)
 /**
  Add an element to the map
  @details If an element already have this index
- its value will be updated.
+ it is returned unchanged.
  
  @param map   The map to use
  @param index The index of the element to add
@@ -100,6 +107,47 @@ MAP ## _elem_t * MAP ## _get(MAP * map, Indextype index)
  */ \
 MAP ## _elem_t * MAP ## _search(MAP * map, Valuetype search)
 
+#define MAP_FN_ATTACH_FILTER_STRUCT(MAP, Indextype) \
+/**
+ Attach a cuckoo filter to a map
+ @details The filter holds a fingerprint of every index of the map.
+ MAP_get and MAP_add answer most lookups of absent indexes from the
+ filter alone, without walking the map. The filter grows with the map.
+
+ @param map  A pointer to a valid MAP object
+ @param hash Function used to hash the indexes (Int_hash, Str_hash...).
+ NULL to detach the filter
+ @return     The pointer to the MAP object
+ */ \
+MAP * MAP ## _attachFilter(MAP * map, uint64_t (*hash)(Indextype index))
+
+#define MAP_FN_CLEAR(MAP) \
+/**
+ Remove every element of the map
+ @details The elements and the filter are kept for the next insertions.
+ @param map A pointer to a valid MAP object
+ */ \
+void MAP ## _clear(MAP * map)
+
+#define MAP_FN_RESERVE(MAP) \
+/**
+ Allocate the elements for n elements
+ @details The map then holds n elements without allocating, an attached
+ filter is grown to n elements.
+ @param map A pointer to a valid MAP object
+ @param n   Number of elements to hold
+ */ \
+void MAP ## _reserve(MAP * map, int n)
+
+#define MAP_FN_SHRINK_TO_FIT(MAP) \
+/**
+ Release the elements kept for reuse and shrink an attached filter
+ @details Elements left by MAP_clear and MAP_reserve are kept for the
+ next insertions until this call.
+ @param map A pointer to a valid MAP object
+ */ \
+void MAP ## _shrink_to_fit(MAP * map)
+
 /*
 #define MAP_FN_GET_PREVIOUS(MAP, Indextype) \
 MAP ## _elem_t MAP ## _find_previous(MAP * map, Indextype index)
@@ -115,6 +163,8 @@ MAP * MAP ## _new() \
 	map->size  = 0; \
 	map->begin = NULL; \
 	map->end   = NULL; \
+	map->spare = NULL; \
+	map->spareCount = 0; \
 	map->elemSize   = sizeof(MAP ## _elem_t); \
 	map->freeValue  = 1; \
 	map->freeIndex  = 1; \
@@ -124,20 +174,29 @@ MAP * MAP ## _new() \
 	map->_cmpIndex  = FN_CMP_IDX; \
 	map->_freeValue = FN_FREE_VAL; \
 	map->_freeIndex = FN_FREE_IDX; \
+	map->filter     = NULL; \
+	map->_hashIndex = NULL; \
 	return map; \
 }
 
 #define IMPLEMENT_MAP_FN_FREE(MAP) \
 void MAP ## _free(MAP * map) \
 { \
-	MAP ## _elem_t * it; \
+	MAP ## _elem_t * it = NULL, * next = NULL; \
 	if(map == NULL) return; \
-	for(it = map->begin ; it != NULL ; it = it->next) \
+	for(it = map->begin ; it != NULL ; it = next) \
 	{ \
-		if(it->prev) free(it->prev); \
+		next = it->next; \
 		if(map->freeValue) map->_freeValue(it->value); \
 		if(map->freeIndex) map->_freeIndex(it->index); \
+		free(it); \
 	} \
+	for(it = map->spare ; it != NULL ; it = next) \
+	{ \
+		next = it->next; \
+		free(it); \
+	} \
+	CuckooFilter_free(map->filter); \
 	free(map); \
 }
 
@@ -152,8 +211,14 @@ MAP ## _elem_t * MAP ## _add(MAP * map, Indextype index, Valuetype value) \
 	elem = MAP ## _get(map, index);\
 	if(elem != NULL) \
 		return elem; \
-	/* Create the element */\
-	elem = malloc(map->elemSize); \
+	/* Create the element, reusing a spare one */\
+	if((elem = map->spare) != NULL) \
+	{ \
+		map->spare = elem->next; \
+		map->spareCount--; \
+	} \
+	else \
+		elem = malloc(map->elemSize); \
 	elem->prev = NULL; \
 	elem->next = NULL; \
 	map->_copyIndex(&(elem->index), &(index)); \
@@ -171,6 +236,9 @@ MAP ## _elem_t * MAP ## _add(MAP * map, Indextype index, Valuetype value) \
 		elem->prev = map->end; \
 		map->end = elem; \
 	} \
+	/* A full filter is rebuilt twice larger, from the map including elem */\
+	if(map->filter != NULL && !CuckooFilter_add(map->filter, map->_hashIndex(elem->index))) \
+		MAP ## _rebuildFilter(map, map->filter->bucketCount * 8); \
 	return elem; \
 }
 
@@ -181,13 +249,16 @@ MAP * MAP ## _remove(MAP * map, Indextype index) \
 	MAP ## _elem_t * elem = MAP ## _get(map, index); \
 	if(elem != NULL) \
 	{ \
+		if(map->filter != NULL) CuckooFilter_remove(map->filter, map->_hashIndex(elem->index)); \
 		if(map->freeValue) map->_freeValue(elem->value); \
 		if(map->freeIndex) map->_freeIndex(elem->index); \
-		elem->prev->next = elem->next; \
-		elem->next->prev = elem->prev; \
+		if(elem->prev != NULL) elem->prev->next = elem->next; \
+		else                   map->begin       = elem->next; \
+		if(elem->next != NULL) elem->next->prev = elem->prev; \
+		else                   map->end         = elem->prev; \
 		free(elem); \
+		map->size--; \
 	} \
-	map->size--; \
 	return map; \
 }
 
@@ -200,6 +271,8 @@ MAP ## _elem_t * MAP ## _get(MAP * map, Indextype index) \
 	/* Check empty map */ \
 	if(map == NULL)        return NULL; \
 	if(map->begin == NULL) return NULL; \
+	if(map->filter != NULL && !CuckooFilter_contains(map->filter, map->_hashIndex(index))) \
+		return NULL; \
 	/* Start search */ \
 	it = map->begin; \
 	while(it != NULL) \
@@ -239,6 +312,95 @@ MAP ## _elem_t * MAP ## _search(MAP * map, Valuetype search) \
 	return out; \
 }
 
+/* Internal helper: replace the filter by one of the given capacity, filled from the map */
+#define IMPLEMENT_MAP_FN_FILTER_HELPERS(MAP) \
+static void MAP ## _rebuildFilter(MAP * map, size_t capacity) \
+{ \
+	MAP ## _elem_t * it = NULL; \
+	CuckooFilter_free(map->filter); \
+	map->filter = CuckooFilter_new(capacity); \
+	for(it = map->begin ; it != NULL ; it = it->next) \
+	{ \
+		if(!CuckooFilter_add(map->filter, map->_hashIndex(it->index))) \
+		{ \
+			MAP ## _rebuildFilter(map, capacity * 2); \
+			return; \
+		} \
+	} \
+}
+
+#define IMPLEMENT_MAP_FN_ATTACH_FILTER_STRUCT(MAP, Indextype) \
+MAP * MAP ## _attachFilter(MAP * map, uint64_t (*hash)(Indextype index)) \
+{ \
+	if(map == NULL) return NULL; \
+	map->_hashIndex = hash; \
+	if(hash == NULL) \
+	{ \
+		CuckooFilter_free(map->filter); \
+		map->filter = NULL; \
+		return map; \
+	} \
+	MAP ## _rebuildFilter(map, (map->size < 1024) ? 1024 : map->size * 2); \
+	return map; \
+}
+
+#define IMPLEMENT_MAP_FN_CLEAR(MAP) \
+void MAP ## _clear(MAP * map) \
+{ \
+	MAP ## _elem_t * it = NULL; \
+	if(map == NULL || map->begin == NULL) return; \
+	for(it = map->begin ; it != NULL ; it = it->next) \
+	{ \
+		if(map->freeValue) map->_freeValue(it->value); \
+		if(map->freeIndex) map->_freeIndex(it->index); \
+	} \
+	/* Put the whole chain in front of spare */\
+	map->end->next  = map->spare; \
+	map->spare      = map->begin; \
+	map->spareCount += map->size; \
+	map->begin = NULL; \
+	map->end   = NULL; \
+	map->size  = 0; \
+	if(map->filter != NULL) \
+		CuckooFilter_clear(map->filter); \
+}
+
+#define IMPLEMENT_MAP_FN_RESERVE(MAP) \
+void MAP ## _reserve(MAP * map, int n) \
+{ \
+	MAP ## _elem_t * elem = NULL; \
+	if(map == NULL) return; \
+	while(map->size + map->spareCount < n) \
+	{ \
+		if((elem = malloc(map->elemSize)) == NULL) \
+			return; \
+		elem->next = map->spare; \
+		map->spare = elem; \
+		map->spareCount++; \
+	} \
+	if(map->filter != NULL && map->filter->bucketCount * 4 * 95 / 100 < (size_t)n) \
+		MAP ## _rebuildFilter(map, n); \
+}
+
+#define IMPLEMENT_MAP_FN_SHRINK_TO_FIT(MAP) \
+void MAP ## _shrink_to_fit(MAP * map) \
+{ \
+	MAP ## _elem_t * it = NULL, * next = NULL; \
+	size_t capacity = 0; \
+	if(map == NULL) return; \
+	for(it = map->spare ; it != NULL ; it = next) \
+	{ \
+		next = it->next; \
+		free(it); \
+	} \
+	map->spare      = NULL; \
+	map->spareCount = 0; \
+	/* Same sizing as MAP_attachFilter */\
+	capacity = (map->size < 1024) ? 1024 : (size_t)map->size * 2; \
+	if(map->filter != NULL && map->filter->bucketCount * 4 > capacity * 2) \
+		MAP ## _rebuildFilter(map, capacity); \
+}
+
 // MACRO HELPERS (One line definitions && implementations)
 #define NEW_MAP_DEFINITION(MAP, VALUETYPE, INDEXTYPE) \
 NEW_MAP_TYPE(MAP, VALUETYPE, INDEXTYPE); \
@@ -247,15 +409,24 @@ MAP_FN_FREE(MAP); \
 MAP_FN_ADD_STRUCT(MAP, VALUETYPE, INDEXTYPE); \
 MAP_FN_REMOVE_STRUCT(MAP, INDEXTYPE); \
 MAP_FN_GET_STRUCT(MAP, INDEXTYPE); \
-MAP_FN_SEARCH_STRUCT(MAP, VALUETYPE)
+MAP_FN_SEARCH_STRUCT(MAP, VALUETYPE); \
+MAP_FN_ATTACH_FILTER_STRUCT(MAP, INDEXTYPE); \
+MAP_FN_CLEAR(MAP); \
+MAP_FN_RESERVE(MAP); \
+MAP_FN_SHRINK_TO_FIT(MAP)
 
 #define IMPLEMENT_MAP(MAP, VALUETYPE, INDEXTYPE, FN_CPY_VAL, FN_CPY_IDX, FN_CMP_VAL, FN_CMP_IDX, FN_FREE_VAL, FN_FREE_IDX) \
 IMPLEMENT_MAP_FN_NEW(MAP, VALUETYPE, INDEXTYPE, FN_CPY_VAL, FN_CPY_IDX, FN_CMP_VAL, FN_CMP_IDX, FN_FREE_VAL, FN_FREE_IDX); \
 IMPLEMENT_MAP_FN_FREE(MAP); \
+IMPLEMENT_MAP_FN_FILTER_HELPERS(MAP); \
 IMPLEMENT_MAP_FN_ADD_STRUCT(MAP, VALUETYPE, INDEXTYPE); \
 IMPLEMENT_MAP_FN_REMOVE_STRUCT(MAP, INDEXTYPE); \
 IMPLEMENT_MAP_FN_GET_STRUCT(MAP, INDEXTYPE); \
-IMPLEMENT_MAP_FN_SEARCH_STRUCT(MAP, VALUETYPE) \
+IMPLEMENT_MAP_FN_SEARCH_STRUCT(MAP, VALUETYPE); \
+IMPLEMENT_MAP_FN_ATTACH_FILTER_STRUCT(MAP, INDEXTYPE); \
+IMPLEMENT_MAP_FN_CLEAR(MAP); \
+IMPLEMENT_MAP_FN_RESERVE(MAP); \
+IMPLEMENT_MAP_FN_SHRINK_TO_FIT(MAP)
 
 #ifdef __cplusplus
 }
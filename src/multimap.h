@@ -0,0 +1,507 @@
+/**
+ * @file multimap.h
+ * @brief Multimap container definition
+ * @details A hash map where an index holds any number of values.
+ * Every index is stored once, in a chained bucket, with its values in a
+ * contiguous array (in insertion order): MMAP_get_all returns them as a
+ * range without walking a chain per value, and MMAP_count is a lookup.
+ *
+ * MMAP_clear keeps the elements and their value arrays for the next
+ * insertions until MMAP_shrink_to_fit. Removing an index frees them.
+ * @author Baudouin FEILDEL
+ */
+#ifndef __MMAP_H__
+#define __MMAP_H__
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Average number of indexes per bucket before the map grows */
+#ifndef MMAP_MAX_LOAD
+#define MMAP_MAX_LOAD 1
+#endif
+
+// =============
+//  Definitions
+// =============
+#define NEW_MMAP_ELEM(MMAP, ElemTypename, Valuetype, Indextype) \
+/**
+ Index of a MMAP object and its values
+ */ \
+typedef struct _ ## ElemTypename \
+{ \
+	Indextype   index;    /**< Index of the element */\
+	uint64_t    hash;     /**< Hash of the index */\
+	Valuetype * values;   /**< Values of the index, in insertion order */\
+	int         count;    /**< Number of values */\
+	int         capacity; /**< Number of allocated values */\
+	struct _ ## ElemTypename * next; /**< Pointer to the next element in the bucket */\
+} ElemTypename
+
+#define NEW_MMAP_TYPE(MMAP, Valuetype, Indextype) \
+NEW_MMAP_ELEM(MMAP, MMAP ## _elem_t, Valuetype, Indextype); \
+typedef struct MMAP \
+{ \
+	MMAP ## _elem_t ** buckets; /**< Hash buckets */\
+	int    bucketCount;         /**< Number of buckets, a power of two */\
+	int    keys;                /**< Number of distinct indexes in the map */\
+	int    size;                /**< Number of values in the map */\
+	MMAP ## _elem_t * spare;    /**< Unused elements kept for reuse, linked by next */\
+	int    spareCount;          /**< Number of elements in spare */\
+	size_t elemSize;   /**< Size of one element in the map */\
+	int    freeValue;  /**< Flag:<br>1: Automatically free the value<br>0: Do not automatically free the value */\
+	int    freeIndex;  /**< Flag:<br>1: Automatically free the index<br>0: Do not automatically free the index */\
+	void (*_copyValue)(Valuetype * dest, Valuetype * src); /**< Pointer to a function used to copy a value */\
+	void (*_copyIndex)(Indextype * dest, Indextype * src); /**< Pointer to a function used to copy an index */\
+	int (*_cmpValue)(Valuetype val1, Valuetype val2); /**< Pointer to a function used to compare two values */\
+	int (*_cmpIndex)(Indextype val1, Indextype val2); /**< Pointer to a function used to compare two indexes */\
+	void (*_freeValue)(Valuetype value); /**< Pointer to a function used to free a value */\
+	void (*_freeIndex)(Indextype index); /**< Pointer to a function used to free an index */\
+	uint64_t (*_hashIndex)(Indextype index); /**< Pointer to a function used to hash an index */\
+} MMAP
+
+#define MMAP_FN_NEW(MMAP) \
+/**
+ @brief Create a new MMAP object
+ @return A pointer to an allocated and initialized
+ MMAP object in memory
+ */ \
+MMAP * MMAP ## _new()
+
+#define MMAP_FN_FREE(MMAP) \
+/**
+ Destroy a MMAP object
+ @param map A pointer to a MMAP object
+ */ \
+void MMAP ## _free(MMAP * map)
+
+#define MMAP_FN_ADD_STRUCT(MMAP, Valuetype, Indextype) \
+/**
+ Add a value to an index
+ @details The value is appended after the values already
+ held by the index, even if one of them is equal.
+
+ @param map   A pointer to a valid MMAP object
+ @param index The index of the value
+ @param value The value to add
+ @return      Number of values of the index after the insertion
+ */ \
+int MMAP ## _add(MMAP * map, Indextype index, Valuetype value)
+
+#define MMAP_FN_GET_ALL_STRUCT(MMAP, Valuetype, Indextype) \
+/**
+ Get every value of an index
+ @param map   A pointer to a valid MMAP object
+ @param index The index of the values to get
+ @param count Receives the number of values. May be NULL
+ @return      A pointer to the first value, followed by the others in
+ insertion order. Valid until the next _add or _remove_* on this index.
+ NULL if the index is not present
+ */ \
+Valuetype * MMAP ## _get_all(MMAP * map, Indextype index, int * count)
+
+#define MMAP_FN_COUNT_STRUCT(MMAP, Indextype) \
+/**
+ Count the values of an index
+ @param map   A pointer to a valid MMAP object
+ @param index The index of the values to count
+ @return      Number of values of the index. 0 if it is not present
+ */ \
+int MMAP ## _count(MMAP * map, Indextype index)
+
+#define MMAP_FN_REMOVE_ONE_STRUCT(MMAP, Valuetype, Indextype) \
+/**
+ Remove one value of an index
+ @details The first value equal to \c value is removed, the order of the
+ others is kept. The index is removed with its last value.
+
+ @param map   A pointer to a valid MMAP object
+ @param index The index of the value
+ @param value The value to remove
+ @return      1 if a value was removed. 0 if none was equal
+ */ \
+int MMAP ## _remove_one(MMAP * map, Indextype index, Valuetype value)
+
+#define MMAP_FN_REMOVE_ALL_STRUCT(MMAP, Indextype) \
+/**
+ Remove an index and all its values
+ @param map   A pointer to a valid MMAP object
+ @param index The index to remove
+ @return      Number of values removed
+ */ \
+int MMAP ## _remove_all(MMAP * map, Indextype index)
+
+#define MMAP_FN_RESERVE(MMAP) \
+/**
+ Size the map for n distinct indexes
+ @details Grows the table and allocates the elements so that the map
+ holds n indexes without rehashing. The value arrays still grow on demand.
+
+ @param map A pointer to a valid MMAP object
+ @param n   Number of indexes to hold
+ */ \
+void MMAP ## _reserve(MMAP * map, int n)
+
+#define MMAP_FN_CLEAR(MMAP) \
+/**
+ Remove every index and value of the map
+ @details The buckets, the elements and their value arrays are kept for
+ the next insertions.
+ @param map A pointer to a valid MMAP object
+ */ \
+void MMAP ## _clear(MMAP * map)
+
+#define MMAP_FN_SHRINK_TO_FIT(MMAP) \
+/**
+ Release the unused elements, trim every value array to its values and
+ shrink the table to the number of indexes
+ @param map A pointer to a valid MMAP object
+ */ \
+void MMAP ## _shrink_to_fit(MMAP * map)
+
+#define MMAP_FN_FOR_EACH(MMAP, Valuetype, Indextype) \
+/**
+ Call a function on every index of the map
+ @details The map must not be modified by \c callback.
+ @param map      A pointer to a valid MMAP object
+ @param callback Function called with the index, its values, their number and \c data
+ @param data     User data given to \c callback
+ */ \
+void MMAP ## _forEach(MMAP * map, void (*callback)(Indextype index, Valuetype * values, int count, void * data), void * data)
+
+// =================
+//  Implementations
+// =================
+#define IMPLEMENT_MMAP_FN_NEW(MMAP, Valuetype, Indextype, FN_CPY_VAL, FN_CPY_IDX, FN_CMP_VAL, FN_CMP_IDX, FN_FREE_VAL, FN_FREE_IDX, FN_HASH_IDX) \
+MMAP * MMAP ## _new() \
+{ \
+	MMAP * map = malloc(sizeof(MMAP)); \
+	map->bucketCount = 16; \
+	map->buckets     = calloc(16, sizeof(MMAP ## _elem_t *)); \
+	map->keys        = 0; \
+	map->size        = 0; \
+	map->spare       = NULL; \
+	map->spareCount  = 0; \
+	map->elemSize   = sizeof(MMAP ## _elem_t); \
+	map->freeValue  = 1; \
+	map->freeIndex  = 1; \
+	map->_copyValue = FN_CPY_VAL; \
+	map->_copyIndex = FN_CPY_IDX; \
+	map->_cmpValue  = FN_CMP_VAL; \
+	map->_cmpIndex  = FN_CMP_IDX; \
+	map->_freeValue = FN_FREE_VAL; \
+	map->_freeIndex = FN_FREE_IDX; \
+	map->_hashIndex = FN_HASH_IDX; \
+	return map; \
+}
+
+/* Internal helpers: lookup, rehash and element recycling */
+#define IMPLEMENT_MMAP_FN_HELPERS(MMAP, Indextype) \
+/* Slot of the element with this index, or the empty slot where to insert it */\
+static MMAP ## _elem_t ** MMAP ## _find(MMAP * map, Indextype index, uint64_t hash) \
+{ \
+	MMAP ## _elem_t ** it = &(map->buckets[hash & (uint64_t)(map->bucketCount - 1)]); \
+	while(*it != NULL) \
+	{ \
+		if((*it)->hash == hash && map->_cmpIndex((*it)->index, index) == 0) \
+			return it; \
+		it = &((*it)->next); \
+	} \
+	return it; \
+} \
+/* Move every element to a table of 'count' buckets */\
+static void MMAP ## _rehash(MMAP * map, int count) \
+{ \
+	MMAP ## _elem_t ** buckets = calloc(count, sizeof(MMAP ## _elem_t *)); \
+	MMAP ## _elem_t * it = NULL, * next = NULL; \
+	int b = 0; \
+	if(buckets == NULL) return; \
+	for(b = 0 ; b < map->bucketCount ; b++) \
+	{ \
+		for(it = map->buckets[b] ; it != NULL ; it = next) \
+		{ \
+			next = it->next; \
+			it->next = buckets[it->hash & (uint64_t)(count - 1)]; \
+			buckets[it->hash & (uint64_t)(count - 1)] = it; \
+		} \
+	} \
+	free(map->buckets); \
+	map->buckets     = buckets; \
+	map->bucketCount = count; \
+} \
+/* Free the values and the index of an element, then keep it in spare or free it */\
+static void MMAP ## _release(MMAP * map, MMAP ## _elem_t * elem, int keep) \
+{ \
+	int i = 0; \
+	if(map->freeValue) \
+		for(i = 0 ; i < elem->count ; i++) \
+			map->_freeValue(elem->values[i]); \
+	if(map->freeIndex) map->_freeIndex(elem->index); \
+	map->size -= elem->count; \
+	map->keys--; \
+	elem->count = 0; \
+	if(!keep) \
+	{ \
+		free(elem->values); \
+		free(elem); \
+		return; \
+	} \
+	elem->next  = map->spare; \
+	map->spare  = elem; \
+	map->spareCount++; \
+}
+
+#define IMPLEMENT_MMAP_FN_FREE(MMAP) \
+void MMAP ## _free(MMAP * map) \
+{ \
+	MMAP ## _elem_t * it = NULL, * next = NULL; \
+	if(map == NULL) return; \
+	MMAP ## _clear(map); \
+	for(it = map->spare ; it != NULL ; it = next) \
+	{ \
+		next = it->next; \
+		free(it->values); \
+		free(it); \
+	} \
+	free(map->buckets); \
+	free(map); \
+}
+
+#define IMPLEMENT_MMAP_FN_ADD_STRUCT(MMAP, Valuetype, Indextype) \
+int MMAP ## _add(MMAP * map, Indextype index, Valuetype value) \
+{ \
+	MMAP ## _elem_t ** slot = NULL; \
+	MMAP ## _elem_t * elem = NULL; \
+	Valuetype * values = NULL; \
+	uint64_t hash = 0; \
+	int capacity = 0; \
+	if(map == NULL) \
+		return 0; \
+	hash = map->_hashIndex(index); \
+	slot = MMAP ## _find(map, index, hash); \
+	if((elem = *slot) == NULL) \
+	{ \
+		/* New index: reuse a spare element and its value array */\
+		if((elem = map->spare) != NULL) \
+		{ \
+			map->spare = elem->next; \
+			map->spareCount--; \
+		} \
+		else \
+		{ \
+			if((elem = malloc(map->elemSize)) == NULL) \
+				return 0; \
+			elem->values   = NULL; \
+			elem->capacity = 0; \
+		} \
+		elem->hash  = hash; \
+		elem->count = 0; \
+		elem->next  = NULL; \
+		map->_copyIndex(&(elem->index), &(index)); \
+		*slot = elem; \
+		map->keys++; \
+	} \
+	if(elem->count == elem->capacity) \
+	{ \
+		capacity = elem->capacity > 0 ? elem->capacity * 2 : 2; \
+		if((values = realloc(elem->values, sizeof(Valuetype) * capacity)) == NULL) \
+			return elem->count; \
+		elem->values   = values; \
+		elem->capacity = capacity; \
+	} \
+	map->_copyValue(&(elem->values[elem->count]), &(value)); \
+	elem->count++; \
+	map->size++; \
+	if(map->keys > map->bucketCount * MMAP_MAX_LOAD) \
+		MMAP ## _rehash(map, map->bucketCount * 2); \
+	return elem->count; \
+}
+
+#define IMPLEMENT_MMAP_FN_GET_ALL_STRUCT(MMAP, Valuetype, Indextype) \
+Valuetype * MMAP ## _get_all(MMAP * map, Indextype index, int * count) \
+{ \
+	MMAP ## _elem_t * elem = NULL; \
+	if(count != NULL) *count = 0; \
+	if(map == NULL) return NULL; \
+	elem = *(MMAP ## _find(map, index, map->_hashIndex(index))); \
+	if(elem == NULL) \
+		return NULL; \
+	if(count != NULL) *count = elem->count; \
+	return elem->values; \
+}
+
+#define IMPLEMENT_MMAP_FN_COUNT_STRUCT(MMAP, Indextype) \
+int MMAP ## _count(MMAP * map, Indextype index) \
+{ \
+	MMAP ## _elem_t * elem = NULL; \
+	if(map == NULL) return 0; \
+	elem = *(MMAP ## _find(map, index, map->_hashIndex(index))); \
+	return (elem != NULL) ? elem->count : 0; \
+}
+
+#define IMPLEMENT_MMAP_FN_REMOVE_ONE_STRUCT(MMAP, Valuetype, Indextype) \
+int MMAP ## _remove_one(MMAP * map, Indextype index, Valuetype value) \
+{ \
+	MMAP ## _elem_t ** slot = NULL; \
+	MMAP ## _elem_t * elem = NULL; \
+	int i = 0; \
+	if(map == NULL) return 0; \
+	slot = MMAP ## _find(map, index, map->_hashIndex(index)); \
+	if((elem = *slot) == NULL) \
+		return 0; \
+	for(i = 0 ; i < elem->count ; i++) \
+		if(map->_cmpValue(elem->values[i], value) == 0) \
+			break; \
+	if(i == elem->count) \
+		return 0; \
+	if(elem->count == 1) \
+	{ \
+		*slot = elem->next; \
+		MMAP ## _release(map, elem, 0); \
+		return 1; \
+	} \
+	if(map->freeValue) map->_freeValue(elem->values[i]); \
+	memmove(&(elem->values[i]), &(elem->values[i + 1]), sizeof(Valuetype) * (elem->count - i - 1)); \
+	elem->count--; \
+	map->size--; \
+	return 1; \
+}
+
+#define IMPLEMENT_MMAP_FN_REMOVE_ALL_STRUCT(MMAP, Indextype) \
+int MMAP ## _remove_all(MMAP * map, Indextype index) \
+{ \
+	MMAP ## _elem_t ** slot = NULL; \
+	MMAP ## _elem_t * elem = NULL; \
+	int count = 0; \
+	if(map == NULL) return 0; \
+	slot = MMAP ## _find(map, index, map->_hashIndex(index)); \
+	if((elem = *slot) == NULL) \
+		return 0; \
+	*slot = elem->next; \
+	count = elem->count; \
+	MMAP ## _release(map, elem, 0); \
+	return count; \
+}
+
+#define IMPLEMENT_MMAP_FN_RESERVE(MMAP) \
+void MMAP ## _reserve(MMAP * map, int n) \
+{ \
+	MMAP ## _elem_t * elem = NULL; \
+	int count = 0; \
+	if(map == NULL) return; \
+	count = map->bucketCount; \
+	while(count * MMAP_MAX_LOAD < n) \
+		count *= 2; \
+	if(count > map->bucketCount) \
+		MMAP ## _rehash(map, count); \
+	while(map->keys + map->spareCount < n) \
+	{ \
+		if((elem = malloc(map->elemSize)) == NULL) \
+			return; \
+		elem->values   = NULL; \
+		elem->capacity = 0; \
+		elem->next = map->spare; \
+		map->spare = elem; \
+		map->spareCount++; \
+	} \
+}
+
+#define IMPLEMENT_MMAP_FN_CLEAR(MMAP) \
+void MMAP ## _clear(MMAP * map) \
+{ \
+	MMAP ## _elem_t * it = NULL, * next = NULL; \
+	int b = 0; \
+	if(map == NULL) return; \
+	for(b = 0 ; b < map->bucketCount ; b++) \
+	{ \
+		for(it = map->buckets[b] ; it != NULL ; it = next) \
+		{ \
+			next = it->next; \
+			MMAP ## _release(map, it, 1); \
+		} \
+		map->buckets[b] = NULL; \
+	} \
+}
+
+#define IMPLEMENT_MMAP_FN_SHRINK_TO_FIT(MMAP, Valuetype) \
+void MMAP ## _shrink_to_fit(MMAP * map) \
+{ \
+	MMAP ## _elem_t * it = NULL, * next = NULL; \
+	Valuetype * values = NULL; \
+	int b = 0, count = 16; \
+	if(map == NULL) return; \
+	for(it = map->spare ; it != NULL ; it = next) \
+	{ \
+		next = it->next; \
+		free(it->values); \
+		free(it); \
+	} \
+	map->spare      = NULL; \
+	map->spareCount = 0; \
+	for(b = 0 ; b < map->bucketCount ; b++) \
+	{ \
+		for(it = map->buckets[b] ; it != NULL ; it = it->next) \
+		{ \
+			if(it->capacity > it->count && (values = realloc(it->values, sizeof(Valuetype) * it->count)) != NULL) \
+			{ \
+				it->values   = values; \
+				it->capacity = it->count; \
+			} \
+		} \
+	} \
+	while(count * MMAP_MAX_LOAD < map->keys) \
+		count *= 2; \
+	if(count < map->bucketCount) \
+		MMAP ## _rehash(map, count); \
+}
+
+#define IMPLEMENT_MMAP_FN_FOR_EACH(MMAP, Valuetype, Indextype) \
+void MMAP ## _forEach(MMAP * map, void (*callback)(Indextype index, Valuetype * values, int count, void * data), void * data) \
+{ \
+	MMAP ## _elem_t * it = NULL; \
+	int b = 0; \
+	if(map == NULL) return; \
+	for(b = 0 ; b < map->bucketCount ; b++) \
+		for(it = map->buckets[b] ; it != NULL ; it = it->next) \
+			callback(it->index, it->values, it->count, data); \
+}
+
+// MACRO HELPERS (One line definitions && implementations)
+#define NEW_MMAP_DEFINITION(MMAP, VALUETYPE, INDEXTYPE) \
+NEW_MMAP_TYPE(MMAP, VALUETYPE, INDEXTYPE); \
+MMAP_FN_NEW(MMAP); \
+MMAP_FN_FREE(MMAP); \
+MMAP_FN_ADD_STRUCT(MMAP, VALUETYPE, INDEXTYPE); \
+MMAP_FN_GET_ALL_STRUCT(MMAP, VALUETYPE, INDEXTYPE); \
+MMAP_FN_COUNT_STRUCT(MMAP, INDEXTYPE); \
+MMAP_FN_REMOVE_ONE_STRUCT(MMAP, VALUETYPE, INDEXTYPE); \
+MMAP_FN_REMOVE_ALL_STRUCT(MMAP, INDEXTYPE); \
+MMAP_FN_RESERVE(MMAP); \
+MMAP_FN_CLEAR(MMAP); \
+MMAP_FN_SHRINK_TO_FIT(MMAP); \
+MMAP_FN_FOR_EACH(MMAP, VALUETYPE, INDEXTYPE)
+
+#define IMPLEMENT_MMAP(MMAP, VALUETYPE, INDEXTYPE, FN_CPY_VAL, FN_CPY_IDX, FN_CMP_VAL, FN_CMP_IDX, FN_FREE_VAL, FN_FREE_IDX, FN_HASH_IDX) \
+IMPLEMENT_MMAP_FN_NEW(MMAP, VALUETYPE, INDEXTYPE, FN_CPY_VAL, FN_CPY_IDX, FN_CMP_VAL, FN_CMP_IDX, FN_FREE_VAL, FN_FREE_IDX, FN_HASH_IDX); \
+IMPLEMENT_MMAP_FN_HELPERS(MMAP, INDEXTYPE); \
+IMPLEMENT_MMAP_FN_CLEAR(MMAP); \
+IMPLEMENT_MMAP_FN_FREE(MMAP); \
+IMPLEMENT_MMAP_FN_ADD_STRUCT(MMAP, VALUETYPE, INDEXTYPE); \
+IMPLEMENT_MMAP_FN_GET_ALL_STRUCT(MMAP, VALUETYPE, INDEXTYPE); \
+IMPLEMENT_MMAP_FN_COUNT_STRUCT(MMAP, INDEXTYPE); \
+IMPLEMENT_MMAP_FN_REMOVE_ONE_STRUCT(MMAP, VALUETYPE, INDEXTYPE); \
+IMPLEMENT_MMAP_FN_REMOVE_ALL_STRUCT(MMAP, INDEXTYPE); \
+IMPLEMENT_MMAP_FN_RESERVE(MMAP); \
+IMPLEMENT_MMAP_FN_SHRINK_TO_FIT(MMAP, VALUETYPE); \
+IMPLEMENT_MMAP_FN_FOR_EACH(MMAP, VALUETYPE, INDEXTYPE)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __MMAP_H__
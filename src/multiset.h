@@ -0,0 +1,423 @@
+/**
+ * @file multiset.h
+ * @brief Counting multiset container definition
+ * @details A multiset storing every distinct value once with its number of
+ * occurrences, made to build histograms of large streams:
+ * - open addressing with linear probing: a value, its hash and its count
+ *   share one slot, so counting a known value is a hash, a few contiguous
+ *   slot reads and an increment, without allocation nor copy,
+ * - the value is only copied the first time it is seen,
+ * - removals shift the next slots back instead of leaving tombstones.
+ *
+ * MSET_top extracts the k most frequent values with a heap of k slots.
+ * @author Baudouin FEILDEL
+ */
+#ifndef __MSET_H__
+#define __MSET_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Percentage of used slots before the set grows */
+#ifndef MSET_MAX_LOAD
+#define MSET_MAX_LOAD 75
+#endif
+
+// =============
+//  Definitions
+// =============
+#define NEW_MSET_SLOT(MSET, SlotTypename, Valuetype) \
+/**
+ Slot of a MSET object
+ */ \
+typedef struct _ ## SlotTypename \
+{ \
+	Valuetype value; /**< Value of the slot */\
+	uint64_t  hash;  /**< Hash of the value */\
+	uint64_t  count; /**< Occurrences of the value. 0 if the slot is empty */\
+} SlotTypename
+
+#define NEW_MSET_TYPE(MSET, Valuetype) \
+NEW_MSET_SLOT(MSET, MSET ## _slot_t, Valuetype); \
+typedef struct MSET \
+{ \
+	MSET ## _slot_t * slots; /**< Slots, a value lives at hash & (capacity - 1) or after */\
+	int      capacity;       /**< Number of slots, a power of two */\
+	int      size;           /**< Number of distinct values in the set */\
+	uint64_t total;          /**< Sum of the counts of every value */\
+	size_t   elemSize;       /**< Size of one slot in the set */\
+	int      freeValue;      /**< Flag:<br>1: Automatically free the value<br>0: Do not automatically free the value */\
+	void (*_copyValue)(Valuetype * dest, Valuetype * src); /**< Pointer to a function used to copy a value */\
+	int (*_cmpValue)(Valuetype val1, Valuetype val2); /**< Pointer to a function used to compare two values */\
+	void (*_freeValue)(Valuetype value); /**< Pointer to a function used to free a value */\
+	uint64_t (*_hashValue)(Valuetype value); /**< Pointer to a function used to hash a value */\
+} MSET
+
+#define MSET_FN_NEW(MSET) \
+/**
+ @brief Create a new MSET object
+ @return A pointer to an allocated and initialized
+ MSET object in memory
+ */ \
+MSET * MSET ## _new()
+
+#define MSET_FN_FREE(MSET) \
+/**
+ Destroy a MSET object
+ @param set A pointer to a MSET object
+ */ \
+void MSET ## _free(MSET * set)
+
+#define MSET_FN_ADD(MSET, Valuetype) \
+/**
+ Add occurrences of a value
+ @param set   A pointer to a valid MSET object
+ @param value The value to count
+ @param n     Number of occurrences to add
+ @return      Count of the value after the insertion
+ */ \
+uint64_t MSET ## _add(MSET * set, Valuetype value, uint64_t n)
+
+#define MSET_FN_COUNT(MSET, Valuetype) \
+/**
+ Count the occurrences of a value
+ @param set   A pointer to a valid MSET object
+ @param value The value to count
+ @return      Count of the value. 0 if it is not present
+ */ \
+uint64_t MSET ## _count(MSET * set, Valuetype value)
+
+#define MSET_FN_REMOVE(MSET, Valuetype) \
+/**
+ Remove occurrences of a value
+ @details The value leaves the set when its count reaches 0.
+ @param set   A pointer to a valid MSET object
+ @param value The value to remove
+ @param n     Number of occurrences to remove, UINT64_MAX for all of them
+ @return      Count of the value after the removal
+ */ \
+uint64_t MSET ## _remove(MSET * set, Valuetype value, uint64_t n)
+
+#define MSET_FN_TOP(MSET, Valuetype) \
+/**
+ Get the k most frequent values
+ @details Runs in O(size * log k). Values of equal count come in no
+ particular order.
+
+ @param set    A pointer to a valid MSET object
+ @param k      Number of values wanted
+ @param values Receives up to k values, most frequent first. They are not
+ copied and stay owned by the set
+ @param counts Receives the count of every value. May be NULL
+ @return       Number of values written: k, or size if the set is smaller
+ */ \
+int MSET ## _top(MSET * set, int k, Valuetype * values, uint64_t * counts)
+
+#define MSET_FN_RESERVE(MSET) \
+/**
+ Size the set for n distinct values
+ @param set A pointer to a valid MSET object
+ @param n   Number of distinct values to hold without growing
+ */ \
+void MSET ## _reserve(MSET * set, int n)
+
+#define MSET_FN_CLEAR(MSET) \
+/**
+ Remove every value of the set
+ @details The slots are kept for the next insertions.
+ @param set A pointer to a valid MSET object
+ */ \
+void MSET ## _clear(MSET * set)
+
+#define MSET_FN_SHRINK_TO_FIT(MSET) \
+/**
+ Shrink the slots to the number of distinct values
+ @param set A pointer to a valid MSET object
+ */ \
+void MSET ## _shrink_to_fit(MSET * set)
+
+#define MSET_FN_FOR_EACH(MSET, Valuetype) \
+/**
+ Call a function on every distinct value of the set
+ @details The set must not be modified by \c callback.
+ @param set      A pointer to a valid MSET object
+ @param callback Function called with the value, its count and \c data
+ @param data     User data given to \c callback
+ */ \
+void MSET ## _forEach(MSET * set, void (*callback)(Valuetype value, uint64_t count, void * data), void * data)
+
+// =================
+//  Implementations
+// =================
+#define IMPLEMENT_MSET_FN_NEW(MSET, Valuetype, FN_CPY_VAL, FN_CMP_VAL, FN_FREE_VAL, FN_HASH_VAL) \
+MSET * MSET ## _new() \
+{ \
+	MSET * set = malloc(sizeof(MSET)); \
+	set->capacity   = 16; \
+	set->slots      = calloc(16, sizeof(MSET ## _slot_t)); \
+	set->size       = 0; \
+	set->total      = 0; \
+	set->elemSize   = sizeof(MSET ## _slot_t); \
+	set->freeValue  = 1; \
+	set->_copyValue = FN_CPY_VAL; \
+	set->_cmpValue  = FN_CMP_VAL; \
+	set->_freeValue = FN_FREE_VAL; \
+	set->_hashValue = FN_HASH_VAL; \
+	return set; \
+}
+
+#define IMPLEMENT_MSET_FN_FREE(MSET) \
+void MSET ## _free(MSET * set) \
+{ \
+	if(set == NULL) return; \
+	MSET ## _clear(set); \
+	free(set->slots); \
+	free(set); \
+}
+
+/* Internal helpers: probing, resizing and the heap of MSET_top */
+#define IMPLEMENT_MSET_FN_HELPERS(MSET, Valuetype) \
+/* Slot holding this value, or the empty slot where to insert it */\
+static MSET ## _slot_t * MSET ## _find(MSET * set, Valuetype value, uint64_t hash) \
+{ \
+	uint64_t mask = (uint64_t)(set->capacity - 1); \
+	uint64_t i = hash & mask; \
+	while(set->slots[i].count != 0) \
+	{ \
+		if(set->slots[i].hash == hash && set->_cmpValue(set->slots[i].value, value) == 0) \
+			break; \
+		i = (i + 1) & mask; \
+	} \
+	return &(set->slots[i]); \
+} \
+/* Move every value to 'capacity' slots */\
+static void MSET ## _resize(MSET * set, int capacity) \
+{ \
+	MSET ## _slot_t * slots = calloc(capacity, sizeof(MSET ## _slot_t)); \
+	MSET ## _slot_t * old = set->slots; \
+	uint64_t mask = (uint64_t)(capacity - 1), j = 0; \
+	int i = 0; \
+	if(slots == NULL) return; \
+	for(i = 0 ; i < set->capacity ; i++) \
+	{ \
+		if(old[i].count == 0) continue; \
+		for(j = old[i].hash & mask ; slots[j].count != 0 ; j = (j + 1) & mask); \
+		slots[j] = old[i]; \
+	} \
+	free(old); \
+	set->slots    = slots; \
+	set->capacity = capacity; \
+} \
+/* Smallest capacity holding n values under MSET_MAX_LOAD */\
+static int MSET ## _capacityFor(int n) \
+{ \
+	int capacity = 16; \
+	while((int64_t)capacity * MSET_MAX_LOAD < (int64_t)n * 100) \
+		capacity *= 2; \
+	return capacity; \
+} \
+/* Restore the min-heap (on count) below position i */\
+static void MSET ## _siftDown(MSET ## _slot_t ** heap, int size, int i) \
+{ \
+	MSET ## _slot_t * tmp = NULL; \
+	int child = 0; \
+	while((child = 2 * i + 1) < size) \
+	{ \
+		if(child + 1 < size && heap[child + 1]->count < heap[child]->count) \
+			child++; \
+		if(heap[i]->count <= heap[child]->count) \
+			break; \
+		tmp = heap[i]; heap[i] = heap[child]; heap[child] = tmp; \
+		i = child; \
+	} \
+}
+
+#define IMPLEMENT_MSET_FN_ADD(MSET, Valuetype) \
+uint64_t MSET ## _add(MSET * set, Valuetype value, uint64_t n) \
+{ \
+	MSET ## _slot_t * slot = NULL; \
+	uint64_t hash = 0; \
+	if(set == NULL || n == 0) \
+		return 0; \
+	hash = set->_hashValue(value); \
+	slot = MSET ## _find(set, value, hash); \
+	set->total += n; \
+	if(slot->count != 0) \
+		return slot->count += n; \
+	/* First occurrence: grow first if needed, the slot may move */\
+	if((int64_t)(set->size + 1) * 100 > (int64_t)set->capacity * MSET_MAX_LOAD) \
+	{ \
+		MSET ## _resize(set, set->capacity * 2); \
+		slot = MSET ## _find(set, value, hash); \
+	} \
+	set->_copyValue(&(slot->value), &(value)); \
+	slot->hash  = hash; \
+	slot->count = n; \
+	set->size++; \
+	return n; \
+}
+
+#define IMPLEMENT_MSET_FN_COUNT(MSET, Valuetype) \
+uint64_t MSET ## _count(MSET * set, Valuetype value) \
+{ \
+	if(set == NULL) return 0; \
+	return MSET ## _find(set, value, set->_hashValue(value))->count; \
+}
+
+#define IMPLEMENT_MSET_FN_REMOVE(MSET, Valuetype) \
+uint64_t MSET ## _remove(MSET * set, Valuetype value, uint64_t n) \
+{ \
+	MSET ## _slot_t * slot = NULL; \
+	uint64_t mask = 0, hole = 0, i = 0, home = 0; \
+	if(set == NULL) return 0; \
+	slot = MSET ## _find(set, value, set->_hashValue(value)); \
+	if(slot->count == 0) \
+		return 0; \
+	if(n < slot->count) \
+	{ \
+		set->total -= n; \
+		return slot->count -= n; \
+	} \
+	set->total -= slot->count; \
+	if(set->freeValue) set->_freeValue(slot->value); \
+	slot->count = 0; \
+	set->size--; \
+	/* Backward shift: move back the next values which may not be found past the hole */\
+	mask = (uint64_t)(set->capacity - 1); \
+	hole = (uint64_t)(slot - set->slots); \
+	for(i = (hole + 1) & mask ; set->slots[i].count != 0 ; i = (i + 1) & mask) \
+	{ \
+		home = set->slots[i].hash & mask; \
+		if(((i - home) & mask) >= ((i - hole) & mask)) \
+		{ \
+			set->slots[hole] = set->slots[i]; \
+			set->slots[i].count = 0; \
+			hole = i; \
+		} \
+	} \
+	return 0; \
+}
+
+#define IMPLEMENT_MSET_FN_TOP(MSET, Valuetype) \
+int MSET ## _top(MSET * set, int k, Valuetype * values, uint64_t * counts) \
+{ \
+	MSET ## _slot_t ** heap = NULL; \
+	MSET ## _slot_t * tmp = NULL; \
+	int i = 0, j = 0, size = 0; \
+	if(set == NULL || k <= 0) return 0; \
+	if(k > set->size) k = set->size; \
+	if(k == 0 || (heap = malloc(sizeof(MSET ## _slot_t *) * k)) == NULL) \
+		return 0; \
+	/* Keep the k largest counts in a min-heap: its root is the one to beat */\
+	for(i = 0 ; i < set->capacity ; i++) \
+	{ \
+		if(set->slots[i].count == 0) continue; \
+		if(size < k) \
+		{ \
+			heap[size++] = &(set->slots[i]); \
+			if(size == k) \
+				for(j = k / 2 - 1 ; j >= 0 ; j--) \
+					MSET ## _siftDown(heap, k, j); \
+		} \
+		else if(set->slots[i].count > heap[0]->count) \
+		{ \
+			heap[0] = &(set->slots[i]); \
+			MSET ## _siftDown(heap, k, 0); \
+		} \
+	} \
+	/* Pop the smallest to the end: the output comes most frequent first */\
+	for(i = k - 1 ; i > 0 ; i--) \
+	{ \
+		tmp = heap[0]; heap[0] = heap[i]; heap[i] = tmp; \
+		MSET ## _siftDown(heap, i, 0); \
+	} \
+	for(i = 0 ; i < k ; i++) \
+	{ \
+		values[i] = heap[i]->value; \
+		if(counts != NULL) counts[i] = heap[i]->count; \
+	} \
+	free(heap); \
+	return k; \
+}
+
+#define IMPLEMENT_MSET_FN_RESERVE(MSET) \
+void MSET ## _reserve(MSET * set, int n) \
+{ \
+	int capacity = 0; \
+	if(set == NULL) return; \
+	capacity = MSET ## _capacityFor(n); \
+	if(capacity > set->capacity) \
+		MSET ## _resize(set, capacity); \
+}
+
+#define IMPLEMENT_MSET_FN_CLEAR(MSET) \
+void MSET ## _clear(MSET * set) \
+{ \
+	int i = 0; \
+	if(set == NULL) return; \
+	for(i = 0 ; i < set->capacity ; i++) \
+	{ \
+		if(set->slots[i].count != 0 && set->freeValue) \
+			set->_freeValue(set->slots[i].value); \
+		set->slots[i].count = 0; \
+	} \
+	set->size  = 0; \
+	set->total = 0; \
+}
+
+#define IMPLEMENT_MSET_FN_SHRINK_TO_FIT(MSET) \
+void MSET ## _shrink_to_fit(MSET * set) \
+{ \
+	int capacity = 0; \
+	if(set == NULL) return; \
+	capacity = MSET ## _capacityFor(set->size); \
+	if(capacity < set->capacity) \
+		MSET ## _resize(set, capacity); \
+}
+
+#define IMPLEMENT_MSET_FN_FOR_EACH(MSET, Valuetype) \
+void MSET ## _forEach(MSET * set, void (*callback)(Valuetype value, uint64_t count, void * data), void * data) \
+{ \
+	int i = 0; \
+	if(set == NULL) return; \
+	for(i = 0 ; i < set->capacity ; i++) \
+		if(set->slots[i].count != 0) \
+			callback(set->slots[i].value, set->slots[i].count, data); \
+}
+
+// MACRO HELPERS (One line definitions && implementations)
+#define NEW_MSET_DEFINITION(MSET, VALUETYPE) \
+NEW_MSET_TYPE(MSET, VALUETYPE); \
+MSET_FN_NEW(MSET); \
+MSET_FN_FREE(MSET); \
+MSET_FN_ADD(MSET, VALUETYPE); \
+MSET_FN_COUNT(MSET, VALUETYPE); \
+MSET_FN_REMOVE(MSET, VALUETYPE); \
+MSET_FN_TOP(MSET, VALUETYPE); \
+MSET_FN_RESERVE(MSET); \
+MSET_FN_CLEAR(MSET); \
+MSET_FN_SHRINK_TO_FIT(MSET); \
+MSET_FN_FOR_EACH(MSET, VALUETYPE)
+
+#define IMPLEMENT_MSET(MSET, VALUETYPE, FN_CPY_VAL, FN_CMP_VAL, FN_FREE_VAL, FN_HASH_VAL) \
+IMPLEMENT_MSET_FN_NEW(MSET, VALUETYPE, FN_CPY_VAL, FN_CMP_VAL, FN_FREE_VAL, FN_HASH_VAL); \
+IMPLEMENT_MSET_FN_HELPERS(MSET, VALUETYPE); \
+IMPLEMENT_MSET_FN_CLEAR(MSET); \
+IMPLEMENT_MSET_FN_FREE(MSET); \
+IMPLEMENT_MSET_FN_ADD(MSET, VALUETYPE); \
+IMPLEMENT_MSET_FN_COUNT(MSET, VALUETYPE); \
+IMPLEMENT_MSET_FN_REMOVE(MSET, VALUETYPE); \
+IMPLEMENT_MSET_FN_TOP(MSET, VALUETYPE); \
+IMPLEMENT_MSET_FN_RESERVE(MSET); \
+IMPLEMENT_MSET_FN_SHRINK_TO_FIT(MSET); \
+IMPLEMENT_MSET_FN_FOR_EACH(MSET, VALUETYPE)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __MSET_H__
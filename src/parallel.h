@@ -0,0 +1,490 @@
+/**
+ * @file parallel.h
+ * @brief Parallel algorithms over containers
+ * @details Run for_each, map_reduce, filter and sort on a ThreadPool.
+ * - NEW_PARALLEL_DEFINITION works on contiguous arrays of values
+ *   (flat map values, priority queue heaps, plain C arrays...).
+ * - NEW_PARALLEL_LINKED_DEFINITION works on linked containers having
+ *   begin, size and next members (LIST, SET, MAP): they are walked once
+ *   to find the first element of every chunk, then chunks are processed
+ *   in parallel.
+ *
+ * The grain is the number of elements of a chunk. A grain <= 0 lets the
+ * algorithm choose one (about 8 chunks per thread). A deterministic
+ * map_reduce chooses PARALLEL_DETERMINISTIC_CHUNKS chunks instead, so that
+ * its result does not depend on the pool.
+ * Values are moved with plain assignments, never with _copyValue.
+ * @author Baudouin FEILDEL
+ */
+#ifndef __PARALLEL_H__
+#define __PARALLEL_H__
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "threadpool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Grain used when the caller gives none */
+#define PARALLEL_GRAIN(pool, size, grain) \
+	(((grain) > 0) ? (grain) : \
+	 (((size) / (8 * ((pool) ? (pool)->threadCount : 1)) > 0) ? (size) / (8 * ((pool) ? (pool)->threadCount : 1)) : 1))
+
+/** Number of chunks of a deterministic map_reduce when the caller gives no grain */
+#define PARALLEL_DETERMINISTIC_CHUNKS 256
+
+/* Grain of a deterministic map_reduce: depends on the size only */
+#define PARALLEL_DETERMINISTIC_GRAIN(size, grain) \
+	(((grain) > 0) ? (grain) : ((size) + PARALLEL_DETERMINISTIC_CHUNKS - 1) / PARALLEL_DETERMINISTIC_CHUNKS)
+
+// =============
+//  Definitions
+// =============
+#define NEW_PARALLEL_TYPE(PAR, Valuetype, Resulttype) \
+/**
+ Arguments of a parallel job of PAR
+ */ \
+typedef struct PAR ## _job_t \
+{ \
+	Valuetype  * values;  /**< Values to process */\
+	Valuetype  * output;  /**< Output values (filter, sort) */\
+	char       * keep;    /**< Filter decisions */\
+	int        * offsets; /**< Per chunk counts, then output offsets (filter) */\
+	Resulttype * partial; /**< Per chunk results (map_reduce) */\
+	Resulttype   result;  /**< Shared result (non deterministic map_reduce) */\
+	pthread_mutex_t lock; /**< Lock of result */\
+	int deterministic;    /**< Flag:<br>1: Reduce chunk results in order<br>0: Reduce chunk results as they finish */\
+	int fromOutput;       /**< Flag:<br>1: Sorted runs are in output<br>0: Sorted runs are in values */\
+	int size;             /**< Number of values */\
+	int grain;            /**< Number of values of a chunk */\
+	void (*forEach)(Valuetype * value, void * data);          /**< for_each callback */\
+	Resulttype (*map)(Valuetype value, void * data);          /**< map_reduce map callback */\
+	Resulttype (*reduce)(Resulttype acc, Resulttype value);    /**< map_reduce reduce callback */\
+	int (*filter)(Valuetype value, void * data);              /**< filter callback */\
+	int (*cmp)(Valuetype val1, Valuetype val2);               /**< sort compare callback */\
+	void * data;          /**< User data given to the callbacks */\
+} PAR ## _job_t
+
+#define PARALLEL_FN_FOR_EACH(PAR, Valuetype) \
+/**
+ Call a function on every value of an array, in parallel
+ @param pool    A pointer to a valid ThreadPool object. NULL to run sequentially
+ @param values  Array of values
+ @param size    Number of values
+ @param grain   Number of values processed by a chunk. <= 0 for automatic
+ @param forEach Function called with a pointer to every value and \c data
+ @param data    User data given to \c forEach
+ */ \
+void PAR ## _for_each(ThreadPool * pool, Valuetype * values, int size, int grain, void (*forEach)(Valuetype * value, void * data), void * data)
+
+#define PARALLEL_FN_MAP_REDUCE(PAR, Valuetype, Resulttype) \
+/**
+ Map every value of an array and reduce the results, in parallel
+ @details Every chunk reduces its values starting from \c init.
+ In deterministic mode the chunk results are then reduced in chunk order,
+ so the result only depends on \c grain and \c size, never on the number
+ of threads or on scheduling (which matters for floating point sums).
+ An automatic grain then cuts the values in PARALLEL_DETERMINISTIC_CHUNKS
+ chunks.
+ Otherwise chunk results are reduced as soon as chunks finish.
+ \c reduce must be associative and \c init must be its neutral element.
+
+ @param pool          A pointer to a valid ThreadPool object. NULL to run sequentially
+ @param values        Array of values
+ @param size          Number of values
+ @param grain         Number of values processed by a chunk. <= 0 for automatic
+ @param init          Neutral element of \c reduce
+ @param map           Function mapping a value to a result
+ @param reduce        Function reducing two results
+ @param data          User data given to \c map
+ @param deterministic Flag:<br>1: Reduce chunk results in order<br>0: Reduce chunk results as they finish
+ @return              The reduced result
+ */ \
+Resulttype PAR ## _map_reduce(ThreadPool * pool, Valuetype * values, int size, int grain, Resulttype init, Resulttype (*map)(Valuetype value, void * data), Resulttype (*reduce)(Resulttype acc, Resulttype value), void * data, int deterministic)
+
+#define PARALLEL_FN_FILTER(PAR, Valuetype) \
+/**
+ Copy the values accepted by a function, in parallel
+ @details The order of the values is preserved.
+
+ @param pool   A pointer to a valid ThreadPool object. NULL to run sequentially
+ @param values Array of values
+ @param size   Number of values
+ @param grain  Number of values processed by a chunk. <= 0 for automatic
+ @param filter Function returning non zero to keep a value
+ @param data   User data given to \c filter
+ @param output Output array, must be able to hold \c size values
+ @return       Number of values written in \c output
+ */ \
+int PAR ## _filter(ThreadPool * pool, Valuetype * values, int size, int grain, int (*filter)(Valuetype value, void * data), void * data, Valuetype * output)
+
+#define PARALLEL_FN_SORT(PAR, Valuetype) \
+/**
+ Sort an array, in parallel
+ @details Stable merge sort: chunks are sorted in parallel, then pairs
+ of sorted runs are merged in parallel until one run is left.
+ Needs a temporary buffer of \c size values.
+
+ @param pool   A pointer to a valid ThreadPool object. NULL to run sequentially
+ @param values Array of values
+ @param size   Number of values
+ @param grain  Number of values sorted by a chunk. <= 0 for automatic
+ @param cmp    Function used to order two values (a _cmpValue function)
+ */ \
+void PAR ## _sort(ThreadPool * pool, Valuetype * values, int size, int grain, int (*cmp)(Valuetype val1, Valuetype val2))
+
+// =================
+//  Implementations
+// =================
+#define IMPLEMENT_PARALLEL_FN_FOR_EACH(PAR, Valuetype) \
+static void PAR ## _forEachChunk(void * data, int chunk) \
+{ \
+	PAR ## _job_t * job = data; \
+	int i = chunk * job->grain; \
+	int end = (i + job->grain < job->size) ? i + job->grain : job->size; \
+	for( ; i < end ; i++) \
+		job->forEach(&(job->values[i]), job->data); \
+} \
+void PAR ## _for_each(ThreadPool * pool, Valuetype * values, int size, int grain, void (*forEach)(Valuetype * value, void * data), void * data) \
+{ \
+	PAR ## _job_t job; \
+	if(values == NULL || size <= 0) return; \
+	job.values  = values; \
+	job.size    = size; \
+	job.grain   = PARALLEL_GRAIN(pool, size, grain); \
+	job.forEach = forEach; \
+	job.data    = data; \
+	ThreadPool_run(pool, (size + job.grain - 1) / job.grain, PAR ## _forEachChunk, &job); \
+}
+
+#define IMPLEMENT_PARALLEL_FN_MAP_REDUCE(PAR, Valuetype, Resulttype) \
+static void PAR ## _mapReduceChunk(void * data, int chunk) \
+{ \
+	PAR ## _job_t * job = data; \
+	int i = chunk * job->grain; \
+	int end = (i + job->grain < job->size) ? i + job->grain : job->size; \
+	Resulttype acc = job->partial[chunk]; \
+	for( ; i < end ; i++) \
+		acc = job->reduce(acc, job->map(job->values[i], job->data)); \
+	job->partial[chunk] = acc; \
+	if(!job->deterministic) \
+	{ \
+		pthread_mutex_lock(&(job->lock)); \
+		job->result = job->reduce(job->result, acc); \
+		pthread_mutex_unlock(&(job->lock)); \
+	} \
+} \
+Resulttype PAR ## _map_reduce(ThreadPool * pool, Valuetype * values, int size, int grain, Resulttype init, Resulttype (*map)(Valuetype value, void * data), Resulttype (*reduce)(Resulttype acc, Resulttype value), void * data, int deterministic) \
+{ \
+	PAR ## _job_t job; \
+	int chunks = 0, i = 0; \
+	if(values == NULL || size <= 0) return init; \
+	job.values  = values; \
+	job.size    = size; \
+	job.grain   = deterministic ? PARALLEL_DETERMINISTIC_GRAIN(size, grain) : PARALLEL_GRAIN(pool, size, grain); \
+	job.map     = map; \
+	job.reduce  = reduce; \
+	job.data    = data; \
+	job.result  = init; \
+	job.deterministic = deterministic; \
+	chunks      = (size + job.grain - 1) / job.grain; \
+	job.partial = malloc(sizeof(Resulttype) * chunks); \
+	for(i = 0 ; i < chunks ; i++) \
+		job.partial[i] = init; \
+	pthread_mutex_init(&(job.lock), NULL); \
+	ThreadPool_run(pool, chunks, PAR ## _mapReduceChunk, &job); \
+	pthread_mutex_destroy(&(job.lock)); \
+	if(deterministic) \
+	{ \
+		for(i = 0 ; i < chunks ; i++) \
+			job.result = reduce(job.result, job.partial[i]); \
+	} \
+	free(job.partial); \
+	return job.result; \
+}
+
+#define IMPLEMENT_PARALLEL_FN_FILTER(PAR, Valuetype) \
+static void PAR ## _filterCount(void * data, int chunk) \
+{ \
+	PAR ## _job_t * job = data; \
+	int i = chunk * job->grain, count = 0; \
+	int end = (i + job->grain < job->size) ? i + job->grain : job->size; \
+	for( ; i < end ; i++) \
+	{ \
+		job->keep[i] = (job->filter(job->values[i], job->data) != 0); \
+		count += job->keep[i]; \
+	} \
+	job->offsets[chunk] = count; \
+} \
+static void PAR ## _filterWrite(void * data, int chunk) \
+{ \
+	PAR ## _job_t * job = data; \
+	int i = chunk * job->grain, out = job->offsets[chunk]; \
+	int end = (i + job->grain < job->size) ? i + job->grain : job->size; \
+	for( ; i < end ; i++) \
+	{ \
+		if(job->keep[i]) \
+			job->output[out++] = job->values[i]; \
+	} \
+} \
+int PAR ## _filter(ThreadPool * pool, Valuetype * values, int size, int grain, int (*filter)(Valuetype value, void * data), void * data, Valuetype * output) \
+{ \
+	PAR ## _job_t job; \
+	int chunks = 0, i = 0, total = 0, count = 0; \
+	if(values == NULL || size <= 0) return 0; \
+	job.values  = values; \
+	job.output  = output; \
+	job.size    = size; \
+	job.grain   = PARALLEL_GRAIN(pool, size, grain); \
+	job.filter  = filter; \
+	job.data    = data; \
+	chunks      = (size + job.grain - 1) / job.grain; \
+	job.keep    = malloc(size); \
+	job.offsets = malloc(sizeof(int) * chunks); \
+	/* Decide and count per chunk, turn counts into offsets, then write */\
+	ThreadPool_run(pool, chunks, PAR ## _filterCount, &job); \
+	for(i = 0 ; i < chunks ; i++) \
+	{ \
+		count = job.offsets[i]; \
+		job.offsets[i] = total; \
+		total += count; \
+	} \
+	ThreadPool_run(pool, chunks, PAR ## _filterWrite, &job); \
+	free(job.keep); \
+	free(job.offsets); \
+	return total; \
+}
+
+#define IMPLEMENT_PARALLEL_FN_SORT(PAR, Valuetype) \
+static void PAR ## _merge(PAR ## _job_t * job, Valuetype * src, Valuetype * dst, int lo, int mid, int hi) \
+{ \
+	int a = lo, b = mid, k = lo; \
+	while(a < mid && b < hi) \
+	{ \
+		if(job->cmp(src[b], src[a]) < 0) dst[k++] = src[b++]; \
+		else                             dst[k++] = src[a++]; \
+	} \
+	while(a < mid) dst[k++] = src[a++]; \
+	while(b < hi)  dst[k++] = src[b++]; \
+} \
+static void PAR ## _sortChunk(void * data, int chunk) \
+{ \
+	PAR ## _job_t * job = data; \
+	Valuetype * src = job->values, * dst = job->output, * swap = NULL; \
+	int begin = chunk * job->grain; \
+	int end = (begin + job->grain < job->size) ? begin + job->grain : job->size; \
+	int width = 0, lo = 0, mid = 0, hi = 0; \
+	/* Bottom-up merge sort, the sorted chunk ends in values */\
+	for(width = 1 ; width < end - begin ; width *= 2) \
+	{ \
+		for(lo = begin ; lo < end ; lo += 2 * width) \
+		{ \
+			mid = (lo + width < end) ? lo + width : end; \
+			hi  = (lo + 2 * width < end) ? lo + 2 * width : end; \
+			PAR ## _merge(job, src, dst, lo, mid, hi); \
+		} \
+		swap = src; src = dst; dst = swap; \
+	} \
+	if(src != job->values) \
+		memcpy(job->values + begin, src + begin, sizeof(Valuetype) * (end - begin)); \
+} \
+static void PAR ## _mergeChunk(void * data, int chunk) \
+{ \
+	PAR ## _job_t * job = data; \
+	/* grain is the width of the sorted runs */\
+	Valuetype * src = job->fromOutput ? job->output : job->values; \
+	Valuetype * dst = job->fromOutput ? job->values : job->output; \
+	int lo  = chunk * 2 * job->grain; \
+	int mid = (lo + job->grain < job->size) ? lo + job->grain : job->size; \
+	int hi  = (lo + 2 * job->grain < job->size) ? lo + 2 * job->grain : job->size; \
+	PAR ## _merge(job, src, dst, lo, mid, hi); \
+} \
+void PAR ## _sort(ThreadPool * pool, Valuetype * values, int size, int grain, int (*cmp)(Valuetype val1, Valuetype val2)) \
+{ \
+	PAR ## _job_t job; \
+	if(values == NULL || size <= 1) return; \
+	job.values = values; \
+	job.output = malloc(sizeof(Valuetype) * size); \
+	job.size   = size; \
+	job.grain  = PARALLEL_GRAIN(pool, size, grain); \
+	job.cmp    = cmp; \
+	job.fromOutput = 0; \
+	ThreadPool_run(pool, (size + job.grain - 1) / job.grain, PAR ## _sortChunk, &job); \
+	/* Merge pairs of runs, ping-ponging between values and output */\
+	for( ; job.grain < size ; job.grain *= 2) \
+	{ \
+		ThreadPool_run(pool, (size + 2 * job.grain - 1) / (2 * job.grain), PAR ## _mergeChunk, &job); \
+		job.fromOutput = !job.fromOutput; \
+	} \
+	if(job.fromOutput) \
+		memcpy(values, job.output, sizeof(Valuetype) * size); \
+	free(job.output); \
+}
+
+// ====================
+//  Linked containers
+// ====================
+#define NEW_PARALLEL_LINKED_TYPE(PAR, CONTAINER, Valuetype, Resulttype) \
+/**
+ Arguments of a parallel job of PAR
+ */ \
+typedef struct PAR ## _job_t \
+{ \
+	CONTAINER ## _elem_t ** firsts; /**< First element of every chunk */\
+	Resulttype * partial; /**< Per chunk results (map_reduce) */\
+	Resulttype   result;  /**< Shared result (non deterministic map_reduce) */\
+	pthread_mutex_t lock; /**< Lock of result */\
+	int deterministic;    /**< Flag:<br>1: Reduce chunk results in order<br>0: Reduce chunk results as they finish */\
+	int size;             /**< Number of elements */\
+	int grain;            /**< Number of elements of a chunk */\
+	void (*forEach)(Valuetype * value, void * data);       /**< for_each callback */\
+	Resulttype (*map)(Valuetype value, void * data);       /**< map_reduce map callback */\
+	Resulttype (*reduce)(Resulttype acc, Resulttype value); /**< map_reduce reduce callback */\
+	void * data;          /**< User data given to the callbacks */\
+} PAR ## _job_t
+
+#define PARALLEL_LINKED_FN_FOR_EACH(PAR, CONTAINER, Valuetype) \
+/**
+ Call a function on the value of every element of a container, in parallel
+ @param pool      A pointer to a valid ThreadPool object. NULL to run sequentially
+ @param container A pointer to a valid CONTAINER object
+ @param grain     Number of elements processed by a chunk. <= 0 for automatic
+ @param forEach   Function called with a pointer to every value and \c data
+ @param data      User data given to \c forEach
+ */ \
+void PAR ## _for_each(ThreadPool * pool, CONTAINER * container, int grain, void (*forEach)(Valuetype * value, void * data), void * data)
+
+#define PARALLEL_LINKED_FN_MAP_REDUCE(PAR, CONTAINER, Valuetype, Resulttype) \
+/**
+ Map the value of every element of a container and reduce the results, in parallel
+ @details See the array version for the meaning of \c deterministic.
+
+ @param pool          A pointer to a valid ThreadPool object. NULL to run sequentially
+ @param container     A pointer to a valid CONTAINER object
+ @param grain         Number of elements processed by a chunk. <= 0 for automatic
+ @param init          Neutral element of \c reduce
+ @param map           Function mapping a value to a result
+ @param reduce        Function reducing two results
+ @param data          User data given to \c map
+ @param deterministic Flag:<br>1: Reduce chunk results in order<br>0: Reduce chunk results as they finish
+ @return              The reduced result
+ */ \
+Resulttype PAR ## _map_reduce(ThreadPool * pool, CONTAINER * container, int grain, Resulttype init, Resulttype (*map)(Valuetype value, void * data), Resulttype (*reduce)(Resulttype acc, Resulttype value), void * data, int deterministic)
+
+#define IMPLEMENT_PARALLEL_LINKED_FN_CHUNKS(PAR, CONTAINER) \
+static int PAR ## _chunks(ThreadPool * pool, CONTAINER * container, int grain, PAR ## _job_t * job) \
+{ \
+	CONTAINER ## _elem_t * it = NULL; \
+	int chunks = 0, i = 0; \
+	job->size   = container->size; \
+	job->grain  = PARALLEL_GRAIN(pool, container->size, grain); \
+	chunks      = (container->size + job->grain - 1) / job->grain; \
+	job->firsts = malloc(sizeof(CONTAINER ## _elem_t *) * chunks); \
+	for(it = container->begin, i = 0 ; it != NULL ; it = it->next, i++) \
+	{ \
+		if(i % job->grain == 0) \
+			job->firsts[i / job->grain] = it; \
+	} \
+	return chunks; \
+}
+
+#define IMPLEMENT_PARALLEL_LINKED_FN_FOR_EACH(PAR, CONTAINER, Valuetype) \
+static void PAR ## _forEachChunk(void * data, int chunk) \
+{ \
+	PAR ## _job_t * job = data; \
+	CONTAINER ## _elem_t * it = job->firsts[chunk]; \
+	int i = 0; \
+	for(i = 0 ; i < job->grain && it != NULL ; i++, it = it->next) \
+		job->forEach(&(it->value), job->data); \
+} \
+void PAR ## _for_each(ThreadPool * pool, CONTAINER * container, int grain, void (*forEach)(Valuetype * value, void * data), void * data) \
+{ \
+	PAR ## _job_t job; \
+	int chunks = 0; \
+	if(container == NULL || container->size <= 0) return; \
+	job.forEach = forEach; \
+	job.data    = data; \
+	chunks = PAR ## _chunks(pool, container, grain, &job); \
+	ThreadPool_run(pool, chunks, PAR ## _forEachChunk, &job); \
+	free(job.firsts); \
+}
+
+#define IMPLEMENT_PARALLEL_LINKED_FN_MAP_REDUCE(PAR, CONTAINER, Valuetype, Resulttype) \
+static void PAR ## _mapReduceChunk(void * data, int chunk) \
+{ \
+	PAR ## _job_t * job = data; \
+	CONTAINER ## _elem_t * it = job->firsts[chunk]; \
+	Resulttype acc = job->partial[chunk]; \
+	int i = 0; \
+	for(i = 0 ; i < job->grain && it != NULL ; i++, it = it->next) \
+		acc = job->reduce(acc, job->map(it->value, job->data)); \
+	job->partial[chunk] = acc; \
+	if(!job->deterministic) \
+	{ \
+		pthread_mutex_lock(&(job->lock)); \
+		job->result = job->reduce(job->result, acc); \
+		pthread_mutex_unlock(&(job->lock)); \
+	} \
+} \
+Resulttype PAR ## _map_reduce(ThreadPool * pool, CONTAINER * container, int grain, Resulttype init, Resulttype (*map)(Valuetype value, void * data), Resulttype (*reduce)(Resulttype acc, Resulttype value), void * data, int deterministic) \
+{ \
+	PAR ## _job_t job; \
+	int chunks = 0, i = 0; \
+	if(container == NULL || container->size <= 0) return init; \
+	job.map    = map; \
+	job.reduce = reduce; \
+	job.data   = data; \
+	job.result = init; \
+	job.deterministic = deterministic; \
+	if(deterministic) \
+		grain = PARALLEL_DETERMINISTIC_GRAIN(container->size, grain); \
+	chunks = PAR ## _chunks(pool, container, grain, &job); \
+	job.partial = malloc(sizeof(Resulttype) * chunks); \
+	for(i = 0 ; i < chunks ; i++) \
+		job.partial[i] = init; \
+	pthread_mutex_init(&(job.lock), NULL); \
+	ThreadPool_run(pool, chunks, PAR ## _mapReduceChunk, &job); \
+	pthread_mutex_destroy(&(job.lock)); \
+	if(deterministic) \
+	{ \
+		for(i = 0 ; i < chunks ; i++) \
+			job.result = reduce(job.result, job.partial[i]); \
+	} \
+	free(job.partial); \
+	free(job.firsts); \
+	return job.result; \
+}
+
+// MACRO HELPERS (One line definitions && implementations)
+#define NEW_PARALLEL_DEFINITION(PAR, VALUETYPE, RESULTTYPE) \
+NEW_PARALLEL_TYPE(PAR, VALUETYPE, RESULTTYPE); \
+PARALLEL_FN_FOR_EACH(PAR, VALUETYPE); \
+PARALLEL_FN_MAP_REDUCE(PAR, VALUETYPE, RESULTTYPE); \
+PARALLEL_FN_FILTER(PAR, VALUETYPE); \
+PARALLEL_FN_SORT(PAR, VALUETYPE)
+
+#define IMPLEMENT_PARALLEL(PAR, VALUETYPE, RESULTTYPE) \
+IMPLEMENT_PARALLEL_FN_FOR_EACH(PAR, VALUETYPE); \
+IMPLEMENT_PARALLEL_FN_MAP_REDUCE(PAR, VALUETYPE, RESULTTYPE); \
+IMPLEMENT_PARALLEL_FN_FILTER(PAR, VALUETYPE); \
+IMPLEMENT_PARALLEL_FN_SORT(PAR, VALUETYPE)
+
+#define NEW_PARALLEL_LINKED_DEFINITION(PAR, CONTAINER, VALUETYPE, RESULTTYPE) \
+NEW_PARALLEL_LINKED_TYPE(PAR, CONTAINER, VALUETYPE, RESULTTYPE); \
+PARALLEL_LINKED_FN_FOR_EACH(PAR, CONTAINER, VALUETYPE); \
+PARALLEL_LINKED_FN_MAP_REDUCE(PAR, CONTAINER, VALUETYPE, RESULTTYPE)
+
+#define IMPLEMENT_PARALLEL_LINKED(PAR, CONTAINER, VALUETYPE, RESULTTYPE) \
+IMPLEMENT_PARALLEL_LINKED_FN_CHUNKS(PAR, CONTAINER); \
+IMPLEMENT_PARALLEL_LINKED_FN_FOR_EACH(PAR, CONTAINER, VALUETYPE); \
+IMPLEMENT_PARALLEL_LINKED_FN_MAP_REDUCE(PAR, CONTAINER, VALUETYPE, RESULTTYPE)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __PARALLEL_H__
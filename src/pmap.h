@@ -0,0 +1,748 @@
+/**
+ * @file pmap.h
+ * @brief Persistent map container definition
+ * @details A persistent map is a hash array mapped trie (HAMT) whose nodes
+ * are never modified once published. A write copies the nodes on the path
+ * from the root to the element (at most 13 small nodes) and publishes a new
+ * version sharing every other node with the previous one.
+ *
+ * Readers take a snapshot, an O(1) operation pinning the current version,
+ * and read it without any lock while writers publish new versions.
+ * The nodes replaced by a write are retired with the current epoch and
+ * freed once every reader pinned before has released its snapshot
+ * (epoch-based reclamation).
+ *
+ * Writers are serialized by a mutex. Readers get a PMAP_reader_t handle
+ * once (one per thread) and use it for every snapshot.
+ * Link with -pthread.
+ * @author Baudouin FEILDEL
+ */
+#ifndef __PMAP_H__
+#define __PMAP_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Number of hash bits used by each level of the trie */
+#define PMAP_BITS 5
+
+/** Epoch of a reader without snapshot */
+#define PMAP_IDLE UINT64_MAX
+
+/**
+ Reader of persistent maps
+ @details Aligned on a cache line so that readers never share one.
+ */
+typedef struct PMAP_reader_t
+{
+	uint64_t epoch; /**< Epoch pinned by the snapshot. PMAP_IDLE without snapshot */
+	int      used;  /**< Flag:<br>1: Owned by a thread<br>0: Free for reuse */
+	struct PMAP_reader_t * next; /**< Next reader of the map */
+} __attribute__((aligned(64))) PMAP_reader_t;
+
+/**
+ Node of a persistent map
+ @details slots holds the elements (one per bit of datamap) followed by
+ the children (one per bit of nodemap). A collision node holds elements
+ with the same 64-bit hash: both maps are 0 and collisions is their count.
+ */
+typedef struct PMAP_node_t
+{
+	uint32_t datamap;    /**< Positions holding an element */
+	uint32_t nodemap;    /**< Positions holding a child node */
+	uint32_t collisions; /**< Number of elements of a collision node */
+	void * slots[];      /**< Elements then children */
+} PMAP_node_t;
+
+/** Kinds of retired objects */
+#define PMAP_RETIRED_NODE    0
+#define PMAP_RETIRED_ELEM    1
+#define PMAP_RETIRED_VERSION 2
+
+/**
+ Object waiting for the readers before being freed
+ */
+typedef struct PMAP_retired_t
+{
+	void   * ptr;   /**< Retired object */
+	int      kind;  /**< PMAP_RETIRED_NODE, PMAP_RETIRED_ELEM or PMAP_RETIRED_VERSION */
+	uint64_t epoch; /**< Epoch of the retirement */
+} PMAP_retired_t;
+
+static inline int PMAP_popcount(uint32_t map) { return __builtin_popcount(map); }
+static inline int PMAP_position(uint32_t map, uint32_t bit) { return __builtin_popcount(map & (bit - 1)); }
+static inline uint32_t PMAP_bit(uint64_t hash, int shift) { return 1u << ((hash >> shift) & 31); }
+
+static inline PMAP_node_t * PMAP_node_new(uint32_t datamap, uint32_t nodemap, uint32_t collisions)
+{
+	PMAP_node_t * node = malloc(sizeof(PMAP_node_t) + sizeof(void *)
+		* (collisions ? collisions : (uint32_t)(PMAP_popcount(datamap) + PMAP_popcount(nodemap))));
+	node->datamap    = datamap;
+	node->nodemap    = nodemap;
+	node->collisions = collisions;
+	return node;
+}
+
+static inline int PMAP_node_count(const PMAP_node_t * node)
+{
+	return node->collisions ? (int)node->collisions : PMAP_popcount(node->datamap) + PMAP_popcount(node->nodemap);
+}
+
+/* A node holding a single element and no child is inlined in its parent */
+static inline int PMAP_node_single(const PMAP_node_t * node)
+{
+	return node->nodemap == 0 && (node->collisions ? node->collisions == 1 : PMAP_popcount(node->datamap) == 1);
+}
+
+// =============
+//  Definitions
+// =============
+#define NEW_PMAP_ELEM(PMAP, ElemTypename, Valuetype, Indextype) \
+/**
+ Element of a PMAP object, never modified once published
+ */ \
+typedef struct _ ## ElemTypename \
+{ \
+	Valuetype value; /**< Value of the element */\
+	Indextype index; /**< Index of the element */\
+	uint64_t  hash;  /**< Hash of the index */\
+} ElemTypename
+
+#define NEW_PMAP_VERSION(PMAP, VersionTypename) \
+/**
+ Version of a PMAP object, as seen by a snapshot
+ */ \
+typedef struct _ ## VersionTypename \
+{ \
+	PMAP_node_t * root;  /**< Root of the trie. NULL if empty */\
+	int           size;  /**< Number of elements */\
+	struct PMAP * map;   /**< Map of the version */\
+} VersionTypename
+
+#define NEW_PMAP_TYPE(PMAP, Valuetype, Indextype) \
+NEW_PMAP_ELEM(PMAP, PMAP ## _elem_t, Valuetype, Indextype); \
+NEW_PMAP_VERSION(PMAP, PMAP ## _version_t); \
+typedef struct PMAP \
+{ \
+	PMAP ## _version_t * current; /**< Current version (atomic) */\
+	uint64_t epoch;               /**< Global epoch (atomic) */\
+	PMAP_reader_t * readers;      /**< Registered readers */\
+	PMAP_retired_t * retired;     /**< Objects waiting for the readers, by epoch */\
+	int    retiredCount;          /**< Number of retired objects */\
+	int    retiredCapacity;       /**< Allocated slots of retired */\
+	pthread_mutex_t writeLock;    /**< Lock of the writers */\
+	size_t elemSize;  /**< Size of one element in the map */\
+	int    freeValue; /**< Flag:<br>1: Automatically free the value<br>0: Do not automatically free the value */\
+	int    freeIndex; /**< Flag:<br>1: Automatically free the index<br>0: Do not automatically free the index */\
+	void (*_copyValue)(Valuetype * dest, Valuetype * src); /**< Pointer to a function used to copy a value */\
+	void (*_copyIndex)(Indextype * dest, Indextype * src); /**< Pointer to a function used to copy an index */\
+	int (*_cmpValue)(Valuetype val1, Valuetype val2); /**< Pointer to a function used to compare two values */\
+	int (*_cmpIndex)(Indextype val1, Indextype val2); /**< Pointer to a function used to compare two indexes */\
+	void (*_freeValue)(Valuetype value); /**< Pointer to a function used to free a value */\
+	void (*_freeIndex)(Indextype index); /**< Pointer to a function used to free an index */\
+	uint64_t (*_hashIndex)(Indextype index); /**< Pointer to a function used to hash an index */\
+} PMAP
+
+#define PMAP_FN_NEW(PMAP) \
+/**
+ @brief Create a new PMAP object
+ @return A pointer to an allocated and initialized
+ PMAP object in memory
+ */ \
+PMAP * PMAP ## _new()
+
+#define PMAP_FN_FREE(PMAP) \
+/**
+ Destroy a PMAP object
+ @details No reader may hold a snapshot anymore.
+ @param map A pointer to a PMAP object
+ */ \
+void PMAP ## _free(PMAP * map)
+
+#define PMAP_FN_ADD_STRUCT(PMAP, Valuetype, Indextype) \
+/**
+ Add an element to the map, publishing a new version
+ @details If an element already have this index
+ its value will be updated.
+
+ @param map   The map to use
+ @param index The index of the element to add
+ @param value The value to set
+ @return      1 if the element was inserted. 0 if it was updated
+ */ \
+int PMAP ## _add(PMAP * map, Indextype index, Valuetype value)
+
+#define PMAP_FN_REMOVE_STRUCT(PMAP, Indextype) \
+/**
+ Remove an element from the map, publishing a new version
+ @param map   A pointer to a valid PMAP object
+ @param index The index of the element to remove
+ @return      1 if the element was removed. 0 if it was not present
+ */ \
+int PMAP ## _remove(PMAP * map, Indextype index)
+
+#define PMAP_FN_READER(PMAP) \
+/**
+ Get a reader handle
+ @details A reader is used by one thread at a time. It stays valid until
+ PMAP_readerFree or the destruction of the map.
+
+ @param map A pointer to a valid PMAP object
+ @return    A reader of the map
+ */ \
+PMAP_reader_t * PMAP ## _reader(PMAP * map)
+
+#define PMAP_FN_READER_FREE(PMAP) \
+/**
+ Give a reader handle back to the map
+ @param reader A reader without snapshot
+ */ \
+void PMAP ## _readerFree(PMAP_reader_t * reader)
+
+#define PMAP_FN_SNAPSHOT(PMAP) \
+/**
+ Pin the current version of the map, in O(1) and without lock
+ @details The version and the values it holds stay valid until
+ PMAP_release. A reader holds one snapshot at a time.
+
+ @param map    A pointer to a valid PMAP object
+ @param reader Reader of the calling thread
+ @return       The current version
+ */ \
+PMAP ## _version_t * PMAP ## _snapshot(PMAP * map, PMAP_reader_t * reader)
+
+#define PMAP_FN_RELEASE(PMAP) \
+/**
+ Release the snapshot of a reader
+ @param reader A reader holding a snapshot
+ */ \
+void PMAP ## _release(PMAP_reader_t * reader)
+
+#define PMAP_FN_GET_STRUCT(PMAP, Valuetype, Indextype) \
+/**
+ Get the value of an element in a version
+ @param version A version returned by PMAP_snapshot
+ @param index   The index of the element to get
+ @return        A pointer to the value, valid until the snapshot is released.
+ NULL if the element is not present
+ */ \
+Valuetype * PMAP ## _get(PMAP ## _version_t * version, Indextype index)
+
+#define PMAP_FN_FOR_EACH_STRUCT(PMAP, Valuetype, Indextype) \
+/**
+ Call a function on every element of a version
+ @param version  A version returned by PMAP_snapshot
+ @param callback Function called with the index, the value and \c data
+ @param data     User data given to \c callback
+ */ \
+void PMAP ## _forEach(PMAP ## _version_t * version, void (*callback)(Indextype index, Valuetype value, void * data), void * data)
+
+#define PMAP_FN_RECLAIM(PMAP) \
+/**
+ Free the retired objects no reader can see anymore
+ @details Called by every write. Call it after releasing long snapshots
+ when no write follows: it waits for the writers' lock.
+
+ @param map A pointer to a valid PMAP object
+ @return    Number of objects still waiting for the readers
+ */ \
+int PMAP ## _reclaim(PMAP * map)
+
+// =================
+//  Implementations
+// =================
+#define IMPLEMENT_PMAP_FN_NEW(PMAP, Valuetype, Indextype, FN_CPY_VAL, FN_CPY_IDX, FN_CMP_VAL, FN_CMP_IDX, FN_FREE_VAL, FN_FREE_IDX, FN_HASH_IDX) \
+PMAP * PMAP ## _new() \
+{ \
+	PMAP * map = malloc(sizeof(PMAP)); \
+	map->current = malloc(sizeof(PMAP ## _version_t)); \
+	map->current->root = NULL; \
+	map->current->size = 0; \
+	map->current->map  = map; \
+	map->epoch           = 1; \
+	map->readers         = NULL; \
+	map->retired         = NULL; \
+	map->retiredCount    = 0; \
+	map->retiredCapacity = 0; \
+	pthread_mutex_init(&(map->writeLock), NULL); \
+	map->elemSize   = sizeof(PMAP ## _elem_t); \
+	map->freeValue  = 1; \
+	map->freeIndex  = 1; \
+	map->_copyValue = FN_CPY_VAL; \
+	map->_copyIndex = FN_CPY_IDX; \
+	map->_cmpValue  = FN_CMP_VAL; \
+	map->_cmpIndex  = FN_CMP_IDX; \
+	map->_freeValue = FN_FREE_VAL; \
+	map->_freeIndex = FN_FREE_IDX; \
+	map->_hashIndex = FN_HASH_IDX; \
+	return map; \
+}
+
+/* Internal helpers, called by the writer holding writeLock */
+#define IMPLEMENT_PMAP_FN_HELPERS(PMAP, Valuetype, Indextype) \
+static void PMAP ## _freeElem(PMAP * map, PMAP ## _elem_t * elem) \
+{ \
+	if(map->freeValue) map->_freeValue(elem->value); \
+	if(map->freeIndex) map->_freeIndex(elem->index); \
+	free(elem); \
+} \
+static void PMAP ## _freeTree(PMAP * map, PMAP_node_t * node) \
+{ \
+	int i = 0, elems = 0, count = 0; \
+	if(node == NULL) return; \
+	count = PMAP_node_count(node); \
+	elems = node->collisions ? count : PMAP_popcount(node->datamap); \
+	for(i = 0 ; i < count ; i++) \
+	{ \
+		if(i < elems) PMAP ## _freeElem(map, node->slots[i]); \
+		else          PMAP ## _freeTree(map, node->slots[i]); \
+	} \
+	free(node); \
+} \
+static void PMAP ## _retire(PMAP * map, void * ptr, int kind) \
+{ \
+	if(map->retiredCount == map->retiredCapacity) \
+	{ \
+		map->retiredCapacity = map->retiredCapacity ? map->retiredCapacity * 2 : 64; \
+		map->retired = realloc(map->retired, sizeof(PMAP_retired_t) * map->retiredCapacity); \
+	} \
+	map->retired[map->retiredCount].ptr   = ptr; \
+	map->retired[map->retiredCount].kind  = kind; \
+	map->retired[map->retiredCount].epoch = __atomic_load_n(&(map->epoch), __ATOMIC_RELAXED); \
+	map->retiredCount++; \
+} \
+/* Copy of node with the slot at position replaced, inserted or removed */\
+static PMAP_node_t * PMAP ## _copy(PMAP_node_t * node, uint32_t datamap, uint32_t nodemap, uint32_t collisions, \
+                                   int position, int removed, int inserted, void * slot) \
+{ \
+	PMAP_node_t * copy = PMAP_node_new(datamap, nodemap, collisions); \
+	int count = PMAP_node_count(node), i = 0, j = 0; \
+	for(i = 0 ; i < count ; i++) \
+	{ \
+		if(i == position && inserted) copy->slots[j++] = slot; \
+		if(i == position && removed)  continue; \
+		copy->slots[j++] = (i == position && !inserted) ? slot : node->slots[i]; \
+	} \
+	if(position == count && inserted) \
+		copy->slots[j++] = slot; \
+	return copy; \
+} \
+/* Node holding two elements whose hashes are equal below shift */\
+static PMAP_node_t * PMAP ## _pair(PMAP ## _elem_t * e1, PMAP ## _elem_t * e2, int shift) \
+{ \
+	PMAP_node_t * node = NULL; \
+	uint32_t b1 = 0, b2 = 0; \
+	if(shift >= 64) \
+	{ \
+		node = PMAP_node_new(0, 0, 2); \
+		node->slots[0] = e1; \
+		node->slots[1] = e2; \
+		return node; \
+	} \
+	b1 = PMAP_bit(e1->hash, shift); \
+	b2 = PMAP_bit(e2->hash, shift); \
+	if(b1 == b2) \
+	{ \
+		node = PMAP_node_new(0, b1, 0); \
+		node->slots[0] = PMAP ## _pair(e1, e2, shift + PMAP_BITS); \
+		return node; \
+	} \
+	node = PMAP_node_new(b1 | b2, 0, 0); \
+	node->slots[b1 < b2 ? 0 : 1] = e1; \
+	node->slots[b1 < b2 ? 1 : 0] = e2; \
+	return node; \
+} \
+static PMAP_node_t * PMAP ## _insert(PMAP * map, PMAP_node_t * node, int shift, PMAP ## _elem_t * elem, int * inserted) \
+{ \
+	PMAP ## _elem_t * other = NULL; \
+	PMAP_node_t * child = NULL; \
+	PMAP_node_t * copy = NULL; \
+	uint32_t bit = 0; \
+	int i = 0, j = 0, position = 0, count = 0; \
+	if(node == NULL) \
+	{ \
+		*inserted = 1; \
+		copy = PMAP_node_new(PMAP_bit(elem->hash, shift), 0, 0); \
+		copy->slots[0] = elem; \
+		return copy; \
+	} \
+	if(node->collisions) \
+	{ \
+		for(i = 0 ; i < (int)node->collisions ; i++) \
+		{ \
+			other = node->slots[i]; \
+			if(map->_cmpIndex(other->index, elem->index) == 0) \
+			{ \
+				*inserted = 0; \
+				PMAP ## _retire(map, other, PMAP_RETIRED_ELEM); \
+				PMAP ## _retire(map, node, PMAP_RETIRED_NODE); \
+				return PMAP ## _copy(node, 0, 0, node->collisions, i, 0, 0, elem); \
+			} \
+		} \
+		*inserted = 1; \
+		PMAP ## _retire(map, node, PMAP_RETIRED_NODE); \
+		return PMAP ## _copy(node, 0, 0, node->collisions + 1, i, 0, 1, elem); \
+	} \
+	bit = PMAP_bit(elem->hash, shift); \
+	if(node->datamap & bit) \
+	{ \
+		position = PMAP_position(node->datamap, bit); \
+		other = node->slots[position]; \
+		PMAP ## _retire(map, node, PMAP_RETIRED_NODE); \
+		if(other->hash == elem->hash && map->_cmpIndex(other->index, elem->index) == 0) \
+		{ \
+			*inserted = 0; \
+			PMAP ## _retire(map, other, PMAP_RETIRED_ELEM); \
+			return PMAP ## _copy(node, node->datamap, node->nodemap, 0, position, 0, 0, elem); \
+		} \
+		/* Push both elements down in a new child */\
+		*inserted = 1; \
+		child = PMAP ## _pair(other, elem, shift + PMAP_BITS); \
+		copy  = PMAP_node_new(node->datamap & ~bit, node->nodemap | bit, 0); \
+		count = PMAP_popcount(node->datamap); \
+		for(i = 0 ; i < count ; i++) \
+			if(i != position) \
+				copy->slots[j++] = node->slots[i]; \
+		position = PMAP_position(node->nodemap, bit); \
+		for(i = 0 ; i <= PMAP_popcount(node->nodemap) ; i++) \
+		{ \
+			if(i == position) copy->slots[j++] = child; \
+			if(i < PMAP_popcount(node->nodemap)) copy->slots[j++] = node->slots[count + i]; \
+		} \
+		return copy; \
+	} \
+	if(node->nodemap & bit) \
+	{ \
+		position = PMAP_popcount(node->datamap) + PMAP_position(node->nodemap, bit); \
+		child = PMAP ## _insert(map, node->slots[position], shift + PMAP_BITS, elem, inserted); \
+		PMAP ## _retire(map, node, PMAP_RETIRED_NODE); \
+		return PMAP ## _copy(node, node->datamap, node->nodemap, 0, position, 0, 0, child); \
+	} \
+	*inserted = 1; \
+	PMAP ## _retire(map, node, PMAP_RETIRED_NODE); \
+	return PMAP ## _copy(node, node->datamap | bit, node->nodemap, 0, PMAP_position(node->datamap, bit), 0, 1, elem); \
+} \
+/* Returns node itself when index is absent, NULL when the node becomes empty */\
+static PMAP_node_t * PMAP ## _erase(PMAP * map, PMAP_node_t * node, int shift, Indextype index, uint64_t hash) \
+{ \
+	PMAP ## _elem_t * elem = NULL; \
+	PMAP_node_t * child = NULL; \
+	PMAP_node_t * copy = NULL; \
+	uint32_t bit = 0; \
+	int i = 0, position = 0; \
+	if(node->collisions) \
+	{ \
+		for(i = 0 ; i < (int)node->collisions ; i++) \
+		{ \
+			elem = node->slots[i]; \
+			if(map->_cmpIndex(elem->index, index) == 0) \
+			{ \
+				PMAP ## _retire(map, elem, PMAP_RETIRED_ELEM); \
+				PMAP ## _retire(map, node, PMAP_RETIRED_NODE); \
+				return PMAP ## _copy(node, 0, 0, node->collisions - 1, i, 1, 0, NULL); \
+			} \
+		} \
+		return node; \
+	} \
+	bit = PMAP_bit(hash, shift); \
+	if(node->datamap & bit) \
+	{ \
+		position = PMAP_position(node->datamap, bit); \
+		elem = node->slots[position]; \
+		if(elem->hash != hash || map->_cmpIndex(elem->index, index) != 0) \
+			return node; \
+		PMAP ## _retire(map, elem, PMAP_RETIRED_ELEM); \
+		PMAP ## _retire(map, node, PMAP_RETIRED_NODE); \
+		if(PMAP_node_count(node) == 1) \
+			return NULL; \
+		return PMAP ## _copy(node, node->datamap & ~bit, node->nodemap, 0, position, 1, 0, NULL); \
+	} \
+	if(!(node->nodemap & bit)) \
+		return node; \
+	position = PMAP_popcount(node->datamap) + PMAP_position(node->nodemap, bit); \
+	child = PMAP ## _erase(map, node->slots[position], shift + PMAP_BITS, index, hash); \
+	if(child == node->slots[position]) \
+		return node; \
+	PMAP ## _retire(map, node, PMAP_RETIRED_NODE); \
+	if(child == NULL) \
+	{ \
+		if(PMAP_node_count(node) == 1) \
+			return NULL; \
+		return PMAP ## _copy(node, node->datamap, node->nodemap & ~bit, 0, position, 1, 0, NULL); \
+	} \
+	if(!PMAP_node_single(child)) \
+		return PMAP ## _copy(node, node->datamap, node->nodemap, 0, position, 0, 0, child); \
+	/* Inline the last element of the child, never published: free it now */\
+	elem = child->slots[0]; \
+	free(child); \
+	if(PMAP_node_count(node) == 1 && shift > 0) \
+	{ \
+		copy = PMAP_node_new(bit, 0, 0); \
+		copy->slots[0] = elem; \
+		return copy; \
+	} \
+	copy = PMAP ## _copy(node, node->datamap, node->nodemap & ~bit, 0, position, 1, 0, NULL); \
+	child = PMAP ## _copy(copy, copy->datamap | bit, copy->nodemap, 0, PMAP_position(copy->datamap, bit), 0, 1, elem); \
+	free(copy); \
+	return child; \
+} \
+/* Free the retired objects no reader can see anymore, holding writeLock */\
+static int PMAP ## _reclaimLocked(PMAP * map) \
+{ \
+	PMAP_reader_t * reader = NULL; \
+	uint64_t oldest = PMAP_IDLE, epoch = 0; \
+	int i = 0, freed = 0; \
+	/* Objects retired before the oldest pinned epoch are unreachable */\
+	for(reader = map->readers ; reader != NULL ; reader = reader->next) \
+	{ \
+		epoch = __atomic_load_n(&(reader->epoch), __ATOMIC_SEQ_CST); \
+		if(epoch < oldest) \
+			oldest = epoch; \
+	} \
+	while(freed < map->retiredCount && map->retired[freed].epoch < oldest) \
+		freed++; \
+	for(i = 0 ; i < freed ; i++) \
+	{ \
+		if(map->retired[i].kind == PMAP_RETIRED_ELEM) PMAP ## _freeElem(map, map->retired[i].ptr); \
+		else                                          free(map->retired[i].ptr); \
+	} \
+	map->retiredCount -= freed; \
+	memmove(map->retired, map->retired + freed, sizeof(PMAP_retired_t) * map->retiredCount); \
+	return map->retiredCount; \
+} \
+/* Publish a new root, retire the previous version */\
+static void PMAP ## _publish(PMAP * map, PMAP_node_t * root, int size) \
+{ \
+	PMAP ## _version_t * version = malloc(sizeof(PMAP ## _version_t)); \
+	PMAP ## _version_t * previous = map->current; \
+	version->root = root; \
+	version->size = size; \
+	version->map  = map; \
+	__atomic_store_n(&(map->current), version, __ATOMIC_SEQ_CST); \
+	PMAP ## _retire(map, previous, PMAP_RETIRED_VERSION); \
+	__atomic_fetch_add(&(map->epoch), 1, __ATOMIC_SEQ_CST); \
+	PMAP ## _reclaimLocked(map); \
+}
+
+#define IMPLEMENT_PMAP_FN_FREE(PMAP) \
+void PMAP ## _free(PMAP * map) \
+{ \
+	PMAP_reader_t * reader = NULL; \
+	PMAP_reader_t * next = NULL; \
+	int i = 0; \
+	if(map == NULL) return; \
+	/* Retired objects are not reachable from the current version */\
+	for(i = 0 ; i < map->retiredCount ; i++) \
+	{ \
+		if(map->retired[i].kind == PMAP_RETIRED_ELEM) PMAP ## _freeElem(map, map->retired[i].ptr); \
+		else                                          free(map->retired[i].ptr); \
+	} \
+	PMAP ## _freeTree(map, map->current->root); \
+	for(reader = map->readers ; reader != NULL ; reader = next) \
+	{ \
+		next = reader->next; \
+		free(reader); \
+	} \
+	pthread_mutex_destroy(&(map->writeLock)); \
+	free(map->retired); \
+	free(map->current); \
+	free(map); \
+}
+
+#define IMPLEMENT_PMAP_FN_ADD_STRUCT(PMAP, Valuetype, Indextype) \
+int PMAP ## _add(PMAP * map, Indextype index, Valuetype value) \
+{ \
+	PMAP ## _elem_t * elem = NULL; \
+	PMAP_node_t * root = NULL; \
+	int inserted = 0; \
+	if(map == NULL) return 0; \
+	elem = malloc(map->elemSize); \
+	elem->hash = map->_hashIndex(index); \
+	map->_copyIndex(&(elem->index), &(index)); \
+	map->_copyValue(&(elem->value), &(value)); \
+	pthread_mutex_lock(&(map->writeLock)); \
+	root = PMAP ## _insert(map, map->current->root, 0, elem, &inserted); \
+	PMAP ## _publish(map, root, map->current->size + inserted); \
+	pthread_mutex_unlock(&(map->writeLock)); \
+	return inserted; \
+}
+
+#define IMPLEMENT_PMAP_FN_REMOVE_STRUCT(PMAP, Indextype) \
+int PMAP ## _remove(PMAP * map, Indextype index) \
+{ \
+	PMAP_node_t * root = NULL; \
+	if(map == NULL) return 0; \
+	pthread_mutex_lock(&(map->writeLock)); \
+	root = map->current->root; \
+	if(root != NULL) \
+		root = PMAP ## _erase(map, root, 0, index, map->_hashIndex(index)); \
+	if(root == map->current->root) \
+	{ \
+		pthread_mutex_unlock(&(map->writeLock)); \
+		return 0; \
+	} \
+	PMAP ## _publish(map, root, map->current->size - 1); \
+	pthread_mutex_unlock(&(map->writeLock)); \
+	return 1; \
+}
+
+#define IMPLEMENT_PMAP_FN_READER(PMAP) \
+PMAP_reader_t * PMAP ## _reader(PMAP * map) \
+{ \
+	PMAP_reader_t * reader = NULL; \
+	void * memory = NULL; \
+	if(map == NULL) return NULL; \
+	pthread_mutex_lock(&(map->writeLock)); \
+	for(reader = map->readers ; reader != NULL ; reader = reader->next) \
+		if(!__atomic_load_n(&(reader->used), __ATOMIC_ACQUIRE)) \
+			break; \
+	if(reader == NULL && posix_memalign(&memory, 64, sizeof(PMAP_reader_t)) == 0) \
+	{ \
+		reader = memory; \
+		reader->epoch = PMAP_IDLE; \
+		reader->next  = map->readers; \
+		map->readers  = reader; \
+	} \
+	if(reader != NULL) \
+		reader->used = 1; \
+	pthread_mutex_unlock(&(map->writeLock)); \
+	return reader; \
+}
+
+#define IMPLEMENT_PMAP_FN_READER_FREE(PMAP) \
+void PMAP ## _readerFree(PMAP_reader_t * reader) \
+{ \
+	if(reader == NULL) return; \
+	__atomic_store_n(&(reader->epoch), PMAP_IDLE, __ATOMIC_RELEASE); \
+	__atomic_store_n(&(reader->used), 0, __ATOMIC_RELEASE); \
+}
+
+#define IMPLEMENT_PMAP_FN_SNAPSHOT(PMAP) \
+PMAP ## _version_t * PMAP ## _snapshot(PMAP * map, PMAP_reader_t * reader) \
+{ \
+	/* Pin the epoch before loading the version: the writers retiring */\
+	/* this version will see the pin and keep it */\
+	__atomic_store_n(&(reader->epoch), __atomic_load_n(&(map->epoch), __ATOMIC_SEQ_CST), __ATOMIC_SEQ_CST); \
+	return __atomic_load_n(&(map->current), __ATOMIC_SEQ_CST); \
+}
+
+#define IMPLEMENT_PMAP_FN_RELEASE(PMAP) \
+void PMAP ## _release(PMAP_reader_t * reader) \
+{ \
+	__atomic_store_n(&(reader->epoch), PMAP_IDLE, __ATOMIC_RELEASE); \
+}
+
+#define IMPLEMENT_PMAP_FN_GET_STRUCT(PMAP, Valuetype, Indextype) \
+Valuetype * PMAP ## _get(PMAP ## _version_t * version, Indextype index) \
+{ \
+	PMAP ## _elem_t * elem = NULL; \
+	PMAP_node_t * node = NULL; \
+	uint64_t hash = 0; \
+	uint32_t bit = 0, i = 0; \
+	int shift = 0; \
+	if(version == NULL) return NULL; \
+	hash = version->map->_hashIndex(index); \
+	for(node = version->root ; node != NULL ; shift += PMAP_BITS) \
+	{ \
+		if(node->collisions) \
+		{ \
+			for(i = 0 ; i < node->collisions ; i++) \
+			{ \
+				elem = node->slots[i]; \
+				if(version->map->_cmpIndex(elem->index, index) == 0) \
+					return &(elem->value); \
+			} \
+			return NULL; \
+		} \
+		bit = PMAP_bit(hash, shift); \
+		if(node->datamap & bit) \
+		{ \
+			elem = node->slots[PMAP_position(node->datamap, bit)]; \
+			if(elem->hash == hash && version->map->_cmpIndex(elem->index, index) == 0) \
+				return &(elem->value); \
+			return NULL; \
+		} \
+		if(!(node->nodemap & bit)) \
+			return NULL; \
+		node = node->slots[PMAP_popcount(node->datamap) + PMAP_position(node->nodemap, bit)]; \
+	} \
+	return NULL; \
+}
+
+#define IMPLEMENT_PMAP_FN_FOR_EACH_STRUCT(PMAP, Valuetype, Indextype) \
+static void PMAP ## _forEachNode(PMAP_node_t * node, void (*callback)(Indextype index, Valuetype value, void * data), void * data) \
+{ \
+	PMAP ## _elem_t * elem = NULL; \
+	int i = 0, elems = 0, count = 0; \
+	if(node == NULL) return; \
+	count = PMAP_node_count(node); \
+	elems = node->collisions ? count : PMAP_popcount(node->datamap); \
+	for(i = 0 ; i < count ; i++) \
+	{ \
+		if(i < elems) \
+		{ \
+			elem = node->slots[i]; \
+			callback(elem->index, elem->value, data); \
+		} \
+		else \
+			PMAP ## _forEachNode(node->slots[i], callback, data); \
+	} \
+} \
+void PMAP ## _forEach(PMAP ## _version_t * version, void (*callback)(Indextype index, Valuetype value, void * data), void * data) \
+{ \
+	if(version == NULL) return; \
+	PMAP ## _forEachNode(version->root, callback, data); \
+}
+
+#define IMPLEMENT_PMAP_FN_RECLAIM(PMAP) \
+int PMAP ## _reclaim(PMAP * map) \
+{ \
+	int count = 0; \
+	if(map == NULL) return 0; \
+	pthread_mutex_lock(&(map->writeLock)); \
+	count = PMAP ## _reclaimLocked(map); \
+	pthread_mutex_unlock(&(map->writeLock)); \
+	return count; \
+}
+
+
+// MACRO HELPERS (One line definitions && implementations)
+#define NEW_PMAP_DEFINITION(PMAP, VALUETYPE, INDEXTYPE) \
+NEW_PMAP_TYPE(PMAP, VALUETYPE, INDEXTYPE); \
+PMAP_FN_NEW(PMAP); \
+PMAP_FN_FREE(PMAP); \
+PMAP_FN_ADD_STRUCT(PMAP, VALUETYPE, INDEXTYPE); \
+PMAP_FN_REMOVE_STRUCT(PMAP, INDEXTYPE); \
+PMAP_FN_READER(PMAP); \
+PMAP_FN_READER_FREE(PMAP); \
+PMAP_FN_SNAPSHOT(PMAP); \
+PMAP_FN_RELEASE(PMAP); \
+PMAP_FN_GET_STRUCT(PMAP, VALUETYPE, INDEXTYPE); \
+PMAP_FN_FOR_EACH_STRUCT(PMAP, VALUETYPE, INDEXTYPE); \
+PMAP_FN_RECLAIM(PMAP)
+
+#define IMPLEMENT_PMAP(PMAP, VALUETYPE, INDEXTYPE, FN_CPY_VAL, FN_CPY_IDX, FN_CMP_VAL, FN_CMP_IDX, FN_FREE_VAL, FN_FREE_IDX, FN_HASH_IDX) \
+IMPLEMENT_PMAP_FN_NEW(PMAP, VALUETYPE, INDEXTYPE, FN_CPY_VAL, FN_CPY_IDX, FN_CMP_VAL, FN_CMP_IDX, FN_FREE_VAL, FN_FREE_IDX, FN_HASH_IDX); \
+IMPLEMENT_PMAP_FN_HELPERS(PMAP, VALUETYPE, INDEXTYPE); \
+IMPLEMENT_PMAP_FN_FREE(PMAP); \
+IMPLEMENT_PMAP_FN_ADD_STRUCT(PMAP, VALUETYPE, INDEXTYPE); \
+IMPLEMENT_PMAP_FN_REMOVE_STRUCT(PMAP, INDEXTYPE); \
+IMPLEMENT_PMAP_FN_READER(PMAP); \
+IMPLEMENT_PMAP_FN_READER_FREE(PMAP); \
+IMPLEMENT_PMAP_FN_SNAPSHOT(PMAP); \
+IMPLEMENT_PMAP_FN_RELEASE(PMAP); \
+IMPLEMENT_PMAP_FN_GET_STRUCT(PMAP, VALUETYPE, INDEXTYPE); \
+IMPLEMENT_PMAP_FN_FOR_EACH_STRUCT(PMAP, VALUETYPE, INDEXTYPE); \
+IMPLEMENT_PMAP_FN_RECLAIM(PMAP)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __PMAP_H__
@@ -0,0 +1,472 @@
+/**
+ * @file pqueue.h
+ * @brief Priority queue container definition
+ * @details A priority queue is a d-ary heap stored in a contiguous array.
+ * The element with the lowest value (according to _cmpValue) is always
+ * on top. The arity is given to IMPLEMENT_PQUEUE: 4 or 8 children per node
+ * make the heap shallower and keep the children of a node on the same
+ * cache lines.
+ *
+ * Every pushed element gets a handle which stays valid until the element
+ * is popped. Handles are used to change the priority of an element.
+ * @author Baudouin FEILDEL
+ */
+#ifndef __PQUEUE_H__
+#define __PQUEUE_H__
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============
+//  Definitions
+// =============
+#define NEW_PQUEUE_ELEM(PQUEUE, ElemTypename, ValueType) \
+/**
+ Element of a PQUEUE object
+ */ \
+typedef struct _ ## ElemTypename \
+{ \
+	ValueType value;  /**< Value of the element */\
+	int       handle; /**< Handle of the element */\
+} ElemTypename
+
+#define NEW_PQUEUE_TYPE(PQUEUE, ValueType) \
+NEW_PQUEUE_ELEM(PQUEUE, PQUEUE ## _elem_t, ValueType); \
+typedef struct PQUEUE \
+{ \
+	PQUEUE ## _elem_t * heap; /**< Heap array, heap[0] is the top of the queue */\
+	int  * position;          /**< position[handle] is the position of the element in heap. -1 if the handle is free */\
+	int  * freeHandles;       /**< Stack of free handles */\
+	int    freeHandlesSize;   /**< Number of free handles */\
+	int    handles;           /**< Number of allocated handles */\
+	int    size;              /**< Priority queue size */\
+	int    capacity;          /**< Number of allocated slots in heap */\
+	int    arity;             /**< Number of children of a node */\
+	size_t elemSize;          /**< Size of one element in the priority queue */\
+	int    freeValue;         /**< Flag:<br>1: Automatically free the value<br>0: Do not automatically free the value */\
+	void (*_copyValue) (ValueType * dest, ValueType * src); /**< Pointer to a function used to copy a value */\
+	int  (*_cmpValue)  (ValueType val1, ValueType val2);    /**< Pointer to a function used to order two values */\
+	void (*_freeValue) (ValueType value);                   /**< Pointer to a function used to free a value */\
+	void (*_print)     (ValueType value);                   /**< Pointer to a function used to print a value */\
+} PQUEUE
+
+#define PQUEUE_FN_NEW(PQUEUE) \
+/**
+ @brief Create a new PQUEUE object
+ @return A pointer to an allocated and initialized
+ PQUEUE object in memory
+ */ \
+PQUEUE * PQUEUE ## _new()
+
+#define PQUEUE_FN_FREE(PQUEUE) \
+/**
+ Destroy a PQUEUE object
+ @param pqueue A pointer to a PQUEUE object
+ */ \
+void PQUEUE ## _free(PQUEUE * pqueue)
+
+#define PQUEUE_FN_PUSH_STRUCT(PQUEUE, ValueType) \
+/**
+ Push an element to the priority queue
+ @param pqueue A pointer to a valid PQUEUE object
+ @param value  The value to push
+ @return       The handle of the element. -1 on error
+ */ \
+int PQUEUE ## _push(PQUEUE * pqueue, ValueType value)
+
+#define PQUEUE_FN_POP_STRUCT(PQUEUE, ValueType) \
+/**
+ Remove the element on top of the priority queue
+ @details The caller becomes the owner of the returned value.
+
+ @param pqueue A pointer to a valid PQUEUE object
+ @return       The lowest value of the queue. The default value if empty
+ */ \
+ValueType PQUEUE ## _pop(PQUEUE * pqueue)
+
+#define PQUEUE_FN_PEEK_STRUCT(PQUEUE, ValueType) \
+/**
+ Get the value on top of the priority queue
+ @param pqueue A pointer to a valid PQUEUE object
+ @return       The lowest value of the queue. The default value if empty
+ */ \
+ValueType PQUEUE ## _peek(PQUEUE * pqueue)
+
+#define PQUEUE_FN_DECREASE_KEY_STRUCT(PQUEUE, ValueType) \
+/**
+ Change the value of an element
+ @details The element moves up the heap when the new value is lower.
+ A greater value is accepted too, the element then moves down.
+
+ @param pqueue A pointer to a valid PQUEUE object
+ @param handle The handle returned by PQUEUE_push
+ @param value  The new value of the element
+ @return       0 on success. -1 if the handle is not valid
+ */ \
+int PQUEUE ## _decrease_key(PQUEUE * pqueue, int handle, ValueType value)
+
+#define PQUEUE_FN_HEAPIFY_STRUCT(PQUEUE, ValueType) \
+/**
+ Push an array of values at once
+ @details The values are appended then the whole heap is rebuilt
+ bottom-up, which is O(n) instead of O(n.log(n)) for n pushes.
+
+ @param pqueue  A pointer to a valid PQUEUE object
+ @param values  Array of \c count values
+ @param count   Number of values
+ @param handles If not NULL, receives the \c count handles
+ @return        The pointer to the PQUEUE object
+ */ \
+PQUEUE * PQUEUE ## _heapify(PQUEUE * pqueue, ValueType * values, int count, int * handles)
+
+#define PQUEUE_FN_CLEAR(PQUEUE) \
+/**
+ Remove every element of the priority queue
+ @details The arrays are kept for the next pushes. Every handle becomes
+ invalid.
+ @param pqueue A pointer to a valid PQUEUE object
+ */ \
+void PQUEUE ## _clear(PQUEUE * pqueue)
+
+#define PQUEUE_FN_RESERVE(PQUEUE) \
+/**
+ Allocate room for n elements
+ @details The priority queue then holds n elements without reallocating.
+ @param pqueue A pointer to a valid PQUEUE object
+ @param n      Number of elements to hold
+ */ \
+void PQUEUE ## _reserve(PQUEUE * pqueue, int n)
+
+#define PQUEUE_FN_SHRINK_TO_FIT(PQUEUE) \
+/**
+ Release the slots and handles not used by the elements
+ @details Handles of the elements stay valid.
+ @param pqueue A pointer to a valid PQUEUE object
+ */ \
+void PQUEUE ## _shrink_to_fit(PQUEUE * pqueue)
+
+#define PQUEUE_FN_PRINT_STRUCT(PQUEUE) \
+/**
+ Print a priority queue in heap order
+ @param pqueue A pointer to a valid PQUEUE object
+ */ \
+void PQUEUE ## _print(PQUEUE * pqueue)
+
+// =================
+//  Implementations
+// =================
+#define IMPLEMENT_PQUEUE_FN_NEW(PQUEUE, Valuetype, ARITY, FN_CPY_VAL, FN_CMP_VAL, FN_FREE_VAL, FN_PRINT_VAL) \
+PQUEUE * PQUEUE ## _new() \
+{ \
+	PQUEUE * pqueue = malloc(sizeof(PQUEUE)); \
+	pqueue->heap        = NULL; \
+	pqueue->position    = NULL; \
+	pqueue->freeHandles = NULL; \
+	pqueue->freeHandlesSize = 0; \
+	pqueue->handles   = 0; \
+	pqueue->size      = 0; \
+	pqueue->capacity  = 0; \
+	pqueue->arity     = ARITY; \
+	pqueue->elemSize   = sizeof(PQUEUE ## _elem_t); \
+	pqueue->freeValue  = 1; \
+	pqueue->_copyValue = FN_CPY_VAL; \
+	pqueue->_cmpValue  = FN_CMP_VAL; \
+	pqueue->_freeValue = FN_FREE_VAL; \
+	pqueue->_print     = FN_PRINT_VAL; \
+	return pqueue; \
+}
+
+#define IMPLEMENT_PQUEUE_FN_FREE(PQUEUE) \
+void PQUEUE ## _free(PQUEUE * pqueue) \
+{ \
+	int i = 0; \
+	if(pqueue == NULL) return; \
+	if(pqueue->freeValue) \
+	{ \
+		for(i = 0 ; i < pqueue->size ; i++) \
+			pqueue->_freeValue(pqueue->heap[i].value); \
+	} \
+	free(pqueue->heap); \
+	free(pqueue->position); \
+	free(pqueue->freeHandles); \
+	free(pqueue); \
+}
+
+/* Internal helpers: move an element up or down, keeping handles up to date */
+#define IMPLEMENT_PQUEUE_FN_SIFT(PQUEUE, ARITY) \
+static void PQUEUE ## _siftUp(PQUEUE * pqueue, int pos) \
+{ \
+	PQUEUE ## _elem_t elem = pqueue->heap[pos]; \
+	int parent = 0; \
+	while(pos > 0) \
+	{ \
+		parent = (pos - 1) / (ARITY); \
+		if(pqueue->_cmpValue(elem.value, pqueue->heap[parent].value) >= 0) \
+			break; \
+		pqueue->heap[pos] = pqueue->heap[parent]; \
+		pqueue->position[pqueue->heap[pos].handle] = pos; \
+		pos = parent; \
+	} \
+	pqueue->heap[pos] = elem; \
+	pqueue->position[elem.handle] = pos; \
+} \
+static void PQUEUE ## _siftDown(PQUEUE * pqueue, int pos) \
+{ \
+	PQUEUE ## _elem_t elem = pqueue->heap[pos]; \
+	int child = 0, last = 0, best = 0; \
+	while(1) \
+	{ \
+		child = pos * (ARITY) + 1; \
+		if(child >= pqueue->size) \
+			break; \
+		last = (child + (ARITY) < pqueue->size) ? child + (ARITY) : pqueue->size; \
+		for(best = child++ ; child < last ; child++) \
+		{ \
+			if(pqueue->_cmpValue(pqueue->heap[child].value, pqueue->heap[best].value) < 0) \
+				best = child; \
+		} \
+		if(pqueue->_cmpValue(pqueue->heap[best].value, elem.value) >= 0) \
+			break; \
+		pqueue->heap[pos] = pqueue->heap[best]; \
+		pqueue->position[pqueue->heap[pos].handle] = pos; \
+		pos = best; \
+	} \
+	pqueue->heap[pos] = elem; \
+	pqueue->position[elem.handle] = pos; \
+} \
+static void PQUEUE ## _grow(PQUEUE * pqueue, int count) \
+{ \
+	int capacity = 0, i = 0; \
+	if(pqueue->size + count > pqueue->capacity) \
+	{ \
+		capacity = (pqueue->capacity == 0) ? 16 : pqueue->capacity * 2; \
+		while(capacity < pqueue->size + count) \
+			capacity *= 2; \
+		pqueue->heap = realloc(pqueue->heap, pqueue->elemSize * capacity); \
+		pqueue->capacity = capacity; \
+	} \
+	if(pqueue->freeHandlesSize < count) \
+	{ \
+		capacity = (pqueue->handles == 0) ? 16 : pqueue->handles * 2; \
+		while(capacity - pqueue->handles + pqueue->freeHandlesSize < count) \
+			capacity *= 2; \
+		pqueue->position    = realloc(pqueue->position, sizeof(int) * capacity); \
+		pqueue->freeHandles = realloc(pqueue->freeHandles, sizeof(int) * capacity); \
+		for(i = capacity - 1 ; i >= pqueue->handles ; i--) \
+		{ \
+			pqueue->position[i] = -1; \
+			pqueue->freeHandles[pqueue->freeHandlesSize++] = i; \
+		} \
+		pqueue->handles = capacity; \
+	} \
+}
+
+#define IMPLEMENT_PQUEUE_FN_PUSH_STRUCT(PQUEUE, Valuetype) \
+int PQUEUE ## _push(PQUEUE * pqueue, Valuetype value) \
+{ \
+	int handle = 0; \
+	/* Test if pqueue is NULL */\
+	if(pqueue == NULL) \
+		return -1; \
+	PQUEUE ## _grow(pqueue, 1); \
+	/* Insert the element at the bottom of the heap */\
+	handle = pqueue->freeHandles[--pqueue->freeHandlesSize]; \
+	pqueue->heap[pqueue->size].handle = handle; \
+	pqueue->_copyValue(&(pqueue->heap[pqueue->size].value), &(value)); \
+	pqueue->size++; \
+	PQUEUE ## _siftUp(pqueue, pqueue->size - 1); \
+	return handle; \
+}
+
+#define IMPLEMENT_PQUEUE_FN_POP_STRUCT(PQUEUE, ValueType, DEFAULT_VALUE) \
+ValueType PQUEUE ## _pop(PQUEUE * pqueue) \
+{ \
+	PQUEUE ## _elem_t top; \
+	/* Check Empty pqueue */\
+	if(pqueue == NULL) \
+		return DEFAULT_VALUE; \
+	if(pqueue->size == 0) \
+		return DEFAULT_VALUE; \
+	top = pqueue->heap[0]; \
+	pqueue->position[top.handle] = -1; \
+	pqueue->freeHandles[pqueue->freeHandlesSize++] = top.handle; \
+	pqueue->size--; \
+	if(pqueue->size > 0) \
+	{ \
+		pqueue->heap[0] = pqueue->heap[pqueue->size]; \
+		PQUEUE ## _siftDown(pqueue, 0); \
+	} \
+	return top.value; \
+}
+
+#define IMPLEMENT_PQUEUE_FN_PEEK_STRUCT(PQUEUE, ValueType, DEFAULT_VALUE) \
+ValueType PQUEUE ## _peek(PQUEUE * pqueue) \
+{ \
+	if(pqueue == NULL) return DEFAULT_VALUE; \
+	if(pqueue->size > 0) \
+		return pqueue->heap[0].value; \
+	return DEFAULT_VALUE; \
+}
+
+#define IMPLEMENT_PQUEUE_FN_DECREASE_KEY_STRUCT(PQUEUE, ValueType) \
+int PQUEUE ## _decrease_key(PQUEUE * pqueue, int handle, ValueType value) \
+{ \
+	int pos = 0; \
+	if(pqueue == NULL) return -1; \
+	if(handle < 0 || handle >= pqueue->handles) return -1; \
+	pos = pqueue->position[handle]; \
+	if(pos < 0) return -1; \
+	if(pqueue->freeValue) pqueue->_freeValue(pqueue->heap[pos].value); \
+	pqueue->_copyValue(&(pqueue->heap[pos].value), &(value)); \
+	PQUEUE ## _siftUp(pqueue, pos); \
+	PQUEUE ## _siftDown(pqueue, pqueue->position[handle]); \
+	return 0; \
+}
+
+#define IMPLEMENT_PQUEUE_FN_HEAPIFY_STRUCT(PQUEUE, ValueType, ARITY) \
+PQUEUE * PQUEUE ## _heapify(PQUEUE * pqueue, ValueType * values, int count, int * handles) \
+{ \
+	int i = 0, handle = 0; \
+	if(pqueue == NULL) return NULL; \
+	if(count <= 0)     return pqueue; \
+	PQUEUE ## _grow(pqueue, count); \
+	/* Append the values without ordering them */\
+	for(i = 0 ; i < count ; i++) \
+	{ \
+		handle = pqueue->freeHandles[--pqueue->freeHandlesSize]; \
+		pqueue->heap[pqueue->size].handle = handle; \
+		pqueue->_copyValue(&(pqueue->heap[pqueue->size].value), &(values[i])); \
+		pqueue->position[handle] = pqueue->size; \
+		pqueue->size++; \
+		if(handles != NULL) handles[i] = handle; \
+	} \
+	/* Sift down every internal node, starting from the last one */\
+	for(i = (pqueue->size - 2) / (ARITY) ; i >= 0 ; i--) \
+		PQUEUE ## _siftDown(pqueue, i); \
+	return pqueue; \
+}
+
+#define IMPLEMENT_PQUEUE_FN_CLEAR(PQUEUE) \
+void PQUEUE ## _clear(PQUEUE * pqueue) \
+{ \
+	int i = 0; \
+	if(pqueue == NULL) return; \
+	if(pqueue->freeValue) \
+	{ \
+		for(i = 0 ; i < pqueue->size ; i++) \
+			pqueue->_freeValue(pqueue->heap[i].value); \
+	} \
+	pqueue->size = 0; \
+	/* Every handle is free again, lowest first */\
+	pqueue->freeHandlesSize = 0; \
+	for(i = pqueue->handles - 1 ; i >= 0 ; i--) \
+	{ \
+		pqueue->position[i] = -1; \
+		pqueue->freeHandles[pqueue->freeHandlesSize++] = i; \
+	} \
+}
+
+#define IMPLEMENT_PQUEUE_FN_RESERVE(PQUEUE) \
+void PQUEUE ## _reserve(PQUEUE * pqueue, int n) \
+{ \
+	if(pqueue == NULL || n <= pqueue->size) return; \
+	PQUEUE ## _grow(pqueue, n - pqueue->size); \
+}
+
+#define IMPLEMENT_PQUEUE_FN_SHRINK_TO_FIT(PQUEUE) \
+void PQUEUE ## _shrink_to_fit(PQUEUE * pqueue) \
+{ \
+	int i = 0, handles = 0; \
+	if(pqueue == NULL) return; \
+	if(pqueue->capacity > pqueue->size) \
+	{ \
+		if(pqueue->size == 0) \
+		{ \
+			free(pqueue->heap); \
+			pqueue->heap = NULL; \
+		} \
+		else \
+			pqueue->heap = realloc(pqueue->heap, pqueue->elemSize * pqueue->size); \
+		pqueue->capacity = pqueue->size; \
+	} \
+	/* Keep the handles up to the highest one in use */\
+	for(handles = pqueue->handles ; handles > 0 && pqueue->position[handles - 1] < 0 ; handles--); \
+	if(handles == pqueue->handles) return; \
+	pqueue->freeHandlesSize = 0; \
+	for(i = handles - 1 ; i >= 0 ; i--) \
+		if(pqueue->position[i] < 0) \
+			pqueue->freeHandles[pqueue->freeHandlesSize++] = i; \
+	if(handles == 0) \
+	{ \
+		free(pqueue->position); \
+		free(pqueue->freeHandles); \
+		pqueue->position    = NULL; \
+		pqueue->freeHandles = NULL; \
+	} \
+	else \
+	{ \
+		pqueue->position    = realloc(pqueue->position, sizeof(int) * handles); \
+		pqueue->freeHandles = realloc(pqueue->freeHandles, sizeof(int) * handles); \
+	} \
+	pqueue->handles = handles; \
+}
+
+#ifdef CCONTAINERS_DISABLE_PRINT
+#define IMPLEMENT_PQUEUE_FN_PRINT(PQUEUE) \
+void PQUEUE ## _print(PQUEUE * pqueue) \
+{ \
+	(void)(pqueue); \
+}
+#else
+#define IMPLEMENT_PQUEUE_FN_PRINT(PQUEUE) \
+void PQUEUE ## _print(PQUEUE * pqueue) \
+{ \
+	int i = 0; \
+	printf("["); \
+	for(i = 0 ; i < pqueue->size ; i++) \
+	{ \
+		pqueue->_print(pqueue->heap[i].value); \
+		if(i + 1 < pqueue->size) \
+			printf(", "); \
+	} \
+	printf("]\n"); \
+}
+#endif
+
+// MACRO HELPERS (One line definitions && implementations)
+#define NEW_PQUEUE_DEFINITION(PQUEUE, VALUETYPE) \
+NEW_PQUEUE_TYPE(PQUEUE, VALUETYPE); \
+PQUEUE_FN_NEW(PQUEUE); \
+PQUEUE_FN_FREE(PQUEUE); \
+PQUEUE_FN_PUSH_STRUCT(PQUEUE, VALUETYPE); \
+PQUEUE_FN_POP_STRUCT(PQUEUE, VALUETYPE); \
+PQUEUE_FN_PEEK_STRUCT(PQUEUE, VALUETYPE); \
+PQUEUE_FN_DECREASE_KEY_STRUCT(PQUEUE, VALUETYPE); \
+PQUEUE_FN_HEAPIFY_STRUCT(PQUEUE, VALUETYPE); \
+PQUEUE_FN_CLEAR(PQUEUE); \
+PQUEUE_FN_RESERVE(PQUEUE); \
+PQUEUE_FN_SHRINK_TO_FIT(PQUEUE); \
+PQUEUE_FN_PRINT_STRUCT(PQUEUE)
+
+#define IMPLEMENT_PQUEUE(PQUEUE, VALUETYPE, ARITY, FN_CPY_VAL, FN_CMP_VAL, FN_FREE_VAL, FN_PRINT_VAL, DEFAULT_VALUE) \
+IMPLEMENT_PQUEUE_FN_NEW(PQUEUE, VALUETYPE, ARITY, FN_CPY_VAL, FN_CMP_VAL, FN_FREE_VAL, FN_PRINT_VAL); \
+IMPLEMENT_PQUEUE_FN_FREE(PQUEUE); \
+IMPLEMENT_PQUEUE_FN_SIFT(PQUEUE, ARITY); \
+IMPLEMENT_PQUEUE_FN_PUSH_STRUCT(PQUEUE, VALUETYPE); \
+IMPLEMENT_PQUEUE_FN_POP_STRUCT(PQUEUE, VALUETYPE, DEFAULT_VALUE); \
+IMPLEMENT_PQUEUE_FN_PEEK_STRUCT(PQUEUE, VALUETYPE, DEFAULT_VALUE); \
+IMPLEMENT_PQUEUE_FN_DECREASE_KEY_STRUCT(PQUEUE, VALUETYPE); \
+IMPLEMENT_PQUEUE_FN_HEAPIFY_STRUCT(PQUEUE, VALUETYPE, ARITY); \
+IMPLEMENT_PQUEUE_FN_CLEAR(PQUEUE); \
+IMPLEMENT_PQUEUE_FN_RESERVE(PQUEUE); \
+IMPLEMENT_PQUEUE_FN_SHRINK_TO_FIT(PQUEUE); \
+IMPLEMENT_PQUEUE_FN_PRINT(PQUEUE)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __PQUEUE_H__
@@ -33,6 +33,8 @@ typedef struct QUEUE \
 	QUEUE ## _elem_t * head;  /**< Head of the queue */\
 	QUEUE ## _elem_t * queue; /**< Queue of the queue */\
 	int    size;              /**< Queue size */\
+	QUEUE ## _elem_t * spare; /**< Unused elements kept for reuse, linked by previous */\
+	int    spareCount;        /**< Number of elements in spare */\
 	size_t elemSize;          /**< Size of one element in the queue */\
 	int    freeValue;         /**< Flag:<br>1: Automatically free the value<br>0: Do not automatically free the value */\
 	void (*_copyValue) (ValueType * dest, ValueType * src); /**< Pointer to a function used to copy a value */\
@@ -71,9 +73,9 @@ QUEUE ## _elem_t * QUEUE ## _enqueue(QUEUE * queue, ValueType value)
 #define QUEUE_FN_DEQUEUE_STRUCT(QUEUE, ValueType) \
 /**
  Remove an element from the queue
+ @details The caller becomes the owner of the returned value.
  @param queue  A pointer to a valid QUEUE object
- @param index The index of the element to remove
- @return      The pointer to the QUEUE object
+ @return      The value at the head of the queue. The default value if empty
  */ \
 ValueType QUEUE ## _dequeue(QUEUE * queue)
 
@@ -86,6 +88,32 @@ ValueType QUEUE ## _dequeue(QUEUE * queue)
  */ \
 ValueType QUEUE ## _head(QUEUE * queue)
 
+#define QUEUE_FN_CLEAR(QUEUE) \
+/**
+ Remove every element of the queue
+ @details The elements are kept for the next insertions.
+ @param queue A pointer to a valid QUEUE object
+ */ \
+void QUEUE ## _clear(QUEUE * queue)
+
+#define QUEUE_FN_RESERVE(QUEUE) \
+/**
+ Allocate the elements for n values
+ @details The queue then holds n values without allocating.
+ @param queue A pointer to a valid QUEUE object
+ @param n     Number of values to hold
+ */ \
+void QUEUE ## _reserve(QUEUE * queue, int n)
+
+#define QUEUE_FN_SHRINK_TO_FIT(QUEUE) \
+/**
+ Release the elements kept for reuse
+ @details Elements left by QUEUE_clear and QUEUE_reserve are kept for
+ the next insertions until this call.
+ @param queue A pointer to a valid QUEUE object
+ */ \
+void QUEUE ## _shrink_to_fit(QUEUE * queue)
+
 #define QUEUE_FN_PRINT_STRUCT(QUEUE) \
 /**
  Print a queue
@@ -103,6 +131,8 @@ QUEUE * QUEUE ## _new() \
 	queue->size  = 0; \
 	queue->head  = NULL; \
 	queue->queue = NULL; \
+	queue->spare = NULL; \
+	queue->spareCount = 0; \
 	queue->elemSize   = sizeof(QUEUE ## _elem_t); \
 	queue->freeValue  = 1; \
 	queue->_copyValue = FN_CPY_VAL; \
@@ -125,6 +155,8 @@ void QUEUE ## _free(QUEUE * queue) \
 		queue->head = it->previous; \
 		free(it); \
 	} \
+	QUEUE ## _shrink_to_fit(queue); \
+	free(queue); \
 }
 
 #define IMPLEMENT_QUEUE_FN_ENQUEUE_STRUCT(QUEUE, Valuetype) \
@@ -134,8 +166,14 @@ QUEUE ## _elem_t * QUEUE ## _enqueue(QUEUE * queue, Valuetype value) \
 	/* Test if queue is NULL */\
 	if(queue == NULL) \
 		return NULL; \
-	/* Create the element */\
-	elem = malloc(queue->elemSize); \
+	/* Create the element, reusing a spare one */\
+	if((elem = queue->spare) != NULL) \
+	{ \
+		queue->spare = elem->previous; \
+		queue->spareCount--; \
+	} \
+	else \
+		elem = malloc(queue->elemSize); \
 	elem->previous = NULL; \
 	queue->_copyValue(&(elem->value), &(value)); \
 	/* Insert the element */\
@@ -161,8 +199,10 @@ ValueType QUEUE ## _dequeue(QUEUE * queue) \
 	if(elem != NULL) \
 	{ \
 		queue->head = elem->previous; \
+		if(queue->head == NULL) \
+			queue->queue = NULL; \
 		queue->size--; \
-		queue->_copyValue(&(value), &(elem->value)); \
+		value = elem->value; \
 		free(elem); \
 	} \
 	return value; \
@@ -177,11 +217,57 @@ ValueType QUEUE ## _head(QUEUE * queue) \
 		return queue->head->value; \
 	return DEFAULT_VALUE; \
 }
+
+#define IMPLEMENT_QUEUE_FN_CLEAR(QUEUE) \
+void QUEUE ## _clear(QUEUE * queue) \
+{ \
+	QUEUE ## _elem_t * it = NULL; \
+	if(queue == NULL || queue->head == NULL) return; \
+	if(queue->freeValue) \
+		for(it = queue->head ; it != NULL ; it = it->previous) \
+			queue->_freeValue(it->value); \
+	/* Put the whole chain in front of spare */\
+	queue->queue->previous = queue->spare; \
+	queue->spare      = queue->head; \
+	queue->spareCount += queue->size; \
+	queue->head  = NULL; \
+	queue->queue = NULL; \
+	queue->size  = 0; \
+}
+
+#define IMPLEMENT_QUEUE_FN_RESERVE(QUEUE) \
+void QUEUE ## _reserve(QUEUE * queue, int n) \
+{ \
+	QUEUE ## _elem_t * elem = NULL; \
+	if(queue == NULL) return; \
+	while(queue->size + queue->spareCount < n) \
+	{ \
+		if((elem = malloc(queue->elemSize)) == NULL) \
+			return; \
+		elem->previous = queue->spare; \
+		queue->spare   = elem; \
+		queue->spareCount++; \
+	} \
+}
+
+#define IMPLEMENT_QUEUE_FN_SHRINK_TO_FIT(QUEUE) \
+void QUEUE ## _shrink_to_fit(QUEUE * queue) \
+{ \
+	QUEUE ## _elem_t * it = NULL; \
+	if(queue == NULL) return; \
+	while((it = queue->spare) != NULL) \
+	{ \
+		queue->spare = it->previous; \
+		free(it); \
+	} \
+	queue->spareCount = 0; \
+}
+
 #ifdef CCONTAINERS_DISABLE_PRINT
 #define IMPLEMENT_QUEUE_FN_PRINT(QUEUE) \
 void QUEUE ## _print(QUEUE * queue) \
 { \
-	(void)(list); \
+	(void)(queue); \
 }
 #else
 #define IMPLEMENT_QUEUE_FN_PRINT(QUEUE) \
@@ -209,6 +295,9 @@ QUEUE_FN_FREE(QUEUE); \
 QUEUE_FN_ENQUEUE_STRUCT(QUEUE, VALUETYPE); \
 QUEUE_FN_DEQUEUE_STRUCT(QUEUE, VALUETYPE); \
 QUEUE_FN_HEAD_STRUCT(QUEUE, VALUETYPE); \
+QUEUE_FN_CLEAR(QUEUE); \
+QUEUE_FN_RESERVE(QUEUE); \
+QUEUE_FN_SHRINK_TO_FIT(QUEUE); \
 QUEUE_FN_PRINT_STRUCT(QUEUE)
 
 #define IMPLEMENT_QUEUE(QUEUE, VALUETYPE, FN_CPY_VAL, FN_CMP_VAL, FN_FREE_VAL, FN_PRINT_VAL, DEFAULT_VALUE) \
@@ -217,6 +306,9 @@ IMPLEMENT_QUEUE_FN_FREE(QUEUE); \
 IMPLEMENT_QUEUE_FN_ENQUEUE_STRUCT(QUEUE, VALUETYPE); \
 IMPLEMENT_QUEUE_FN_DEQUEUE_STRUCT(QUEUE, VALUETYPE, DEFAULT_VALUE); \
 IMPLEMENT_QUEUE_FN_HEAD_STRUCT(QUEUE, VALUETYPE, DEFAULT_VALUE); \
+IMPLEMENT_QUEUE_FN_CLEAR(QUEUE); \
+IMPLEMENT_QUEUE_FN_RESERVE(QUEUE); \
+IMPLEMENT_QUEUE_FN_SHRINK_TO_FIT(QUEUE); \
 IMPLEMENT_QUEUE_FN_PRINT(QUEUE)
 
 #ifdef __cplusplus
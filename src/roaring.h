@@ -0,0 +1,945 @@
+/**
+ * @file roaring.h
+ * @brief Compressed set of 32-bit unsigned integers (roaring bitmap)
+ * @details Values are grouped by their high 16 bits. Each group is kept in
+ * the smallest of three containers:
+ * - array  Sorted array of the low 16 bits, up to 4096 values (2 bytes per value)
+ * - bitmap 65536 bits (8 KiB), for dense groups
+ * - run    Sorted (start, length - 1) pairs, for consecutive values.
+ *   Runs are created by Roaring_optimize; adding to or removing from a
+ *   run container turns it back into an array or a bitmap.
+ *
+ * Cardinalities are kept per container, bitmaps are combined one 64-bit
+ * word at a time with popcount (the POPCNT instruction when the CPU
+ * supports it), so unions and intersections of dense sets run at memory
+ * speed.
+ * @author Baudouin FEILDEL
+ */
+#ifndef __C_CONTAINERS_ROARING_H__
+#define __C_CONTAINERS_ROARING_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Container types */
+#define ROARING_ARRAY  0
+#define ROARING_BITMAP 1
+#define ROARING_RUN    2
+
+/** Maximum cardinality of an array container */
+#define ROARING_ARRAY_MAX 4096
+
+/** Number of 64-bit words of a bitmap container */
+#define ROARING_WORDS 1024
+
+/**
+ Container of the values sharing the same high 16 bits
+ */
+typedef struct RoaringContainer
+{
+	int        type;        /**< ROARING_ARRAY, ROARING_BITMAP or ROARING_RUN */
+	int        cardinality; /**< Number of values in the container */
+	int        size;        /**< Array: number of values. Run: number of runs */
+	int        capacity;    /**< Number of allocated 16-bit slots in values */
+	uint16_t * values;      /**< Array: sorted low bits. Run: (start, length - 1) pairs */
+	uint64_t * words;       /**< Bitmap: ROARING_WORDS words */
+} RoaringContainer;
+
+/**
+ Roaring bitmap
+ */
+typedef struct Roaring
+{
+	uint16_t         * keys;       /**< Sorted high 16 bits of the containers */
+	RoaringContainer * containers; /**< Containers, in the order of keys */
+	int                size;       /**< Number of containers */
+	int                capacity;   /**< Number of allocated containers */
+} Roaring;
+
+// =================
+//  Word kernels
+// =================
+/*
+ Generate a kernel combining two bitmaps word by word and returning the
+ cardinality of the result. dst can be NULL to only count.
+ */
+#define IMPLEMENT_ROARING_KERNEL(NAME, ATTRIBUTES, OP) \
+static inline ATTRIBUTES int NAME(uint64_t * dst, const uint64_t * a, const uint64_t * b) \
+{ \
+	int i = 0, cardinality = 0; \
+	uint64_t word = 0; \
+	for(i = 0 ; i < ROARING_WORDS ; i++) \
+	{ \
+		word = a[i] OP b[i]; \
+		if(dst != NULL) dst[i] = word; \
+		cardinality += __builtin_popcountll(word); \
+	} \
+	return cardinality; \
+}
+
+IMPLEMENT_ROARING_KERNEL(Roaring_and_scalar, , &)
+IMPLEMENT_ROARING_KERNEL(Roaring_or_scalar,  , |)
+#if !defined(CCONTAINERS_DISABLE_SIMD) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CCONTAINERS_ROARING_POPCNT
+IMPLEMENT_ROARING_KERNEL(Roaring_and_popcnt, __attribute__((target("popcnt"))), &)
+IMPLEMENT_ROARING_KERNEL(Roaring_or_popcnt,  __attribute__((target("popcnt"))), |)
+#endif
+
+/* op: 0 for AND, 1 for OR. The kernels are selected the first time */
+static inline int Roaring_combine(uint64_t * dst, const uint64_t * a, const uint64_t * b, int op)
+{
+	static int (* const scalar[2])(uint64_t *, const uint64_t *, const uint64_t *) = {Roaring_and_scalar, Roaring_or_scalar};
+#ifdef CCONTAINERS_ROARING_POPCNT
+	static int (* const popcnt[2])(uint64_t *, const uint64_t *, const uint64_t *) = {Roaring_and_popcnt, Roaring_or_popcnt};
+#endif
+	static int (* const * kernels)(uint64_t *, const uint64_t *, const uint64_t *) = NULL;
+	int (* const * selected)(uint64_t *, const uint64_t *, const uint64_t *) = __atomic_load_n(&kernels, __ATOMIC_ACQUIRE);
+	if(selected == NULL)
+	{
+		/* Both kernels are published at once, with a single release store */
+		selected = scalar;
+#ifdef CCONTAINERS_ROARING_POPCNT
+		if(__builtin_cpu_supports("popcnt"))
+			selected = popcnt;
+#endif
+		__atomic_store_n(&kernels, selected, __ATOMIC_RELEASE);
+	}
+	return selected[op](dst, a, b);
+}
+
+// =================
+//  Containers
+// =================
+static inline void RoaringContainer_init(RoaringContainer * c)
+{
+	c->type        = ROARING_ARRAY;
+	c->cardinality = 0;
+	c->size        = 0;
+	c->capacity    = 0;
+	c->values      = NULL;
+	c->words       = NULL;
+}
+
+static inline void RoaringContainer_release(RoaringContainer * c)
+{
+	free(c->values);
+	free(c->words);
+	RoaringContainer_init(c);
+}
+
+static inline void RoaringContainer_reserve(RoaringContainer * c, int slots)
+{
+	if(c->capacity >= slots) return;
+	c->capacity = (c->capacity < 4) ? 4 : c->capacity;
+	while(c->capacity < slots)
+		c->capacity *= 2;
+	c->values = realloc(c->values, sizeof(uint16_t) * c->capacity);
+}
+
+/* Position of the first value >= low in an array container */
+static inline int RoaringContainer_lowerBound(const uint16_t * values, int size, uint16_t low)
+{
+	int first = 0, count = size, step = 0;
+	while(count > 0)
+	{
+		step = count / 2;
+		if(values[first + step] < low)
+		{
+			first += step + 1;
+			count -= step + 1;
+		}
+		else
+			count = step;
+	}
+	return first;
+}
+
+/* Position of the last run starting at or before low. -1 if none */
+static inline int RoaringContainer_runOf(const RoaringContainer * c, uint16_t low)
+{
+	int first = 0, last = c->size - 1, middle = 0, found = -1;
+	while(first <= last)
+	{
+		middle = (first + last) / 2;
+		if(c->values[2 * middle] <= low)
+		{
+			found = middle;
+			first = middle + 1;
+		}
+		else
+			last = middle - 1;
+	}
+	return found;
+}
+
+static inline int RoaringContainer_contains(const RoaringContainer * c, uint16_t low)
+{
+	int i = 0;
+	switch(c->type)
+	{
+		case ROARING_BITMAP:
+			return (c->words[low >> 6] >> (low & 63)) & 1;
+		case ROARING_RUN:
+			i = RoaringContainer_runOf(c, low);
+			return i >= 0 && low - c->values[2 * i] <= c->values[2 * i + 1];
+		default:
+			i = RoaringContainer_lowerBound(c->values, c->size, low);
+			return i < c->size && c->values[i] == low;
+	}
+}
+
+/* Turn an array or run container into a bitmap container */
+static inline void RoaringContainer_toBitmap(RoaringContainer * c)
+{
+	uint64_t * words = calloc(ROARING_WORDS, sizeof(uint64_t));
+	uint32_t v = 0, end = 0;
+	int i = 0;
+	if(c->type == ROARING_ARRAY)
+	{
+		for(i = 0 ; i < c->size ; i++)
+			words[c->values[i] >> 6] |= 1ULL << (c->values[i] & 63);
+	}
+	else
+	{
+		for(i = 0 ; i < c->size ; i++)
+		{
+			end = (uint32_t)c->values[2 * i] + c->values[2 * i + 1];
+			for(v = c->values[2 * i] ; v <= end ; v++)
+				words[v >> 6] |= 1ULL << (v & 63);
+		}
+	}
+	free(c->values);
+	c->values   = NULL;
+	c->capacity = 0;
+	c->size     = 0;
+	c->words    = words;
+	c->type     = ROARING_BITMAP;
+}
+
+/* Turn a bitmap or run container into an array container */
+static inline void RoaringContainer_toArray(RoaringContainer * c)
+{
+	uint16_t * values = malloc(sizeof(uint16_t) * (c->cardinality ? c->cardinality : 1));
+	uint64_t word = 0;
+	uint32_t v = 0, end = 0;
+	int i = 0, n = 0;
+	if(c->type == ROARING_BITMAP)
+	{
+		for(i = 0 ; i < ROARING_WORDS ; i++)
+		{
+			for(word = c->words[i] ; word != 0 ; word &= word - 1)
+				values[n++] = (uint16_t)(i * 64 + __builtin_ctzll(word));
+		}
+	}
+	else
+	{
+		for(i = 0 ; i < c->size ; i++)
+		{
+			end = (uint32_t)c->values[2 * i] + c->values[2 * i + 1];
+			for(v = c->values[2 * i] ; v <= end ; v++)
+				values[n++] = (uint16_t)v;
+		}
+	}
+	free(c->values);
+	free(c->words);
+	c->words    = NULL;
+	c->values   = values;
+	c->size     = n;
+	c->capacity = c->cardinality ? c->cardinality : 1;
+	c->type     = ROARING_ARRAY;
+}
+
+/* Run containers are read only: expand them before a modification */
+static inline void RoaringContainer_unrun(RoaringContainer * c)
+{
+	if(c->type != ROARING_RUN) return;
+	if(c->cardinality > ROARING_ARRAY_MAX) RoaringContainer_toBitmap(c);
+	else                                   RoaringContainer_toArray(c);
+}
+
+static inline int RoaringContainer_add(RoaringContainer * c, uint16_t low)
+{
+	int i = 0;
+	RoaringContainer_unrun(c);
+	if(c->type == ROARING_ARRAY)
+	{
+		i = RoaringContainer_lowerBound(c->values, c->size, low);
+		if(i < c->size && c->values[i] == low)
+			return 0;
+		if(c->size < ROARING_ARRAY_MAX)
+		{
+			RoaringContainer_reserve(c, c->size + 1);
+			memmove(c->values + i + 1, c->values + i, sizeof(uint16_t) * (c->size - i));
+			c->values[i] = low;
+			c->size++;
+			c->cardinality++;
+			return 1;
+		}
+		RoaringContainer_toBitmap(c);
+	}
+	if((c->words[low >> 6] >> (low & 63)) & 1)
+		return 0;
+	c->words[low >> 6] |= 1ULL << (low & 63);
+	c->cardinality++;
+	return 1;
+}
+
+static inline int RoaringContainer_remove(RoaringContainer * c, uint16_t low)
+{
+	int i = 0;
+	if(!RoaringContainer_contains(c, low))
+		return 0;
+	RoaringContainer_unrun(c);
+	c->cardinality--;
+	if(c->type == ROARING_ARRAY)
+	{
+		i = RoaringContainer_lowerBound(c->values, c->size, low);
+		memmove(c->values + i, c->values + i + 1, sizeof(uint16_t) * (c->size - i - 1));
+		c->size--;
+		return 1;
+	}
+	c->words[low >> 6] &= ~(1ULL << (low & 63));
+	if(c->cardinality <= ROARING_ARRAY_MAX)
+		RoaringContainer_toArray(c);
+	return 1;
+}
+
+/* Number of values <= low */
+static inline int RoaringContainer_rank(const RoaringContainer * c, uint16_t low)
+{
+	int i = 0, rank = 0;
+	switch(c->type)
+	{
+		case ROARING_BITMAP:
+			for(i = 0 ; i < (low >> 6) ; i++)
+				rank += __builtin_popcountll(c->words[i]);
+			return rank + __builtin_popcountll(c->words[low >> 6] & (~0ULL >> (63 - (low & 63))));
+		case ROARING_RUN:
+			for(i = 0 ; i < c->size && c->values[2 * i] <= low ; i++)
+			{
+				if(low - c->values[2 * i] <= c->values[2 * i + 1])
+					return rank + (low - c->values[2 * i]) + 1;
+				rank += c->values[2 * i + 1] + 1;
+			}
+			return rank;
+		default:
+			i = RoaringContainer_lowerBound(c->values, c->size, low);
+			return (i < c->size && c->values[i] == low) ? i + 1 : i;
+	}
+}
+
+/* Low bits of the value of position k, k < cardinality */
+static inline uint16_t RoaringContainer_select(const RoaringContainer * c, int k)
+{
+	uint64_t word = 0;
+	int i = 0, count = 0;
+	switch(c->type)
+	{
+		case ROARING_BITMAP:
+			for(i = 0 ; i < ROARING_WORDS ; i++)
+			{
+				count = __builtin_popcountll(c->words[i]);
+				if(k < count)
+				{
+					for(word = c->words[i] ; k > 0 ; k--)
+						word &= word - 1;
+					return (uint16_t)(i * 64 + __builtin_ctzll(word));
+				}
+				k -= count;
+			}
+			return 0;
+		case ROARING_RUN:
+			for(i = 0 ; i < c->size ; i++)
+			{
+				if(k <= c->values[2 * i + 1])
+					return (uint16_t)(c->values[2 * i] + k);
+				k -= c->values[2 * i + 1] + 1;
+			}
+			return 0;
+		default:
+			return c->values[k];
+	}
+}
+
+/* Deep copy of a container */
+static inline void RoaringContainer_copy(RoaringContainer * dst, const RoaringContainer * src)
+{
+	*dst = *src;
+	if(src->words != NULL)
+	{
+		dst->words = malloc(sizeof(uint64_t) * ROARING_WORDS);
+		memcpy(dst->words, src->words, sizeof(uint64_t) * ROARING_WORDS);
+	}
+	if(src->values != NULL)
+	{
+		dst->values = malloc(sizeof(uint16_t) * src->capacity);
+		memcpy(dst->values, src->values, sizeof(uint16_t) * src->capacity);
+	}
+}
+
+/* Make sure c is not a run container, using tmp for the expanded copy */
+static inline const RoaringContainer * RoaringContainer_expand(const RoaringContainer * c, RoaringContainer * tmp)
+{
+	if(c->type != ROARING_RUN) return c;
+	RoaringContainer_copy(tmp, c);
+	RoaringContainer_unrun(tmp);
+	return tmp;
+}
+
+/* Intersection of a and b in dst. Returns the cardinality */
+static inline int RoaringContainer_and(RoaringContainer * dst, const RoaringContainer * a, const RoaringContainer * b)
+{
+	RoaringContainer ta, tb;
+	const RoaringContainer * swap = NULL;
+	int i = 0, j = 0;
+	RoaringContainer_init(&ta);
+	RoaringContainer_init(&tb);
+	RoaringContainer_init(dst);
+	a = RoaringContainer_expand(a, &ta);
+	b = RoaringContainer_expand(b, &tb);
+	if(a->type == ROARING_BITMAP && b->type == ROARING_BITMAP)
+	{
+		dst->words = malloc(sizeof(uint64_t) * ROARING_WORDS);
+		dst->type  = ROARING_BITMAP;
+		dst->cardinality = Roaring_combine(dst->words, a->words, b->words, 0);
+		if(dst->cardinality <= ROARING_ARRAY_MAX)
+			RoaringContainer_toArray(dst);
+	}
+	else
+	{
+		if(a->type == ROARING_BITMAP)
+		{
+			swap = a;
+			a = b;
+			b = swap;
+		}
+		RoaringContainer_reserve(dst, a->size);
+		if(b->type == ROARING_BITMAP)
+		{
+			for(i = 0 ; i < a->size ; i++)
+				if((b->words[a->values[i] >> 6] >> (a->values[i] & 63)) & 1)
+					dst->values[dst->size++] = a->values[i];
+		}
+		else
+		{
+			while(i < a->size && j < b->size)
+			{
+				if(a->values[i] < b->values[j])      i++;
+				else if(a->values[i] > b->values[j]) j++;
+				else
+				{
+					dst->values[dst->size++] = a->values[i];
+					i++;
+					j++;
+				}
+			}
+		}
+		dst->cardinality = dst->size;
+	}
+	RoaringContainer_release(&ta);
+	RoaringContainer_release(&tb);
+	return dst->cardinality;
+}
+
+/* Union of a and b in dst. Returns the cardinality */
+static inline int RoaringContainer_or(RoaringContainer * dst, const RoaringContainer * a, const RoaringContainer * b)
+{
+	RoaringContainer ta, tb;
+	const RoaringContainer * swap = NULL;
+	int i = 0, j = 0;
+	RoaringContainer_init(&ta);
+	RoaringContainer_init(&tb);
+	RoaringContainer_init(dst);
+	a = RoaringContainer_expand(a, &ta);
+	b = RoaringContainer_expand(b, &tb);
+	if(a->type == ROARING_ARRAY && b->type == ROARING_ARRAY && a->size + b->size <= ROARING_ARRAY_MAX)
+	{
+		/* Merge two sorted arrays */
+		RoaringContainer_reserve(dst, a->size + b->size);
+		while(i < a->size || j < b->size)
+		{
+			if(j >= b->size || (i < a->size && a->values[i] < b->values[j]))
+				dst->values[dst->size++] = a->values[i++];
+			else if(i >= a->size || b->values[j] < a->values[i])
+				dst->values[dst->size++] = b->values[j++];
+			else
+			{
+				dst->values[dst->size++] = a->values[i++];
+				j++;
+			}
+		}
+		dst->cardinality = dst->size;
+	}
+	else
+	{
+		if(a->type != ROARING_BITMAP)
+		{
+			swap = a;
+			a = b;
+			b = swap;
+		}
+		/* Start from a bitmap copy of a, then add b */
+		RoaringContainer_copy(dst, a);
+		if(dst->type != ROARING_BITMAP)
+			RoaringContainer_toBitmap(dst);
+		if(b->type == ROARING_BITMAP)
+			dst->cardinality = Roaring_combine(dst->words, dst->words, b->words, 1);
+		else
+		{
+			for(i = 0 ; i < b->size ; i++)
+				dst->words[b->values[i] >> 6] |= 1ULL << (b->values[i] & 63);
+			dst->cardinality = Roaring_combine(NULL, dst->words, dst->words, 1);
+		}
+		if(dst->cardinality <= ROARING_ARRAY_MAX)
+			RoaringContainer_toArray(dst);
+	}
+	RoaringContainer_release(&ta);
+	RoaringContainer_release(&tb);
+	return dst->cardinality;
+}
+
+/* Extend the last run or start a new one, values come in increasing order */
+static inline void RoaringContainer_pushRun(uint16_t * runs, int * n, uint32_t v)
+{
+	if(*n > 0 && v == (uint32_t)runs[2 * (*n - 1)] + runs[2 * (*n - 1) + 1] + 1)
+		runs[2 * (*n - 1) + 1]++;
+	else
+	{
+		runs[2 * *n]     = (uint16_t)v;
+		runs[2 * *n + 1] = 0;
+		(*n)++;
+	}
+}
+
+/* Convert c to runs when smaller. Returns 1 if converted */
+static inline int RoaringContainer_optimize(RoaringContainer * c)
+{
+	uint16_t * runs = NULL;
+	uint64_t word = 0, carry = 0;
+	int i = 0, n = 0, count = 0, bytes = 0;
+	uint32_t v = 0;
+	if(c->type == ROARING_RUN) return 0;
+	/* Count the runs: a run starts at a set bit whose predecessor is clear */
+	if(c->type == ROARING_BITMAP)
+	{
+		for(i = 0 ; i < ROARING_WORDS ; i++)
+		{
+			word = c->words[i];
+			count += __builtin_popcountll(word & ~((word << 1) | carry));
+			carry = word >> 63;
+		}
+		bytes = ROARING_WORDS * 8;
+	}
+	else
+	{
+		for(i = 0 ; i < c->size ; i++)
+			if(i == 0 || c->values[i] != c->values[i - 1] + 1)
+				count++;
+		bytes = c->size * 2;
+	}
+	if(count * 4 >= bytes)
+		return 0;
+	runs = malloc(sizeof(uint16_t) * 2 * count);
+	if(c->type == ROARING_BITMAP)
+	{
+		for(i = 0 ; i < ROARING_WORDS ; i++)
+			for(word = c->words[i] ; word != 0 ; word &= word - 1)
+			{
+				v = (uint32_t)(i * 64 + __builtin_ctzll(word));
+				RoaringContainer_pushRun(runs, &n, v);
+			}
+	}
+	else
+	{
+		for(i = 0 ; i < c->size ; i++)
+		{
+			v = c->values[i];
+			RoaringContainer_pushRun(runs, &n, v);
+		}
+	}
+	free(c->values);
+	free(c->words);
+	c->words    = NULL;
+	c->values   = runs;
+	c->size     = n;
+	c->capacity = 2 * count;
+	c->type     = ROARING_RUN;
+	return 1;
+}
+
+static inline size_t RoaringContainer_bytes(const RoaringContainer * c)
+{
+	if(c->type == ROARING_BITMAP) return ROARING_WORDS * sizeof(uint64_t);
+	return c->capacity * sizeof(uint16_t);
+}
+
+// =================
+//  Roaring bitmap
+// =================
+/* Position of the container of key. -(insertion point) - 1 if absent */
+static inline int Roaring_find(const Roaring * r, uint16_t key)
+{
+	int i = RoaringContainer_lowerBound(r->keys, r->size, key);
+	if(i < r->size && r->keys[i] == key)
+		return i;
+	return -i - 1;
+}
+
+/* Insert an empty container of key at position i */
+static inline RoaringContainer * Roaring_insertContainer(Roaring * r, int i, uint16_t key)
+{
+	if(r->size == r->capacity)
+	{
+		r->capacity   = r->capacity ? r->capacity * 2 : 4;
+		r->keys       = realloc(r->keys, sizeof(uint16_t) * r->capacity);
+		r->containers = realloc(r->containers, sizeof(RoaringContainer) * r->capacity);
+	}
+	memmove(r->keys + i + 1, r->keys + i, sizeof(uint16_t) * (r->size - i));
+	memmove(r->containers + i + 1, r->containers + i, sizeof(RoaringContainer) * (r->size - i));
+	r->keys[i] = key;
+	RoaringContainer_init(&(r->containers[i]));
+	r->size++;
+	return &(r->containers[i]);
+}
+
+/* Append a container to a bitmap being built in key order */
+static inline void Roaring_append(Roaring * r, uint16_t key, RoaringContainer * c)
+{
+	*Roaring_insertContainer(r, r->size, key) = *c;
+}
+
+/**
+ @brief Create a new Roaring object
+ @return A pointer to an allocated and initialized
+ Roaring object in memory
+ */
+static inline Roaring * Roaring_new()
+{
+	Roaring * r = malloc(sizeof(Roaring));
+	r->keys       = NULL;
+	r->containers = NULL;
+	r->size       = 0;
+	r->capacity   = 0;
+	return r;
+}
+
+/**
+ Destroy a Roaring object
+ @param r A pointer to a Roaring object
+ */
+static inline void Roaring_free(Roaring * r)
+{
+	int i = 0;
+	if(r == NULL) return;
+	for(i = 0 ; i < r->size ; i++)
+		RoaringContainer_release(&(r->containers[i]));
+	free(r->keys);
+	free(r->containers);
+	free(r);
+}
+
+/**
+ Remove every value of a roaring bitmap
+ @details The arrays of containers are kept for the next values.
+ @param r A pointer to a valid Roaring object
+ */
+static inline void Roaring_clear(Roaring * r)
+{
+	int i = 0;
+	if(r == NULL) return;
+	for(i = 0 ; i < r->size ; i++)
+		RoaringContainer_release(&(r->containers[i]));
+	r->size = 0;
+}
+
+/**
+ Allocate the arrays of containers for n containers
+ @details A container holds the values sharing their high 16 bits.
+ @param r A pointer to a valid Roaring object
+ @param n Number of containers to hold without reallocating
+ */
+static inline void Roaring_reserve(Roaring * r, int n)
+{
+	if(r == NULL || n <= r->capacity) return;
+	r->capacity   = n;
+	r->keys       = realloc(r->keys, sizeof(uint16_t) * n);
+	r->containers = realloc(r->containers, sizeof(RoaringContainer) * n);
+}
+
+/**
+ Release the unused slots of the arrays of containers and of the
+ array and run containers
+ @param r A pointer to a valid Roaring object
+ */
+static inline void Roaring_shrink_to_fit(Roaring * r)
+{
+	RoaringContainer * c = NULL;
+	int i = 0, slots = 0;
+	if(r == NULL) return;
+	for(i = 0 ; i < r->size ; i++)
+	{
+		c = &(r->containers[i]);
+		if(c->type == ROARING_BITMAP) continue;
+		slots = (c->type == ROARING_RUN) ? 2 * c->size : c->size;
+		if(slots > 0 && slots < c->capacity)
+		{
+			c->values   = realloc(c->values, sizeof(uint16_t) * slots);
+			c->capacity = slots;
+		}
+	}
+	if(r->size == r->capacity) return;
+	if(r->size == 0)
+	{
+		free(r->keys);
+		free(r->containers);
+		r->keys       = NULL;
+		r->containers = NULL;
+	}
+	else
+	{
+		r->keys       = realloc(r->keys, sizeof(uint16_t) * r->size);
+		r->containers = realloc(r->containers, sizeof(RoaringContainer) * r->size);
+	}
+	r->capacity = r->size;
+}
+
+/**
+ Add a value to a roaring bitmap
+ @param r     A pointer to a valid Roaring object
+ @param value The value to add
+ @return      1 if the value was added. 0 if it was already present
+ */
+static inline int Roaring_add(Roaring * r, uint32_t value)
+{
+	int i = Roaring_find(r, (uint16_t)(value >> 16));
+	RoaringContainer * c = NULL;
+	if(i >= 0) c = &(r->containers[i]);
+	else       c = Roaring_insertContainer(r, -i - 1, (uint16_t)(value >> 16));
+	return RoaringContainer_add(c, (uint16_t)value);
+}
+
+/**
+ Remove a value from a roaring bitmap
+ @param r     A pointer to a valid Roaring object
+ @param value The value to remove
+ @return      1 if the value was removed. 0 if it was not present
+ */
+static inline int Roaring_remove(Roaring * r, uint32_t value)
+{
+	int i = Roaring_find(r, (uint16_t)(value >> 16));
+	if(i < 0 || !RoaringContainer_remove(&(r->containers[i]), (uint16_t)value))
+		return 0;
+	if(r->containers[i].cardinality == 0)
+	{
+		RoaringContainer_release(&(r->containers[i]));
+		memmove(r->keys + i, r->keys + i + 1, sizeof(uint16_t) * (r->size - i - 1));
+		memmove(r->containers + i, r->containers + i + 1, sizeof(RoaringContainer) * (r->size - i - 1));
+		r->size--;
+	}
+	return 1;
+}
+
+/**
+ Test if a value is in a roaring bitmap
+ @param r     A pointer to a valid Roaring object
+ @param value The value to test
+ @return      1 if the value is present. 0 otherwise
+ */
+static inline int Roaring_contains(const Roaring * r, uint32_t value)
+{
+	int i = Roaring_find(r, (uint16_t)(value >> 16));
+	return i >= 0 && RoaringContainer_contains(&(r->containers[i]), (uint16_t)value);
+}
+
+/**
+ Count the values of a roaring bitmap
+ @param r A pointer to a valid Roaring object
+ @return  Number of values
+ */
+static inline uint64_t Roaring_cardinality(const Roaring * r)
+{
+	uint64_t cardinality = 0;
+	int i = 0;
+	for(i = 0 ; i < r->size ; i++)
+		cardinality += r->containers[i].cardinality;
+	return cardinality;
+}
+
+/**
+ Count the values lower than or equal to a value
+ @param r     A pointer to a valid Roaring object
+ @param value The value
+ @return      Number of values <= value
+ */
+static inline uint64_t Roaring_rank(const Roaring * r, uint32_t value)
+{
+	uint64_t rank = 0;
+	int i = 0;
+	for(i = 0 ; i < r->size && r->keys[i] < (value >> 16) ; i++)
+		rank += r->containers[i].cardinality;
+	if(i < r->size && r->keys[i] == (value >> 16))
+		rank += RoaringContainer_rank(&(r->containers[i]), (uint16_t)value);
+	return rank;
+}
+
+/**
+ Get the value of a position
+ @param r     A pointer to a valid Roaring object
+ @param k     Position of the value, 0 is the smallest value
+ @param value Receives the value
+ @return      1 if the position exists. 0 if k >= cardinality
+ */
+static inline int Roaring_select(const Roaring * r, uint64_t k, uint32_t * value)
+{
+	int i = 0;
+	for(i = 0 ; i < r->size ; i++)
+	{
+		if(k < (uint64_t)r->containers[i].cardinality)
+		{
+			*value = ((uint32_t)r->keys[i] << 16) | RoaringContainer_select(&(r->containers[i]), (int)k);
+			return 1;
+		}
+		k -= r->containers[i].cardinality;
+	}
+	return 0;
+}
+
+/**
+ Compute the intersection of two roaring bitmaps
+ @param a A pointer to a valid Roaring object
+ @param b A pointer to a valid Roaring object
+ @return  A new Roaring object holding the values present in both
+ */
+static inline Roaring * Roaring_intersection(const Roaring * a, const Roaring * b)
+{
+	Roaring * r = Roaring_new();
+	RoaringContainer c;
+	int i = 0, j = 0;
+	while(i < a->size && j < b->size)
+	{
+		if(a->keys[i] < b->keys[j])      i++;
+		else if(a->keys[i] > b->keys[j]) j++;
+		else
+		{
+			if(RoaringContainer_and(&c, &(a->containers[i]), &(b->containers[j])) > 0)
+				Roaring_append(r, a->keys[i], &c);
+			else
+				RoaringContainer_release(&c);
+			i++;
+			j++;
+		}
+	}
+	return r;
+}
+
+/**
+ Compute the union of two roaring bitmaps
+ @param a A pointer to a valid Roaring object
+ @param b A pointer to a valid Roaring object
+ @return  A new Roaring object holding the values present in either
+ */
+static inline Roaring * Roaring_union(const Roaring * a, const Roaring * b)
+{
+	Roaring * r = Roaring_new();
+	RoaringContainer c;
+	int i = 0, j = 0;
+	while(i < a->size || j < b->size)
+	{
+		if(j >= b->size || (i < a->size && a->keys[i] < b->keys[j]))
+		{
+			RoaringContainer_copy(&c, &(a->containers[i]));
+			Roaring_append(r, a->keys[i++], &c);
+		}
+		else if(i >= a->size || b->keys[j] < a->keys[i])
+		{
+			RoaringContainer_copy(&c, &(b->containers[j]));
+			Roaring_append(r, b->keys[j++], &c);
+		}
+		else
+		{
+			RoaringContainer_or(&c, &(a->containers[i]), &(b->containers[j]));
+			Roaring_append(r, a->keys[i], &c);
+			i++;
+			j++;
+		}
+	}
+	return r;
+}
+
+/**
+ Convert the containers to runs where this saves memory
+ @details Call it once a bitmap is built, for instance on sets of
+ consecutive ids.
+ @param r A pointer to a valid Roaring object
+ @return  Number of containers converted to runs
+ */
+static inline int Roaring_optimize(Roaring * r)
+{
+	int i = 0, converted = 0;
+	for(i = 0 ; i < r->size ; i++)
+		converted += RoaringContainer_optimize(&(r->containers[i]));
+	return converted;
+}
+
+/**
+ Call a function on every value, in increasing order
+ @param r        A pointer to a valid Roaring object
+ @param callback Function called with every value and \c data
+ @param data     User data given to \c callback
+ */
+static inline void Roaring_forEach(const Roaring * r, void (*callback)(uint32_t value, void * data), void * data)
+{
+	const RoaringContainer * c = NULL;
+	uint64_t word = 0;
+	uint32_t high = 0, v = 0, end = 0;
+	int i = 0, j = 0;
+	for(i = 0 ; i < r->size ; i++)
+	{
+		c    = &(r->containers[i]);
+		high = (uint32_t)r->keys[i] << 16;
+		if(c->type == ROARING_ARRAY)
+		{
+			for(j = 0 ; j < c->size ; j++)
+				callback(high | c->values[j], data);
+		}
+		else if(c->type == ROARING_RUN)
+		{
+			for(j = 0 ; j < c->size ; j++)
+			{
+				end = (uint32_t)c->values[2 * j] + c->values[2 * j + 1];
+				for(v = c->values[2 * j] ; v <= end ; v++)
+					callback(high | v, data);
+			}
+		}
+		else
+		{
+			for(j = 0 ; j < ROARING_WORDS ; j++)
+				for(word = c->words[j] ; word != 0 ; word &= word - 1)
+					callback(high | (uint32_t)(j * 64 + __builtin_ctzll(word)), data);
+		}
+	}
+}
+
+/**
+ Memory used by a roaring bitmap
+ @param r A pointer to a valid Roaring object
+ @return  Number of bytes allocated for r
+ */
+static inline size_t Roaring_bytes(const Roaring * r)
+{
+	size_t bytes = sizeof(Roaring) + r->capacity * (sizeof(uint16_t) + sizeof(RoaringContainer));
+	int i = 0;
+	for(i = 0 ; i < r->size ; i++)
+		bytes += RoaringContainer_bytes(&(r->containers[i]));
+	return bytes;
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __C_CONTAINERS_ROARING_H__
@@ -0,0 +1,355 @@
+/**
+ * @file scheduler.h
+ * @brief Work-stealing task scheduler
+ * @details A scheduler runs recursive (divide and conquer) tasks on one
+ * worker per core. Every worker owns a work-stealing deque (see wsdeque.h):
+ * - SCHED_spawn pushes a task on the deque of the current worker,
+ * - SCHED_sync waits for the tasks of a group. Meanwhile the worker pops
+ *   its own tasks (newest first, the cache is still warm), then steals the
+ *   oldest tasks (the biggest ones) of random workers.
+ * Idle workers steal too, so the load balances itself without any global
+ * queue or lock.
+ *
+ * SCHED_run executes a root task: the calling thread becomes worker 0
+ * until the task returns. A task must sync the groups it spawned into
+ * before returning.
+ * Link with -pthread.
+ * @author Baudouin FEILDEL
+ */
+#ifndef __SCHEDULER_H__
+#define __SCHEDULER_H__
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include "wsdeque.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Failed steals before an idle worker yields its core */
+#define SCHEDULER_SPINS 64
+
+/** Released tasks kept by a worker for the next spawns */
+#define SCHEDULER_CACHED_TASKS 1024
+
+// =============
+//  Definitions
+// =============
+#define NEW_SCHEDULER_TYPE(SCHED) \
+/**
+ Group of tasks waited together by SCHED_sync
+ */ \
+typedef struct SCHED ## _group_t \
+{ \
+	int pending; /**< Number of unfinished tasks (atomic) */\
+} SCHED ## _group_t; \
+/**
+ Task of a SCHED object
+ */ \
+typedef struct SCHED ## _task_t \
+{ \
+	void (*run)(void * data);      /**< Function of the task */\
+	void * data;                   /**< User data given to run */\
+	SCHED ## _group_t * group;     /**< Group of the task */\
+	struct SCHED ## _task_t * next; /**< Next cached task */\
+} SCHED ## _task_t; \
+NEW_WSDEQUE_DEFINITION(SCHED ## _deque, SCHED ## _task_t *); \
+/**
+ Worker of a SCHED object
+ */ \
+typedef struct SCHED ## _worker_t \
+{ \
+	SCHED ## _deque   * deque;    /**< Spawned tasks */\
+	SCHED ## _task_t  * cache;    /**< Released tasks, for the next spawns */\
+	int                 cached;   /**< Number of tasks in cache */\
+	unsigned int        seed;     /**< Random state used to choose victims */\
+	struct SCHED      * scheduler; /**< Scheduler of the worker */\
+} __attribute__((aligned(64))) SCHED ## _worker_t; \
+typedef struct SCHED \
+{ \
+	SCHED ## _worker_t * workers;  /**< Workers, 0 is the thread calling _run */\
+	pthread_t  * threads;          /**< Threads of the workers 1 to workerCount - 1 */\
+	int          workerCount;      /**< Number of workers */\
+	int          running;          /**< Flag:<br>1: A root task runs<br>0: Workers sleep (atomic) */\
+	int          stop;             /**< Flag:<br>1: Workers must exit<br>0: Workers run */\
+	pthread_mutex_t lock;          /**< Lock of running and stop */\
+	pthread_cond_t  work;          /**< Signaled when a root task starts */\
+	pthread_mutex_t runLock;       /**< Serializes the calls to _run */\
+} SCHED
+
+#define SCHEDULER_FN_NEW(SCHED) \
+/**
+ @brief Create a new SCHED object
+ @param workers Number of workers, counting the thread calling _run.
+ 0 to use one per core
+ @return A pointer to an allocated and initialized
+ SCHED object in memory
+ */ \
+SCHED * SCHED ## _new(int workers)
+
+#define SCHEDULER_FN_FREE(SCHED) \
+/**
+ Destroy a SCHED object
+ @param scheduler A pointer to a SCHED object
+ */ \
+void SCHED ## _free(SCHED * scheduler)
+
+#define SCHEDULER_FN_RUN(SCHED) \
+/**
+ Execute a root task with the workers and wait for it
+ @param scheduler A pointer to a valid SCHED object
+ @param run       Function of the task
+ @param data      User data given to \c run
+ */ \
+void SCHED ## _run(SCHED * scheduler, void (*run)(void * data), void * data)
+
+#define SCHEDULER_FN_SPAWN(SCHED) \
+/**
+ Spawn a task from a running task
+ @details The task may run on any worker. Outside of SCHED_run, the task
+ runs immediately.
+
+ @param group Group of the task, given to SCHED_sync later
+ @param run   Function of the task
+ @param data  User data given to \c run
+ */ \
+void SCHED ## _spawn(SCHED ## _group_t * group, void (*run)(void * data), void * data)
+
+#define SCHEDULER_FN_SYNC(SCHED) \
+/**
+ Wait for every task of a group, executing other tasks meanwhile
+ @param group A group given to SCHED_spawn
+ */ \
+void SCHED ## _sync(SCHED ## _group_t * group)
+
+// =================
+//  Implementations
+// =================
+/* Internal helpers */
+#define IMPLEMENT_SCHEDULER_FN_HELPERS(SCHED) \
+IMPLEMENT_WSDEQUE(SCHED ## _deque, SCHED ## _task_t *); \
+/* Worker of the current thread, NULL outside of the workers */\
+static __thread SCHED ## _worker_t * SCHED ## _self = NULL; \
+static void SCHED ## _execute(SCHED ## _worker_t * worker, SCHED ## _task_t * task) \
+{ \
+	SCHED ## _group_t * group = task->group; \
+	task->run(task->data); \
+	/* Keep the task for the next spawns of this worker */\
+	if(worker->cached < SCHEDULER_CACHED_TASKS) \
+	{ \
+		task->next    = worker->cache; \
+		worker->cache = task; \
+		worker->cached++; \
+	} \
+	else free(task); \
+	__atomic_sub_fetch(&(group->pending), 1, __ATOMIC_RELEASE); \
+} \
+/* Execute one task, from the worker deque first, else stolen. Returns 0 if none found */\
+static int SCHED ## _help(SCHED ## _worker_t * worker) \
+{ \
+	SCHED * scheduler = worker->scheduler; \
+	SCHED ## _task_t * task = NULL; \
+	int i = 0, victim = 0; \
+	if(SCHED ## _deque_pop(worker->deque, &task)) \
+	{ \
+		SCHED ## _execute(worker, task); \
+		return 1; \
+	} \
+	if(scheduler->workerCount == 1) return 0; \
+	/* xorshift */\
+	worker->seed ^= worker->seed << 13; \
+	worker->seed ^= worker->seed >> 17; \
+	worker->seed ^= worker->seed << 5; \
+	victim = (int)(worker->seed % (unsigned int)scheduler->workerCount); \
+	for(i = 0 ; i < scheduler->workerCount ; i++) \
+	{ \
+		if(&(scheduler->workers[victim]) != worker && \
+		   SCHED ## _deque_steal(scheduler->workers[victim].deque, &task) == WSDEQUE_OK) \
+		{ \
+			SCHED ## _execute(worker, task); \
+			return 1; \
+		} \
+		victim = (victim + 1) % scheduler->workerCount; \
+	} \
+	return 0; \
+} \
+static void * SCHED ## _worker(void * data) \
+{ \
+	SCHED ## _worker_t * worker = data; \
+	SCHED * scheduler = worker->scheduler; \
+	int spins = 0; \
+	SCHED ## _self = worker; \
+	while(1) \
+	{ \
+		pthread_mutex_lock(&(scheduler->lock)); \
+		while(!__atomic_load_n(&(scheduler->running), __ATOMIC_ACQUIRE) && !scheduler->stop) \
+			pthread_cond_wait(&(scheduler->work), &(scheduler->lock)); \
+		if(scheduler->stop) \
+		{ \
+			pthread_mutex_unlock(&(scheduler->lock)); \
+			return NULL; \
+		} \
+		pthread_mutex_unlock(&(scheduler->lock)); \
+		/* Steal until the root task returns */\
+		while(__atomic_load_n(&(scheduler->running), __ATOMIC_ACQUIRE)) \
+		{ \
+			if(SCHED ## _help(worker)) spins = 0; \
+			else if(++spins >= SCHEDULER_SPINS) \
+			{ \
+				spins = 0; \
+				sched_yield(); \
+			} \
+		} \
+	} \
+}
+
+#define IMPLEMENT_SCHEDULER_FN_NEW(SCHED) \
+SCHED * SCHED ## _new(int workers) \
+{ \
+	SCHED * scheduler = malloc(sizeof(SCHED)); \
+	int i = 0; \
+	if(workers <= 0) workers = (int)sysconf(_SC_NPROCESSORS_ONLN); \
+	if(workers <= 0) workers = 1; \
+	if(posix_memalign((void **)&(scheduler->workers), 64, sizeof(SCHED ## _worker_t) * workers) != 0) \
+	{ \
+		free(scheduler); \
+		return NULL; \
+	} \
+	scheduler->threads     = malloc(sizeof(pthread_t) * workers); \
+	scheduler->workerCount = workers; \
+	scheduler->running     = 0; \
+	scheduler->stop        = 0; \
+	pthread_mutex_init(&(scheduler->lock), NULL); \
+	pthread_cond_init(&(scheduler->work), NULL); \
+	pthread_mutex_init(&(scheduler->runLock), NULL); \
+	for(i = 0 ; i < workers ; i++) \
+	{ \
+		scheduler->workers[i].deque     = SCHED ## _deque_new(256); \
+		scheduler->workers[i].cache     = NULL; \
+		scheduler->workers[i].cached    = 0; \
+		scheduler->workers[i].seed      = 2463534242u + 7919u * (unsigned int)i; \
+		scheduler->workers[i].scheduler = scheduler; \
+	} \
+	for(i = 1 ; i < workers ; i++) \
+		pthread_create(&(scheduler->threads[i]), NULL, SCHED ## _worker, &(scheduler->workers[i])); \
+	return scheduler; \
+}
+
+#define IMPLEMENT_SCHEDULER_FN_FREE(SCHED) \
+void SCHED ## _free(SCHED * scheduler) \
+{ \
+	SCHED ## _task_t * task = NULL; \
+	int i = 0; \
+	if(scheduler == NULL) return; \
+	pthread_mutex_lock(&(scheduler->lock)); \
+	scheduler->stop = 1; \
+	pthread_cond_broadcast(&(scheduler->work)); \
+	pthread_mutex_unlock(&(scheduler->lock)); \
+	for(i = 1 ; i < scheduler->workerCount ; i++) \
+		pthread_join(scheduler->threads[i], NULL); \
+	for(i = 0 ; i < scheduler->workerCount ; i++) \
+	{ \
+		while((task = scheduler->workers[i].cache) != NULL) \
+		{ \
+			scheduler->workers[i].cache = task->next; \
+			free(task); \
+		} \
+		SCHED ## _deque_free(scheduler->workers[i].deque); \
+	} \
+	pthread_mutex_destroy(&(scheduler->lock)); \
+	pthread_cond_destroy(&(scheduler->work)); \
+	pthread_mutex_destroy(&(scheduler->runLock)); \
+	free(scheduler->threads); \
+	free(scheduler->workers); \
+	free(scheduler); \
+}
+
+#define IMPLEMENT_SCHEDULER_FN_RUN(SCHED) \
+void SCHED ## _run(SCHED * scheduler, void (*run)(void * data), void * data) \
+{ \
+	SCHED ## _worker_t * previous = SCHED ## _self; \
+	/* Called from a task: run it inline */\
+	if(previous != NULL) \
+	{ \
+		run(data); \
+		return; \
+	} \
+	pthread_mutex_lock(&(scheduler->runLock)); \
+	pthread_mutex_lock(&(scheduler->lock)); \
+	__atomic_store_n(&(scheduler->running), 1, __ATOMIC_RELEASE); \
+	pthread_cond_broadcast(&(scheduler->work)); \
+	pthread_mutex_unlock(&(scheduler->lock)); \
+	SCHED ## _self = &(scheduler->workers[0]); \
+	run(data); \
+	SCHED ## _self = NULL; \
+	__atomic_store_n(&(scheduler->running), 0, __ATOMIC_RELEASE); \
+	pthread_mutex_unlock(&(scheduler->runLock)); \
+}
+
+#define IMPLEMENT_SCHEDULER_FN_SPAWN(SCHED) \
+void SCHED ## _spawn(SCHED ## _group_t * group, void (*run)(void * data), void * data) \
+{ \
+	SCHED ## _worker_t * worker = SCHED ## _self; \
+	SCHED ## _task_t * task = NULL; \
+	if(worker == NULL) \
+	{ \
+		run(data); \
+		return; \
+	} \
+	if(worker->cache != NULL) \
+	{ \
+		task          = worker->cache; \
+		worker->cache = task->next; \
+		worker->cached--; \
+	} \
+	else task = malloc(sizeof(SCHED ## _task_t)); \
+	task->run   = run; \
+	task->data  = data; \
+	task->group = group; \
+	__atomic_add_fetch(&(group->pending), 1, __ATOMIC_RELAXED); \
+	SCHED ## _deque_push(worker->deque, task); \
+}
+
+#define IMPLEMENT_SCHEDULER_FN_SYNC(SCHED) \
+void SCHED ## _sync(SCHED ## _group_t * group) \
+{ \
+	SCHED ## _worker_t * worker = SCHED ## _self; \
+	int spins = 0; \
+	while(__atomic_load_n(&(group->pending), __ATOMIC_ACQUIRE) > 0) \
+	{ \
+		if(worker != NULL && SCHED ## _help(worker)) spins = 0; \
+		else if(++spins >= SCHEDULER_SPINS) \
+		{ \
+			spins = 0; \
+			sched_yield(); \
+		} \
+	} \
+}
+
+
+// MACRO HELPERS (One line definitions && implementations)
+#define NEW_SCHEDULER_DEFINITION(SCHED) \
+NEW_SCHEDULER_TYPE(SCHED); \
+SCHEDULER_FN_NEW(SCHED); \
+SCHEDULER_FN_FREE(SCHED); \
+SCHEDULER_FN_RUN(SCHED); \
+SCHEDULER_FN_SPAWN(SCHED); \
+SCHEDULER_FN_SYNC(SCHED)
+
+#define IMPLEMENT_SCHEDULER(SCHED) \
+IMPLEMENT_SCHEDULER_FN_HELPERS(SCHED); \
+IMPLEMENT_SCHEDULER_FN_NEW(SCHED); \
+IMPLEMENT_SCHEDULER_FN_FREE(SCHED); \
+IMPLEMENT_SCHEDULER_FN_RUN(SCHED); \
+IMPLEMENT_SCHEDULER_FN_SPAWN(SCHED); \
+IMPLEMENT_SCHEDULER_FN_SYNC(SCHED)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SCHEDULER_H__
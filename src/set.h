@@ -7,6 +7,9 @@
 #define __SET_H__
 
 #include <stdlib.h>
+#include <stdint.h>
+
+#include "filter.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -26,21 +29,49 @@ typedef struct _ ## ElemTypename \
 	struct _ ## ElemTypename * prev; /**< Pointer to the previous element in the set */\
 } ElemTypename
 
-#define NEW_SET_TYPE(SET, ValueType) \
+#define NEW_SET_STRUCT(SET, ValueType, InlineStorage) \
 NEW_SET_ELEM(SET, SET ## _elem_t, ValueType); \
 typedef struct SET \
 { \
 	SET ## _elem_t * begin; /**< Beginning of the set */\
 	SET ## _elem_t * end; /**< End of the set */\
 	int    size; /**< Set size */\
+	SET ## _elem_t * spare; /**< Unused elements kept for reuse, linked by next */\
+	int    spareCount; /**< Number of elements in spare */\
 	size_t elemSize; /**< Size of one element in the set */\
 	int    freeValue; /**< Flag:<br>1: Automatically free the value<br>0: Do not automatically free the value */\
 	void (*_copyValue) (ValueType * dest, ValueType * src); /**< Pointer to a function used to copy a value */\
 	int  (*_cmpValue)  (ValueType val1, ValueType val2); /**< Pointer to a function used to compare two values */\
 	void (*_freeValue) (ValueType value); /**< Pointer to a function used to free a value */\
 	void (*_print)     (ValueType value); /**< Pointer to a function used to print a value */\
+	CuckooFilter * filter; /**< Filter answering the lookups of absent values. NULL if none is attached */\
+	uint64_t (*_hashValue) (ValueType value); /**< Pointer to a function used to hash a value for the filter */\
+	SET ## _elem_t * inlineElems; /**< Elements stored in the SET object itself. NULL without inline storage */\
+	int    inlineCount; /**< Number of elements in inlineElems */\
+	InlineStorage \
 } SET
 
+/* Inline storage of a SET object, and whether an element belongs to it (not to free) */
+#define SET_FN_INLINE_STORAGE(SET, STORAGE, N) \
+static inline SET ## _elem_t * SET ## _inlineStorage(SET * set, int * count) \
+{ \
+	(void)(set); \
+	*count = N; \
+	return STORAGE; \
+} \
+static inline int SET ## _isInline(SET * set, SET ## _elem_t * elem) \
+{ \
+	return (uintptr_t)elem - (uintptr_t)set->inlineElems < (uintptr_t)set->inlineCount * sizeof(SET ## _elem_t); \
+}
+
+#define NEW_SET_TYPE(SET, ValueType) \
+NEW_SET_STRUCT(SET, ValueType, ); \
+SET_FN_INLINE_STORAGE(SET, NULL, 0)
+
+#define NEW_SET_SMALL_TYPE(SET, ValueType, N) \
+NEW_SET_STRUCT(SET, ValueType, SET ## _elem_t inlineStorage[N]; /**< Storage of the first N elements */); \
+SET_FN_INLINE_STORAGE(SET, set->inlineStorage, N)
+
 #define SET_FN_NEW(SET) \
 /**
  @brief Create a new SET object
@@ -49,6 +80,18 @@ typedef struct SET \
  */ \
 SET * SET ## _new()
 
+#define SET_FN_INIT(SET) \
+/**
+ @brief Initialize a SET object in place
+ @details For a SET object on the stack or inside another structure,
+ released by SET_destroy. The object must not be copied or moved
+ afterwards: its inline storage (see NEW_SET_SMALL_DEFINITION) is linked
+ to it.
+ @param set A pointer to the SET object to initialize
+ @return    The pointer to the SET object
+ */ \
+SET * SET ## _init(SET * set)
+
 #define SET_FN_FREE(SET) \
 /**
  Destroy a SET object
@@ -56,6 +99,14 @@ SET * SET ## _new()
  */ \
 void SET ## _free(SET * set)
 
+#define SET_FN_DESTROY(SET) \
+/**
+ Release the elements and the filter of a SET object initialized by SET_init
+ @details The SET object itself is not freed.
+ @param set A pointer to a SET object
+ */ \
+void SET ## _destroy(SET * set)
+
 #define SET_FN_ADD_STRUCT(SET, Valuetype) \
 /**
  Add an element to the set
@@ -96,6 +147,48 @@ SET ## _elem_t * SET ## _get(SET * set, ValueType index)
  */ \
 SET ## _elem_t * SET ## _search(SET * set, Valuetype search)
 
+#define SET_FN_ATTACH_FILTER_STRUCT(SET, Valuetype) \
+/**
+ Attach a cuckoo filter to a set
+ @details The filter holds a fingerprint of every value of the set.
+ SET_get, SET_search and SET_add answer most lookups of absent values
+ from the filter alone, without walking the set. The filter grows
+ with the set.
+
+ @param set  A pointer to a valid SET object
+ @param hash Function used to hash the values (Int_hash, Str_hash...).
+ NULL to detach the filter
+ @return     The pointer to the SET object
+ */ \
+SET * SET ## _attachFilter(SET * set, uint64_t (*hash)(Valuetype value))
+
+#define SET_FN_CLEAR(SET) \
+/**
+ Remove every element of the set
+ @details The elements and the filter are kept for the next insertions.
+ @param set A pointer to a valid SET object
+ */ \
+void SET ## _clear(SET * set)
+
+#define SET_FN_RESERVE(SET) \
+/**
+ Allocate the elements for n elements
+ @details The set then holds n elements without allocating, an attached
+ filter is grown to n elements.
+ @param set A pointer to a valid SET object
+ @param n   Number of elements to hold
+ */ \
+void SET ## _reserve(SET * set, int n)
+
+#define SET_FN_SHRINK_TO_FIT(SET) \
+/**
+ Release the elements kept for reuse and shrink an attached filter
+ @details Elements left by SET_clear and SET_reserve are kept for the
+ next insertions until this call.
+ @param set A pointer to a valid SET object
+ */ \
+void SET ## _shrink_to_fit(SET * set)
+
 #define SET_FN_PRINT_STRUCT(SET) \
 /**
  Print a set
@@ -107,31 +200,65 @@ void SET ## _print(SET * set)
 //  Implementations
 // =================
 #define IMPLEMENT_SET_FN_NEW(SET, Valuetype, FN_CPY_VAL, FN_CMP_VAL, FN_FREE_VAL, FN_PRINT_VAL) \
-SET * SET ## _new() \
+SET * SET ## _init(SET * set) \
 { \
-	SET * set = malloc(sizeof(SET)); \
+	int i = 0; \
 	set->size  = 0; \
 	set->begin = NULL; \
 	set->end   = NULL; \
+	set->spare = NULL; \
+	set->spareCount = 0; \
 	set->elemSize   = sizeof(SET ## _elem_t); \
 	set->freeValue  = 1; \
 	set->_copyValue = FN_CPY_VAL; \
 	set->_cmpValue  = FN_CMP_VAL; \
 	set->_freeValue = FN_FREE_VAL; \
 	set->_print     = FN_PRINT_VAL; \
+	set->filter     = NULL; \
+	set->_hashValue = NULL; \
+	/* The inline elements are the first spare ones */\
+	set->inlineElems = SET ## _inlineStorage(set, &(set->inlineCount)); \
+	for(i = set->inlineCount - 1 ; i >= 0 ; i--) \
+	{ \
+		set->inlineElems[i].next = set->spare; \
+		set->spare = &(set->inlineElems[i]); \
+	} \
+	set->spareCount = set->inlineCount; \
 	return set; \
+} \
+SET * SET ## _new() \
+{ \
+	return SET ## _init(malloc(sizeof(SET))); \
 }
 
 #define IMPLEMENT_SET_FN_FREE(SET) \
-void SET ## _free(SET * set) \
+void SET ## _destroy(SET * set) \
 { \
-	SET ## _elem_t * it = NULL; \
+	SET ## _elem_t * it = NULL, * next = NULL; \
 	if(set == NULL) return; \
-	for(it = set->begin ; it != NULL ; it = it->next) \
+	for(it = set->begin ; it != NULL ; it = next) \
 	{ \
-		if(it->prev) free(it->prev); \
+		next = it->next; \
 		if(set->freeValue) set->_freeValue(it->value); \
+		if(!SET ## _isInline(set, it)) free(it); \
 	} \
+	for(it = set->spare ; it != NULL ; it = next) \
+	{ \
+		next = it->next; \
+		if(!SET ## _isInline(set, it)) free(it); \
+	} \
+	CuckooFilter_free(set->filter); \
+	set->begin  = NULL; \
+	set->end    = NULL; \
+	set->spare  = NULL; \
+	set->filter = NULL; \
+	set->size   = 0; \
+	set->spareCount = 0; \
+} \
+void SET ## _free(SET * set) \
+{ \
+	if(set == NULL) return; \
+	SET ## _destroy(set); \
 	free(set); \
 }
 
@@ -144,14 +271,21 @@ SET ## _elem_t * SET ## _add(SET * set, Valuetype value) \
 		return NULL; \
 	/* Test if value exists */\
 	elem = SET ## _get(set, value);\
+	/* Equal values have the same hash: the filter is unchanged */\
 	if(elem != NULL) \
 	{ \
 		if(set->freeValue) set->_freeValue(elem->value); \
 		set->_copyValue(&(elem->value), &(value)); \
 		return elem; \
 	} \
-	/* Create the element */\
-	elem = malloc(set->elemSize); \
+	/* Create the element, reusing a spare one */\
+	if((elem = set->spare) != NULL) \
+	{ \
+		set->spare = elem->next; \
+		set->spareCount--; \
+	} \
+	else \
+		elem = malloc(set->elemSize); \
 	elem->prev = NULL; \
 	elem->next = NULL; \
 	set->_copyValue(&(elem->value), &(value)); \
@@ -167,6 +301,9 @@ SET ## _elem_t * SET ## _add(SET * set, Valuetype value) \
 		elem->prev = set->end; \
 	} \
 	set->end = elem; \
+	/* A full filter is rebuilt twice larger, from the set including elem */\
+	if(set->filter != NULL && !CuckooFilter_add(set->filter, set->_hashValue(elem->value))) \
+		SET ## _rebuildFilter(set, set->filter->bucketCount * 8); \
 	return elem; \
 }
 
@@ -179,10 +316,21 @@ SET * SET ## _remove(SET * set, ValueType value) \
 	if(set == NULL) return NULL; \
 	if(elem != NULL) \
 	{ \
+		if(set->filter != NULL) CuckooFilter_remove(set->filter, set->_hashValue(elem->value)); \
 		if(set->freeValue) set->_freeValue(elem->value); \
-		elem->prev->next = elem->next; \
-		elem->next->prev = elem->prev; \
-		free(elem); \
+		if(elem->prev != NULL) elem->prev->next = elem->next; \
+		else                   set->begin       = elem->next; \
+		if(elem->next != NULL) elem->next->prev = elem->prev; \
+		else                   set->end         = elem->prev; \
+		/* Inline elements go back to spare, the others are freed */\
+		if(SET ## _isInline(set, elem)) \
+		{ \
+			elem->next = set->spare; \
+			set->spare = elem; \
+			set->spareCount++; \
+		} \
+		else \
+			free(elem); \
 		set->size--; \
 	} \
 	return set; \
@@ -197,6 +345,8 @@ SET ## _elem_t * SET ## _get(SET * set, ValueType value) \
 	/* Check empty set */ \
 	if(set == NULL)        return NULL; \
 	if(set->begin == NULL) return NULL; \
+	if(set->filter != NULL && !CuckooFilter_contains(set->filter, set->_hashValue(value))) \
+		return NULL; \
 	/* Start search */ \
 	it = set->begin; \
 	while(it != NULL) \
@@ -221,6 +371,8 @@ SET ## _elem_t * SET ## _search(SET * set, Valuetype search) \
 	/* Check empty set */ \
 	if(set == NULL)        return NULL; \
 	if(set->begin == NULL) return NULL; \
+	if(set->filter != NULL && !CuckooFilter_contains(set->filter, set->_hashValue(search))) \
+		return NULL; \
 	/* Start search */ \
 	it = set->begin; \
 	while(it != NULL) \
@@ -236,11 +388,107 @@ SET ## _elem_t * SET ## _search(SET * set, Valuetype search) \
 	return out; \
 }
 
+/* Internal helper: replace the filter by one of the given capacity, filled from the set */
+#define IMPLEMENT_SET_FN_FILTER_HELPERS(SET) \
+static void SET ## _rebuildFilter(SET * set, size_t capacity) \
+{ \
+	SET ## _elem_t * it = NULL; \
+	CuckooFilter_free(set->filter); \
+	set->filter = CuckooFilter_new(capacity); \
+	for(it = set->begin ; it != NULL ; it = it->next) \
+	{ \
+		if(!CuckooFilter_add(set->filter, set->_hashValue(it->value))) \
+		{ \
+			SET ## _rebuildFilter(set, capacity * 2); \
+			return; \
+		} \
+	} \
+}
+
+#define IMPLEMENT_SET_FN_ATTACH_FILTER_STRUCT(SET, Valuetype) \
+SET * SET ## _attachFilter(SET * set, uint64_t (*hash)(Valuetype value)) \
+{ \
+	if(set == NULL) return NULL; \
+	set->_hashValue = hash; \
+	if(hash == NULL) \
+	{ \
+		CuckooFilter_free(set->filter); \
+		set->filter = NULL; \
+		return set; \
+	} \
+	SET ## _rebuildFilter(set, (set->size < 1024) ? 1024 : set->size * 2); \
+	return set; \
+}
+
+#define IMPLEMENT_SET_FN_CLEAR(SET) \
+void SET ## _clear(SET * set) \
+{ \
+	SET ## _elem_t * it = NULL; \
+	if(set == NULL || set->begin == NULL) return; \
+	if(set->freeValue) \
+		for(it = set->begin ; it != NULL ; it = it->next) \
+			set->_freeValue(it->value); \
+	/* Put the whole chain in front of spare */\
+	set->end->next  = set->spare; \
+	set->spare      = set->begin; \
+	set->spareCount += set->size; \
+	set->begin = NULL; \
+	set->end   = NULL; \
+	set->size  = 0; \
+	if(set->filter != NULL) \
+		CuckooFilter_clear(set->filter); \
+}
+
+#define IMPLEMENT_SET_FN_RESERVE(SET) \
+void SET ## _reserve(SET * set, int n) \
+{ \
+	SET ## _elem_t * elem = NULL; \
+	if(set == NULL) return; \
+	while(set->size + set->spareCount < n) \
+	{ \
+		if((elem = malloc(set->elemSize)) == NULL) \
+			return; \
+		elem->next = set->spare; \
+		set->spare = elem; \
+		set->spareCount++; \
+	} \
+	if(set->filter != NULL && set->filter->bucketCount * 4 * 95 / 100 < (size_t)n) \
+		SET ## _rebuildFilter(set, n); \
+}
+
+#define IMPLEMENT_SET_FN_SHRINK_TO_FIT(SET) \
+void SET ## _shrink_to_fit(SET * set) \
+{ \
+	SET ## _elem_t * it = NULL, * next = NULL; \
+	size_t capacity = 0; \
+	if(set == NULL) return; \
+	it = set->spare; \
+	set->spare      = NULL; \
+	set->spareCount = 0; \
+	for( ; it != NULL ; it = next) \
+	{ \
+		next = it->next; \
+		if(!SET ## _isInline(set, it)) \
+		{ \
+			free(it); \
+			continue; \
+		} \
+		/* Inline elements stay spare */\
+		it->next   = set->spare; \
+		set->spare = it; \
+		set->spareCount++; \
+	} \
+	/* Same sizing as SET_attachFilter */\
+	capacity = (set->size < 1024) ? 1024 : (size_t)set->size * 2; \
+	if(set->filter != NULL && set->filter->bucketCount * 4 > capacity * 2) \
+		SET ## _rebuildFilter(set, capacity); \
+}
+
 #ifdef CCONTAINERS_DISABLE_PRINT
 #define IMPLEMENT_SET_FN_PRINT(SET) \
 void SET ## _print(SET * set) \
 { \
-	(void)(list); \
+	(void)(set); \
 }
 #else
 #define IMPLEMENT_SET_FN_PRINT(SET) \
@@ -262,21 +510,40 @@ void SET ## _print(SET * set) \
 // MACRO HELPERS (One line definitions && implementations)
 #define NEW_SET_DEFINITION(SET, VALUETYPE) \
 NEW_SET_TYPE(SET, VALUETYPE); \
+NEW_SET_FUNCTIONS(SET, VALUETYPE)
+
+/* SET holding its first N elements: they cost no allocation */
+#define NEW_SET_SMALL_DEFINITION(SET, VALUETYPE, N) \
+NEW_SET_SMALL_TYPE(SET, VALUETYPE, N); \
+NEW_SET_FUNCTIONS(SET, VALUETYPE)
+
+#define NEW_SET_FUNCTIONS(SET, VALUETYPE) \
 SET_FN_NEW(SET); \
+SET_FN_INIT(SET); \
 SET_FN_FREE(SET); \
+SET_FN_DESTROY(SET); \
 SET_FN_ADD_STRUCT(SET, VALUETYPE); \
 SET_FN_REMOVE_STRUCT(SET, VALUETYPE); \
 SET_FN_GET_STRUCT(SET, VALUETYPE); \
 SET_FN_SEARCH_STRUCT(SET, VALUETYPE); \
+SET_FN_ATTACH_FILTER_STRUCT(SET, VALUETYPE); \
+SET_FN_CLEAR(SET); \
+SET_FN_RESERVE(SET); \
+SET_FN_SHRINK_TO_FIT(SET); \
 SET_FN_PRINT_STRUCT(SET)
 
 #define IMPLEMENT_SET(SET, VALUETYPE, FN_CPY_VAL, FN_CMP_VAL, FN_FREE_VAL, FN_PRINT_VAL) \
 IMPLEMENT_SET_FN_NEW(SET, VALUETYPE, FN_CPY_VAL, FN_CMP_VAL, FN_FREE_VAL, FN_PRINT_VAL); \
 IMPLEMENT_SET_FN_FREE(SET); \
+IMPLEMENT_SET_FN_FILTER_HELPERS(SET); \
 IMPLEMENT_SET_FN_ADD_STRUCT(SET, VALUETYPE); \
 IMPLEMENT_SET_FN_REMOVE_STRUCT(SET, VALUETYPE); \
 IMPLEMENT_SET_FN_GET_STRUCT(SET, VALUETYPE); \
 IMPLEMENT_SET_FN_SEARCH_STRUCT(SET, VALUETYPE); \
+IMPLEMENT_SET_FN_ATTACH_FILTER_STRUCT(SET, VALUETYPE); \
+IMPLEMENT_SET_FN_CLEAR(SET); \
+IMPLEMENT_SET_FN_RESERVE(SET); \
+IMPLEMENT_SET_FN_SHRINK_TO_FIT(SET); \
 IMPLEMENT_SET_FN_PRINT(SET)
 
 
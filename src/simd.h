@@ -0,0 +1,193 @@
+/**
+ * @file simd.h
+ * @brief Vectorized search kernels for standard types
+ * @details Scan contiguous arrays of int, float or double for a value.
+ * The best kernel available on the running CPU (AVX2, SSE2 or scalar)
+ * is selected the first time a type is scanned.
+ * Define CCONTAINERS_DISABLE_SIMD to always use the scalar kernels.
+ *
+ * Values are compared as Float_cmp and Double_cmp do: -0.0 matches 0.0
+ * and a NaN matches every NaN (NaN searches take a scalar loop).
+ * @author Baudouin FEILDEL
+ */
+#ifndef __C_CONTAINERS_SIMD_H__
+#define __C_CONTAINERS_SIMD_H__
+
+#include <stdlib.h>
+
+#if !defined(CCONTAINERS_DISABLE_SIMD) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CCONTAINERS_SIMD_X86
+#include <immintrin.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =================
+//  Kernels
+// =================
+/*
+ Generate a scan kernel.
+ A kernel stores the positions of the first \c limit elements equal to
+ \c search in \c out and returns how many were found.
+ When \c out is NULL matches are only counted, using popcount.
+ MATCH_MASK must set bit n when data[i + n] == search.
+ */
+#define IMPLEMENT_SIMD_SCAN(NAME, Type, ATTRIBUTES, LANES, DECL_KEY, MATCH_MASK) \
+static inline ATTRIBUTES int NAME(const Type * data, int size, Type search, int * out, int limit) \
+{ \
+	int i = 0, found = 0; \
+	unsigned int mask = 0; \
+	DECL_KEY; \
+	for(i = 0 ; i + (LANES) <= size ; i += (LANES)) \
+	{ \
+		mask = (MATCH_MASK); \
+		if(mask == 0) \
+			continue; \
+		if(out == NULL) \
+		{ \
+			found += __builtin_popcount(mask); \
+			if(found >= limit) return limit; \
+			continue; \
+		} \
+		while(mask != 0) \
+		{ \
+			out[found++] = i + __builtin_ctz(mask); \
+			if(found >= limit) return found; \
+			mask &= mask - 1; \
+		} \
+	} \
+	for( ; i < size ; i++) \
+	{ \
+		if(data[i] == search) \
+		{ \
+			if(out != NULL) out[found] = i; \
+			if(++found >= limit) return found; \
+		} \
+	} \
+	return found; \
+}
+
+IMPLEMENT_SIMD_SCAN(Int_scan_scalar,    int,    , 1, (void)0, data[i] == search)
+IMPLEMENT_SIMD_SCAN(Float_scan_scalar,  float,  , 1, (void)0, data[i] == search)
+IMPLEMENT_SIMD_SCAN(Double_scan_scalar, double, , 1, (void)0, data[i] == search)
+
+#ifdef CCONTAINERS_SIMD_X86
+IMPLEMENT_SIMD_SCAN(Int_scan_sse2, int, __attribute__((target("sse2"))), 4,
+	__m128i key = _mm_set1_epi32(search),
+	_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(data + i)), key))))
+IMPLEMENT_SIMD_SCAN(Float_scan_sse2, float, __attribute__((target("sse2"))), 4,
+	__m128 key = _mm_set1_ps(search),
+	_mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(data + i), key)))
+IMPLEMENT_SIMD_SCAN(Double_scan_sse2, double, __attribute__((target("sse2"))), 2,
+	__m128d key = _mm_set1_pd(search),
+	_mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(data + i), key)))
+
+IMPLEMENT_SIMD_SCAN(Int_scan_avx2, int, __attribute__((target("avx2"))), 8,
+	__m256i key = _mm256_set1_epi32(search),
+	_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(data + i)), key))))
+IMPLEMENT_SIMD_SCAN(Float_scan_avx2, float, __attribute__((target("avx2"))), 8,
+	__m256 key = _mm256_set1_ps(search),
+	_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(data + i), key, _CMP_EQ_OQ)))
+IMPLEMENT_SIMD_SCAN(Double_scan_avx2, double, __attribute__((target("avx2"))), 4,
+	__m256d key = _mm256_set1_pd(search),
+	_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(data + i), key, _CMP_EQ_OQ)))
+#endif
+
+// =================
+//  Dispatch
+// =================
+/* IS_NAN argument of IMPLEMENT_SIMD_DISPATCH */
+#define SIMD_IS_NAN(value)    ((value) != (value))
+#define SIMD_NEVER_NAN(value) 0
+
+/*
+ Generate the dispatched entry points of a type:
+ - Prefix_scan     Kernel selected for the running CPU
+ - Prefix_search   Position of the first match, -1 if none
+ - Prefix_count    Number of matches
+ - Prefix_find_all Positions of every match
+ */
+#define IMPLEMENT_SIMD_DISPATCH(Prefix, Type, IS_NAN) \
+static inline int Prefix ## _scan(const Type * data, int size, Type search, int * out, int limit) \
+{ \
+	int i = 0, found = 0; \
+	static int (*kernel)(const Type *, int, Type, int *, int) = NULL; \
+	int (*selected)(const Type *, int, Type, int *, int) = __atomic_load_n(&kernel, __ATOMIC_ACQUIRE); \
+	if(selected == NULL) \
+	{ \
+		/* Threads racing here select the same kernel, published once chosen */\
+		selected = Prefix ## _scan_scalar; \
+		IMPLEMENT_SIMD_SELECT(Prefix) \
+		__atomic_store_n(&kernel, selected, __ATOMIC_RELEASE); \
+	} \
+	if(data == NULL || size <= 0 || limit <= 0) return 0; \
+	if(IS_NAN(search)) \
+	{ \
+		/* == never matches NaN: match the NaN elements instead */\
+		for(i = 0 ; i < size && found < limit ; i++) \
+		{ \
+			if(!IS_NAN(data[i])) continue; \
+			if(out != NULL) out[found] = i; \
+			found++; \
+		} \
+		return found; \
+	} \
+	return selected(data, size, search, out, limit); \
+} \
+/**
+ Search a value in an array
+ @param data   Array to scan
+ @param size   Number of elements in \c data
+ @param search The value to search
+ @return       Position of the first element equal to \c search. -1 otherwise
+ */ \
+static inline int Prefix ## _search(const Type * data, int size, Type search) \
+{ \
+	int position = -1; \
+	Prefix ## _scan(data, size, search, &position, 1); \
+	return position; \
+} \
+/**
+ Count the occurrences of a value in an array
+ @param data   Array to scan
+ @param size   Number of elements in \c data
+ @param search The value to count
+ @return       Number of elements equal to \c search
+ */ \
+static inline int Prefix ## _count(const Type * data, int size, Type search) \
+{ \
+	return Prefix ## _scan(data, size, search, NULL, size); \
+} \
+/**
+ Find every occurrence of a value in an array
+ @param data      Array to scan
+ @param size      Number of elements in \c data
+ @param search    The value to search
+ @param positions Output array, must be able to hold \c size positions
+ @return          Number of positions written in \c positions
+ */ \
+static inline int Prefix ## _find_all(const Type * data, int size, Type search, int * positions) \
+{ \
+	return Prefix ## _scan(data, size, search, positions, size); \
+}
+
+#ifdef CCONTAINERS_SIMD_X86
+#define IMPLEMENT_SIMD_SELECT(Prefix) \
+		if(__builtin_cpu_supports("avx2")) \
+			selected = Prefix ## _scan_avx2; \
+		else if(__builtin_cpu_supports("sse2")) \
+			selected = Prefix ## _scan_sse2;
+#else
+#define IMPLEMENT_SIMD_SELECT(Prefix)
+#endif
+
+IMPLEMENT_SIMD_DISPATCH(Int,    int,    SIMD_NEVER_NAN)
+IMPLEMENT_SIMD_DISPATCH(Float,  float,  SIMD_IS_NAN)
+IMPLEMENT_SIMD_DISPATCH(Double, double, SIMD_IS_NAN)
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __C_CONTAINERS_SIMD_H__
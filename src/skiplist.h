@@ -0,0 +1,677 @@
+/**
+ * @file skiplist.h
+ * @brief Concurrent skip list container definition
+ * @details An ordered set (by _cmpValue) shared by many threads, built as a
+ * lazy skip list:
+ * - _get, _range and _forEach never lock nor write shared memory: they
+ *   follow the next pointers and skip the nodes being inserted or removed,
+ * - _add and _remove search without lock too, then lock only the
+ *   predecessors of the node (one per level, bottom-up), check that they
+ *   did not change and link or unlink the node.
+ * A removed node is first marked (logically removed), then unlinked.
+ *
+ * Unlinked nodes may still be read by other threads. They are retired with
+ * the current epoch and freed once every thread entered before has left
+ * (epoch-based reclamation, like pmap.h). Every thread gets a
+ * SKIPLIST_reader_t with SKIPLIST_reader and gives it to each call.
+ * Link with -pthread.
+ * @author Baudouin FEILDEL
+ */
+#ifndef __SKIPLIST_H__
+#define __SKIPLIST_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Number of levels of the list: a node goes up one level with probability 1/4 */
+#ifndef SKIPLIST_MAX_LEVEL
+#define SKIPLIST_MAX_LEVEL 16
+#endif
+
+/** Retired nodes accumulated before trying to free them */
+#ifndef SKIPLIST_RECLAIM_BATCH
+#define SKIPLIST_RECLAIM_BATCH 64
+#endif
+
+/** Epoch of a reader outside of any call */
+#define SKIPLIST_IDLE UINT64_MAX
+
+/**
+ Reader of skip lists
+ @details Aligned on a cache line so that readers never share one.
+ */
+typedef struct SKIPLIST_reader_t
+{
+	uint64_t epoch; /**< Epoch pinned by the thread. SKIPLIST_IDLE outside of a call */
+	int      depth; /**< Number of nested SKIPLIST_enter */
+	int      used;  /**< Flag:<br>1: Owned by a thread<br>0: Free for reuse */
+	uint64_t seed;  /**< State of the level generator of the thread */
+	struct SKIPLIST_reader_t * next; /**< Next reader of the list */
+} __attribute__((aligned(64))) SKIPLIST_reader_t;
+
+/**
+ Node waiting for the readers before being freed
+ */
+typedef struct SKIPLIST_retired_t
+{
+	void   * node;  /**< Unlinked node */
+	uint64_t epoch; /**< Epoch of the retirement */
+} SKIPLIST_retired_t;
+
+/* Level of a new node: 1 + number of pairs of zero bits (p = 1/4) */
+static inline int SKIPLIST_randomLevel(SKIPLIST_reader_t * reader)
+{
+	uint64_t x = reader->seed;
+	int level = 1;
+	x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+	reader->seed = x;
+	while((x & 3) == 0 && level < SKIPLIST_MAX_LEVEL)
+	{
+		level++;
+		x >>= 2;
+	}
+	return level;
+}
+
+// =============
+//  Definitions
+// =============
+#define NEW_SKIPLIST_NODE(SKIPLIST, NodeTypename, Valuetype) \
+/**
+ Node of a SKIPLIST object
+ */ \
+typedef struct _ ## NodeTypename \
+{ \
+	Valuetype       value;  /**< Value of the node */\
+	pthread_mutex_t lock;   /**< Lock taken to link or unlink the node and its successors */\
+	int             level;  /**< Number of levels of the node */\
+	int             marked; /**< Flag: removed, being unlinked (atomic) */\
+	int             linked; /**< Flag: linked at every level (atomic) */\
+	struct _ ## NodeTypename * next[]; /**< Next node of every level (atomic). NULL at the end */\
+} NodeTypename
+
+#define NEW_SKIPLIST_TYPE(SKIPLIST, Valuetype) \
+NEW_SKIPLIST_NODE(SKIPLIST, SKIPLIST ## _node_t, Valuetype); \
+typedef struct SKIPLIST \
+{ \
+	SKIPLIST ## _node_t * head;   /**< Sentinel before the first node, on every level */\
+	int      size;                /**< Number of values (atomic) */\
+	uint64_t epoch;               /**< Global epoch (atomic) */\
+	SKIPLIST_reader_t * readers;  /**< Registered readers (atomic) */\
+	SKIPLIST_retired_t * retired; /**< Nodes waiting for the readers, by epoch */\
+	int      retiredCount;        /**< Number of retired nodes */\
+	int      retiredCapacity;     /**< Allocated slots of retired */\
+	pthread_mutex_t retireLock;   /**< Lock of readers registration and of retired */\
+	size_t   elemSize;   /**< Size of one node of one level in the list */\
+	int      freeValue;  /**< Flag:<br>1: Automatically free the value<br>0: Do not automatically free the value */\
+	void (*_copyValue)(Valuetype * dest, Valuetype * src); /**< Pointer to a function used to copy a value */\
+	int (*_cmpValue)(Valuetype val1, Valuetype val2); /**< Pointer to a function used to compare two values */\
+	void (*_freeValue)(Valuetype value); /**< Pointer to a function used to free a value */\
+} SKIPLIST
+
+#define SKIPLIST_FN_NEW(SKIPLIST) \
+/**
+ @brief Create a new SKIPLIST object
+ @return A pointer to an allocated and initialized
+ SKIPLIST object in memory
+ */ \
+SKIPLIST * SKIPLIST ## _new()
+
+#define SKIPLIST_FN_FREE(SKIPLIST) \
+/**
+ Destroy a SKIPLIST object
+ @details No other thread may use the list anymore.
+ @param list A pointer to a SKIPLIST object
+ */ \
+void SKIPLIST ## _free(SKIPLIST * list)
+
+#define SKIPLIST_FN_READER(SKIPLIST) \
+/**
+ Get a reader handle
+ @details A reader is used by one thread at a time. It stays valid until
+ SKIPLIST_readerFree or the destruction of the list.
+
+ @param list A pointer to a valid SKIPLIST object
+ @return     A reader of the list
+ */ \
+SKIPLIST_reader_t * SKIPLIST ## _reader(SKIPLIST * list)
+
+#define SKIPLIST_FN_READER_FREE(SKIPLIST) \
+/**
+ Give a reader handle back to the list
+ @param reader A reader outside of SKIPLIST_enter
+ */ \
+void SKIPLIST ## _readerFree(SKIPLIST_reader_t * reader)
+
+#define SKIPLIST_FN_ENTER(SKIPLIST) \
+/**
+ Keep the values seen by a thread valid until SKIPLIST_leave
+ @details Every call enters and leaves by itself: enter explicitly to use
+ the pointers returned by SKIPLIST_get or given to the callbacks after the
+ call. Calls may be nested. Nodes removed meanwhile are not freed, so do
+ not stay inside for long.
+
+ @param list   A pointer to a valid SKIPLIST object
+ @param reader Reader of the calling thread
+ */ \
+void SKIPLIST ## _enter(SKIPLIST * list, SKIPLIST_reader_t * reader)
+
+#define SKIPLIST_FN_LEAVE(SKIPLIST) \
+/**
+ Leave a SKIPLIST_enter
+ @param reader Reader of the calling thread
+ */ \
+void SKIPLIST ## _leave(SKIPLIST_reader_t * reader)
+
+#define SKIPLIST_FN_ADD(SKIPLIST, Valuetype) \
+/**
+ Add a value to the list
+ @param list   A pointer to a valid SKIPLIST object
+ @param reader Reader of the calling thread
+ @param value  The value to add
+ @return       1 if the value was inserted. 0 if it was already present
+ */ \
+int SKIPLIST ## _add(SKIPLIST * list, SKIPLIST_reader_t * reader, Valuetype value)
+
+#define SKIPLIST_FN_REMOVE(SKIPLIST, Valuetype) \
+/**
+ Remove a value from the list
+ @param list   A pointer to a valid SKIPLIST object
+ @param reader Reader of the calling thread
+ @param value  The value to remove
+ @return       1 if the value was removed. 0 if it was not present
+ */ \
+int SKIPLIST ## _remove(SKIPLIST * list, SKIPLIST_reader_t * reader, Valuetype value)
+
+#define SKIPLIST_FN_GET(SKIPLIST, Valuetype) \
+/**
+ Look for a value without locking
+ @param list   A pointer to a valid SKIPLIST object
+ @param reader Reader of the calling thread
+ @param value  The value to look for
+ @return       A pointer to the value stored in the list, valid until
+ SKIPLIST_leave if the thread entered, else only a presence flag.
+ NULL if the value is not present
+ */ \
+Valuetype * SKIPLIST ## _get(SKIPLIST * list, SKIPLIST_reader_t * reader, Valuetype value)
+
+#define SKIPLIST_FN_RANGE(SKIPLIST, Valuetype) \
+/**
+ Call a function on every value between two bounds, in order, without locking
+ @details Values added or removed during the scan may or may not be seen.
+ @param list     A pointer to a valid SKIPLIST object
+ @param reader   Reader of the calling thread
+ @param from     Lowest value of the range (included)
+ @param to       Highest value of the range (included)
+ @param callback Function called with a pointer to the value and \c data.
+ Returns 0 to continue, anything else to stop
+ @param data     User data given to \c callback
+ @return         Number of calls to \c callback
+ */ \
+int SKIPLIST ## _range(SKIPLIST * list, SKIPLIST_reader_t * reader, Valuetype from, Valuetype to, int (*callback)(Valuetype * value, void * data), void * data)
+
+#define SKIPLIST_FN_FOR_EACH(SKIPLIST, Valuetype) \
+/**
+ Call a function on every value of the list, in order, without locking
+ @param list     A pointer to a valid SKIPLIST object
+ @param reader   Reader of the calling thread
+ @param callback Function called with a pointer to the value and \c data
+ @param data     User data given to \c callback
+ */ \
+void SKIPLIST ## _forEach(SKIPLIST * list, SKIPLIST_reader_t * reader, void (*callback)(Valuetype * value, void * data), void * data)
+
+#define SKIPLIST_FN_SIZE(SKIPLIST) \
+/**
+ Count the values of the list
+ @details Only an estimate while other threads use the list.
+ @param list A pointer to a valid SKIPLIST object
+ @return     Number of values in the list
+ */ \
+int SKIPLIST ## _size(SKIPLIST * list)
+
+#define SKIPLIST_FN_RECLAIM(SKIPLIST) \
+/**
+ Free the removed nodes no thread can see anymore
+ @details Called by _remove every SKIPLIST_RECLAIM_BATCH nodes.
+ @param list A pointer to a valid SKIPLIST object
+ @return     Number of nodes still waiting for the readers
+ */ \
+int SKIPLIST ## _reclaim(SKIPLIST * list)
+
+// =================
+//  Implementations
+// =================
+#define IMPLEMENT_SKIPLIST_FN_NEW(SKIPLIST, Valuetype, FN_CPY_VAL, FN_CMP_VAL, FN_FREE_VAL) \
+SKIPLIST * SKIPLIST ## _new() \
+{ \
+	SKIPLIST * list = malloc(sizeof(SKIPLIST)); \
+	list->head = calloc(1, sizeof(SKIPLIST ## _node_t) + sizeof(SKIPLIST ## _node_t *) * SKIPLIST_MAX_LEVEL); \
+	pthread_mutex_init(&(list->head->lock), NULL); \
+	list->head->level  = SKIPLIST_MAX_LEVEL; \
+	list->head->linked = 1; \
+	list->size            = 0; \
+	list->epoch           = 1; \
+	list->readers         = NULL; \
+	list->retired         = NULL; \
+	list->retiredCount    = 0; \
+	list->retiredCapacity = 0; \
+	pthread_mutex_init(&(list->retireLock), NULL); \
+	list->elemSize   = sizeof(SKIPLIST ## _node_t) + sizeof(SKIPLIST ## _node_t *); \
+	list->freeValue  = 1; \
+	list->_copyValue = FN_CPY_VAL; \
+	list->_cmpValue  = FN_CMP_VAL; \
+	list->_freeValue = FN_FREE_VAL; \
+	return list; \
+}
+
+/* Internal helpers: search, locking and reclamation */
+#define IMPLEMENT_SKIPLIST_FN_HELPERS(SKIPLIST, Valuetype) \
+static void SKIPLIST ## _freeNode(SKIPLIST * list, SKIPLIST ## _node_t * node) \
+{ \
+	if(list->freeValue) list->_freeValue(node->value); \
+	pthread_mutex_destroy(&(node->lock)); \
+	free(node); \
+} \
+/* Predecessor and successor of value on every level. Returns the highest level where value was found, or -1 */\
+static int SKIPLIST ## _find(SKIPLIST * list, Valuetype value, SKIPLIST ## _node_t ** preds, SKIPLIST ## _node_t ** succs) \
+{ \
+	SKIPLIST ## _node_t * pred = list->head, * curr = NULL; \
+	int level = 0, found = -1, cmp = 1; \
+	for(level = SKIPLIST_MAX_LEVEL - 1 ; level >= 0 ; level--) \
+	{ \
+		curr = __atomic_load_n(&(pred->next[level]), __ATOMIC_ACQUIRE); \
+		while(curr != NULL && (cmp = list->_cmpValue(curr->value, value)) < 0) \
+		{ \
+			pred = curr; \
+			curr = __atomic_load_n(&(pred->next[level]), __ATOMIC_ACQUIRE); \
+		} \
+		if(found == -1 && curr != NULL && cmp == 0) \
+			found = level; \
+		preds[level] = pred; \
+		succs[level] = curr; \
+	} \
+	return found; \
+} \
+/* First node not lower than value */\
+static SKIPLIST ## _node_t * SKIPLIST ## _lowerBound(SKIPLIST * list, Valuetype value) \
+{ \
+	SKIPLIST ## _node_t * pred = list->head, * curr = NULL; \
+	int level = 0; \
+	for(level = SKIPLIST_MAX_LEVEL - 1 ; level >= 0 ; level--) \
+	{ \
+		curr = __atomic_load_n(&(pred->next[level]), __ATOMIC_ACQUIRE); \
+		while(curr != NULL && list->_cmpValue(curr->value, value) < 0) \
+		{ \
+			pred = curr; \
+			curr = __atomic_load_n(&(pred->next[level]), __ATOMIC_ACQUIRE); \
+		} \
+	} \
+	return curr; \
+} \
+/* Unlock the distinct predecessors locked on levels 0 to highest */\
+static void SKIPLIST ## _unlock(SKIPLIST ## _node_t ** preds, int highest) \
+{ \
+	int level = 0; \
+	for(level = 0 ; level <= highest ; level++) \
+		if(level == 0 || preds[level] != preds[level - 1]) \
+			pthread_mutex_unlock(&(preds[level]->lock)); \
+} \
+static int SKIPLIST ## _reclaimLocked(SKIPLIST * list) \
+{ \
+	SKIPLIST_reader_t * reader = NULL; \
+	uint64_t oldest = SKIPLIST_IDLE, epoch = 0; \
+	int i = 0, freed = 0; \
+	/* Nodes retired before the oldest pinned epoch are unreachable */\
+	for(reader = __atomic_load_n(&(list->readers), __ATOMIC_ACQUIRE) ; reader != NULL ; reader = reader->next) \
+	{ \
+		epoch = __atomic_load_n(&(reader->epoch), __ATOMIC_SEQ_CST); \
+		if(epoch < oldest) \
+			oldest = epoch; \
+	} \
+	while(freed < list->retiredCount && list->retired[freed].epoch < oldest) \
+		freed++; \
+	for(i = 0 ; i < freed ; i++) \
+		SKIPLIST ## _freeNode(list, list->retired[i].node); \
+	list->retiredCount -= freed; \
+	memmove(list->retired, list->retired + freed, sizeof(SKIPLIST_retired_t) * list->retiredCount); \
+	return list->retiredCount; \
+} \
+static void SKIPLIST ## _retire(SKIPLIST * list, SKIPLIST ## _node_t * node) \
+{ \
+	pthread_mutex_lock(&(list->retireLock)); \
+	if(list->retiredCount == list->retiredCapacity) \
+	{ \
+		list->retiredCapacity = list->retiredCapacity ? list->retiredCapacity * 2 : SKIPLIST_RECLAIM_BATCH; \
+		list->retired = realloc(list->retired, sizeof(SKIPLIST_retired_t) * list->retiredCapacity); \
+	} \
+	list->retired[list->retiredCount].node  = node; \
+	list->retired[list->retiredCount].epoch = __atomic_fetch_add(&(list->epoch), 1, __ATOMIC_SEQ_CST); \
+	list->retiredCount++; \
+	if(list->retiredCount % SKIPLIST_RECLAIM_BATCH == 0) \
+		SKIPLIST ## _reclaimLocked(list); \
+	pthread_mutex_unlock(&(list->retireLock)); \
+}
+
+#define IMPLEMENT_SKIPLIST_FN_FREE(SKIPLIST) \
+void SKIPLIST ## _free(SKIPLIST * list) \
+{ \
+	SKIPLIST ## _node_t * node = NULL, * next = NULL; \
+	SKIPLIST_reader_t * reader = NULL, * nextReader = NULL; \
+	int i = 0; \
+	if(list == NULL) return; \
+	/* Retired nodes are not reachable from the head anymore */\
+	for(i = 0 ; i < list->retiredCount ; i++) \
+		SKIPLIST ## _freeNode(list, list->retired[i].node); \
+	for(node = list->head->next[0] ; node != NULL ; node = next) \
+	{ \
+		next = node->next[0]; \
+		SKIPLIST ## _freeNode(list, node); \
+	} \
+	for(reader = list->readers ; reader != NULL ; reader = nextReader) \
+	{ \
+		nextReader = reader->next; \
+		free(reader); \
+	} \
+	pthread_mutex_destroy(&(list->head->lock)); \
+	pthread_mutex_destroy(&(list->retireLock)); \
+	free(list->head); \
+	free(list->retired); \
+	free(list); \
+}
+
+#define IMPLEMENT_SKIPLIST_FN_READER(SKIPLIST) \
+SKIPLIST_reader_t * SKIPLIST ## _reader(SKIPLIST * list) \
+{ \
+	SKIPLIST_reader_t * reader = NULL; \
+	void * memory = NULL; \
+	if(list == NULL) return NULL; \
+	pthread_mutex_lock(&(list->retireLock)); \
+	for(reader = list->readers ; reader != NULL ; reader = reader->next) \
+		if(!__atomic_load_n(&(reader->used), __ATOMIC_ACQUIRE)) \
+			break; \
+	if(reader == NULL && posix_memalign(&memory, 64, sizeof(SKIPLIST_reader_t)) == 0) \
+	{ \
+		reader = memory; \
+		reader->epoch = SKIPLIST_IDLE; \
+		reader->depth = 0; \
+		reader->seed  = 0x9E3779B97F4A7C15ULL ^ (uint64_t)(uintptr_t)reader; \
+		reader->next  = list->readers; \
+		__atomic_store_n(&(list->readers), reader, __ATOMIC_RELEASE); \
+	} \
+	if(reader != NULL) \
+		reader->used = 1; \
+	pthread_mutex_unlock(&(list->retireLock)); \
+	return reader; \
+}
+
+#define IMPLEMENT_SKIPLIST_FN_READER_FREE(SKIPLIST) \
+void SKIPLIST ## _readerFree(SKIPLIST_reader_t * reader) \
+{ \
+	if(reader == NULL) return; \
+	reader->depth = 0; \
+	__atomic_store_n(&(reader->epoch), SKIPLIST_IDLE, __ATOMIC_RELEASE); \
+	__atomic_store_n(&(reader->used), 0, __ATOMIC_RELEASE); \
+}
+
+#define IMPLEMENT_SKIPLIST_FN_ENTER(SKIPLIST) \
+void SKIPLIST ## _enter(SKIPLIST * list, SKIPLIST_reader_t * reader) \
+{ \
+	if(reader->depth++ > 0) \
+		return; \
+	/* Pin the epoch before reading any node: the removers retiring */\
+	/* a node the thread may reach will see the pin and keep it */\
+	__atomic_store_n(&(reader->epoch), __atomic_load_n(&(list->epoch), __ATOMIC_SEQ_CST), __ATOMIC_SEQ_CST); \
+	__atomic_thread_fence(__ATOMIC_SEQ_CST); \
+}
+
+#define IMPLEMENT_SKIPLIST_FN_LEAVE(SKIPLIST) \
+void SKIPLIST ## _leave(SKIPLIST_reader_t * reader) \
+{ \
+	if(--reader->depth > 0) \
+		return; \
+	__atomic_store_n(&(reader->epoch), SKIPLIST_IDLE, __ATOMIC_RELEASE); \
+}
+
+#define IMPLEMENT_SKIPLIST_FN_ADD(SKIPLIST, Valuetype) \
+int SKIPLIST ## _add(SKIPLIST * list, SKIPLIST_reader_t * reader, Valuetype value) \
+{ \
+	SKIPLIST ## _node_t * preds[SKIPLIST_MAX_LEVEL]; \
+	SKIPLIST ## _node_t * succs[SKIPLIST_MAX_LEVEL]; \
+	SKIPLIST ## _node_t * node = NULL, * found = NULL, * pred = NULL, * prevPred = NULL; \
+	int level = 0, top = 0, highest = -1, valid = 1, lFound = -1; \
+	if(list == NULL || reader == NULL) return 0; \
+	top  = SKIPLIST_randomLevel(reader); \
+	node = malloc(sizeof(SKIPLIST ## _node_t) + sizeof(SKIPLIST ## _node_t *) * top); \
+	list->_copyValue(&(node->value), &(value)); \
+	pthread_mutex_init(&(node->lock), NULL); \
+	node->level  = top; \
+	node->marked = 0; \
+	node->linked = 0; \
+	SKIPLIST ## _enter(list, reader); \
+	while(1) \
+	{ \
+		if((lFound = SKIPLIST ## _find(list, node->value, preds, succs)) != -1) \
+		{ \
+			found = succs[lFound]; \
+			if(!__atomic_load_n(&(found->marked), __ATOMIC_ACQUIRE)) \
+			{ \
+				/* Present: wait for a concurrent insertion to finish */\
+				while(!__atomic_load_n(&(found->linked), __ATOMIC_ACQUIRE)) \
+					sched_yield(); \
+				SKIPLIST ## _leave(reader); \
+				SKIPLIST ## _freeNode(list, node); \
+				return 0; \
+			} \
+			/* Being removed: retry once it is unlinked */\
+			sched_yield(); \
+			continue; \
+		} \
+		highest  = -1; \
+		valid    = 1; \
+		prevPred = NULL; \
+		for(level = 0 ; valid && level < top ; level++) \
+		{ \
+			pred = preds[level]; \
+			if(pred != prevPred) \
+			{ \
+				pthread_mutex_lock(&(pred->lock)); \
+				highest  = level; \
+				prevPred = pred; \
+			} \
+			valid = !__atomic_load_n(&(pred->marked), __ATOMIC_ACQUIRE) \
+			     && (succs[level] == NULL || !__atomic_load_n(&(succs[level]->marked), __ATOMIC_ACQUIRE)) \
+			     && __atomic_load_n(&(pred->next[level]), __ATOMIC_ACQUIRE) == succs[level]; \
+		} \
+		if(!valid) \
+		{ \
+			SKIPLIST ## _unlock(preds, highest); \
+			continue; \
+		} \
+		for(level = 0 ; level < top ; level++) \
+			node->next[level] = succs[level]; \
+		for(level = 0 ; level < top ; level++) \
+			__atomic_store_n(&(preds[level]->next[level]), node, __ATOMIC_RELEASE); \
+		__atomic_store_n(&(node->linked), 1, __ATOMIC_RELEASE); \
+		SKIPLIST ## _unlock(preds, highest); \
+		__atomic_fetch_add(&(list->size), 1, __ATOMIC_RELAXED); \
+		SKIPLIST ## _leave(reader); \
+		return 1; \
+	} \
+}
+
+#define IMPLEMENT_SKIPLIST_FN_REMOVE(SKIPLIST, Valuetype) \
+int SKIPLIST ## _remove(SKIPLIST * list, SKIPLIST_reader_t * reader, Valuetype value) \
+{ \
+	SKIPLIST ## _node_t * preds[SKIPLIST_MAX_LEVEL]; \
+	SKIPLIST ## _node_t * succs[SKIPLIST_MAX_LEVEL]; \
+	SKIPLIST ## _node_t * victim = NULL, * pred = NULL, * prevPred = NULL; \
+	int level = 0, top = 0, highest = -1, valid = 1, lFound = -1, marked = 0; \
+	if(list == NULL || reader == NULL) return 0; \
+	SKIPLIST ## _enter(list, reader); \
+	while(1) \
+	{ \
+		lFound = SKIPLIST ## _find(list, value, preds, succs); \
+		if(!marked) \
+		{ \
+			/* Only a fully linked node found on its top level may be removed */\
+			victim = lFound != -1 ? succs[lFound] : NULL; \
+			if(victim == NULL || !__atomic_load_n(&(victim->linked), __ATOMIC_ACQUIRE) \
+			   || victim->level - 1 != lFound || __atomic_load_n(&(victim->marked), __ATOMIC_ACQUIRE)) \
+			{ \
+				SKIPLIST ## _leave(reader); \
+				return 0; \
+			} \
+			top = victim->level; \
+			pthread_mutex_lock(&(victim->lock)); \
+			if(__atomic_load_n(&(victim->marked), __ATOMIC_ACQUIRE)) \
+			{ \
+				pthread_mutex_unlock(&(victim->lock)); \
+				SKIPLIST ## _leave(reader); \
+				return 0; \
+			} \
+			__atomic_store_n(&(victim->marked), 1, __ATOMIC_RELEASE); \
+			marked = 1; \
+		} \
+		highest  = -1; \
+		valid    = 1; \
+		prevPred = NULL; \
+		for(level = 0 ; valid && level < top ; level++) \
+		{ \
+			pred = preds[level]; \
+			if(pred != prevPred) \
+			{ \
+				pthread_mutex_lock(&(pred->lock)); \
+				highest  = level; \
+				prevPred = pred; \
+			} \
+			valid = !__atomic_load_n(&(pred->marked), __ATOMIC_ACQUIRE) \
+			     && __atomic_load_n(&(pred->next[level]), __ATOMIC_ACQUIRE) == victim; \
+		} \
+		if(!valid) \
+		{ \
+			SKIPLIST ## _unlock(preds, highest); \
+			continue; \
+		} \
+		for(level = top - 1 ; level >= 0 ; level--) \
+			__atomic_store_n(&(preds[level]->next[level]), victim->next[level], __ATOMIC_RELEASE); \
+		pthread_mutex_unlock(&(victim->lock)); \
+		SKIPLIST ## _unlock(preds, highest); \
+		__atomic_fetch_sub(&(list->size), 1, __ATOMIC_RELAXED); \
+		SKIPLIST ## _leave(reader); \
+		SKIPLIST ## _retire(list, victim); \
+		return 1; \
+	} \
+}
+
+#define IMPLEMENT_SKIPLIST_FN_GET(SKIPLIST, Valuetype) \
+Valuetype * SKIPLIST ## _get(SKIPLIST * list, SKIPLIST_reader_t * reader, Valuetype value) \
+{ \
+	SKIPLIST ## _node_t * node = NULL; \
+	Valuetype * found = NULL; \
+	if(list == NULL || reader == NULL) return NULL; \
+	SKIPLIST ## _enter(list, reader); \
+	node = SKIPLIST ## _lowerBound(list, value); \
+	if(node != NULL && list->_cmpValue(node->value, value) == 0 \
+	   && __atomic_load_n(&(node->linked), __ATOMIC_ACQUIRE) && !__atomic_load_n(&(node->marked), __ATOMIC_ACQUIRE)) \
+		found = &(node->value); \
+	SKIPLIST ## _leave(reader); \
+	return found; \
+}
+
+#define IMPLEMENT_SKIPLIST_FN_RANGE(SKIPLIST, Valuetype) \
+int SKIPLIST ## _range(SKIPLIST * list, SKIPLIST_reader_t * reader, Valuetype from, Valuetype to, int (*callback)(Valuetype * value, void * data), void * data) \
+{ \
+	SKIPLIST ## _node_t * node = NULL; \
+	int calls = 0; \
+	if(list == NULL || reader == NULL) return 0; \
+	SKIPLIST ## _enter(list, reader); \
+	/* A removed node keeps its next pointers: the scan may go through it */\
+	for(node = SKIPLIST ## _lowerBound(list, from) ; node != NULL && list->_cmpValue(node->value, to) <= 0 ; \
+	    node = __atomic_load_n(&(node->next[0]), __ATOMIC_ACQUIRE)) \
+	{ \
+		if(!__atomic_load_n(&(node->linked), __ATOMIC_ACQUIRE) || __atomic_load_n(&(node->marked), __ATOMIC_ACQUIRE)) \
+			continue; \
+		calls++; \
+		if(callback(&(node->value), data)) \
+			break; \
+	} \
+	SKIPLIST ## _leave(reader); \
+	return calls; \
+}
+
+#define IMPLEMENT_SKIPLIST_FN_FOR_EACH(SKIPLIST, Valuetype) \
+void SKIPLIST ## _forEach(SKIPLIST * list, SKIPLIST_reader_t * reader, void (*callback)(Valuetype * value, void * data), void * data) \
+{ \
+	SKIPLIST ## _node_t * node = NULL; \
+	if(list == NULL || reader == NULL) return; \
+	SKIPLIST ## _enter(list, reader); \
+	for(node = __atomic_load_n(&(list->head->next[0]), __ATOMIC_ACQUIRE) ; node != NULL ; \
+	    node = __atomic_load_n(&(node->next[0]), __ATOMIC_ACQUIRE)) \
+		if(__atomic_load_n(&(node->linked), __ATOMIC_ACQUIRE) && !__atomic_load_n(&(node->marked), __ATOMIC_ACQUIRE)) \
+			callback(&(node->value), data); \
+	SKIPLIST ## _leave(reader); \
+}
+
+#define IMPLEMENT_SKIPLIST_FN_SIZE(SKIPLIST) \
+int SKIPLIST ## _size(SKIPLIST * list) \
+{ \
+	if(list == NULL) return 0; \
+	return __atomic_load_n(&(list->size), __ATOMIC_RELAXED); \
+}
+
+#define IMPLEMENT_SKIPLIST_FN_RECLAIM(SKIPLIST) \
+int SKIPLIST ## _reclaim(SKIPLIST * list) \
+{ \
+	int count = 0; \
+	if(list == NULL) return 0; \
+	pthread_mutex_lock(&(list->retireLock)); \
+	count = SKIPLIST ## _reclaimLocked(list); \
+	pthread_mutex_unlock(&(list->retireLock)); \
+	return count; \
+}
+
+// MACRO HELPERS (One line definitions && implementations)
+#define NEW_SKIPLIST_DEFINITION(SKIPLIST, VALUETYPE) \
+NEW_SKIPLIST_TYPE(SKIPLIST, VALUETYPE); \
+SKIPLIST_FN_NEW(SKIPLIST); \
+SKIPLIST_FN_FREE(SKIPLIST); \
+SKIPLIST_FN_READER(SKIPLIST); \
+SKIPLIST_FN_READER_FREE(SKIPLIST); \
+SKIPLIST_FN_ENTER(SKIPLIST); \
+SKIPLIST_FN_LEAVE(SKIPLIST); \
+SKIPLIST_FN_ADD(SKIPLIST, VALUETYPE); \
+SKIPLIST_FN_REMOVE(SKIPLIST, VALUETYPE); \
+SKIPLIST_FN_GET(SKIPLIST, VALUETYPE); \
+SKIPLIST_FN_RANGE(SKIPLIST, VALUETYPE); \
+SKIPLIST_FN_FOR_EACH(SKIPLIST, VALUETYPE); \
+SKIPLIST_FN_SIZE(SKIPLIST); \
+SKIPLIST_FN_RECLAIM(SKIPLIST)
+
+#define IMPLEMENT_SKIPLIST(SKIPLIST, VALUETYPE, FN_CPY_VAL, FN_CMP_VAL, FN_FREE_VAL) \
+IMPLEMENT_SKIPLIST_FN_NEW(SKIPLIST, VALUETYPE, FN_CPY_VAL, FN_CMP_VAL, FN_FREE_VAL); \
+IMPLEMENT_SKIPLIST_FN_HELPERS(SKIPLIST, VALUETYPE); \
+IMPLEMENT_SKIPLIST_FN_FREE(SKIPLIST); \
+IMPLEMENT_SKIPLIST_FN_READER(SKIPLIST); \
+IMPLEMENT_SKIPLIST_FN_READER_FREE(SKIPLIST); \
+IMPLEMENT_SKIPLIST_FN_ENTER(SKIPLIST); \
+IMPLEMENT_SKIPLIST_FN_LEAVE(SKIPLIST); \
+IMPLEMENT_SKIPLIST_FN_ADD(SKIPLIST, VALUETYPE); \
+IMPLEMENT_SKIPLIST_FN_REMOVE(SKIPLIST, VALUETYPE); \
+IMPLEMENT_SKIPLIST_FN_GET(SKIPLIST, VALUETYPE); \
+IMPLEMENT_SKIPLIST_FN_RANGE(SKIPLIST, VALUETYPE); \
+IMPLEMENT_SKIPLIST_FN_FOR_EACH(SKIPLIST, VALUETYPE); \
+IMPLEMENT_SKIPLIST_FN_SIZE(SKIPLIST); \
+IMPLEMENT_SKIPLIST_FN_RECLAIM(SKIPLIST)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SKIPLIST_H__
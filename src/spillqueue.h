@@ -0,0 +1,446 @@
+/**
+ * @file spillqueue.h
+ * @brief Queue container spilling to disk
+ * @details A spill queue keeps at most two bounded buffers in memory:
+ * - head: the next values to dequeue
+ * - tail: the last enqueued values
+ *
+ * When the tail buffer is full, its values are serialized and appended to
+ * a segment file, so the values between the head and the tail live on disk
+ * and the memory used by the queue stays bounded whatever its size.
+ * Segment files are written sequentially, read back a whole head buffer at
+ * a time (read-ahead) and removed once consumed.
+ *
+ * Values are converted with two callbacks:
+ * - size_t serialize(ValueType * value, void * buffer, size_t capacity)
+ *   writes the value in buffer and returns its size in bytes. If the value
+ *   needs more than capacity bytes, it returns the needed size without
+ *   writing and is called again with a large enough buffer.
+ * - void deserialize(ValueType * dest, const void * buffer, size_t size)
+ *   rebuilds a value from the bytes written by serialize.
+ * @author Baudouin FEILDEL
+ */
+#ifndef __SPILLQUEUE_H__
+#define __SPILLQUEUE_H__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Size of a segment file before switching to the next one */
+#ifndef SPILLQUEUE_SEGMENT_BYTES
+#define SPILLQUEUE_SEGMENT_BYTES (64 << 20)
+#endif
+
+/** Size of the stdio buffers of the segment files */
+#ifndef SPILLQUEUE_IO_BYTES
+#define SPILLQUEUE_IO_BYTES (1 << 20)
+#endif
+
+// =============
+//  Definitions
+// =============
+#define NEW_SPILLQUEUE_TYPE(SPILLQUEUE, ValueType) \
+typedef struct SPILLQUEUE \
+{ \
+	ValueType * head;          /**< Circular buffer of the next values to dequeue */\
+	int    headFirst;          /**< Position of the first value in head */\
+	int    headCount;          /**< Number of values in head */\
+	int    headCapacity;       /**< Number of slots in head */\
+	ValueType * tail;          /**< Last enqueued values, waiting to be spilled */\
+	int    tailCount;          /**< Number of values in tail */\
+	int    tailCapacity;       /**< Number of slots in tail */\
+	char * directory;          /**< Directory of the segment files */\
+	FILE * writer;             /**< Segment being written. NULL before the first spill */\
+	FILE * reader;             /**< Segment being read. NULL before the first read */\
+	unsigned long writeSegment; /**< Number of the segment being written */\
+	unsigned long readSegment; /**< Number of the segment being read */\
+	long   segmentBytes;       /**< Bytes written in the current segment */\
+	size_t spilled;            /**< Number of values on disk */\
+	size_t lost;               /**< Number of values lost to read errors */\
+	unsigned char * buffer;    /**< Serialization buffer */\
+	size_t bufferSize;         /**< Size of buffer */\
+	size_t size;               /**< Queue size */\
+	size_t elemSize;           /**< Size of one element in the queue */\
+	int    freeValue;          /**< Flag:<br>1: Automatically free the value<br>0: Do not automatically free the value */\
+	void   (*_copyValue)   (ValueType * dest, ValueType * src); /**< Pointer to a function used to copy a value */\
+	void   (*_freeValue)   (ValueType value);                   /**< Pointer to a function used to free a value */\
+	void   (*_print)       (ValueType value);                   /**< Pointer to a function used to print a value */\
+	size_t (*_serialize)   (ValueType * value, void * buffer, size_t capacity); /**< Pointer to a function used to write a value in bytes */\
+	void   (*_deserialize) (ValueType * dest, const void * buffer, size_t size); /**< Pointer to a function used to read a value from bytes */\
+} SPILLQUEUE
+
+#define SPILLQUEUE_FN_NEW(SPILLQUEUE) \
+/**
+ @brief Create a new SPILLQUEUE object
+ @param directory    Existing directory where the segment files are written
+ @param memoryValues Number of values kept in memory at each end of the queue
+ @return A pointer to an allocated and initialized
+ SPILLQUEUE object in memory. NULL on error
+ */ \
+SPILLQUEUE * SPILLQUEUE ## _new(const char * directory, int memoryValues)
+
+#define SPILLQUEUE_FN_FREE(SPILLQUEUE) \
+/**
+ Destroy a SPILLQUEUE object
+ @details The segment files still holding values are removed.
+ @param queue A pointer to a SPILLQUEUE object
+ */ \
+void SPILLQUEUE ## _free(SPILLQUEUE * queue)
+
+#define SPILLQUEUE_FN_ENQUEUE_STRUCT(SPILLQUEUE, ValueType) \
+/**
+ Add a value at the end of the queue
+ @details If the values cannot be written to disk, they stay in memory
+ and the tail buffer grows.
+
+ @param queue A pointer to a valid SPILLQUEUE object
+ @param value The value to add
+ @return      1 if the value is added. 0 on error
+ */ \
+int SPILLQUEUE ## _enqueue(SPILLQUEUE * queue, ValueType value)
+
+#define SPILLQUEUE_FN_DEQUEUE_STRUCT(SPILLQUEUE, ValueType) \
+/**
+ Remove the value at the beginning of the queue
+ @details The caller becomes the owner of the returned value.
+
+ @param queue A pointer to a valid SPILLQUEUE object
+ @return      The first value. The default value if empty
+ */ \
+ValueType SPILLQUEUE ## _dequeue(SPILLQUEUE * queue)
+
+#define SPILLQUEUE_FN_HEAD_STRUCT(SPILLQUEUE, ValueType) \
+/**
+ Get the value at the beginning of the queue
+ @param queue A pointer to a valid SPILLQUEUE object
+ @return      The first value. The default value if empty
+ */ \
+ValueType SPILLQUEUE ## _head(SPILLQUEUE * queue)
+
+#define SPILLQUEUE_FN_PRINT_STRUCT(SPILLQUEUE) \
+/**
+ Print a queue
+ @details Only the values in memory are printed.
+ @param queue A pointer to a valid SPILLQUEUE object
+ */ \
+void SPILLQUEUE ## _print(SPILLQUEUE * queue)
+
+// =================
+//  Implementations
+// =================
+#define IMPLEMENT_SPILLQUEUE_FN_NEW(SPILLQUEUE, Valuetype, FN_CPY_VAL, FN_FREE_VAL, FN_PRINT_VAL, FN_SERIALIZE, FN_DESERIALIZE) \
+SPILLQUEUE * SPILLQUEUE ## _new(const char * directory, int memoryValues) \
+{ \
+	SPILLQUEUE * queue = NULL; \
+	if(directory == NULL) return NULL; \
+	if(memoryValues < 1) memoryValues = 1; \
+	queue = malloc(sizeof(SPILLQUEUE)); \
+	queue->head         = malloc(sizeof(Valuetype) * memoryValues); \
+	queue->headFirst    = 0; \
+	queue->headCount    = 0; \
+	queue->headCapacity = memoryValues; \
+	queue->tail         = malloc(sizeof(Valuetype) * memoryValues); \
+	queue->tailCount    = 0; \
+	queue->tailCapacity = memoryValues; \
+	queue->directory    = malloc(strlen(directory) + 1); \
+	strcpy(queue->directory, directory); \
+	queue->writer       = NULL; \
+	queue->reader       = NULL; \
+	queue->writeSegment = 0; \
+	queue->readSegment  = 0; \
+	queue->segmentBytes = 0; \
+	queue->spilled      = 0; \
+	queue->lost         = 0; \
+	queue->bufferSize   = 256; \
+	queue->buffer       = malloc(queue->bufferSize); \
+	queue->size         = 0; \
+	queue->elemSize     = sizeof(Valuetype); \
+	queue->freeValue    = 1; \
+	queue->_copyValue   = FN_CPY_VAL; \
+	queue->_freeValue   = FN_FREE_VAL; \
+	queue->_print       = FN_PRINT_VAL; \
+	queue->_serialize   = FN_SERIALIZE; \
+	queue->_deserialize = FN_DESERIALIZE; \
+	return queue; \
+}
+
+#define IMPLEMENT_SPILLQUEUE_FN_FREE(SPILLQUEUE) \
+void SPILLQUEUE ## _free(SPILLQUEUE * queue) \
+{ \
+	char path[4096]; \
+	unsigned long segment = 0; \
+	int i = 0; \
+	if(queue == NULL) return; \
+	if(queue->freeValue) \
+	{ \
+		for(i = 0 ; i < queue->headCount ; i++) \
+			queue->_freeValue(queue->head[(queue->headFirst + i) % queue->headCapacity]); \
+		for(i = 0 ; i < queue->tailCount ; i++) \
+			queue->_freeValue(queue->tail[i]); \
+	} \
+	if(queue->writer != NULL) fclose(queue->writer); \
+	if(queue->reader != NULL) fclose(queue->reader); \
+	/* Remove the segments not consumed yet */\
+	if(queue->writer != NULL || queue->reader != NULL || queue->readSegment != queue->writeSegment) \
+		for(segment = queue->readSegment ; segment <= queue->writeSegment ; segment++) \
+		{ \
+			SPILLQUEUE ## _segmentPath(queue, segment, path, sizeof(path)); \
+			remove(path); \
+		} \
+	free(queue->head); \
+	free(queue->tail); \
+	free(queue->directory); \
+	free(queue->buffer); \
+	free(queue); \
+}
+
+/* Internal helpers: segment file names, spill the tail, refill the head */
+#define IMPLEMENT_SPILLQUEUE_FN_SEGMENTS(SPILLQUEUE, Valuetype) \
+static void SPILLQUEUE ## _segmentPath(SPILLQUEUE * queue, unsigned long segment, char * path, size_t size) \
+{ \
+	snprintf(path, size, "%s/spill-%ld-%p-%lu.seg", queue->directory, (long)getpid(), (void *)queue, segment); \
+} \
+static FILE * SPILLQUEUE ## _openSegment(SPILLQUEUE * queue, unsigned long segment, const char * mode) \
+{ \
+	char path[4096]; \
+	FILE * file = NULL; \
+	SPILLQUEUE ## _segmentPath(queue, segment, path, sizeof(path)); \
+	if((file = fopen(path, mode)) != NULL) \
+		setvbuf(file, NULL, _IOFBF, SPILLQUEUE_IO_BYTES); \
+	return file; \
+} \
+static int SPILLQUEUE ## _spill(SPILLQUEUE * queue) \
+{ \
+	Valuetype * tail = NULL; \
+	uint32_t length = 0; \
+	size_t bytes = 0; \
+	long start = 0; \
+	int i = 0, failed = 0; \
+	/* Switch to a new segment when the current one is large enough */\
+	if(queue->writer != NULL && queue->segmentBytes >= SPILLQUEUE_SEGMENT_BYTES) \
+	{ \
+		fclose(queue->writer); \
+		queue->writer = NULL; \
+		queue->writeSegment++; \
+		queue->segmentBytes = 0; \
+	} \
+	if(queue->writer == NULL) \
+		queue->writer = SPILLQUEUE ## _openSegment(queue, queue->writeSegment, "wb"); \
+	failed = (queue->writer == NULL); \
+	/* Append the records (length, bytes) and flush them in one write */\
+	start = queue->segmentBytes; \
+	for(i = 0 ; i < queue->tailCount && !failed ; i++) \
+	{ \
+		while((bytes = queue->_serialize(&(queue->tail[i]), queue->buffer, queue->bufferSize)) > queue->bufferSize) \
+		{ \
+			queue->bufferSize = bytes; \
+			queue->buffer = realloc(queue->buffer, bytes); \
+		} \
+		length = (uint32_t)bytes; \
+		failed = fwrite(&length, sizeof(length), 1, queue->writer) != 1 \
+		      || (bytes > 0 && fwrite(queue->buffer, bytes, 1, queue->writer) != 1); \
+		queue->segmentBytes += sizeof(length) + bytes; \
+	} \
+	if(!failed) \
+		failed = fflush(queue->writer) != 0; \
+	if(failed) \
+	{ \
+		/* Drop the partial records, keep the values in memory */\
+		if(queue->writer != NULL) \
+		{ \
+			clearerr(queue->writer); \
+			if(ftruncate(fileno(queue->writer), start) == 0) \
+				fseek(queue->writer, start, SEEK_SET); \
+		} \
+		queue->segmentBytes = start; \
+		if((tail = realloc(queue->tail, sizeof(Valuetype) * queue->tailCapacity * 2)) != NULL) \
+		{ \
+			queue->tail = tail; \
+			queue->tailCapacity *= 2; \
+		} \
+		return 0; \
+	} \
+	if(queue->freeValue) \
+		for(i = 0 ; i < queue->tailCount ; i++) \
+			queue->_freeValue(queue->tail[i]); \
+	queue->spilled  += queue->tailCount; \
+	queue->tailCount = 0; \
+	return 1; \
+} \
+static void SPILLQUEUE ## _refill(SPILLQUEUE * queue) \
+{ \
+	char path[4096]; \
+	Valuetype * swap = NULL; \
+	uint32_t length = 0; \
+	int capacity = 0; \
+	queue->headFirst = 0; \
+	/* Nothing on disk: the tail becomes the head */\
+	if(queue->spilled == 0) \
+	{ \
+		swap = queue->head; \
+		capacity = queue->headCapacity; \
+		queue->head         = queue->tail; \
+		queue->headCapacity = queue->tailCapacity; \
+		queue->headCount    = queue->tailCount; \
+		queue->tail         = swap; \
+		queue->tailCapacity = capacity; \
+		queue->tailCount    = 0; \
+		return; \
+	} \
+	/* Read ahead a whole head buffer of records */\
+	if(queue->writer != NULL && queue->readSegment == queue->writeSegment) \
+		fflush(queue->writer); \
+	while(queue->headCount < queue->headCapacity && queue->spilled > 0) \
+	{ \
+		if(queue->reader == NULL \
+		&& (queue->reader = SPILLQUEUE ## _openSegment(queue, queue->readSegment, "rb")) == NULL) \
+			break; \
+		if(fread(&length, sizeof(length), 1, queue->reader) != 1) \
+		{ \
+			/* End of a finished segment: remove it, go to the next one */\
+			if(queue->readSegment == queue->writeSegment) \
+			{ \
+				clearerr(queue->reader); \
+				break; \
+			} \
+			fclose(queue->reader); \
+			queue->reader = NULL; \
+			SPILLQUEUE ## _segmentPath(queue, queue->readSegment, path, sizeof(path)); \
+			remove(path); \
+			queue->readSegment++; \
+			continue; \
+		} \
+		if(length > queue->bufferSize) \
+		{ \
+			queue->bufferSize = length; \
+			queue->buffer = realloc(queue->buffer, length); \
+		} \
+		if(length > 0 && fread(queue->buffer, length, 1, queue->reader) != 1) \
+			break; \
+		queue->_deserialize(&(queue->head[queue->headCount]), queue->buffer, length); \
+		queue->headCount++; \
+		queue->spilled--; \
+	} \
+	/* Values that cannot be read back are lost */\
+	if(queue->headCount == 0 && queue->spilled > 0) \
+	{ \
+		queue->size  -= queue->spilled; \
+		queue->lost  += queue->spilled; \
+		queue->spilled = 0; \
+		SPILLQUEUE ## _refill(queue); \
+	} \
+}
+
+#define IMPLEMENT_SPILLQUEUE_FN_ENQUEUE_STRUCT(SPILLQUEUE, Valuetype) \
+int SPILLQUEUE ## _enqueue(SPILLQUEUE * queue, Valuetype value) \
+{ \
+	if(queue == NULL) return 0; \
+	/* Nothing after the head: stay in the head buffer */\
+	if(queue->spilled == 0 && queue->tailCount == 0 && queue->headCount < queue->headCapacity) \
+	{ \
+		queue->_copyValue(&(queue->head[(queue->headFirst + queue->headCount) % queue->headCapacity]), &value); \
+		queue->headCount++; \
+		queue->size++; \
+		return 1; \
+	} \
+	if(queue->tailCount == queue->tailCapacity) \
+		SPILLQUEUE ## _spill(queue); \
+	if(queue->tailCount == queue->tailCapacity) \
+		return 0; \
+	queue->_copyValue(&(queue->tail[queue->tailCount]), &value); \
+	queue->tailCount++; \
+	queue->size++; \
+	return 1; \
+}
+
+#define IMPLEMENT_SPILLQUEUE_FN_DEQUEUE_STRUCT(SPILLQUEUE, Valuetype, DEFAULT_VALUE) \
+Valuetype SPILLQUEUE ## _dequeue(SPILLQUEUE * queue) \
+{ \
+	Valuetype value = DEFAULT_VALUE; \
+	if(queue == NULL || queue->size == 0) \
+		return DEFAULT_VALUE; \
+	if(queue->headCount == 0) \
+		SPILLQUEUE ## _refill(queue); \
+	if(queue->headCount == 0) \
+		return DEFAULT_VALUE; \
+	value = queue->head[queue->headFirst]; \
+	queue->headFirst = (queue->headFirst + 1) % queue->headCapacity; \
+	queue->headCount--; \
+	queue->size--; \
+	return value; \
+}
+
+#define IMPLEMENT_SPILLQUEUE_FN_HEAD_STRUCT(SPILLQUEUE, Valuetype, DEFAULT_VALUE) \
+Valuetype SPILLQUEUE ## _head(SPILLQUEUE * queue) \
+{ \
+	if(queue == NULL || queue->size == 0) \
+		return DEFAULT_VALUE; \
+	if(queue->headCount == 0) \
+		SPILLQUEUE ## _refill(queue); \
+	if(queue->headCount == 0) \
+		return DEFAULT_VALUE; \
+	return queue->head[queue->headFirst]; \
+}
+
+#ifdef CCONTAINERS_DISABLE_PRINT
+#define IMPLEMENT_SPILLQUEUE_FN_PRINT(SPILLQUEUE) \
+void SPILLQUEUE ## _print(SPILLQUEUE * queue) \
+{ \
+	(void)(queue); \
+}
+#else
+#define IMPLEMENT_SPILLQUEUE_FN_PRINT(SPILLQUEUE) \
+void SPILLQUEUE ## _print(SPILLQUEUE * queue) \
+{ \
+	int i = 0; \
+	printf("["); \
+	for(i = 0 ; i < queue->headCount ; i++) \
+	{ \
+		queue->_print(queue->head[(queue->headFirst + i) % queue->headCapacity]); \
+		if(i + 1 < queue->headCount || queue->spilled > 0 || queue->tailCount > 0) \
+			printf(", "); \
+	} \
+	if(queue->spilled > 0) \
+		printf("<%zu on disk>%s", queue->spilled, queue->tailCount > 0 ? ", " : ""); \
+	for(i = 0 ; i < queue->tailCount ; i++) \
+	{ \
+		queue->_print(queue->tail[i]); \
+		if(i + 1 < queue->tailCount) \
+			printf(", "); \
+	} \
+	printf("]\n"); \
+}
+#endif
+
+
+// MACRO HELPERS (One line definitions && implementations)
+#define NEW_SPILLQUEUE_DEFINITION(SPILLQUEUE, VALUETYPE) \
+NEW_SPILLQUEUE_TYPE(SPILLQUEUE, VALUETYPE); \
+SPILLQUEUE_FN_NEW(SPILLQUEUE); \
+SPILLQUEUE_FN_FREE(SPILLQUEUE); \
+SPILLQUEUE_FN_ENQUEUE_STRUCT(SPILLQUEUE, VALUETYPE); \
+SPILLQUEUE_FN_DEQUEUE_STRUCT(SPILLQUEUE, VALUETYPE); \
+SPILLQUEUE_FN_HEAD_STRUCT(SPILLQUEUE, VALUETYPE); \
+SPILLQUEUE_FN_PRINT_STRUCT(SPILLQUEUE)
+
+#define IMPLEMENT_SPILLQUEUE(SPILLQUEUE, VALUETYPE, FN_CPY_VAL, FN_FREE_VAL, FN_PRINT_VAL, FN_SERIALIZE, FN_DESERIALIZE, DEFAULT_VALUE) \
+IMPLEMENT_SPILLQUEUE_FN_NEW(SPILLQUEUE, VALUETYPE, FN_CPY_VAL, FN_FREE_VAL, FN_PRINT_VAL, FN_SERIALIZE, FN_DESERIALIZE); \
+IMPLEMENT_SPILLQUEUE_FN_SEGMENTS(SPILLQUEUE, VALUETYPE); \
+IMPLEMENT_SPILLQUEUE_FN_FREE(SPILLQUEUE); \
+IMPLEMENT_SPILLQUEUE_FN_ENQUEUE_STRUCT(SPILLQUEUE, VALUETYPE); \
+IMPLEMENT_SPILLQUEUE_FN_DEQUEUE_STRUCT(SPILLQUEUE, VALUETYPE, DEFAULT_VALUE); \
+IMPLEMENT_SPILLQUEUE_FN_HEAD_STRUCT(SPILLQUEUE, VALUETYPE, DEFAULT_VALUE); \
+IMPLEMENT_SPILLQUEUE_FN_PRINT(SPILLQUEUE)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SPILLQUEUE_H__
@@ -7,6 +7,7 @@
 #define __STACK_H__
 
 #include <stdlib.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -26,20 +27,46 @@ typedef struct _ ## ElemTypename \
 	struct _ ## ElemTypename * next; /**< Pointer to the next element in the stack */\
 } ElemTypename
 
-#define NEW_STACK_TYPE(STACK, ValueType) \
+#define NEW_STACK_STRUCT(STACK, ValueType, InlineStorage) \
 NEW_STACK_ELEM(STACK, STACK ## _elem_t, ValueType); \
 typedef struct STACK \
 { \
 	STACK ## _elem_t * top; /**< Top of the stack */\
 	int    size;            /**< Stack size */\
+	STACK ## _elem_t * spare; /**< Unused elements kept for reuse, linked by next */\
+	int    spareCount;      /**< Number of elements in spare */\
 	size_t elemSize;        /**< Size of one element in the stack */\
 	int    freeValue;       /**< Flag:<br>1: Automatically free the value<br>0: Do not automatically free the value */\
 	void (*_copyValue) (ValueType * dest, ValueType * src); /**< Pointer to a function used to copy a value */\
 	int  (*_cmpValue)  (ValueType val1, ValueType val2);    /**< Pointer to a function used to compare two values */\
 	void (*_freeValue) (ValueType value);                   /**< Pointer to a function used to free a value */\
 	void (*_print)     (ValueType value);                   /**< Pointer to a function used to print a value */\
+	STACK ## _elem_t * inlineElems; /**< Elements stored in the STACK object itself. NULL without inline storage */\
+	int    inlineCount;     /**< Number of elements in inlineElems */\
+	InlineStorage \
 } STACK
 
+/* Inline storage of a STACK object, and whether an element belongs to it (not to free) */
+#define STACK_FN_INLINE_STORAGE(STACK, STORAGE, N) \
+static inline STACK ## _elem_t * STACK ## _inlineStorage(STACK * stack, int * count) \
+{ \
+	(void)(stack); \
+	*count = N; \
+	return STORAGE; \
+} \
+static inline int STACK ## _isInline(STACK * stack, STACK ## _elem_t * elem) \
+{ \
+	return (uintptr_t)elem - (uintptr_t)stack->inlineElems < (uintptr_t)stack->inlineCount * sizeof(STACK ## _elem_t); \
+}
+
+#define NEW_STACK_TYPE(STACK, ValueType) \
+NEW_STACK_STRUCT(STACK, ValueType, ); \
+STACK_FN_INLINE_STORAGE(STACK, NULL, 0)
+
+#define NEW_STACK_SMALL_TYPE(STACK, ValueType, N) \
+NEW_STACK_STRUCT(STACK, ValueType, STACK ## _elem_t inlineStorage[N]; /**< Storage of the first N elements */); \
+STACK_FN_INLINE_STORAGE(STACK, stack->inlineStorage, N)
+
 #define STACK_FN_NEW(STACK) \
 /**
  @brief Create a new STACK object
@@ -47,6 +74,18 @@ typedef struct STACK \
  */ \
 STACK * STACK ## _new()
 
+#define STACK_FN_INIT(STACK) \
+/**
+ @brief Initialize a STACK object in place
+ @details For a STACK object on the stack or inside another structure,
+ released by STACK_destroy. The object must not be copied or moved
+ afterwards: its inline storage (see NEW_STACK_SMALL_DEFINITION) is linked
+ to it.
+ @param stack A pointer to the STACK object to initialize
+ @return      The pointer to the STACK object
+ */ \
+STACK * STACK ## _init(STACK * stack)
+
 #define STACK_FN_FREE(STACK) \
 /**
  Destroy a STACK object
@@ -54,6 +93,14 @@ STACK * STACK ## _new()
  */ \
 void STACK ## _free(STACK * stack)
 
+#define STACK_FN_DESTROY(STACK) \
+/**
+ Release the elements of a STACK object initialized by STACK_init
+ @details The STACK object itself is not freed.
+ @param stack A pointer to a STACK object
+ */ \
+void STACK ## _destroy(STACK * stack)
+
 #define STACK_FN_PUSH_STRUCT(STACK, ValueType) \
 /**
  Push an element to the stack
@@ -65,8 +112,9 @@ void STACK ## _push(STACK * stack, ValueType value)
 #define STACK_FN_POP_STRUCT(STACK, ValueType) \
 /**
  Remove an element from the stack
+ @details The caller becomes the owner of the returned value.
  @param stack  A pointer to a valid STACK object
- @return       The pointer to the STACK object
+ @return       The value on top of the stack. The default value if empty
  */ \
 ValueType STACK ## _pop(STACK * stack)
 
@@ -74,17 +122,36 @@ ValueType STACK ## _pop(STACK * stack)
 /**
  Get the value on top of the stack
  @param stack  A pointer to a valid STACK object
- @return       Iterator to the element if present. NULL otherwise
+ @return       The value on top of the stack. The default value if empty
  */ \
 ValueType STACK ## _peek(STACK * stack)
 
 #define STACK_FN_CLEAR_STRUCT(STACK) \
 /**
  Clear the stack
+ @details The elements are kept for the next pushes.
  @param stack A pointer to a valid STACK object
  */ \
 void STACK ## _clear(STACK * stack)
 
+#define STACK_FN_RESERVE(STACK) \
+/**
+ Allocate the elements for n values
+ @details The stack then holds n values without allocating.
+ @param stack A pointer to a valid STACK object
+ @param n     Number of values to hold
+ */ \
+void STACK ## _reserve(STACK * stack, int n)
+
+#define STACK_FN_SHRINK_TO_FIT(STACK) \
+/**
+ Release the elements kept for reuse
+ @details Elements left by STACK_clear and STACK_reserve are kept for
+ the next pushes until this call.
+ @param stack A pointer to a valid STACK object
+ */ \
+void STACK ## _shrink_to_fit(STACK * stack)
+
 #define STACK_FN_PRINT_STRUCT(STACK) \
 /**
  Print a stack
@@ -96,22 +163,36 @@ void STACK ## _print(STACK * set)
 //  Implementations
 // =================
 #define IMPLEMENT_STACK_FN_NEW(STACK, Valuetype, FN_CPY_VAL, FN_CMP_VAL, FN_FREE_VAL, FN_PRINT_VAL) \
-STACK * STACK ## _new() \
+STACK * STACK ## _init(STACK * stack) \
 { \
-	STACK * stack = malloc(sizeof(STACK)); \
+	int i = 0; \
 	stack->size  = 0; \
 	stack->top   = NULL; \
+	stack->spare = NULL; \
+	stack->spareCount = 0; \
 	stack->elemSize   = sizeof(STACK ## _elem_t); \
 	stack->freeValue  = 1; \
 	stack->_copyValue = FN_CPY_VAL; \
 	stack->_cmpValue  = FN_CMP_VAL; \
 	stack->_freeValue = FN_FREE_VAL; \
 	stack->_print     = FN_PRINT_VAL; \
+	/* The inline elements are the first spare ones */\
+	stack->inlineElems = STACK ## _inlineStorage(stack, &(stack->inlineCount)); \
+	for(i = stack->inlineCount - 1 ; i >= 0 ; i--) \
+	{ \
+		stack->inlineElems[i].next = stack->spare; \
+		stack->spare = &(stack->inlineElems[i]); \
+	} \
+	stack->spareCount = stack->inlineCount; \
 	return stack; \
+} \
+STACK * STACK ## _new() \
+{ \
+	return STACK ## _init(malloc(sizeof(STACK))); \
 }
 
 #define IMPLEMENT_STACK_FN_FREE(STACK) \
-void STACK ## _free(STACK * stack) \
+void STACK ## _destroy(STACK * stack) \
 { \
 	STACK ## _elem_t * it = NULL; \
 	if(stack == NULL) return; \
@@ -121,8 +202,18 @@ void STACK ## _free(STACK * stack) \
 		if(stack->freeValue) \
 			stack->_freeValue(it->value); \
 		stack->top = it->next; \
-		free(it); \
+		if(!STACK ## _isInline(stack, it)) free(it); \
 	} \
+	stack->size = 0; \
+	STACK ## _shrink_to_fit(stack); \
+	stack->spare      = NULL; \
+	stack->spareCount = 0; \
+} \
+void STACK ## _free(STACK * stack) \
+{ \
+	if(stack == NULL) return; \
+	STACK ## _destroy(stack); \
+	free(stack); \
 }
 
 #define IMPLEMENT_STACK_FN_PUSH_STRUCT(STACK, Valuetype) \
@@ -132,8 +223,14 @@ void STACK ## _push(STACK * stack, Valuetype value) \
 	/* Test if stack is NULL */\
 	if(stack == NULL) \
 		return; \
-	/* Create the element */\
-	elem = malloc(stack->elemSize); \
+	/* Create the element, reusing a spare one */\
+	if((elem = stack->spare) != NULL) \
+	{ \
+		stack->spare = elem->next; \
+		stack->spareCount--; \
+	} \
+	else \
+		elem = malloc(stack->elemSize); \
 	elem->next = stack->top; \
 	stack->_copyValue(&(elem->value), &(value)); \
 	/* Insert the element */\
@@ -155,15 +252,23 @@ ValueType STACK ## _pop(STACK * stack) \
 	{ \
 		stack->top = elem->next; \
 		stack->size--; \
-		stack->_copyValue(&(value), &(elem->value)); \
-		free(elem); \
+		value = elem->value; \
+		/* Inline elements go back to spare, the others are freed */\
+		if(STACK ## _isInline(stack, elem)) \
+		{ \
+			elem->next   = stack->spare; \
+			stack->spare = elem; \
+			stack->spareCount++; \
+		} \
+		else \
+			free(elem); \
 	} \
 	return value; \
 }
 
 
 #define IMPLEMENT_STACK_FN_PEEK_STRUCT(STACK, ValueType, DEFAULT_VALUE) \
-ValueType STACK ## _PEEK(STACK * stack) \
+ValueType STACK ## _peek(STACK * stack) \
 { \
 	if(stack == NULL) return DEFAULT_VALUE; \
 	if(stack->top != NULL) \
@@ -171,11 +276,66 @@ ValueType STACK ## _PEEK(STACK * stack) \
 	return DEFAULT_VALUE; \
 }
 
+#define IMPLEMENT_STACK_FN_CLEAR_STRUCT(STACK) \
+void STACK ## _clear(STACK * stack) \
+{ \
+	STACK ## _elem_t * it = NULL; \
+	if(stack == NULL) return; \
+	while((it = stack->top) != NULL) \
+	{ \
+		if(stack->freeValue) \
+			stack->_freeValue(it->value); \
+		stack->top   = it->next; \
+		it->next     = stack->spare; \
+		stack->spare = it; \
+		stack->spareCount++; \
+	} \
+	stack->size = 0; \
+}
+
+#define IMPLEMENT_STACK_FN_RESERVE(STACK) \
+void STACK ## _reserve(STACK * stack, int n) \
+{ \
+	STACK ## _elem_t * elem = NULL; \
+	if(stack == NULL) return; \
+	while(stack->size + stack->spareCount < n) \
+	{ \
+		if((elem = malloc(stack->elemSize)) == NULL) \
+			return; \
+		elem->next   = stack->spare; \
+		stack->spare = elem; \
+		stack->spareCount++; \
+	} \
+}
+
+#define IMPLEMENT_STACK_FN_SHRINK_TO_FIT(STACK) \
+void STACK ## _shrink_to_fit(STACK * stack) \
+{ \
+	STACK ## _elem_t * it = NULL, * next = NULL; \
+	if(stack == NULL) return; \
+	it = stack->spare; \
+	stack->spare      = NULL; \
+	stack->spareCount = 0; \
+	for( ; it != NULL ; it = next) \
+	{ \
+		next = it->next; \
+		if(!STACK ## _isInline(stack, it)) \
+		{ \
+			free(it); \
+			continue; \
+		} \
+		/* Inline elements stay spare */\
+		it->next     = stack->spare; \
+		stack->spare = it; \
+		stack->spareCount++; \
+	} \
+}
+
 #ifdef CCONTAINERS_DISABLE_PRINT
 #define IMPLEMENT_STACK_FN_PRINT(STACK) \
 void STACK ## _print(STACK * stack) \
 { \
-	(void)(list); \
+	(void)(stack); \
 }
 #else
 #define IMPLEMENT_STACK_FN_PRINT(STACK) \
@@ -197,11 +357,24 @@ void STACK ## _print(STACK * stack) \
 // MACRO HELPERS (One line definitions && implementations)
 #define NEW_STACK_DEFINITION(STACK, VALUETYPE) \
 NEW_STACK_TYPE(STACK, VALUETYPE); \
+NEW_STACK_FUNCTIONS(STACK, VALUETYPE)
+
+/* STACK holding its first N elements: they cost no allocation */
+#define NEW_STACK_SMALL_DEFINITION(STACK, VALUETYPE, N) \
+NEW_STACK_SMALL_TYPE(STACK, VALUETYPE, N); \
+NEW_STACK_FUNCTIONS(STACK, VALUETYPE)
+
+#define NEW_STACK_FUNCTIONS(STACK, VALUETYPE) \
 STACK_FN_NEW(STACK); \
+STACK_FN_INIT(STACK); \
 STACK_FN_FREE(STACK); \
+STACK_FN_DESTROY(STACK); \
 STACK_FN_PUSH_STRUCT(STACK, VALUETYPE); \
 STACK_FN_POP_STRUCT(STACK, VALUETYPE); \
 STACK_FN_PEEK_STRUCT(STACK, VALUETYPE); \
+STACK_FN_CLEAR_STRUCT(STACK); \
+STACK_FN_RESERVE(STACK); \
+STACK_FN_SHRINK_TO_FIT(STACK); \
 STACK_FN_PRINT_STRUCT(STACK)
 
 #define IMPLEMENT_STACK(STACK, VALUETYPE, FN_CPY_VAL, FN_CMP_VAL, FN_FREE_VAL, FN_PRINT_VAL, DEFAULT_VALUE) \
@@ -210,6 +383,9 @@ IMPLEMENT_STACK_FN_FREE(STACK); \
 IMPLEMENT_STACK_FN_PUSH_STRUCT(STACK, VALUETYPE); \
 IMPLEMENT_STACK_FN_POP_STRUCT(STACK, VALUETYPE, DEFAULT_VALUE); \
 IMPLEMENT_STACK_FN_PEEK_STRUCT(STACK, VALUETYPE, DEFAULT_VALUE); \
+IMPLEMENT_STACK_FN_CLEAR_STRUCT(STACK); \
+IMPLEMENT_STACK_FN_RESERVE(STACK); \
+IMPLEMENT_STACK_FN_SHRINK_TO_FIT(STACK); \
 IMPLEMENT_STACK_FN_PRINT(STACK)
 
 #ifdef __cplusplus
@@ -0,0 +1,235 @@
+/**
+ * @file threadpool.h
+ * @brief Thread pool used by the parallel algorithms
+ * @details A fixed set of worker threads executes jobs. A job is split in
+ * chunks; workers (and the thread that submitted the job) take chunks
+ * one at a time from an atomic counter, so fast threads naturally take
+ * more chunks than slow ones.
+ * Link with -pthread.
+ * @author Baudouin FEILDEL
+ */
+#ifndef __C_CONTAINERS_THREADPOOL_H__
+#define __C_CONTAINERS_THREADPOOL_H__
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ Job executed by a thread pool
+ */
+typedef struct ThreadPool_job
+{
+	void (*run)(void * data, int chunk); /**< Function executed for every chunk */
+	void * data;     /**< User data given to run */
+	int    chunks;   /**< Number of chunks of the job */
+	int    next;     /**< Next chunk to execute (atomic) */
+	int    finished; /**< Number of executed chunks (atomic) */
+	int    helpers;  /**< Number of workers still to be attached to the job */
+	int    refs;     /**< References to the job (atomic), the last one frees it */
+	int    detached; /**< Flag:<br>1: Nobody waits for the job<br>0: The submitter waits for the job */
+	struct ThreadPool_job * next_job; /**< Next job in the pool queue */
+} ThreadPool_job;
+
+/**
+ Thread pool
+ */
+typedef struct ThreadPool
+{
+	pthread_t      * threads;     /**< Worker threads */
+	int              threadCount; /**< Number of worker threads */
+	pthread_mutex_t  lock;        /**< Lock of the queue */
+	pthread_cond_t   work;        /**< Signaled when a job is queued */
+	pthread_cond_t   done;        /**< Signaled when a job is finished */
+	ThreadPool_job * head;        /**< First queued job */
+	ThreadPool_job * tail;        /**< Last queued job */
+	int              pending;     /**< Number of unfinished detached jobs */
+	int              stop;        /**< Flag:<br>1: Workers must exit<br>0: Workers run */
+} ThreadPool;
+
+/* Execute chunks of a job until none is left, then drop the reference */
+static inline void ThreadPool_work(ThreadPool * pool, ThreadPool_job * job)
+{
+	int chunk = 0;
+	while((chunk = __atomic_fetch_add(&(job->next), 1, __ATOMIC_RELAXED)) < job->chunks)
+	{
+		job->run(job->data, chunk);
+		if(__atomic_add_fetch(&(job->finished), 1, __ATOMIC_ACQ_REL) == job->chunks)
+		{
+			pthread_mutex_lock(&(pool->lock));
+			if(job->detached) pool->pending--;
+			pthread_cond_broadcast(&(pool->done));
+			pthread_mutex_unlock(&(pool->lock));
+		}
+	}
+	if(__atomic_sub_fetch(&(job->refs), 1, __ATOMIC_ACQ_REL) == 0)
+		free(job);
+}
+
+static inline void * ThreadPool_worker(void * data)
+{
+	ThreadPool * pool = data;
+	ThreadPool_job * job = NULL;
+	while(1)
+	{
+		pthread_mutex_lock(&(pool->lock));
+		while(pool->head == NULL && !pool->stop)
+			pthread_cond_wait(&(pool->work), &(pool->lock));
+		if(pool->head == NULL)
+		{
+			pthread_mutex_unlock(&(pool->lock));
+			return NULL;
+		}
+		/* Attach to the first job, dequeue it when it needs no more helpers */
+		job = pool->head;
+		if(--job->helpers == 0)
+		{
+			pool->head = job->next_job;
+			if(pool->head == NULL) pool->tail = NULL;
+		}
+		pthread_mutex_unlock(&(pool->lock));
+		ThreadPool_work(pool, job);
+	}
+}
+
+/**
+ @brief Create a new ThreadPool object
+ @param threads Number of worker threads. 0 to use one per core
+ @return A pointer to an allocated and initialized
+ ThreadPool object in memory
+ */
+static inline ThreadPool * ThreadPool_new(int threads)
+{
+	ThreadPool * pool = malloc(sizeof(ThreadPool));
+	int i = 0;
+	if(threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	if(threads <= 0) threads = 1;
+	pool->threads     = malloc(sizeof(pthread_t) * threads);
+	pool->threadCount = threads;
+	pool->head    = NULL;
+	pool->tail    = NULL;
+	pool->pending = 0;
+	pool->stop    = 0;
+	pthread_mutex_init(&(pool->lock), NULL);
+	pthread_cond_init(&(pool->work), NULL);
+	pthread_cond_init(&(pool->done), NULL);
+	for(i = 0 ; i < threads ; i++)
+		pthread_create(&(pool->threads[i]), NULL, ThreadPool_worker, pool);
+	return pool;
+}
+
+/**
+ Destroy a ThreadPool object
+ @details Wait for the queued jobs, then stop the workers.
+ @param pool A pointer to a ThreadPool object
+ */
+static inline void ThreadPool_free(ThreadPool * pool)
+{
+	int i = 0;
+	if(pool == NULL) return;
+	pthread_mutex_lock(&(pool->lock));
+	while(pool->pending > 0)
+		pthread_cond_wait(&(pool->done), &(pool->lock));
+	pool->stop = 1;
+	pthread_cond_broadcast(&(pool->work));
+	pthread_mutex_unlock(&(pool->lock));
+	for(i = 0 ; i < pool->threadCount ; i++)
+		pthread_join(pool->threads[i], NULL);
+	pthread_mutex_destroy(&(pool->lock));
+	pthread_cond_destroy(&(pool->work));
+	pthread_cond_destroy(&(pool->done));
+	free(pool->threads);
+	free(pool);
+}
+
+/* Queue a job for up to 'helpers' workers */
+static inline ThreadPool_job * ThreadPool_push(ThreadPool * pool, void (*run)(void * data, int chunk), void * data, int chunks, int helpers, int detached)
+{
+	ThreadPool_job * job = malloc(sizeof(ThreadPool_job));
+	job->run      = run;
+	job->data     = data;
+	job->chunks   = chunks;
+	job->next     = 0;
+	job->finished = 0;
+	job->helpers  = helpers;
+	job->refs     = helpers + (detached ? 0 : 2);
+	job->detached = detached;
+	job->next_job = NULL;
+	pthread_mutex_lock(&(pool->lock));
+	if(pool->tail != NULL) pool->tail->next_job = job;
+	else                   pool->head = job;
+	pool->tail = job;
+	if(detached) pool->pending++;
+	if(helpers == 1) pthread_cond_signal(&(pool->work));
+	else             pthread_cond_broadcast(&(pool->work));
+	pthread_mutex_unlock(&(pool->lock));
+	return job;
+}
+
+/**
+ Run \c chunks chunks of work in parallel and wait for all of them
+ @details \c run is called once for every chunk in [0, chunks[.
+ The calling thread executes chunks too, so ThreadPool_run can be
+ called from inside a chunk without deadlock.
+
+ @param pool   A pointer to a valid ThreadPool object. NULL to run sequentially
+ @param chunks Number of chunks
+ @param run    Function executed for every chunk
+ @param data   User data given to \c run
+ */
+static inline void ThreadPool_run(ThreadPool * pool, int chunks, void (*run)(void * data, int chunk), void * data)
+{
+	ThreadPool_job * job = NULL;
+	int i = 0, helpers = 0;
+	if(chunks <= 0) return;
+	if(pool == NULL || chunks == 1)
+	{
+		for(i = 0 ; i < chunks ; i++)
+			run(data, i);
+		return;
+	}
+	helpers = (chunks - 1 < pool->threadCount) ? chunks - 1 : pool->threadCount;
+	/* The caller holds two references: one to help, one to wait */
+	job = ThreadPool_push(pool, run, data, chunks, helpers, 0);
+	ThreadPool_work(pool, job);
+	pthread_mutex_lock(&(pool->lock));
+	while(__atomic_load_n(&(job->finished), __ATOMIC_ACQUIRE) < chunks)
+		pthread_cond_wait(&(pool->done), &(pool->lock));
+	pthread_mutex_unlock(&(pool->lock));
+	if(__atomic_sub_fetch(&(job->refs), 1, __ATOMIC_ACQ_REL) == 0)
+		free(job);
+}
+
+/**
+ Execute a task on a worker, without waiting for it
+ @param pool A pointer to a valid ThreadPool object
+ @param task Function to execute
+ @param data User data given to \c task
+ */
+static inline void ThreadPool_submit(ThreadPool * pool, void (*task)(void * data, int chunk), void * data)
+{
+	if(pool == NULL) return;
+	ThreadPool_push(pool, task, data, 1, 1, 1);
+}
+
+/**
+ Wait until every task given to ThreadPool_submit is finished
+ @param pool A pointer to a valid ThreadPool object
+ */
+static inline void ThreadPool_wait(ThreadPool * pool)
+{
+	if(pool == NULL) return;
+	pthread_mutex_lock(&(pool->lock));
+	while(pool->pending > 0)
+		pthread_cond_wait(&(pool->done), &(pool->lock));
+	pthread_mutex_unlock(&(pool->lock));
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif // __C_CONTAINERS_THREADPOOL_H__
@@ -0,0 +1,792 @@
+/**
+ * @file walqueue.h
+ * @brief Durable queue container backed by a write-ahead log
+ * @details Every enqueued value is appended to a log file before it is
+ * visible in the queue. Dequeuing advances a cursor which is saved from
+ * time to time in a checkpoint file. Opening the queue again replays the
+ * log from the last checkpoint, so after a crash the values dequeued since
+ * the last checkpoint are delivered again (at least once delivery).
+ *
+ * Log file:    header (magic, logical offset of the file start), then
+ *              records (length, CRC32 of the bytes, bytes).
+ * Checkpoint:  \<path\>.cursor, replaced atomically with rename.
+ *
+ * Sync policies:
+ * - WALQUEUE_SYNC_NONE:   the operating system decides when to write
+ * - WALQUEUE_SYNC_BATCH:  fdatasync every groupSize records or groupDelay
+ *                         microseconds, checked on every enqueue
+ * - WALQUEUE_SYNC_ALWAYS: _enqueue returns once its record is on disk.
+ *                         Concurrent enqueues share a single fdatasync
+ *                         (group commit): the first thread writes and syncs
+ *                         all the pending records, the others wait for it.
+ *                         A value is dequeued only once its record is on
+ *                         disk (WALQUEUE_available counts these values).
+ *                         If the write fails, the records which are not on
+ *                         disk are cut off the log and their values dropped.
+ *
+ * Once the dequeued part of the log is large enough, the remaining records
+ * are copied to a new log file which atomically replaces the old one.
+ *
+ * Values are converted with the same callbacks as the spill queue:
+ * - size_t serialize(ValueType * value, void * buffer, size_t capacity)
+ * - void deserialize(ValueType * dest, const void * buffer, size_t size)
+ *
+ * Every function is thread safe. Link with -pthread.
+ * @author Baudouin FEILDEL
+ */
+#ifndef __WALQUEUE_H__
+#define __WALQUEUE_H__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Sync policies */
+#define WALQUEUE_SYNC_NONE   0
+#define WALQUEUE_SYNC_BATCH  1
+#define WALQUEUE_SYNC_ALWAYS 2
+
+/** Default number of records per fdatasync with WALQUEUE_SYNC_BATCH */
+#ifndef WALQUEUE_GROUP_SIZE
+#define WALQUEUE_GROUP_SIZE 64
+#endif
+
+/** Default maximum delay between two fdatasync with WALQUEUE_SYNC_BATCH */
+#ifndef WALQUEUE_GROUP_DELAY_US
+#define WALQUEUE_GROUP_DELAY_US 10000
+#endif
+
+/** Default number of dequeues between two checkpoints */
+#ifndef WALQUEUE_CHECKPOINT_EVERY
+#define WALQUEUE_CHECKPOINT_EVERY 1024
+#endif
+
+/** Default size of the dequeued part of the log triggering a compaction */
+#ifndef WALQUEUE_COMPACT_BYTES
+#define WALQUEUE_COMPACT_BYTES (16 << 20)
+#endif
+
+/** Pending bytes written to the log without sync with WALQUEUE_SYNC_NONE */
+#ifndef WALQUEUE_WRITE_BYTES
+#define WALQUEUE_WRITE_BYTES (64 << 10)
+#endif
+
+#define WALQUEUE_MAGIC       "CCWALQ01"
+#define WALQUEUE_HEADER_SIZE 16
+#define WALQUEUE_RECORD_SIZE 8
+
+// =================
+//  Log helpers
+// =================
+static uint32_t WalQueue_crcTable[256];
+static pthread_once_t WalQueue_crcOnce = PTHREAD_ONCE_INIT;
+
+static inline void WalQueue_crcInit(void)
+{
+	uint32_t crc = 0, i = 0, bit = 0;
+	for(i = 0 ; i < 256 ; i++)
+	{
+		crc = i;
+		for(bit = 0 ; bit < 8 ; bit++)
+			crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+		WalQueue_crcTable[i] = crc;
+	}
+}
+
+/* CRC32 (IEEE) of a record */
+static inline uint32_t WalQueue_crc32(const unsigned char * data, size_t size)
+{
+	uint32_t crc = 0xFFFFFFFFu;
+	size_t i = 0;
+	for(i = 0 ; i < size ; i++)
+		crc = WalQueue_crcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	return ~crc;
+}
+
+static inline uint64_t WalQueue_now(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+/* Write the whole buffer at a position */
+static inline int WalQueue_write(int fd, const void * data, size_t size, off_t position)
+{
+	ssize_t written = 0;
+	while(size > 0)
+	{
+		if((written = pwrite(fd, data, size, position)) <= 0)
+			return 0;
+		data      = (const unsigned char *)data + written;
+		size     -= written;
+		position += written;
+	}
+	return 1;
+}
+
+/* Make a rename in the directory of path durable */
+static inline void WalQueue_syncDirectory(const char * path)
+{
+	char directory[4096];
+	char * slash = NULL;
+	int fd = -1;
+	snprintf(directory, sizeof(directory), "%s", path);
+	if((slash = strrchr(directory, '/')) == NULL) strcpy(directory, ".");
+	else if(slash == directory)                 directory[1] = '\0';
+	else                                        *slash = '\0';
+	if((fd = open(directory, O_RDONLY)) >= 0)
+	{
+		fsync(fd);
+		close(fd);
+	}
+}
+
+/* Create a file with its content, then atomically replace path with it */
+static inline int WalQueue_replace(const char * path, const char * tmp, int fd)
+{
+	if(fsync(fd) != 0 || rename(tmp, path) != 0)
+		return 0;
+	WalQueue_syncDirectory(path);
+	return 1;
+}
+
+// =============
+//  Definitions
+// =============
+#define NEW_WALQUEUE_TYPE(WALQUEUE, ValueType) \
+typedef struct WALQUEUE \
+{ \
+	ValueType * values;        /**< Circular buffer of the values in the queue */\
+	uint64_t  * ends;          /**< Log offset of the end of the record of each value */\
+	int    first;              /**< Position of the first value */\
+	int    capacity;           /**< Number of slots in values and ends */\
+	int    size;               /**< Queue size */\
+	char * path;               /**< Path of the log file */\
+	int    fd;                 /**< Log file */\
+	uint64_t base;             /**< Log offset of the first record of the file */\
+	uint64_t logEnd;           /**< Log offset after the last enqueued record */\
+	uint64_t writtenEnd;       /**< Log offset after the last written record */\
+	uint64_t durableEnd;       /**< Log offset after the last synced record */\
+	uint64_t cursor;           /**< Log offset after the last dequeued record */\
+	uint64_t lastSync;         /**< Time of the last sync in microseconds */\
+	unsigned char * pending;   /**< Records not written yet */\
+	size_t pendingSize;        /**< Number of bytes in pending */\
+	size_t pendingCapacity;    /**< Allocated bytes of pending */\
+	unsigned char * writing;   /**< Records being written by a flush */\
+	size_t writingCapacity;    /**< Allocated bytes of writing */\
+	int    flushing;           /**< Flag:<br>1: A thread writes the log<br>0: No write in progress */\
+	int    failed;             /**< Flag:<br>1: A write failed, enqueues are refused<br>0: No error */\
+	int    dequeued;           /**< Dequeues since the last checkpoint */\
+	int    syncPolicy;         /**< WALQUEUE_SYNC_NONE, WALQUEUE_SYNC_BATCH or WALQUEUE_SYNC_ALWAYS */\
+	int    groupSize;          /**< Records per sync with WALQUEUE_SYNC_BATCH */\
+	int    groupDelay;         /**< Maximum microseconds between syncs with WALQUEUE_SYNC_BATCH */\
+	int    checkpointEvery;    /**< Dequeues between two checkpoints */\
+	uint64_t compactBytes;     /**< Dequeued log bytes triggering a compaction */\
+	int    pendingRecords;     /**< Records enqueued since the last sync */\
+	pthread_mutex_t lock;      /**< Lock of the queue */\
+	pthread_cond_t  flushed;   /**< Signaled at the end of a flush */\
+	size_t elemSize;           /**< Size of one element in the queue */\
+	int    freeValue;          /**< Flag:<br>1: Automatically free the value<br>0: Do not automatically free the value */\
+	void   (*_copyValue)   (ValueType * dest, ValueType * src); /**< Pointer to a function used to copy a value */\
+	void   (*_freeValue)   (ValueType value);                   /**< Pointer to a function used to free a value */\
+	void   (*_print)       (ValueType value);                   /**< Pointer to a function used to print a value */\
+	size_t (*_serialize)   (ValueType * value, void * buffer, size_t capacity); /**< Pointer to a function used to write a value in bytes */\
+	void   (*_deserialize) (ValueType * dest, const void * buffer, size_t size); /**< Pointer to a function used to read a value from bytes */\
+} WALQUEUE
+
+#define WALQUEUE_FN_OPEN(WALQUEUE) \
+/**
+ @brief Open a WALQUEUE object, replaying its log
+ @details The log file is created if needed. A record torn by a crash at
+ the end of the log is discarded.
+
+ @param path       Path of the log file
+ @param syncPolicy WALQUEUE_SYNC_NONE, WALQUEUE_SYNC_BATCH or WALQUEUE_SYNC_ALWAYS
+ @return A pointer to an allocated and initialized
+ WALQUEUE object in memory. NULL on error
+ */ \
+WALQUEUE * WALQUEUE ## _open(const char * path, int syncPolicy)
+
+#define WALQUEUE_FN_CLOSE(WALQUEUE) \
+/**
+ Sync, checkpoint and destroy a WALQUEUE object
+ @param queue A pointer to a WALQUEUE object
+ */ \
+void WALQUEUE ## _close(WALQUEUE * queue)
+
+#define WALQUEUE_FN_ENQUEUE_STRUCT(WALQUEUE, ValueType) \
+/**
+ Append a value to the log and to the queue
+ @param queue A pointer to a valid WALQUEUE object
+ @param value The value to add
+ @return      1 if the value is added (on disk with WALQUEUE_SYNC_ALWAYS).
+              0 if the log cannot be written: the queue refuses the next values,
+              and with WALQUEUE_SYNC_ALWAYS the value is not added
+ */ \
+int WALQUEUE ## _enqueue(WALQUEUE * queue, ValueType value)
+
+#define WALQUEUE_FN_DEQUEUE_STRUCT(WALQUEUE, ValueType) \
+/**
+ Remove the value at the beginning of the queue
+ @details The caller becomes the owner of the returned value.
+
+ @param queue A pointer to a valid WALQUEUE object
+ @return      The first value. The default value if empty, or with
+              WALQUEUE_SYNC_ALWAYS if its record is not on disk yet
+              (WALQUEUE_available tells the two apart)
+ */ \
+ValueType WALQUEUE ## _dequeue(WALQUEUE * queue)
+
+#define WALQUEUE_FN_HEAD_STRUCT(WALQUEUE, ValueType) \
+/**
+ Get the value at the beginning of the queue
+ @param queue A pointer to a valid WALQUEUE object
+ @return      The first value. The default value if empty, or with
+              WALQUEUE_SYNC_ALWAYS if its record is not on disk yet
+              (WALQUEUE_available tells the two apart)
+ */ \
+ValueType WALQUEUE ## _head(WALQUEUE * queue)
+
+#define WALQUEUE_FN_AVAILABLE(WALQUEUE) \
+/**
+ Count the values which can be dequeued now
+ @details With WALQUEUE_SYNC_ALWAYS, queue->size also counts the values
+ whose record is not on disk yet. They are returned by WALQUEUE_dequeue
+ once their _enqueue succeeds.
+
+ @param queue A pointer to a valid WALQUEUE object
+ @return      The number of values WALQUEUE_dequeue can return
+ */ \
+int WALQUEUE ## _available(WALQUEUE * queue)
+
+#define WALQUEUE_FN_SYNC(WALQUEUE) \
+/**
+ Write and sync all the enqueued records
+ @param queue A pointer to a valid WALQUEUE object
+ @return      1 on success. 0 on error
+ */ \
+int WALQUEUE ## _sync(WALQUEUE * queue)
+
+#define WALQUEUE_FN_CHECKPOINT(WALQUEUE) \
+/**
+ Save the position of the first value of the queue
+ @details Values dequeued before a checkpoint are not replayed on open.
+ The log is compacted when its dequeued part is large enough.
+
+ @param queue A pointer to a valid WALQUEUE object
+ @return      1 on success. 0 on error
+ */ \
+int WALQUEUE ## _checkpoint(WALQUEUE * queue)
+
+#define WALQUEUE_FN_PRINT_STRUCT(WALQUEUE) \
+/**
+ Print a queue
+ @param queue A pointer to a valid WALQUEUE object
+ */ \
+void WALQUEUE ## _print(WALQUEUE * queue)
+
+// =================
+//  Implementations
+// =================
+/* Internal helpers, called with the lock held */
+#define IMPLEMENT_WALQUEUE_FN_HELPERS(WALQUEUE, Valuetype) \
+static void WALQUEUE ## _push(WALQUEUE * queue, Valuetype * value, uint64_t end) \
+{ \
+	Valuetype * values = NULL; \
+	uint64_t * ends = NULL; \
+	int i = 0, slot = 0; \
+	/* Grow the buffer, unrolling the circular order */\
+	if(queue->size == queue->capacity) \
+	{ \
+		values = malloc(sizeof(Valuetype) * queue->capacity * 2); \
+		ends   = malloc(sizeof(uint64_t) * queue->capacity * 2); \
+		for(i = 0 ; i < queue->size ; i++) \
+		{ \
+			values[i] = queue->values[(queue->first + i) % queue->capacity]; \
+			ends[i]   = queue->ends[(queue->first + i) % queue->capacity]; \
+		} \
+		free(queue->values); \
+		free(queue->ends); \
+		queue->values    = values; \
+		queue->ends      = ends; \
+		queue->first     = 0; \
+		queue->capacity *= 2; \
+	} \
+	slot = (queue->first + queue->size) % queue->capacity; \
+	queue->values[slot] = *value; \
+	queue->ends[slot]   = end; \
+	queue->size++; \
+} \
+/* Whether the first value can be dequeued: with WALQUEUE_SYNC_ALWAYS, */\
+/* once its record is on disk */\
+static int WALQUEUE ## _ready(WALQUEUE * queue) \
+{ \
+	return queue->size > 0 \
+	    && (queue->syncPolicy != WALQUEUE_SYNC_ALWAYS || queue->ends[queue->first] <= queue->durableEnd); \
+} \
+/* Number of values from the first one whose record is on disk */\
+static int WALQUEUE ## _readyCount(WALQUEUE * queue) \
+{ \
+	int count = queue->size; \
+	if(queue->syncPolicy != WALQUEUE_SYNC_ALWAYS) \
+		return count; \
+	while(count > 0 && queue->ends[(queue->first + count - 1) % queue->capacity] > queue->durableEnd) \
+		count--; \
+	return count; \
+} \
+/* Cut the records which did not reach the disk off the log, so that */\
+/* they are not replayed on open, then drop their values */\
+static void WALQUEUE ## _dropUnsynced(WALQUEUE * queue) \
+{ \
+	int last = 0; \
+	if(ftruncate(queue->fd, (off_t)(WALQUEUE_HEADER_SIZE + queue->durableEnd - queue->base)) == 0) \
+		fdatasync(queue->fd); \
+	queue->logEnd         = queue->durableEnd; \
+	queue->writtenEnd     = queue->durableEnd; \
+	queue->pendingSize    = 0; \
+	queue->pendingRecords = 0; \
+	while(queue->size > 0) \
+	{ \
+		last = (queue->first + queue->size - 1) % queue->capacity; \
+		if(queue->ends[last] <= queue->durableEnd) \
+			break; \
+		if(queue->freeValue) queue->_freeValue(queue->values[last]); \
+		queue->size--; \
+	} \
+} \
+static int WALQUEUE ## _flush(WALQUEUE * queue, int sync) \
+{ \
+	unsigned char * data = NULL; \
+	size_t size = 0, capacity = 0; \
+	uint64_t target = 0, position = 0; \
+	int success = 1; \
+	while(queue->flushing) \
+		pthread_cond_wait(&(queue->flushed), &(queue->lock)); \
+	if(queue->failed) \
+		return 0; \
+	if(queue->writtenEnd == queue->logEnd && (!sync || queue->durableEnd == queue->logEnd)) \
+		return 1; \
+	/* Take the pending records: enqueues go on in the other buffer */\
+	queue->flushing = 1; \
+	data     = queue->pending; \
+	size     = queue->pendingSize; \
+	capacity = queue->pendingCapacity; \
+	queue->pending         = queue->writing; \
+	queue->pendingCapacity = queue->writingCapacity; \
+	queue->pendingSize     = 0; \
+	queue->writing         = data; \
+	queue->writingCapacity = capacity; \
+	queue->pendingRecords  = 0; \
+	target   = queue->logEnd; \
+	position = WALQUEUE_HEADER_SIZE + queue->writtenEnd - queue->base; \
+	pthread_mutex_unlock(&(queue->lock)); \
+	success = WalQueue_write(queue->fd, data, size, (off_t)position); \
+	if(success && sync) \
+		success = fdatasync(queue->fd) == 0; \
+	pthread_mutex_lock(&(queue->lock)); \
+	if(success) \
+	{ \
+		queue->writtenEnd = target; \
+		if(sync) \
+		{ \
+			queue->durableEnd = target; \
+			queue->lastSync   = WalQueue_now(); \
+		} \
+	} \
+	else \
+		queue->failed = 1; \
+	queue->flushing = 0; \
+	pthread_cond_broadcast(&(queue->flushed)); \
+	return success; \
+} \
+static int WALQUEUE ## _compact(WALQUEUE * queue) \
+{ \
+	unsigned char header[WALQUEUE_HEADER_SIZE]; \
+	unsigned char buffer[1 << 16]; \
+	char tmp[4096]; \
+	off_t from = 0, to = WALQUEUE_HEADER_SIZE; \
+	ssize_t bytes = 0; \
+	int fd = -1, success = 1; \
+	/* Copy the records after the cursor to a new log file */\
+	snprintf(tmp, sizeof(tmp), "%s.tmp", queue->path); \
+	if((fd = open(tmp, O_RDWR | O_CREAT | O_TRUNC, 0644)) < 0) \
+		return 0; \
+	memcpy(header, WALQUEUE_MAGIC, 8); \
+	memcpy(header + 8, &(queue->cursor), 8); \
+	success = WalQueue_write(fd, header, WALQUEUE_HEADER_SIZE, 0); \
+	from = WALQUEUE_HEADER_SIZE + queue->cursor - queue->base; \
+	while(success && (bytes = pread(queue->fd, buffer, sizeof(buffer), from)) > 0) \
+	{ \
+		success = WalQueue_write(fd, buffer, bytes, to); \
+		from += bytes; \
+		to   += bytes; \
+	} \
+	if(!success || bytes < 0 || !WalQueue_replace(queue->path, tmp, fd)) \
+	{ \
+		close(fd); \
+		unlink(tmp); \
+		return 0; \
+	} \
+	close(queue->fd); \
+	queue->fd   = fd; \
+	queue->base = queue->cursor; \
+	return 1; \
+} \
+static int WALQUEUE ## _saveCursor(WALQUEUE * queue) \
+{ \
+	unsigned char header[WALQUEUE_HEADER_SIZE]; \
+	char path[4096]; \
+	char tmp[4096]; \
+	int fd = -1, success = 0; \
+	/* The cursor must never be ahead of the log on disk */\
+	while(queue->durableEnd < queue->cursor) \
+		if(!WALQUEUE ## _flush(queue, 1)) \
+			return 0; \
+	snprintf(path, sizeof(path), "%s.cursor", queue->path); \
+	snprintf(tmp, sizeof(tmp), "%s.cursor.tmp", queue->path); \
+	if((fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0) \
+		return 0; \
+	memcpy(header, WALQUEUE_MAGIC, 8); \
+	memcpy(header + 8, &(queue->cursor), 8); \
+	success = WalQueue_write(fd, header, WALQUEUE_HEADER_SIZE, 0) && WalQueue_replace(path, tmp, fd); \
+	close(fd); \
+	if(!success) \
+		unlink(tmp); \
+	queue->dequeued = 0; \
+	/* Compact once the dequeued part is large and most of the log */\
+	if(success && queue->cursor - queue->base >= queue->compactBytes \
+	&& queue->cursor - queue->base >= queue->logEnd - queue->cursor \
+	&& WALQUEUE ## _flush(queue, 0)) \
+		WALQUEUE ## _compact(queue); \
+	return success; \
+} \
+static int WALQUEUE ## _replay(WALQUEUE * queue) \
+{ \
+	unsigned char header[WALQUEUE_HEADER_SIZE]; \
+	unsigned char * data = NULL; \
+	char path[4096]; \
+	Valuetype value; \
+	uint32_t record[2]; \
+	off_t position = 0, end = 0; \
+	int fd = -1; \
+	end = lseek(queue->fd, 0, SEEK_END); \
+	/* New log: write the header */\
+	if(end < WALQUEUE_HEADER_SIZE) \
+	{ \
+		memcpy(header, WALQUEUE_MAGIC, 8); \
+		memset(header + 8, 0, 8); \
+		if(ftruncate(queue->fd, 0) != 0 || !WalQueue_write(queue->fd, header, WALQUEUE_HEADER_SIZE, 0) \
+		|| fsync(queue->fd) != 0) \
+			return 0; \
+		WalQueue_syncDirectory(queue->path); \
+		end = WALQUEUE_HEADER_SIZE; \
+	} \
+	if(pread(queue->fd, header, WALQUEUE_HEADER_SIZE, 0) != WALQUEUE_HEADER_SIZE \
+	|| memcmp(header, WALQUEUE_MAGIC, 8) != 0) \
+		return 0; \
+	memcpy(&(queue->base), header + 8, 8); \
+	queue->cursor = queue->base; \
+	/* Start after the last checkpoint */\
+	snprintf(path, sizeof(path), "%s.cursor", queue->path); \
+	if((fd = open(path, O_RDONLY)) >= 0) \
+	{ \
+		if(read(fd, header, WALQUEUE_HEADER_SIZE) == WALQUEUE_HEADER_SIZE \
+		&& memcmp(header, WALQUEUE_MAGIC, 8) == 0) \
+			memcpy(&(queue->cursor), header + 8, 8); \
+		close(fd); \
+	} \
+	if(queue->cursor < queue->base) \
+		queue->cursor = queue->base; \
+	if(queue->cursor > queue->base + (end - WALQUEUE_HEADER_SIZE)) \
+		queue->cursor = queue->base + (end - WALQUEUE_HEADER_SIZE); \
+	/* Load the records, up to the first torn or corrupted one */\
+	position = WALQUEUE_HEADER_SIZE + queue->cursor - queue->base; \
+	while(position + WALQUEUE_RECORD_SIZE <= end \
+	   && pread(queue->fd, record, WALQUEUE_RECORD_SIZE, position) == WALQUEUE_RECORD_SIZE \
+	   && position + WALQUEUE_RECORD_SIZE + record[0] <= end) \
+	{ \
+		data = realloc(data, record[0] ? record[0] : 1); \
+		if(pread(queue->fd, data, record[0], position + WALQUEUE_RECORD_SIZE) != (ssize_t)record[0] \
+		|| WalQueue_crc32(data, record[0]) != record[1]) \
+			break; \
+		position += WALQUEUE_RECORD_SIZE + record[0]; \
+		queue->_deserialize(&value, data, record[0]); \
+		WALQUEUE ## _push(queue, &value, queue->base + position - WALQUEUE_HEADER_SIZE); \
+	} \
+	free(data); \
+	/* Drop what follows the last valid record */\
+	if(position < end && (ftruncate(queue->fd, position) != 0 || fsync(queue->fd) != 0)) \
+		return 0; \
+	queue->logEnd     = queue->base + position - WALQUEUE_HEADER_SIZE; \
+	queue->writtenEnd = queue->logEnd; \
+	queue->durableEnd = queue->logEnd; \
+	return 1; \
+}
+
+#define IMPLEMENT_WALQUEUE_FN_OPEN(WALQUEUE, Valuetype, FN_CPY_VAL, FN_FREE_VAL, FN_PRINT_VAL, FN_SERIALIZE, FN_DESERIALIZE) \
+WALQUEUE * WALQUEUE ## _open(const char * path, int syncPolicy) \
+{ \
+	WALQUEUE * queue = NULL; \
+	if(path == NULL) return NULL; \
+	pthread_once(&WalQueue_crcOnce, WalQueue_crcInit); \
+	queue = malloc(sizeof(WALQUEUE)); \
+	queue->capacity = 16; \
+	queue->values   = malloc(sizeof(Valuetype) * queue->capacity); \
+	queue->ends     = malloc(sizeof(uint64_t) * queue->capacity); \
+	queue->first    = 0; \
+	queue->size     = 0; \
+	queue->path     = malloc(strlen(path) + 1); \
+	strcpy(queue->path, path); \
+	queue->base = queue->logEnd = queue->writtenEnd = queue->durableEnd = queue->cursor = 0; \
+	queue->lastSync        = WalQueue_now(); \
+	queue->pendingCapacity = 4096; \
+	queue->pending         = malloc(queue->pendingCapacity); \
+	queue->pendingSize     = 0; \
+	queue->writingCapacity = 4096; \
+	queue->writing         = malloc(queue->writingCapacity); \
+	queue->flushing        = 0; \
+	queue->failed          = 0; \
+	queue->dequeued        = 0; \
+	queue->syncPolicy      = syncPolicy; \
+	queue->groupSize       = WALQUEUE_GROUP_SIZE; \
+	queue->groupDelay      = WALQUEUE_GROUP_DELAY_US; \
+	queue->checkpointEvery = WALQUEUE_CHECKPOINT_EVERY; \
+	queue->compactBytes    = WALQUEUE_COMPACT_BYTES; \
+	queue->pendingRecords  = 0; \
+	pthread_mutex_init(&(queue->lock), NULL); \
+	pthread_cond_init(&(queue->flushed), NULL); \
+	queue->elemSize     = sizeof(Valuetype); \
+	queue->freeValue    = 1; \
+	queue->_copyValue   = FN_CPY_VAL; \
+	queue->_freeValue   = FN_FREE_VAL; \
+	queue->_print       = FN_PRINT_VAL; \
+	queue->_serialize   = FN_SERIALIZE; \
+	queue->_deserialize = FN_DESERIALIZE; \
+	queue->fd = open(path, O_RDWR | O_CREAT, 0644); \
+	if(queue->fd < 0 || !WALQUEUE ## _replay(queue)) \
+	{ \
+		queue->failed = 1; \
+		WALQUEUE ## _close(queue); \
+		return NULL; \
+	} \
+	return queue; \
+}
+
+#define IMPLEMENT_WALQUEUE_FN_CLOSE(WALQUEUE) \
+void WALQUEUE ## _close(WALQUEUE * queue) \
+{ \
+	int i = 0; \
+	if(queue == NULL) return; \
+	pthread_mutex_lock(&(queue->lock)); \
+	if(!queue->failed && WALQUEUE ## _flush(queue, 1)) \
+		WALQUEUE ## _saveCursor(queue); \
+	pthread_mutex_unlock(&(queue->lock)); \
+	if(queue->freeValue) \
+		for(i = 0 ; i < queue->size ; i++) \
+			queue->_freeValue(queue->values[(queue->first + i) % queue->capacity]); \
+	if(queue->fd >= 0) \
+		close(queue->fd); \
+	pthread_mutex_destroy(&(queue->lock)); \
+	pthread_cond_destroy(&(queue->flushed)); \
+	free(queue->values); \
+	free(queue->ends); \
+	free(queue->path); \
+	free(queue->pending); \
+	free(queue->writing); \
+	free(queue); \
+}
+
+#define IMPLEMENT_WALQUEUE_FN_ENQUEUE_STRUCT(WALQUEUE, Valuetype) \
+int WALQUEUE ## _enqueue(WALQUEUE * queue, Valuetype value) \
+{ \
+	Valuetype copy; \
+	unsigned char * record = NULL; \
+	uint32_t header[2]; \
+	size_t bytes = 0; \
+	uint64_t end = 0; \
+	int success = 1; \
+	if(queue == NULL) return 0; \
+	pthread_mutex_lock(&(queue->lock)); \
+	if(queue->failed) \
+	{ \
+		pthread_mutex_unlock(&(queue->lock)); \
+		return 0; \
+	} \
+	/* Serialize the record after the pending ones */\
+	while(queue->pendingSize + WALQUEUE_RECORD_SIZE >= queue->pendingCapacity) \
+	{ \
+		queue->pendingCapacity *= 2; \
+		queue->pending = realloc(queue->pending, queue->pendingCapacity); \
+	} \
+	for(;;) \
+	{ \
+		record = queue->pending + queue->pendingSize; \
+		bytes  = queue->_serialize(&value, record + WALQUEUE_RECORD_SIZE, \
+		                           queue->pendingCapacity - queue->pendingSize - WALQUEUE_RECORD_SIZE); \
+		if(queue->pendingSize + WALQUEUE_RECORD_SIZE + bytes <= queue->pendingCapacity) \
+			break; \
+		while(queue->pendingSize + WALQUEUE_RECORD_SIZE + bytes > queue->pendingCapacity) \
+			queue->pendingCapacity *= 2; \
+		queue->pending = realloc(queue->pending, queue->pendingCapacity); \
+	} \
+	header[0] = (uint32_t)bytes; \
+	header[1] = WalQueue_crc32(record + WALQUEUE_RECORD_SIZE, bytes); \
+	memcpy(record, header, WALQUEUE_RECORD_SIZE); \
+	queue->pendingSize += WALQUEUE_RECORD_SIZE + bytes; \
+	queue->pendingRecords++; \
+	queue->logEnd += WALQUEUE_RECORD_SIZE + bytes; \
+	end = queue->logEnd; \
+	queue->_copyValue(&copy, &value); \
+	WALQUEUE ## _push(queue, &copy, end); \
+	/* Write (and sync) according to the policy */\
+	switch(queue->syncPolicy) \
+	{ \
+		case WALQUEUE_SYNC_ALWAYS: \
+			while(success && queue->durableEnd < end) \
+				success = WALQUEUE ## _flush(queue, 1); \
+			if(!success) \
+				WALQUEUE ## _dropUnsynced(queue); \
+			break; \
+		case WALQUEUE_SYNC_BATCH: \
+			if(queue->pendingRecords >= queue->groupSize \
+			|| WalQueue_now() - queue->lastSync >= (uint64_t)queue->groupDelay) \
+				success = WALQUEUE ## _flush(queue, 1); \
+			break; \
+		default: \
+			if(queue->pendingSize >= WALQUEUE_WRITE_BYTES) \
+				success = WALQUEUE ## _flush(queue, 0); \
+			break; \
+	} \
+	pthread_mutex_unlock(&(queue->lock)); \
+	return success; \
+}
+
+#define IMPLEMENT_WALQUEUE_FN_DEQUEUE_STRUCT(WALQUEUE, Valuetype, DEFAULT_VALUE) \
+Valuetype WALQUEUE ## _dequeue(WALQUEUE * queue) \
+{ \
+	Valuetype value = DEFAULT_VALUE; \
+	if(queue == NULL) return DEFAULT_VALUE; \
+	pthread_mutex_lock(&(queue->lock)); \
+	if(WALQUEUE ## _ready(queue)) \
+	{ \
+		value = queue->values[queue->first]; \
+		queue->cursor = queue->ends[queue->first]; \
+		queue->first  = (queue->first + 1) % queue->capacity; \
+		queue->size--; \
+		if(++queue->dequeued >= queue->checkpointEvery) \
+			WALQUEUE ## _saveCursor(queue); \
+	} \
+	pthread_mutex_unlock(&(queue->lock)); \
+	return value; \
+}
+
+#define IMPLEMENT_WALQUEUE_FN_HEAD_STRUCT(WALQUEUE, Valuetype, DEFAULT_VALUE) \
+Valuetype WALQUEUE ## _head(WALQUEUE * queue) \
+{ \
+	Valuetype value = DEFAULT_VALUE; \
+	if(queue == NULL) return DEFAULT_VALUE; \
+	pthread_mutex_lock(&(queue->lock)); \
+	if(WALQUEUE ## _ready(queue)) \
+		value = queue->values[queue->first]; \
+	pthread_mutex_unlock(&(queue->lock)); \
+	return value; \
+}
+
+#define IMPLEMENT_WALQUEUE_FN_AVAILABLE(WALQUEUE) \
+int WALQUEUE ## _available(WALQUEUE * queue) \
+{ \
+	int count = 0; \
+	if(queue == NULL) return 0; \
+	pthread_mutex_lock(&(queue->lock)); \
+	count = WALQUEUE ## _readyCount(queue); \
+	pthread_mutex_unlock(&(queue->lock)); \
+	return count; \
+}
+
+#define IMPLEMENT_WALQUEUE_FN_SYNC(WALQUEUE) \
+int WALQUEUE ## _sync(WALQUEUE * queue) \
+{ \
+	int success = 0; \
+	if(queue == NULL) return 0; \
+	pthread_mutex_lock(&(queue->lock)); \
+	success = WALQUEUE ## _flush(queue, 1); \
+	pthread_mutex_unlock(&(queue->lock)); \
+	return success; \
+}
+
+#define IMPLEMENT_WALQUEUE_FN_CHECKPOINT(WALQUEUE) \
+int WALQUEUE ## _checkpoint(WALQUEUE * queue) \
+{ \
+	int success = 0; \
+	if(queue == NULL) return 0; \
+	pthread_mutex_lock(&(queue->lock)); \
+	success = WALQUEUE ## _saveCursor(queue); \
+	pthread_mutex_unlock(&(queue->lock)); \
+	return success; \
+}
+
+#ifdef CCONTAINERS_DISABLE_PRINT
+#define IMPLEMENT_WALQUEUE_FN_PRINT(WALQUEUE) \
+void WALQUEUE ## _print(WALQUEUE * queue) \
+{ \
+	(void)(queue); \
+}
+#else
+#define IMPLEMENT_WALQUEUE_FN_PRINT(WALQUEUE) \
+void WALQUEUE ## _print(WALQUEUE * queue) \
+{ \
+	int i = 0; \
+	pthread_mutex_lock(&(queue->lock)); \
+	printf("["); \
+	for(i = 0 ; i < queue->size ; i++) \
+	{ \
+		queue->_print(queue->values[(queue->first + i) % queue->capacity]); \
+		if(i + 1 < queue->size) \
+			printf(", "); \
+	} \
+	printf("]\n"); \
+	pthread_mutex_unlock(&(queue->lock)); \
+}
+#endif
+
+
+// MACRO HELPERS (One line definitions && implementations)
+#define NEW_WALQUEUE_DEFINITION(WALQUEUE, VALUETYPE) \
+NEW_WALQUEUE_TYPE(WALQUEUE, VALUETYPE); \
+WALQUEUE_FN_OPEN(WALQUEUE); \
+WALQUEUE_FN_CLOSE(WALQUEUE); \
+WALQUEUE_FN_ENQUEUE_STRUCT(WALQUEUE, VALUETYPE); \
+WALQUEUE_FN_DEQUEUE_STRUCT(WALQUEUE, VALUETYPE); \
+WALQUEUE_FN_HEAD_STRUCT(WALQUEUE, VALUETYPE); \
+WALQUEUE_FN_AVAILABLE(WALQUEUE); \
+WALQUEUE_FN_SYNC(WALQUEUE); \
+WALQUEUE_FN_CHECKPOINT(WALQUEUE); \
+WALQUEUE_FN_PRINT_STRUCT(WALQUEUE)
+
+#define IMPLEMENT_WALQUEUE(WALQUEUE, VALUETYPE, FN_CPY_VAL, FN_FREE_VAL, FN_PRINT_VAL, FN_SERIALIZE, FN_DESERIALIZE, DEFAULT_VALUE) \
+IMPLEMENT_WALQUEUE_FN_HELPERS(WALQUEUE, VALUETYPE); \
+IMPLEMENT_WALQUEUE_FN_OPEN(WALQUEUE, VALUETYPE, FN_CPY_VAL, FN_FREE_VAL, FN_PRINT_VAL, FN_SERIALIZE, FN_DESERIALIZE); \
+IMPLEMENT_WALQUEUE_FN_CLOSE(WALQUEUE); \
+IMPLEMENT_WALQUEUE_FN_ENQUEUE_STRUCT(WALQUEUE, VALUETYPE); \
+IMPLEMENT_WALQUEUE_FN_DEQUEUE_STRUCT(WALQUEUE, VALUETYPE, DEFAULT_VALUE); \
+IMPLEMENT_WALQUEUE_FN_HEAD_STRUCT(WALQUEUE, VALUETYPE, DEFAULT_VALUE); \
+IMPLEMENT_WALQUEUE_FN_AVAILABLE(WALQUEUE); \
+IMPLEMENT_WALQUEUE_FN_SYNC(WALQUEUE); \
+IMPLEMENT_WALQUEUE_FN_CHECKPOINT(WALQUEUE); \
+IMPLEMENT_WALQUEUE_FN_PRINT(WALQUEUE)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __WALQUEUE_H__
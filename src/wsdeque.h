@@ -0,0 +1,240 @@
+/**
+ * @file wsdeque.h
+ * @brief Work-stealing deque container definition
+ * @details A work-stealing deque (Chase-Lev) is a stack for its owner
+ * thread and a queue for the other threads:
+ * - the owner pushes and pops values at the bottom, without any lock
+ *   (a compare-and-swap is only needed for the last value),
+ * - thieves steal the oldest value at the top with a compare-and-swap.
+ *
+ * Values live in a circular buffer which grows when full. Old buffers may
+ * still be read by thieves, so they are kept until WSDEQUE_free.
+ * Values are copied with atomic loads and stores: use pointers or small
+ * scalars. The deque never frees them.
+ * @author Baudouin FEILDEL
+ */
+#ifndef __WSDEQUE_H__
+#define __WSDEQUE_H__
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Results of WSDEQUE_steal */
+#define WSDEQUE_OK     1
+#define WSDEQUE_EMPTY  0
+#define WSDEQUE_ABORT -1
+
+// =============
+//  Definitions
+// =============
+#define NEW_WSDEQUE_BUFFER(WSDEQUE, BufferTypename, Valuetype) \
+/**
+ Circular buffer of a WSDEQUE object
+ */ \
+typedef struct _ ## BufferTypename \
+{ \
+	long mask;                     /**< Number of slots - 1 (a power of 2) */\
+	struct _ ## BufferTypename * previous; /**< Previous (smaller) buffer */\
+	Valuetype slots[];             /**< Values, at their position & mask */\
+} BufferTypename
+
+#define NEW_WSDEQUE_TYPE(WSDEQUE, Valuetype) \
+NEW_WSDEQUE_BUFFER(WSDEQUE, WSDEQUE ## _buffer_t, Valuetype); \
+typedef struct WSDEQUE \
+{ \
+	long top;                                 /**< Position of the oldest value, moved by thieves (atomic) */\
+	char padding[64];                         /**< Keeps top and bottom on different cache lines */\
+	long bottom;                              /**< Position after the newest value, moved by the owner (atomic) */\
+	WSDEQUE ## _buffer_t * buffer;            /**< Current buffer (atomic) */\
+	size_t elemSize;                          /**< Size of one element in the deque */\
+} WSDEQUE
+
+#define WSDEQUE_FN_NEW(WSDEQUE) \
+/**
+ @brief Create a new WSDEQUE object
+ @param capacity Initial number of slots, rounded up to a power of 2
+ @return A pointer to an allocated and initialized
+ WSDEQUE object in memory
+ */ \
+WSDEQUE * WSDEQUE ## _new(int capacity)
+
+#define WSDEQUE_FN_FREE(WSDEQUE) \
+/**
+ Destroy a WSDEQUE object
+ @details No other thread may use the deque anymore.
+ @param deque A pointer to a WSDEQUE object
+ */ \
+void WSDEQUE ## _free(WSDEQUE * deque)
+
+#define WSDEQUE_FN_PUSH(WSDEQUE, Valuetype) \
+/**
+ Push a value at the bottom. Owner thread only
+ @param deque A pointer to a valid WSDEQUE object
+ @param value The value to push
+ */ \
+void WSDEQUE ## _push(WSDEQUE * deque, Valuetype value)
+
+#define WSDEQUE_FN_POP(WSDEQUE, Valuetype) \
+/**
+ Pop the newest value from the bottom. Owner thread only
+ @param deque A pointer to a valid WSDEQUE object
+ @param value Receives the value
+ @return      1 if a value was popped. 0 if the deque is empty
+ */ \
+int WSDEQUE ## _pop(WSDEQUE * deque, Valuetype * value)
+
+#define WSDEQUE_FN_STEAL(WSDEQUE, Valuetype) \
+/**
+ Steal the oldest value from the top. Any thread
+ @param deque A pointer to a valid WSDEQUE object
+ @param value Receives the value
+ @return      WSDEQUE_OK, WSDEQUE_EMPTY, or WSDEQUE_ABORT if another
+ thread took the value first (the deque may not be empty)
+ */ \
+int WSDEQUE ## _steal(WSDEQUE * deque, Valuetype * value)
+
+#define WSDEQUE_FN_SIZE(WSDEQUE) \
+/**
+ Count the values of the deque
+ @details Only an estimate while other threads use the deque.
+ @param deque A pointer to a valid WSDEQUE object
+ @return      Number of values in the deque
+ */ \
+long WSDEQUE ## _size(WSDEQUE * deque)
+
+// =================
+//  Implementations
+// =================
+#define IMPLEMENT_WSDEQUE_FN_NEW(WSDEQUE, Valuetype) \
+WSDEQUE * WSDEQUE ## _new(int capacity) \
+{ \
+	WSDEQUE * deque = malloc(sizeof(WSDEQUE)); \
+	long slots = 16; \
+	while(slots < capacity) slots *= 2; \
+	deque->buffer = malloc(sizeof(WSDEQUE ## _buffer_t) + sizeof(Valuetype) * slots); \
+	deque->buffer->mask     = slots - 1; \
+	deque->buffer->previous = NULL; \
+	deque->top      = 0; \
+	deque->bottom   = 0; \
+	deque->elemSize = sizeof(Valuetype); \
+	return deque; \
+}
+
+#define IMPLEMENT_WSDEQUE_FN_FREE(WSDEQUE) \
+void WSDEQUE ## _free(WSDEQUE * deque) \
+{ \
+	WSDEQUE ## _buffer_t * buffer = NULL, * previous = NULL; \
+	if(deque == NULL) return; \
+	for(buffer = deque->buffer ; buffer != NULL ; buffer = previous) \
+	{ \
+		previous = buffer->previous; \
+		free(buffer); \
+	} \
+	free(deque); \
+}
+
+#define IMPLEMENT_WSDEQUE_FN_PUSH(WSDEQUE, Valuetype) \
+void WSDEQUE ## _push(WSDEQUE * deque, Valuetype value) \
+{ \
+	long bottom = __atomic_load_n(&(deque->bottom), __ATOMIC_RELAXED); \
+	long top    = __atomic_load_n(&(deque->top), __ATOMIC_ACQUIRE); \
+	long i = 0; \
+	WSDEQUE ## _buffer_t * buffer = __atomic_load_n(&(deque->buffer), __ATOMIC_RELAXED); \
+	WSDEQUE ## _buffer_t * grown  = NULL; \
+	Valuetype copy; \
+	/* Full: copy the values in a buffer twice larger, keep the old one for the thieves */\
+	if(bottom - top > buffer->mask) \
+	{ \
+		grown = malloc(sizeof(WSDEQUE ## _buffer_t) + sizeof(Valuetype) * (buffer->mask + 1) * 2); \
+		grown->mask     = (buffer->mask + 1) * 2 - 1; \
+		grown->previous = buffer; \
+		for(i = top ; i < bottom ; i++) \
+		{ \
+			__atomic_load(&(buffer->slots[i & buffer->mask]), &copy, __ATOMIC_RELAXED); \
+			__atomic_store(&(grown->slots[i & grown->mask]), &copy, __ATOMIC_RELAXED); \
+		} \
+		__atomic_store_n(&(deque->buffer), grown, __ATOMIC_RELEASE); \
+		buffer = grown; \
+	} \
+	__atomic_store(&(buffer->slots[bottom & buffer->mask]), &value, __ATOMIC_RELAXED); \
+	__atomic_store_n(&(deque->bottom), bottom + 1, __ATOMIC_RELEASE); \
+}
+
+#define IMPLEMENT_WSDEQUE_FN_POP(WSDEQUE, Valuetype) \
+int WSDEQUE ## _pop(WSDEQUE * deque, Valuetype * value) \
+{ \
+	long bottom = __atomic_load_n(&(deque->bottom), __ATOMIC_RELAXED) - 1; \
+	long top    = 0; \
+	int  found  = 1; \
+	WSDEQUE ## _buffer_t * buffer = __atomic_load_n(&(deque->buffer), __ATOMIC_RELAXED); \
+	/* Reserve the bottom value before looking at the thieves */\
+	__atomic_store_n(&(deque->bottom), bottom, __ATOMIC_RELAXED); \
+	__atomic_thread_fence(__ATOMIC_SEQ_CST); \
+	top = __atomic_load_n(&(deque->top), __ATOMIC_RELAXED); \
+	if(top > bottom) \
+	{ \
+		__atomic_store_n(&(deque->bottom), bottom + 1, __ATOMIC_RELAXED); \
+		return 0; \
+	} \
+	__atomic_load(&(buffer->slots[bottom & buffer->mask]), value, __ATOMIC_RELAXED); \
+	/* Last value: race against the thieves */\
+	if(top == bottom) \
+	{ \
+		found = __atomic_compare_exchange_n(&(deque->top), &top, top + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED); \
+		__atomic_store_n(&(deque->bottom), bottom + 1, __ATOMIC_RELAXED); \
+	} \
+	return found; \
+}
+
+#define IMPLEMENT_WSDEQUE_FN_STEAL(WSDEQUE, Valuetype) \
+int WSDEQUE ## _steal(WSDEQUE * deque, Valuetype * value) \
+{ \
+	long top    = __atomic_load_n(&(deque->top), __ATOMIC_ACQUIRE); \
+	long bottom = 0; \
+	WSDEQUE ## _buffer_t * buffer = NULL; \
+	__atomic_thread_fence(__ATOMIC_SEQ_CST); \
+	bottom = __atomic_load_n(&(deque->bottom), __ATOMIC_ACQUIRE); \
+	if(top >= bottom) \
+		return WSDEQUE_EMPTY; \
+	buffer = __atomic_load_n(&(deque->buffer), __ATOMIC_ACQUIRE); \
+	__atomic_load(&(buffer->slots[top & buffer->mask]), value, __ATOMIC_RELAXED); \
+	if(!__atomic_compare_exchange_n(&(deque->top), &top, top + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) \
+		return WSDEQUE_ABORT; \
+	return WSDEQUE_OK; \
+}
+
+#define IMPLEMENT_WSDEQUE_FN_SIZE(WSDEQUE) \
+long WSDEQUE ## _size(WSDEQUE * deque) \
+{ \
+	long bottom = __atomic_load_n(&(deque->bottom), __ATOMIC_RELAXED); \
+	long top    = __atomic_load_n(&(deque->top), __ATOMIC_RELAXED); \
+	return bottom > top ? bottom - top : 0; \
+}
+
+
+// MACRO HELPERS (One line definitions && implementations)
+#define NEW_WSDEQUE_DEFINITION(WSDEQUE, VALUETYPE) \
+NEW_WSDEQUE_TYPE(WSDEQUE, VALUETYPE); \
+WSDEQUE_FN_NEW(WSDEQUE); \
+WSDEQUE_FN_FREE(WSDEQUE); \
+WSDEQUE_FN_PUSH(WSDEQUE, VALUETYPE); \
+WSDEQUE_FN_POP(WSDEQUE, VALUETYPE); \
+WSDEQUE_FN_STEAL(WSDEQUE, VALUETYPE); \
+WSDEQUE_FN_SIZE(WSDEQUE)
+
+#define IMPLEMENT_WSDEQUE(WSDEQUE, VALUETYPE) \
+IMPLEMENT_WSDEQUE_FN_NEW(WSDEQUE, VALUETYPE); \
+IMPLEMENT_WSDEQUE_FN_FREE(WSDEQUE); \
+IMPLEMENT_WSDEQUE_FN_PUSH(WSDEQUE, VALUETYPE); \
+IMPLEMENT_WSDEQUE_FN_POP(WSDEQUE, VALUETYPE); \
+IMPLEMENT_WSDEQUE_FN_STEAL(WSDEQUE, VALUETYPE); \
+IMPLEMENT_WSDEQUE_FN_SIZE(WSDEQUE)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __WSDEQUE_H__